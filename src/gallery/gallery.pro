@@ -19,6 +19,7 @@ PUBLIC_HEADERS += \
     qgalleryqueryrequest.h \
     qgalleryresource.h \
     qgalleryresultset.h \
+    qgalleryrowbuffer.h \
     qgallerytype.h \
     qgallerytyperequest.h
 
@@ -40,6 +41,7 @@ SOURCES += \
     qgalleryqueryrequest.cpp \
     qgalleryresource.cpp \
     qgalleryresultset.cpp \
+    qgalleryrowbuffer.cpp \
     qgallerytyperequest.cpp
 
 OTHER_FILES = \
@@ -941,6 +941,23 @@ Q_DEFINE_GALLERY_PROPERTY(QDocumentGallery, count)
     Destroys a document gallery.
 */
 
+/*!
+    \fn QDocumentGallery::isReady() const
+
+    Returns true if the gallery has connected to its back-end.
+
+    The connection is opened in the background when the first gallery is
+    constructed.  Requests executed before it is ready remain active and are
+    started once it is, or finish with a ConnectionError if it can't be opened.
+*/
+
+/*!
+    \fn QDocumentGallery::readyChanged()
+
+    Signals that the gallery has connected to its back-end and isReady() now
+    returns true.
+*/
+
 /*!
     \fn QDocumentGallery::isRequestSupported(QGalleryAbstractRequest::RequestType type) const
 
@@ -978,6 +995,11 @@ QDocumentGallery::~QDocumentGallery()
 {
 }
 
+bool QDocumentGallery::isReady() const
+{
+    return true;
+}
+
 bool QDocumentGallery::isRequestSupported(QGalleryAbstractRequest::RequestType) const
 {
     return false;
@@ -166,12 +166,17 @@ public:
     QDocumentGallery(QObject *parent = Q_NULLPTR);
     ~QDocumentGallery();
 
+    bool isReady() const;
+
     bool isRequestSupported(QGalleryAbstractRequest::RequestType type) const;
 
     QStringList itemTypePropertyNames(const QString &itemType) const;
     QGalleryProperty::Attributes propertyAttributes(
             const QString &propertyName, const QString &itemType) const;
 
+Q_SIGNALS:
+    void readyChanged();
+
 protected:
     QGalleryAbstractResponse *createResponse(QGalleryAbstractRequest *request);
 
@@ -163,6 +163,38 @@ bool QGalleryAbstractResponse::isIdle() const
     return d_func()->state == QGalleryAbstractRequest::Idle;
 }
 
+/*!
+    Identifies if updates to the items returned by a response are suspended.
+
+    Returns true if updates are suspended, and false otherwise.
+*/
+
+bool QGalleryAbstractResponse::isSuspended() const
+{
+    return d_func()->suspended;
+}
+
+/*!
+    Sets whether updates to the items returned by an idle response are
+     suspended.
+
+    While suspended a response keeps the items it has but only records that
+    they have changed, once updates resume it will refresh them a single time
+    to catch up.  Responses which don't monitor their items for changes ignore
+    this.
+*/
+
+void QGalleryAbstractResponse::setSuspended(bool suspended)
+{
+    Q_D(QGalleryAbstractResponse);
+
+    if (d->suspended != suspended) {
+        d->suspended = suspended;
+
+        d->suspendedChanged();
+    }
+}
+
 /*!
     Returns an identifier describing an error condition encountered by a
     response.
@@ -65,6 +65,9 @@ public:
     bool isActive() const;
     bool isIdle() const;
 
+    bool isSuspended() const;
+    void setSuspended(bool suspended);
+
     virtual void cancel();
 
     virtual bool waitForFinished(int msecs);
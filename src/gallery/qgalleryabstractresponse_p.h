@@ -69,15 +69,19 @@ public:
         , waitLoop(0)
         , error(QGalleryAbstractRequest::NoError)
         , state(QGalleryAbstractRequest::Active)
+        , suspended(false)
     {
     }
 
     virtual ~QGalleryAbstractResponsePrivate() {}
 
+    virtual void suspendedChanged() {}
+
     QGalleryAbstractResponse *q_ptr;
     QEventLoop *waitLoop;
     int error;
     QGalleryAbstractRequest::State state;
+    bool suspended;
     QString errorString;
 };
 
@@ -44,9 +44,12 @@
 #include "qgalleryresultset.h"
 #include "qgalleryqueryrequest.h"
 
+#include <QtCore/qbitarray.h>
 #include <QtCore/qstringlist.h>
 #include <QtCore/qpointer.h>
 
+#include <climits>
+
 QT_BEGIN_NAMESPACE_DOCGALLERY
 
 class QGalleryQueryModelPrivate
@@ -54,11 +57,18 @@ class QGalleryQueryModelPrivate
 public:
     typedef QHash<int, QString> RoleProperties;
 
+    enum
+    {
+        MaximumRoleStride = Qt::UserRole + 256
+    };
+
     QGalleryQueryModelPrivate(QAbstractGallery *gallery)
         : q_ptr(0)
         , resultSet(0)
         , columnCount(0)
         , rowCount(0)
+        , rowLimit(INT_MAX)
+        , roleStride(0)
         , query(gallery)
     {
     }
@@ -80,14 +90,22 @@ public:
         QObject::connect(&query, SIGNAL(autoUpdateChanged()), q_ptr, SIGNAL(autoUpdateChanged()));
         QObject::connect(&query, SIGNAL(offsetChanged()), q_ptr, SIGNAL(offsetChanged()));
         QObject::connect(&query, SIGNAL(limitChanged()), q_ptr, SIGNAL(limitChanged()));
+        QObject::connect(&query, SIGNAL(pageSizeChanged()), q_ptr, SIGNAL(pageSizeChanged()));
         QObject::connect(&query, SIGNAL(rootTypeChanged()), q_ptr, SIGNAL(rootTypeChanged()));
         QObject::connect(&query, SIGNAL(rootItemChanged()), q_ptr, SIGNAL(rootItemChanged()));
         QObject::connect(&query, SIGNAL(scopeChanged()), q_ptr, SIGNAL(scopeChanged()));
         QObject::connect(&query, SIGNAL(filterChanged()), q_ptr, SIGNAL(filterChanged()));
     }
 
-    void updateRoles(int column);
     void updateRoles();
+
+    int roleKey(int column, int role) const
+    {
+        return role >= 0 && role < roleStride
+                ? roleKeys.at(column * roleStride + role)
+                : sparseRoleKeys.at(column).value(role, -1);
+    }
+
     void _q_resultSetChanged(QGalleryResultSet *resultSet);
     void _q_itemsInserted(int index, int count);
     void _q_itemsRemoved(int index, int count);
@@ -98,97 +116,80 @@ public:
     QGalleryResultSet *resultSet;
     int columnCount;
     int rowCount;
+    int rowLimit;
+    int roleStride;
     QGalleryQueryRequest query;
     QVector<RoleProperties> roleProperties;
     QVector<int> roleKeys;
-    QVector<int> columnOffsets;
+    QVector<QHash<int, int> > sparseRoleKeys;
+    QHash<int, QBitArray> keyColumns;
     QVector<Qt::ItemFlags> itemFlags;
     QVector<QHash<int, QVariant> > headerData;
 };
 
-void QGalleryQueryModelPrivate::updateRoles(int column)
+/*
+    The keys of each column are laid out in a table indexed by column and role so data() is a
+    single lookup, roles too large for the table are kept in a hash.  Each key also has a bitmap
+    of the columns it appears in so a meta-data change maps to columns without scanning roles.
+*/
+
+void QGalleryQueryModelPrivate::updateRoles()
 {
-    if (resultSet) {
-        int offset = column != 0 ? columnOffsets.at(column - 1) : 0;
+    QVector<QVector<QPair<int, int> > > columnKeys(columnCount);
+    int maximumRole = -1;
 
+    for (int column = 0; column < columnCount; ++column) {
         const RoleProperties &properties = roleProperties.at(column);
 
         itemFlags[column] = Qt::ItemFlags();
 
+        if (!resultSet)
+            continue;
+
         typedef RoleProperties::const_iterator iterator;
         for (iterator it = properties.begin(), end = properties.end(); it != end; ++it) {
             const int key = resultSet->propertyKey(it.value());
 
             if (key > -1) {
-                roleKeys.insert(offset, it.key());
-                roleKeys.insert(offset + 1, key);
-
-                offset += 2;
+                const bool writable
+                        = resultSet->propertyAttributes(key) & QGalleryProperty::CanWrite;
 
-                if (it.key() == Qt::DisplayRole && !properties.contains(Qt::EditRole) &&
-                        (resultSet->propertyAttributes(key) & QGalleryProperty::CanWrite)) {
-                    roleKeys.insert(offset, Qt::EditRole);
-                    roleKeys.insert(offset + 1, key);
+                columnKeys[column].append(qMakePair(it.key(), key));
+                maximumRole = qMax(maximumRole, it.key());
 
-                    offset += 2;
+                if (it.key() == Qt::DisplayRole && !properties.contains(Qt::EditRole) && writable) {
+                    columnKeys[column].append(qMakePair(int(Qt::EditRole), key));
+                    maximumRole = qMax(maximumRole, int(Qt::EditRole));
                 }
 
                 itemFlags[column] |= Qt::ItemIsEnabled | Qt::ItemIsSelectable;
 
-                if ((it.key() == Qt::DisplayRole || it.key() == Qt::EditRole)
-                        && (resultSet->propertyAttributes(key) & QGalleryProperty::CanWrite)) {
+                if ((it.key() == Qt::DisplayRole || it.key() == Qt::EditRole) && writable)
                     itemFlags[column] |= Qt::ItemIsEditable;
-                }
             }
         }
-
-        const int difference = column != 0 ? offset - columnOffsets.at(column - 1) : offset;
-        for (int i = column + 1; i < columnCount; ++i)
-            columnOffsets[i] += difference;
-
-        columnOffsets[column] = offset;
     }
-}
-
-void QGalleryQueryModelPrivate::updateRoles()
-{
-    roleKeys.clear();
-
-    if (resultSet) {
-        int offset = 0;
-
-        for (int column = 0; column < columnCount; ++column) {
-            const RoleProperties &properties = roleProperties.at(column);
-
-            itemFlags[column] = Qt::ItemFlags();
-
-            typedef RoleProperties::const_iterator iterator;
-            for (iterator it = properties.begin(), end = properties.end(); it != end; ++it) {
-                const int key = resultSet->propertyKey(it.value());
 
-                if (key > -1) {
-                    roleKeys.append(it.key());
-                    roleKeys.append(key);
-
-                    offset += 2;
-
-                    if (it.key() == Qt::DisplayRole && !properties.contains(Qt::EditRole) &&
-                            (resultSet->propertyAttributes(key) & QGalleryProperty::CanWrite)) {
-                        roleKeys.append(Qt::EditRole);
-                        roleKeys.append(key);
-
-                        offset += 2;
-                    }
-
-                    itemFlags[column] |= Qt::ItemIsEnabled | Qt::ItemIsSelectable;
-
-                    if ((it.key() == Qt::DisplayRole || it.key() == Qt::EditRole)
-                            && (resultSet->propertyAttributes(key) & QGalleryProperty::CanWrite)) {
-                        itemFlags[column] |= Qt::ItemIsEditable;
-                    }
-                }
-            }
-            columnOffsets[column] = offset;
+    roleStride = qMin(maximumRole + 1, int(MaximumRoleStride));
+    roleKeys.fill(-1, columnCount * roleStride);
+    sparseRoleKeys = QVector<QHash<int, int> >(columnCount);
+    keyColumns.clear();
+
+    for (int column = 0; column < columnCount; ++column) {
+        typedef QVector<QPair<int, int> >::const_iterator iterator;
+        for (iterator it = columnKeys.at(column).constBegin(), end = columnKeys.at(column).constEnd();
+                it != end;
+                ++it) {
+            if (it->first >= 0 && it->first < roleStride)
+                roleKeys[column * roleStride + it->first] = it->second;
+            else
+                sparseRoleKeys[column].insert(it->first, it->second);
+
+            QHash<int, QBitArray>::iterator columns = keyColumns.find(it->second);
+            if (columns == keyColumns.end())
+                columns = keyColumns.insert(it->second, QBitArray(columnCount));
+
+            columns->setBit(column);
         }
     }
 }
@@ -215,7 +216,12 @@ void QGalleryQueryModelPrivate::_q_resultSetChanged(QGalleryResultSet *set)
                 resultSet, SIGNAL(metaDataChanged(int,int,QList<int>)),
                 q_ptr, SLOT(_q_metaDataChanged(int,int,QList<int>)));
 
-        const int count = resultSet->itemCount();
+        updateRoles();
+
+        // With a page size only the first page of rows is exposed until more are fetched.
+        rowLimit = query.pageSize() > 0 ? query.pageSize() : INT_MAX;
+
+        const int count = qMin(resultSet->itemCount(), rowLimit);
         if (count > 0) {
             q_ptr->beginInsertRows(QModelIndex(), 0, count - 1);
             rowCount = count;
@@ -226,51 +232,74 @@ void QGalleryQueryModelPrivate::_q_resultSetChanged(QGalleryResultSet *set)
 
 void QGalleryQueryModelPrivate::_q_itemsInserted(int index, int count)
 {
+    if (index < rowCount) {
+        if (rowLimit != INT_MAX)
+            rowLimit += count;
+    } else if (index > rowCount || rowCount == rowLimit) {
+        return;
+    } else {
+        count = qMin(count, rowLimit - rowCount);
+    }
+
     q_ptr->beginInsertRows(QModelIndex(), index, index + count - 1);
-    rowCount = resultSet->itemCount();
+    rowCount += count;
     q_ptr->endInsertRows();
 }
 
 void QGalleryQueryModelPrivate::_q_itemsRemoved(int index, int count)
 {
+    if (index >= rowCount)
+        return;
+
+    count = qMin(count, rowCount - index);
+
+    if (rowLimit != INT_MAX)
+        rowLimit -= count;
+
     q_ptr->beginRemoveRows(QModelIndex(), index, index + count -1);
-    rowCount = resultSet->itemCount();
+    rowCount -= count;
     q_ptr->endRemoveRows();
 }
 
 void QGalleryQueryModelPrivate::_q_itemsMoved(int from, int to, int count)
 {
-    q_ptr->beginMoveRows(QModelIndex(), from, from + count - 1, QModelIndex(), to);
-    q_ptr->endMoveRows();
+    if (from + count <= rowCount && to <= rowCount) {
+        q_ptr->beginMoveRows(QModelIndex(), from, from + count - 1, QModelIndex(), to);
+        q_ptr->endMoveRows();
+    } else {
+        // Rows moving in or out of the fetched range are removed and inserted instead.
+        _q_itemsRemoved(from, count);
+        _q_itemsInserted(to > from ? to - count : to, count);
+    }
 }
 
 void QGalleryQueryModelPrivate::_q_metaDataChanged(int index, int count, const QList<int> &keys)
 {
-    for (int i = 0, column = 0; i < roleKeys.count(); i += 2) {
-        if (i == columnOffsets.at(column))
-            column += 1;
+    if (index >= rowCount)
+        return;
 
-        if (keys.contains(roleKeys.at(i + 1))) {
-            const int start = column;
+    count = qMin(count, rowCount - index);
+
+    QBitArray columns(columnCount);
 
-            column += 1;
+    typedef QList<int>::const_iterator iterator;
+    for (iterator it = keys.constBegin(), end = keys.constEnd(); it != end; ++it) {
+        const QHash<int, QBitArray>::const_iterator keyColumn = keyColumns.constFind(*it);
 
-            for (i = columnOffsets.at(start); i < roleKeys.count(); i += 2) {
-                if (i == columnOffsets.at(column))
-                    break;
+        if (keyColumn != keyColumns.constEnd())
+            columns |= *keyColumn;
+    }
 
-                if (keys.contains(roleKeys.at(i + 1))) {
-                    i = columnOffsets.at(column) - 2;
+    for (int column = 0; column < columnCount; ++column) {
+        if (columns.testBit(column)) {
+            const int start = column;
 
-                    column += 1;
-                }
-            }
+            while (column + 1 < columnCount && columns.testBit(column + 1))
+                column += 1;
 
             Q_EMIT q_ptr->dataChanged(
                     q_ptr->createIndex(index, start),
-                    q_ptr->createIndex(index + count - 1, column - 1));
-
-            column += 1;
+                    q_ptr->createIndex(index + count - 1, column));
         }
     }
 }
@@ -398,7 +427,7 @@ void QGalleryQueryModel::setRoleProperties(int column, const QHash<int, QString>
     if (column >= 0 && column < d->columnCount) {
         d->roleProperties[column] = properties;
 
-        d->updateRoles(column);
+        d->updateRoles();
 
         if (d->rowCount > 0)
             Q_EMIT dataChanged(createIndex(0, column), createIndex(d->rowCount - 1, column));
@@ -419,12 +448,11 @@ void QGalleryQueryModel::addColumn(const QHash<int, QString> &properties)
 
     d->roleProperties.append(properties);
     d->itemFlags.append(Qt::ItemFlags());
-    d->columnOffsets.append(d->columnOffsets.isEmpty() ? 0 : d->columnOffsets.last());
     d->headerData.append(QHash<int, QVariant>());
 
     d->columnCount += 1;
 
-    d->updateRoles(d->columnCount - 1);
+    d->updateRoles();
 
     endInsertColumns();
 }
@@ -460,12 +488,11 @@ void QGalleryQueryModel::insertColumn(int index, const QHash<int, QString> &prop
 
     d->roleProperties.insert(index, properties);
     d->itemFlags.insert(index, Qt::ItemFlags());
-    d->columnOffsets.insert(index, index < d->columnCount ? d->columnOffsets.at(index) : 0);
     d->headerData.insert(index, QHash<int, QVariant>());
 
     d->columnCount += 1;
 
-    d->updateRoles(index);
+    d->updateRoles();
 
     endInsertColumns();
 }
@@ -496,20 +523,13 @@ void QGalleryQueryModel::removeColumn(int index)
 
     beginRemoveColumns(QModelIndex(), index, index);
 
-    const int offset = index != 0 ? d->columnOffsets.at(index - 1) : 0;
-    const int count = d->columnOffsets.at(index);
-    const int difference = count - offset;
-
     d->roleProperties.remove(index);
     d->itemFlags.remove(index);
-    d->columnOffsets.remove(index);
-    d->roleKeys.remove(offset, difference);
     d->headerData.remove(index);
 
     d->columnCount -= 1;
 
-    for (int i = index; i < d->columnCount; ++i)
-        d->columnOffsets[i] -= difference;
+    d->updateRoles();
 
     endRemoveColumns();
 }
@@ -608,6 +628,34 @@ void QGalleryQueryModel::setLimit(int limit)
     Signals that the value of \l limit has changed.
 */
 
+/*!
+    \property QGalleryQueryModel::pageSize
+
+    \brief The number of items a query should load at a time.
+
+    If the page size is greater than zero the model initially exposes a single
+    page of rows and more can be added with fetchMore().  The gallery may also
+    load the meta-data of rows a page at a time as they are accessed.
+
+    \sa QGalleryQueryRequest::pageSize
+*/
+
+int QGalleryQueryModel::pageSize() const
+{
+    return d_ptr->query.pageSize();
+}
+
+void QGalleryQueryModel::setPageSize(int size)
+{
+    d_ptr->query.setPageSize(size);
+}
+
+/*!
+    \fn QGalleryQueryModel::pageSizeChanged()
+
+    Signals that the value of \l pageSize has changed.
+*/
+
 /*!
     \property QGalleryQueryModel::rootType
 
@@ -851,19 +899,45 @@ int QGalleryQueryModel::columnCount(const QModelIndex &parent) const
     \reimp
 */
 
+bool QGalleryQueryModel::canFetchMore(const QModelIndex &parent) const
+{
+    return !parent.isValid()
+            && d_ptr->resultSet
+            && d_ptr->rowCount < d_ptr->resultSet->itemCount();
+}
+
+/*!
+    \reimp
+*/
+
+void QGalleryQueryModel::fetchMore(const QModelIndex &parent)
+{
+    Q_D(QGalleryQueryModel);
+
+    if (parent.isValid() || !d->resultSet || d->rowLimit == INT_MAX)
+        return;
+
+    const int count = qMin(d->resultSet->itemCount() - d->rowCount, d->query.pageSize());
+
+    if (count > 0) {
+        beginInsertRows(QModelIndex(), d->rowCount, d->rowCount + count - 1);
+        d->rowLimit = d->rowCount + count;
+        d->rowCount += count;
+        endInsertRows();
+    }
+}
+
+/*!
+    \reimp
+*/
+
 QVariant QGalleryQueryModel::data(const QModelIndex &index, int role) const
 {
     if (index.isValid()) {
-        if (d_ptr->resultSet->currentIndex() != index.row())
-            d_ptr->resultSet->fetch(index.row());
-
-        const int offset = index.column() != 0 ? d_ptr->columnOffsets.at(index.column() - 1) : 0;
-        const int count = d_ptr->columnOffsets.at(index.column());
+        const int key = d_ptr->roleKey(index.column(), role);
 
-        for (int i = offset; i < count; i += 2) {
-            if (d_ptr->roleKeys.at(i) == role)
-                return d_ptr->resultSet->metaData(d_ptr->roleKeys.at(i + 1));
-        }
+        if (key != -1)
+            return d_ptr->resultSet->metaData(index.row(), key);
     }
     return QVariant();
 }
@@ -875,15 +949,13 @@ QVariant QGalleryQueryModel::data(const QModelIndex &index, int role) const
 bool QGalleryQueryModel::setData(const QModelIndex &index, const QVariant &value, int role)
 {
     if (index.isValid()) {
-        if (d_ptr->resultSet->currentIndex() != index.row())
-            d_ptr->resultSet->fetch(index.row());
+        const int key = d_ptr->roleKey(index.column(), role);
 
-        const int offset = index.column() != 0 ? d_ptr->columnOffsets.at(index.column() - 1) : 0;
-        const int count = d_ptr->columnOffsets.at(index.column());
+        if (key != -1) {
+            if (d_ptr->resultSet->currentIndex() != index.row())
+                d_ptr->resultSet->fetch(index.row());
 
-        for (int i = offset; i < count; i += 2) {
-            if (d_ptr->roleKeys.at(i) == role)
-                return d_ptr->resultSet->setMetaData(d_ptr->roleKeys.at(i + 1), value);
+            return d_ptr->resultSet->setMetaData(key, value);
         }
     }
     return false;
@@ -895,13 +967,9 @@ bool QGalleryQueryModel::setData(const QModelIndex &index, const QVariant &value
 
 QVariant QGalleryQueryModel::itemId(const QModelIndex &index) const
 {
-    if (index.isValid()) {
-        if (d_ptr->resultSet->currentIndex() != index.row())
-            d_ptr->resultSet->fetch(index.row());
-
-        return d_ptr->resultSet->itemId();
-    }
-    return QVariant();
+    return index.isValid()
+            ? d_ptr->resultSet->itemId(index.row())
+            : QVariant();
 }
 
 /*!
@@ -910,13 +978,9 @@ QVariant QGalleryQueryModel::itemId(const QModelIndex &index) const
 
 QUrl QGalleryQueryModel::itemUrl(const QModelIndex &index) const
 {
-    if (index.isValid()) {
-        if (d_ptr->resultSet->currentIndex() != index.row())
-            d_ptr->resultSet->fetch(index.row());
-
-        return d_ptr->resultSet->itemUrl();
-    }
-    return QUrl();
+    return index.isValid()
+            ? d_ptr->resultSet->itemUrl(index.row())
+            : QUrl();
 }
 
 /*!
@@ -925,13 +989,9 @@ QUrl QGalleryQueryModel::itemUrl(const QModelIndex &index) const
 
 QString QGalleryQueryModel::itemType(const QModelIndex &index) const
 {
-    if (index.isValid()) {
-        if (d_ptr->resultSet->currentIndex() != index.row())
-            d_ptr->resultSet->fetch(index.row());
-
-        return d_ptr->resultSet->itemType();
-    }
-    return QString();
+    return index.isValid()
+            ? d_ptr->resultSet->itemType(index.row())
+            : QString();
 }
 
 /*!
@@ -61,6 +61,7 @@ class Q_GALLERY_EXPORT QGalleryQueryModel : public QAbstractItemModel
     Q_PROPERTY(bool autoUpdate READ autoUpdate WRITE setAutoUpdate NOTIFY autoUpdateChanged)
     Q_PROPERTY(int offset READ offset WRITE setOffset NOTIFY offsetChanged)
     Q_PROPERTY(int limit READ limit WRITE setLimit NOTIFY limitChanged)
+    Q_PROPERTY(int pageSize READ pageSize WRITE setPageSize NOTIFY pageSizeChanged)
     Q_PROPERTY(QString rootType READ rootType WRITE setRootType NOTIFY rootTypeChanged)
     Q_PROPERTY(QVariant rootItem READ rootItem WRITE setRootItem NOTIFY rootItemChanged)
     Q_PROPERTY(QGalleryQueryRequest::Scope scope READ scope WRITE setScope NOTIFY scopeChanged)
@@ -97,6 +98,9 @@ public:
     int limit() const;
     void setLimit(int limit);
 
+    int pageSize() const;
+    void setPageSize(int size);
+
     QString rootType() const;
     void setRootType(const QString &itemType);
 
@@ -124,6 +128,9 @@ public:
     int rowCount(const QModelIndex &parent = QModelIndex()) const;
     int columnCount(const QModelIndex &parent = QModelIndex()) const;
 
+    bool canFetchMore(const QModelIndex &parent) const;
+    void fetchMore(const QModelIndex &parent);
+
     QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const;
     bool setData(const QModelIndex &index, const QVariant &value, int role = Qt::EditRole);
 
@@ -146,6 +153,7 @@ Q_SIGNALS:
     void autoUpdateChanged();
     void offsetChanged();
     void limitChanged();
+    void pageSizeChanged();
     void rootTypeChanged();
     void rootItemChanged();
     void scopeChanged();
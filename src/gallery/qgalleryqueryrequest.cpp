@@ -54,8 +54,10 @@ public:
         : QGalleryAbstractRequestPrivate(gallery, QGalleryAbstractRequest::QueryRequest)
         , offset(0)
         , limit(0)
+        , pageSize(0)
         , scope(QGalleryQueryRequest::AllDescendants)
         , autoUpdate(false)
+        , suspended(false)
         , resultSet(0)
         , internalResultSet(0)
     {
@@ -64,8 +66,10 @@ public:
 
     int offset;
     int limit;
+    int pageSize;
     QGalleryQueryRequest::Scope scope;
     bool autoUpdate;
+    bool suspended;
     QGalleryResultSet *resultSet;
     QGalleryResultSet *internalResultSet;
     QGalleryNullResultSet nullResultSet;
@@ -271,6 +275,44 @@ void QGalleryQueryRequest::setAutoUpdate(bool enabled)
     Signals that the value of \l autoUpdate has changed.
 */
 
+/*!
+    \property QGalleryQueryRequest::suspended
+
+    \brief Whether updates to the results of an \l autoUpdate request are
+    suspended.
+
+    While suspended the results of a request are kept but not refreshed when
+    the items in the gallery change, instead they are refreshed once when the
+    request is no longer suspended if anything changed in the meantime.  This
+    is cheaper than cancelling and re-executing a request whose results are
+    temporarily not visible.
+*/
+
+bool QGalleryQueryRequest::isSuspended() const
+{
+    return d_func()->suspended;
+}
+
+void QGalleryQueryRequest::setSuspended(bool suspended)
+{
+    Q_D(QGalleryQueryRequest);
+
+    if (d->suspended != suspended) {
+        d->suspended = suspended;
+
+        if (d->resultSet)
+            d->resultSet->setSuspended(suspended);
+
+        Q_EMIT suspendedChanged();
+    }
+}
+
+/*!
+    \fn QGalleryQueryRequest::suspendedChanged()
+
+    Signals that the value of \l suspended has changed.
+*/
+
 /*!
     \property QGalleryQueryRequest::offset
 
@@ -325,6 +367,44 @@ void QGalleryQueryRequest::setLimit(int limit)
     Signals that the value of \l limit has changed.
 */
 
+/*!
+    \property QGalleryQueryRequest::pageSize
+
+    \brief the number of items a query should load at a time.
+
+    If the page size is greater than zero a gallery may report the total
+    number of items matching a query before it has loaded them, and then load
+    the meta-data of items in pages of this size as they are
+    \l {seek()}{fetched}.  Only a bounded number of pages are kept in memory,
+    so meta-data may not be available immediately after an item is fetched,
+    in which case metaData() will return a null value until the item's page
+    has loaded.
+
+    The default page size is 0, which loads every item matching a query
+    up front.
+*/
+
+int QGalleryQueryRequest::pageSize() const
+{
+    return d_func()->pageSize;
+}
+
+void QGalleryQueryRequest::setPageSize(int size)
+{
+    const int boundedSize = qMax(0, size);
+    if (d_func()->pageSize != boundedSize) {
+        d_func()->pageSize = boundedSize;
+
+        Q_EMIT pageSizeChanged();
+    }
+}
+
+/*!
+    \fn QGalleryQueryRequest::pageSizeChanged()
+
+    Signals that the value of \l pageSize has changed.
+*/
+
 /*!
     \property QGalleryQueryRequest::rootType
 
@@ -681,6 +761,8 @@ void QGalleryQueryRequest::setResponse(QGalleryAbstractResponse *response)
     if (d->resultSet) {
         d->internalResultSet = d->resultSet;
 
+        d->resultSet->setSuspended(d->suspended);
+
         connect(d->resultSet, SIGNAL(currentItemChanged()), this, SIGNAL(currentItemChanged()));
     } else {
         d->internalResultSet = &d->nullResultSet;
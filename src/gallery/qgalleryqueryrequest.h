@@ -63,8 +63,10 @@ class Q_GALLERY_EXPORT QGalleryQueryRequest : public QGalleryAbstractRequest
     Q_PROPERTY(QStringList propertyNames READ propertyNames WRITE setPropertyNames NOTIFY propertyNamesChanged)
     Q_PROPERTY(QStringList sortPropertyNames READ sortPropertyNames WRITE setSortPropertyNames NOTIFY sortPropertyNamesChanged)
     Q_PROPERTY(bool autoUpdate READ autoUpdate WRITE setAutoUpdate NOTIFY autoUpdateChanged)
+    Q_PROPERTY(bool suspended READ isSuspended WRITE setSuspended NOTIFY suspendedChanged)
     Q_PROPERTY(int offset READ offset WRITE setOffset NOTIFY offsetChanged)
     Q_PROPERTY(int limit READ limit WRITE setLimit NOTIFY limitChanged)
+    Q_PROPERTY(int pageSize READ pageSize WRITE setPageSize NOTIFY pageSizeChanged)
     Q_PROPERTY(QString rootType READ rootType WRITE setRootType NOTIFY rootTypeChanged)
     Q_PROPERTY(QVariant rootItem READ rootItem WRITE setRootItem NOTIFY rootItemChanged)
     Q_PROPERTY(QGalleryQueryRequest::Scope scope READ scope WRITE setScope NOTIFY scopeChanged)
@@ -95,12 +97,18 @@ public:
     bool autoUpdate() const;
     void setAutoUpdate(bool enabled);
 
+    bool isSuspended() const;
+    void setSuspended(bool suspended);
+
     int offset() const;
     void setOffset(int offset);
 
     int limit() const;
     void setLimit(int limit);
 
+    int pageSize() const;
+    void setPageSize(int size);
+
     QString rootType() const;
     void setRootType(const QString &itemType);
 
@@ -145,8 +153,10 @@ Q_SIGNALS:
     void propertyNamesChanged();
     void sortPropertyNamesChanged();
     void autoUpdateChanged();
+    void suspendedChanged();
     void offsetChanged();
     void limitChanged();
+    void pageSizeChanged();
     void rootTypeChanged();
     void rootItemChanged();
     void scopeChanged();
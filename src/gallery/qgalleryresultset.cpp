@@ -45,6 +45,76 @@
 
 QT_BEGIN_NAMESPACE_DOCGALLERY
 
+/*
+    Result sets which don't provide random access of their own are read by moving the current
+    index, as callers had to before.
+*/
+
+bool QGalleryResultSetPrivate::seek(int index) const
+{
+    QGalleryResultSet *q = static_cast<QGalleryResultSet *>(q_ptr);
+
+    return q->currentIndex() == index || q->fetch(index);
+}
+
+QVariant QGalleryResultSetPrivate::itemIdAt(int index) const
+{
+    return seek(index) ? static_cast<QGalleryResultSet *>(q_ptr)->itemId() : QVariant();
+}
+
+QUrl QGalleryResultSetPrivate::itemUrlAt(int index) const
+{
+    return seek(index) ? static_cast<QGalleryResultSet *>(q_ptr)->itemUrl() : QUrl();
+}
+
+QString QGalleryResultSetPrivate::itemTypeAt(int index) const
+{
+    return seek(index) ? static_cast<QGalleryResultSet *>(q_ptr)->itemType() : QString();
+}
+
+QVariant QGalleryResultSetPrivate::metaDataAt(int index, int key) const
+{
+    return seek(index) ? static_cast<QGalleryResultSet *>(q_ptr)->metaData(key) : QVariant();
+}
+
+void QGalleryResultSetPrivate::readRows(
+        int first, int count, const QVector<int> &keys, QGalleryRowBuffer *buffer) const
+{
+    const QGalleryResultSet *q = static_cast<QGalleryResultSet *>(q_ptr);
+
+    QVector<QGalleryRowBuffer::ColumnType> types;
+    types.reserve(keys.count());
+
+    typedef QVector<int>::const_iterator iterator;
+    for (iterator it = keys.constBegin(), end = keys.constEnd(); it != end; ++it)
+        types.append(bufferType(q->propertyType(*it)));
+
+    buffer->reset(count, types);
+
+    for (int row = 0; row < count; ++row) {
+        for (int column = 0; column < keys.count(); ++column)
+            buffer->setValue(row, column, metaDataAt(first + row, keys.at(column)));
+    }
+}
+
+QGalleryRowBuffer::ColumnType QGalleryResultSetPrivate::bufferType(QVariant::Type type)
+{
+    switch (type) {
+    case QVariant::Bool:
+    case QVariant::Int:
+    case QVariant::UInt:
+    case QVariant::LongLong:
+    case QVariant::ULongLong:
+        return QGalleryRowBuffer::Integer;
+    case QVariant::Double:
+        return QGalleryRowBuffer::Real;
+    case QVariant::DateTime:
+        return QGalleryRowBuffer::DateTime;
+    default:
+        return QGalleryRowBuffer::Text;
+    }
+}
+
 /*!
     \class QGalleryResultSet
 
@@ -62,7 +132,9 @@ QT_BEGIN_NAMESPACE_DOCGALLERY
 
     Only one item in a result set can be accessed at a time, so before
     information about an item can be accessed it must be selected using one of
-    the fetch() functions.  When a new index is selected the result set will
+    the fetch() functions.  Alternatively the itemId(), itemUrl(), itemType()
+    and metaData() overloads which take an index can be used to read any item
+    without moving the current index.  When a new index is selected the result set will
     emit the currentIndexChanged() signal, and when the currently selected item
     changes the currentItemChanged() signal will be emitted.  If the
     currentIndex() contains a gallery item isValid() will return true, otherwise
@@ -282,6 +354,89 @@ bool QGalleryResultSet::fetchLast()
     return fetch(itemCount() - 1);
 }
 
+/*!
+    Returns the ID of the item at \a index.
+
+    Unlike fetch() this doesn't change the current index of a result set or
+    emit any signals, unless the result set doesn't support random access in
+    which case it is repositioned on \a index.
+
+    \sa itemId()
+*/
+
+QVariant QGalleryResultSet::itemId(int index) const
+{
+    return index >= 0 && index < itemCount()
+            ? d_func()->itemIdAt(index)
+            : QVariant();
+}
+
+/*!
+    Returns the URL of the item at \a index.
+
+    \sa itemId(int), itemUrl()
+*/
+
+QUrl QGalleryResultSet::itemUrl(int index) const
+{
+    return index >= 0 && index < itemCount()
+            ? d_func()->itemUrlAt(index)
+            : QUrl();
+}
+
+/*!
+    Returns the type of the item at \a index.
+
+    \sa itemId(int), itemType()
+*/
+
+QString QGalleryResultSet::itemType(int index) const
+{
+    return index >= 0 && index < itemCount()
+            ? d_func()->itemTypeAt(index)
+            : QString();
+}
+
+/*!
+    Returns the meta-data value for \a key of the item at \a index.
+
+    \sa itemId(int)
+*/
+
+QVariant QGalleryResultSet::metaData(int index, int key) const
+{
+    return index >= 0 && index < itemCount()
+            ? d_func()->metaDataAt(index, key)
+            : QVariant();
+}
+
+/*!
+    Reads the values for \a keys of \a count items starting at \a first into
+    a \a buffer, with one buffer column for each key.
+
+    Like metaData(int, int) this doesn't change the current index of a result
+    set.  Result sets with a native implementation copy their values into the
+    buffer a column at a time without converting them to QVariants.
+
+    Returns the number of rows read, which is less than \a count if the range
+    extends past the end of the result set.
+*/
+
+int QGalleryResultSet::readRows(
+        int first, int count, const QVector<int> &keys, QGalleryRowBuffer *buffer) const
+{
+    if (first < 0) {
+        count += first;
+        first = 0;
+    }
+
+    count = qMax(0, qMin(count, itemCount() - first));
+
+    d_func()->readRows(first, count, keys, buffer);
+
+    return count;
+}
+
 /*!
     \fn QGalleryResultSet::currentItemChanged()
 
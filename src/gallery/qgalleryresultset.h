@@ -44,6 +44,7 @@
 
 #include <qgalleryabstractresponse.h>
 #include <qgalleryproperty.h>
+#include <qgalleryrowbuffer.h>
 
 #include <QtCore/qmap.h>
 #include <QtCore/qobject.h>
@@ -87,6 +88,13 @@ public:
     virtual bool fetchFirst();
     virtual bool fetchLast();
 
+    QVariant itemId(int index) const;
+    QUrl itemUrl(int index) const;
+    QString itemType(int index) const;
+    QVariant metaData(int index, int key) const;
+
+    int readRows(int first, int count, const QVector<int> &keys, QGalleryRowBuffer *buffer) const;
+
 Q_SIGNALS:
     void currentItemChanged();
     void currentIndexChanged(int index);
@@ -67,6 +67,18 @@ public:
     }
 
     virtual ~QGalleryResultSetPrivate() {}
+
+    virtual QVariant itemIdAt(int index) const;
+    virtual QUrl itemUrlAt(int index) const;
+    virtual QString itemTypeAt(int index) const;
+    virtual QVariant metaDataAt(int index, int key) const;
+    virtual void readRows(
+            int first, int count, const QVector<int> &keys, QGalleryRowBuffer *buffer) const;
+
+    static QGalleryRowBuffer::ColumnType bufferType(QVariant::Type type);
+
+private:
+    bool seek(int index) const;
 };
 
 QT_END_NAMESPACE_DOCGALLERY
@@ -0,0 +1,388 @@
+/****************************************************************************
+**
+** Copyright (C) 2012 Digia Plc and/or its subsidiary(-ies).
+** Contact: http://www.qt-project.org/legal
+**
+** This file is part of the QtDocGallery module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and Digia.  For licensing terms and
+** conditions see http://qt.digia.com/licensing.  For further information
+** use the contact form at http://qt.digia.com/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU Lesser General Public License version 2.1 requirements
+** will be met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** In addition, as a special exception, Digia gives you certain additional
+** rights.  These rights are described in the Digia Qt LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3.0 as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU General Public License version 3.0 requirements will be
+** met: http://www.gnu.org/copyleft/gpl.html.
+**
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "qgalleryrowbuffer.h"
+
+#include <QtCore/qbitarray.h>
+#include <QtCore/qdatetime.h>
+#include <QtCore/qstringlist.h>
+#include <QtCore/qurl.h>
+
+QT_BEGIN_NAMESPACE_DOCGALLERY
+
+class QGalleryRowBufferPrivate
+{
+public:
+    struct Entry
+    {
+        int offset;
+        int length;
+    };
+
+    struct Column
+    {
+        QGalleryRowBuffer::ColumnType type;
+        QVector<qint64> integers;
+        QVector<double> reals;
+        QVector<Entry> entries;
+        QByteArray text;
+        QBitArray nulls;
+    };
+
+    QGalleryRowBufferPrivate() : rowCount(0) {}
+
+    int rowCount;
+    QVector<Column> columns;
+};
+
+/*!
+    \class QGalleryRowBuffer
+
+    \ingroup gallery
+
+    \inmodule QtDocGallery
+
+    \brief The QGalleryRowBuffer class provides typed storage for a range of
+    rows read from a QGalleryResultSet.
+
+    A row buffer is filled by QGalleryResultSet::readRows() with one column
+    for each meta-data key requested.  Values are stored by type in
+    contiguous arrays rather than as QVariants, integer and date-time columns
+    can be accessed directly with integers() and real columns with reals().
+    Text columns hold UTF-8 encoded strings, URLs are stored in their encoded
+    form and string lists are joined with a '|' separator.
+
+    A buffer can be reused for any number of reads, the memory allocated for
+    earlier reads is kept and reused.
+*/
+
+/*!
+    \enum QGalleryRowBuffer::ColumnType
+
+    Identifies how the values of a column are stored.
+
+    \value Integer The values are 64-bit integers.
+    \value Real The values are doubles.
+    \value DateTime The values are milliseconds since the epoch in UTC, stored
+    as 64-bit integers.
+    \value Text The values are UTF-8 encoded strings.
+*/
+
+/*!
+    Constructs an empty row buffer.
+*/
+
+QGalleryRowBuffer::QGalleryRowBuffer()
+    : d(new QGalleryRowBufferPrivate)
+{
+}
+
+/*!
+    Destroys a row buffer.
+*/
+
+QGalleryRowBuffer::~QGalleryRowBuffer()
+{
+}
+
+/*!
+    Returns the number of rows in a buffer.
+*/
+
+int QGalleryRowBuffer::rowCount() const
+{
+    return d->rowCount;
+}
+
+/*!
+    Returns the number of columns in a buffer.
+*/
+
+int QGalleryRowBuffer::columnCount() const
+{
+    return d->columns.count();
+}
+
+/*!
+    Returns how the values of a \a column are stored.
+*/
+
+QGalleryRowBuffer::ColumnType QGalleryRowBuffer::columnType(int column) const
+{
+    return d->columns.at(column).type;
+}
+
+/*!
+    Returns true if the value in \a row and \a column is null; otherwise
+    returns false.
+*/
+
+bool QGalleryRowBuffer::isNull(int row, int column) const
+{
+    return d->columns.at(column).nulls.testBit(row);
+}
+
+/*!
+    Returns the value in \a row of an Integer or DateTime \a column.
+*/
+
+qint64 QGalleryRowBuffer::integer(int row, int column) const
+{
+    return d->columns.at(column).integers.at(row);
+}
+
+/*!
+    Returns the value in \a row of a Real \a column.
+*/
+
+double QGalleryRowBuffer::real(int row, int column) const
+{
+    return d->columns.at(column).reals.at(row);
+}
+
+/*!
+    Returns the UTF-8 encoded value in \a row of a Text \a column.
+
+    The returned array references the buffer's own memory and is only valid
+    until the buffer is next reset or destroyed.
+*/
+
+QByteArray QGalleryRowBuffer::text(int row, int column) const
+{
+    const QGalleryRowBufferPrivate::Column &values = d->columns.at(column);
+    const QGalleryRowBufferPrivate::Entry &entry = values.entries.at(row);
+
+    return entry.length >= 0
+            ? QByteArray::fromRawData(values.text.constData() + entry.offset, entry.length)
+            : QByteArray();
+}
+
+/*!
+    Returns the value in \a row of a Text \a column as a string.
+*/
+
+QString QGalleryRowBuffer::string(int row, int column) const
+{
+    const QGalleryRowBufferPrivate::Column &values = d->columns.at(column);
+    const QGalleryRowBufferPrivate::Entry &entry = values.entries.at(row);
+
+    return entry.length >= 0
+            ? QString::fromUtf8(values.text.constData() + entry.offset, entry.length)
+            : QString();
+}
+
+/*!
+    Returns the value in \a row and \a column as a QVariant.
+*/
+
+QVariant QGalleryRowBuffer::value(int row, int column) const
+{
+    const QGalleryRowBufferPrivate::Column &values = d->columns.at(column);
+
+    if (values.nulls.testBit(row))
+        return QVariant();
+
+    switch (values.type) {
+    case Integer:
+        return QVariant(values.integers.at(row));
+    case Real:
+        return QVariant(values.reals.at(row));
+    case DateTime:
+        return QVariant(QDateTime::fromMSecsSinceEpoch(values.integers.at(row), Qt::UTC));
+    default:
+        return QVariant(string(row, column));
+    }
+}
+
+/*!
+    Returns the values of an Integer or DateTime \a column.
+
+    The array contains rowCount() values.
+*/
+
+const qint64 *QGalleryRowBuffer::integers(int column) const
+{
+    return d->columns.at(column).integers.constData();
+}
+
+/*!
+    Returns the values of a Real \a column.
+
+    The array contains rowCount() values.
+*/
+
+const double *QGalleryRowBuffer::reals(int column) const
+{
+    return d->columns.at(column).reals.constData();
+}
+
+/*!
+    Resizes a buffer to hold \a rowCount rows of columns of the given
+    \a types, with every value null.
+
+    This is called by result sets before writing to a buffer.
+*/
+
+void QGalleryRowBuffer::reset(int rowCount, const QVector<ColumnType> &types)
+{
+    d->rowCount = rowCount;
+    d->columns.resize(types.count());
+
+    for (int i = 0; i < types.count(); ++i) {
+        QGalleryRowBufferPrivate::Column &column = d->columns[i];
+
+        column.type = types.at(i);
+        column.integers.resize(column.type == Integer || column.type == DateTime ? rowCount : 0);
+        column.reals.resize(column.type == Real ? rowCount : 0);
+        column.entries.resize(column.type == Text ? rowCount : 0);
+        column.text.truncate(0);
+        column.nulls.fill(true, rowCount);
+    }
+}
+
+/*!
+    Removes all rows and columns from a buffer.
+*/
+
+void QGalleryRowBuffer::clear()
+{
+    d->rowCount = 0;
+    d->columns.clear();
+}
+
+/*!
+    Returns the writable values of an Integer or DateTime \a column.
+
+    Values written this way must also be marked as not null with setNull().
+*/
+
+qint64 *QGalleryRowBuffer::integers(int column)
+{
+    return d->columns[column].integers.data();
+}
+
+/*!
+    Returns the writable values of a Real \a column.
+
+    Values written this way must also be marked as not null with setNull().
+*/
+
+double *QGalleryRowBuffer::reals(int column)
+{
+    return d->columns[column].reals.data();
+}
+
+/*!
+    Sets whether the value in \a row and \a column is \a null.
+*/
+
+void QGalleryRowBuffer::setNull(int row, int column, bool null)
+{
+    d->columns[column].nulls.setBit(row, null);
+}
+
+/*!
+    Sets the value in \a row of a Text \a column to \a length bytes of UTF-8
+    encoded \a data.
+*/
+
+void QGalleryRowBuffer::setText(int row, int column, const char *data, int length)
+{
+    QGalleryRowBufferPrivate::Column &values = d->columns[column];
+    QGalleryRowBufferPrivate::Entry &entry = values.entries[row];
+
+    entry.offset = values.text.size();
+    entry.length = length;
+
+    values.text.append(data, length);
+    values.nulls.clearBit(row);
+}
+
+/*!
+    Sets the value in \a row and \a column to \a value, converting it to the
+    column's type.
+*/
+
+void QGalleryRowBuffer::setValue(int row, int column, const QVariant &value)
+{
+    QGalleryRowBufferPrivate::Column &values = d->columns[column];
+
+    if (value.isNull()) {
+        values.nulls.setBit(row);
+
+        return;
+    }
+
+    switch (values.type) {
+    case Integer:
+        values.integers[row] = value.toLongLong();
+        values.nulls.clearBit(row);
+        break;
+    case Real:
+        values.reals[row] = value.toDouble();
+        values.nulls.clearBit(row);
+        break;
+    case DateTime:
+        {
+            const QDateTime dateTime = value.toDateTime();
+
+            values.integers[row] = dateTime.isValid() ? dateTime.toMSecsSinceEpoch() : 0;
+            values.nulls.setBit(row, !dateTime.isValid());
+        }
+        break;
+    default:
+        {
+            QByteArray data;
+
+            if (value.type() == QVariant::Url)
+                data = value.toUrl().toEncoded();
+            else if (value.type() == QVariant::StringList)
+                data = value.toStringList().join(QLatin1String("|")).toUtf8();
+            else
+                data = value.toString().toUtf8();
+
+            setText(row, column, data.constData(), data.size());
+        }
+        break;
+    }
+}
+
+QT_END_NAMESPACE_DOCGALLERY
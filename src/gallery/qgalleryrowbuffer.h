@@ -0,0 +1,104 @@
+/****************************************************************************
+**
+** Copyright (C) 2012 Digia Plc and/or its subsidiary(-ies).
+** Contact: http://www.qt-project.org/legal
+**
+** This file is part of the QtDocGallery module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and Digia.  For licensing terms and
+** conditions see http://qt.digia.com/licensing.  For further information
+** use the contact form at http://qt.digia.com/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU Lesser General Public License version 2.1 requirements
+** will be met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** In addition, as a special exception, Digia gives you certain additional
+** rights.  These rights are described in the Digia Qt LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3.0 as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU General Public License version 3.0 requirements will be
+** met: http://www.gnu.org/copyleft/gpl.html.
+**
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QGALLERYROWBUFFER_H
+#define QGALLERYROWBUFFER_H
+
+#include "qgalleryglobal.h"
+
+#include <QtCore/qbytearray.h>
+#include <QtCore/qscopedpointer.h>
+#include <QtCore/qvariant.h>
+#include <QtCore/qvector.h>
+
+QT_BEGIN_NAMESPACE_DOCGALLERY
+
+class QGalleryRowBufferPrivate;
+
+class Q_GALLERY_EXPORT QGalleryRowBuffer
+{
+public:
+    enum ColumnType
+    {
+        Integer,
+        Real,
+        DateTime,
+        Text
+    };
+
+    QGalleryRowBuffer();
+    ~QGalleryRowBuffer();
+
+    int rowCount() const;
+    int columnCount() const;
+
+    ColumnType columnType(int column) const;
+
+    bool isNull(int row, int column) const;
+
+    qint64 integer(int row, int column) const;
+    double real(int row, int column) const;
+    QByteArray text(int row, int column) const;
+    QString string(int row, int column) const;
+    QVariant value(int row, int column) const;
+
+    const qint64 *integers(int column) const;
+    const double *reals(int column) const;
+
+    void reset(int rowCount, const QVector<ColumnType> &types);
+    void clear();
+
+    qint64 *integers(int column);
+    double *reals(int column);
+
+    void setNull(int row, int column, bool null);
+    void setText(int row, int column, const char *data, int length);
+    void setValue(int row, int column, const QVariant &value);
+
+private:
+    Q_DISABLE_COPY(QGalleryRowBuffer)
+
+    QScopedPointer<QGalleryRowBufferPrivate> d;
+};
+
+QT_END_NAMESPACE_DOCGALLERY
+
+#endif
@@ -41,9 +41,7 @@
 
 #include <tracker-sparql.h>
 
-#include "qdocumentgallery.h"
-
-#include "qabstractgallery_p.h"
+#include "qdocumentgallery_tracker_p.h"
 
 #include "qgalleryitemrequest.h"
 #include "qgalleryqueryrequest.h"
@@ -52,8 +50,12 @@
 #include "qgallerytrackerchangenotifier_p.h"
 #include "qgallerytrackerschema_p.h"
 #include "qgallerytrackereditableresultset_p.h"
+#include "qgallerytrackerpagedresultset_p.h"
+#include "qgallerytrackerresultsetcursor_p.h"
 
+#include <QtCore/qhash.h>
 #include <QtCore/qmetaobject.h>
+#include <QtCore/qpointer.h>
 #include <QtDBus/qdbusmetatype.h>
 #include <QtDBus/qdbusargument.h>
 
@@ -63,26 +65,6 @@ Q_DECLARE_METATYPE(QVector<QStringList>)
 
 QT_BEGIN_NAMESPACE_DOCGALLERY
 
-class QDocumentGalleryPrivate : public QAbstractGalleryPrivate
-{
-public:
-    QDocumentGalleryPrivate()
-        : connection(nullptr), m_notifier(nullptr)
-    {
-    }
-
-    QGalleryAbstractResponse *createItemResponse(QGalleryItemRequest *request);
-    QGalleryAbstractResponse *createTypeResponse(QGalleryTypeRequest *request);
-    QGalleryAbstractResponse *createFilterResponse(QGalleryQueryRequest *request);
-
-    QGalleryAbstractResponse *createItemListResponse(
-            QGalleryTrackerResultSetArguments *arguments,
-            bool autoUpdate);
-
-    TrackerSparqlConnection *connection;
-    QGalleryTrackerChangeNotifier *m_notifier;
-};
-
 QGalleryAbstractResponse *QDocumentGalleryPrivate::createItemResponse(QGalleryItemRequest *request)
 {
     QGalleryTrackerSchema schema = QGalleryTrackerSchema::fromItemId(request->itemId().toString());
@@ -95,6 +77,9 @@ QGalleryAbstractResponse *QDocumentGalleryPrivate::createItemResponse(QGalleryIt
     if (error != QDocumentGallery::NoError) {
         return new QGalleryAbstractResponse(error);
     } else {
+        // Single items are typically bound to visible delegates, load them ahead of lists.
+        arguments.priority = QGalleryTrackerScheduler::HighPriority;
+
         return createItemListResponse(
                 &arguments,
                 request->autoUpdate());
@@ -111,9 +96,16 @@ QGalleryAbstractResponse *QDocumentGalleryPrivate::createTypeResponse(QGalleryTy
 
     if (error != QDocumentGallery::NoError) {
         return new QGalleryAbstractResponse(error);
+    } else if (connectionFailed) {
+        return new QGalleryAbstractResponse(QDocumentGallery::ConnectionError);
     } else {
+        arguments.statements = statements;
+
         QGalleryTrackerResultSet *response = new QGalleryTrackerResultSet(connection, &arguments, request->autoUpdate());
 
+        if (!connection)
+            pendingResponses.append(response);
+
         if (request->autoUpdate()) {
             if (m_notifier)
                 QObject::connect(m_notifier, &QGalleryTrackerChangeNotifier::itemsChanged,
@@ -128,12 +120,52 @@ QGalleryAbstractResponse *QDocumentGalleryPrivate::createItemListResponse(
         QGalleryTrackerResultSetArguments *arguments,
         bool autoUpdate)
 {
-    if (!connection)
+    if (connectionFailed)
         return new QGalleryAbstractResponse(QDocumentGallery::ConnectionError);
 
+    if (!autoUpdate)
+        return createResultSet(arguments, autoUpdate);
+
+    // Live requests for the same query are all kept current by the same change notifications, so
+    // rather than have each run and cache its own copy of the results they share one result set
+    // and get a cursor over it.
+    const QChar separator(0x1f);
+    const QString key = arguments->sparql
+            + separator + arguments->parameters.join(separator)
+            + separator + arguments->propertyNames.join(separator);
+
+    for (QHash<QString, QWeakPointer<QGalleryTrackerResultSet> >::iterator it
+            = sharedResultSets.begin(); it != sharedResultSets.end();) {
+        if (it.value().isNull())
+            it = sharedResultSets.erase(it);
+        else
+            ++it;
+    }
+
+    QSharedPointer<QGalleryTrackerResultSet> resultSet = sharedResultSets.value(key).toStrongRef();
+
+    if (!resultSet) {
+        resultSet = QSharedPointer<QGalleryTrackerResultSet>(
+                createResultSet(arguments, autoUpdate), &QObject::deleteLater);
+
+        sharedResultSets.insert(key, resultSet);
+    }
+
+    return new QGalleryTrackerResultSetCursor(resultSet);
+}
+
+QGalleryTrackerResultSet *QDocumentGalleryPrivate::createResultSet(
+        QGalleryTrackerResultSetArguments *arguments,
+        bool autoUpdate)
+{
+    arguments->statements = statements;
+
     QGalleryTrackerResultSet *response = new QGalleryTrackerEditableResultSet(
             connection, arguments, autoUpdate);
 
+    if (!connection)
+        pendingResponses.append(response);
+
     if (autoUpdate) {
         if (m_notifier) {
             QObject::connect(m_notifier, &QGalleryTrackerChangeNotifier::itemsChanged,
@@ -163,10 +195,16 @@ QGalleryAbstractResponse *QDocumentGalleryPrivate::createFilterResponse(
             request->propertyNames(),
             request->sortPropertyNames(),
             request->offset(),
-            request->limit());
+            request->limit(),
+            &planCache);
 
     if (error != QDocumentGallery::NoError) {
         return new QGalleryAbstractResponse(error);
+    } else if (request->pageSize() > 0) {
+        return createPagedResponse(
+                &arguments,
+                request->pageSize(),
+                request->autoUpdate());
     } else {
         return createItemListResponse(
                 &arguments,
@@ -174,6 +212,75 @@ QGalleryAbstractResponse *QDocumentGalleryPrivate::createFilterResponse(
     }
 }
 
+QGalleryAbstractResponse *QDocumentGalleryPrivate::createPagedResponse(
+        QGalleryTrackerResultSetArguments *arguments,
+        int pageSize,
+        bool autoUpdate)
+{
+    if (connectionFailed)
+        return new QGalleryAbstractResponse(QDocumentGallery::ConnectionError);
+
+    arguments->statements = statements;
+
+    QGalleryTrackerPagedResultSet *response = new QGalleryTrackerPagedResultSet(
+            connection, arguments, pageSize, autoUpdate);
+
+    if (!connection)
+        pendingResponses.append(response);
+
+    if (autoUpdate) {
+        if (m_notifier) {
+            QObject::connect(m_notifier, &QGalleryTrackerChangeNotifier::itemsChanged,
+                             response, &QGalleryTrackerPagedResultSet::refresh);
+        }
+    }
+
+    return response;
+}
+
+void QDocumentGalleryPrivate::_q_connectionStateChanged()
+{
+    if (trackerConnection->state() == QGalleryTrackerConnection::Connecting)
+        return;
+
+    setConnection(trackerConnection->connection(), trackerConnection->statements());
+}
+
+/*
+    Sets the \a connection requests are executed on, a null connection if it couldn't be opened.
+*/
+
+void QDocumentGalleryPrivate::setConnection(
+        TrackerSparqlConnection *connection,
+        const QSharedPointer<QGalleryTrackerStatementCache> &statements)
+{
+    this->connection = connection;
+    this->statements = statements;
+
+    connectionFailed = !connection;
+
+    // Start the requests that were executed while the connection was being opened, or fail them
+    // if it couldn't be.
+    const QList<QPointer<QGalleryResultSet> > responses = pendingResponses;
+    pendingResponses.clear();
+
+    typedef QList<QPointer<QGalleryResultSet> >::const_iterator iterator;
+    for (iterator it = responses.begin(), end = responses.end(); it != end; ++it) {
+        QGalleryResultSet *response = it->data();
+
+        if (QGalleryTrackerResultSet *resultSet
+                = qobject_cast<QGalleryTrackerResultSet *>(response)) {
+            resultSet->setConnection(connection, statements);
+        } else if (QGalleryTrackerPagedResultSet *resultSet
+                = qobject_cast<QGalleryTrackerPagedResultSet *>(response)) {
+            resultSet->setConnection(connection, statements);
+        }
+    }
+
+    if (connection)
+        Q_EMIT static_cast<QDocumentGallery *>(q_ptr)->readyChanged();
+}
+
 QDocumentGallery::QDocumentGallery(QObject *parent)
     : QAbstractGallery(*new QDocumentGalleryPrivate, parent)
 {
@@ -181,26 +288,26 @@ QDocumentGallery::QDocumentGallery(QObject *parent)
 
     qDBusRegisterMetaType<QVector<QStringList> >();
 
-    GError *error = NULL;
-    d->connection = tracker_sparql_connection_bus_new("org.freedesktop.Tracker3.Miner.Files", NULL, NULL, &error);
-    if (error != NULL) {
-        qWarning() << "Error creating tracker connection:" << error->message;
-        g_error_free(error);
-    }
+    // All galleries in the process share one connection and change notifier.
+    d->trackerConnection = QGalleryTrackerConnection::instance();
+    d->connection = d->trackerConnection->connection();
+    d->statements = d->trackerConnection->statements();
+    d->connectionFailed = d->trackerConnection->state() == QGalleryTrackerConnection::Failed;
+    d->m_notifier = d->trackerConnection->notifier();
 
-    if (d->connection) {
-        d->m_notifier = new QGalleryTrackerChangeNotifier(d->connection);
+    if (d->trackerConnection->state() == QGalleryTrackerConnection::Connecting) {
+        connect(d->trackerConnection.data(), &QGalleryTrackerConnection::stateChanged,
+                this, [d]() { d->_q_connectionStateChanged(); });
     }
 }
 
 QDocumentGallery::~QDocumentGallery()
 {
-    Q_D(QDocumentGallery);
-    delete d->m_notifier;
-    d->m_notifier = nullptr;
+}
 
-    if (d->connection)
-        g_object_unref(d->connection);
+bool QDocumentGallery::isReady() const
+{
+    return d_func()->connection != 0;
 }
 
 bool QDocumentGallery::isRequestSupported(QGalleryAbstractRequest::RequestType type) const
@@ -0,0 +1,120 @@
+/****************************************************************************
+**
+** Copyright (C) 2012 Digia Plc and/or its subsidiary(-ies).
+** Contact: http://www.qt-project.org/legal
+**
+** This file is part of the QtDocGallery module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and Digia.  For licensing terms and
+** conditions see http://qt.digia.com/licensing.  For further information
+** use the contact form at http://qt.digia.com/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU Lesser General Public License version 2.1 requirements
+** will be met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** In addition, as a special exception, Digia gives you certain additional
+** rights.  These rights are described in the Digia Qt LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3.0 as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU General Public License version 3.0 requirements will be
+** met: http://www.gnu.org/copyleft/gpl.html.
+**
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#ifndef QDOCUMENTGALLERY_TRACKER_P_H
+#define QDOCUMENTGALLERY_TRACKER_P_H
+
+#include "qdocumentgallery.h"
+
+#include "qabstractgallery_p.h"
+
+#include "qgallerytrackerconnection_p.h"
+#include "qgallerytrackerqueryplancache_p.h"
+#include "qgallerytrackerstatementcache_p.h"
+
+#include <QtCore/qhash.h>
+#include <QtCore/qpointer.h>
+#include <QtCore/qsharedpointer.h>
+
+QT_BEGIN_NAMESPACE_DOCGALLERY
+
+class QGalleryAbstractResponse;
+class QGalleryItemRequest;
+class QGalleryQueryRequest;
+class QGalleryResultSet;
+class QGalleryTrackerChangeNotifier;
+class QGalleryTrackerResultSet;
+class QGalleryTypeRequest;
+struct QGalleryTrackerResultSetArguments;
+
+class Q_GALLERY_EXPORT QDocumentGalleryPrivate : public QAbstractGalleryPrivate
+{
+public:
+    QDocumentGalleryPrivate()
+        : connection(nullptr), connectionFailed(false), m_notifier(nullptr)
+    {
+    }
+
+    QGalleryAbstractResponse *createItemResponse(QGalleryItemRequest *request);
+    QGalleryAbstractResponse *createTypeResponse(QGalleryTypeRequest *request);
+    QGalleryAbstractResponse *createFilterResponse(QGalleryQueryRequest *request);
+
+    QGalleryAbstractResponse *createItemListResponse(
+            QGalleryTrackerResultSetArguments *arguments,
+            bool autoUpdate);
+    QGalleryTrackerResultSet *createResultSet(
+            QGalleryTrackerResultSetArguments *arguments,
+            bool autoUpdate);
+
+    void setConnection(
+            TrackerSparqlConnection *connection,
+            const QSharedPointer<QGalleryTrackerStatementCache> &statements);
+    void _q_connectionStateChanged();
+
+    QGalleryAbstractResponse *createPagedResponse(
+            QGalleryTrackerResultSetArguments *arguments,
+            int pageSize,
+            bool autoUpdate);
+
+    QSharedPointer<QGalleryTrackerConnection> trackerConnection;
+    TrackerSparqlConnection *connection;
+    bool connectionFailed;
+    QSharedPointer<QGalleryTrackerStatementCache> statements;
+    QGalleryTrackerQueryPlanCache planCache;
+    QHash<QString, QWeakPointer<QGalleryTrackerResultSet> > sharedResultSets;
+    QList<QPointer<QGalleryResultSet> > pendingResponses;
+    QGalleryTrackerChangeNotifier *m_notifier;
+};
+
+QT_END_NAMESPACE_DOCGALLERY
+
+#endif
@@ -42,10 +42,162 @@
 #include "qgallerytrackerchangenotifier_p.h"
 
 #include "qgallerytrackerschema_p.h"
+#include "qgallerytrackerscheduler_p.h"
+
+#include <QtCore/qcoreapplication.h>
+#include <QtCore/qcoreevent.h>
 #include <QtCore/qdebug.h>
+#include <QtCore/qset.h>
 
 QT_BEGIN_NAMESPACE_DOCGALLERY
 
+/*
+    Looks up the RDF classes of changed resources off the GUI thread so that only result sets of
+    the affected item types are refreshed, rather than every type stored in the changed graph.
+*/
+
+class QGalleryTrackerChangeLookup : public QGalleryTrackerTask
+{
+public:
+    enum
+    {
+        MaximumResources = 256
+    };
+
+    struct Update
+    {
+        QString graph;
+        QGalleryTrackerResourceChangeList changes;
+        QList<int> updateIds;
+    };
+
+    QGalleryTrackerChangeLookup(TrackerSparqlConnection *connection, QObject *receiver)
+        : receiver(receiver)
+        , m_connection(connection)
+        , m_cancellable(g_cancellable_new())
+    {
+        g_object_ref(G_OBJECT(m_connection));
+    }
+
+    ~QGalleryTrackerChangeLookup()
+    {
+        g_object_unref(G_OBJECT(m_cancellable));
+        g_object_unref(G_OBJECT(m_connection));
+    }
+
+    void cancel() { g_cancellable_cancel(m_cancellable); }
+
+    QMutex mutex;
+    QObject *receiver;
+    QList<Update> pendingUpdates;
+    QList<Update> finishedUpdates;
+
+protected:
+    void run();
+    void taskFinished();
+
+private:
+    QList<int> updateIds(const Update &update) const;
+
+    TrackerSparqlConnection *const m_connection;
+    GCancellable *const m_cancellable;
+};
+
+void QGalleryTrackerChangeLookup::run()
+{
+    for (;;) {
+        Update update;
+        {
+            QMutexLocker locker(&mutex);
+
+            if (pendingUpdates.isEmpty())
+                break;
+
+            update = pendingUpdates.takeFirst();
+        }
+
+        update.updateIds = updateIds(update);
+
+        QMutexLocker locker(&mutex);
+
+        if (receiver && !g_cancellable_is_cancelled(m_cancellable)) {
+            finishedUpdates.append(update);
+
+            if (finishedUpdates.count() == 1)
+                QCoreApplication::postEvent(receiver, new QEvent(QEvent::UpdateLater));
+        }
+    }
+}
+
+void QGalleryTrackerChangeLookup::taskFinished()
+{
+    // Updates queued while the last one was being looked up may need the task to be restarted.
+    QMutexLocker locker(&mutex);
+
+    if (receiver && finishedUpdates.isEmpty() && !pendingUpdates.isEmpty())
+        QCoreApplication::postEvent(receiver, new QEvent(QEvent::UpdateLater));
+}
+
+QList<int> QGalleryTrackerChangeLookup::updateIds(const Update &update) const
+{
+    // Deleted resources no longer have a class to look up, and a large batch is likely to touch
+    // most types anyway; either way every type in the graph is refreshed.
+    const QList<int> graphIds = QGalleryTrackerSchema::graphUpdateIds(update.graph);
+
+    if (update.changes.isEmpty() || update.changes.count() > MaximumResources || graphIds.count() < 2)
+        return graphIds;
+
+    QString valueList;
+
+    typedef QGalleryTrackerResourceChangeList::const_iterator iterator;
+    for (iterator it = update.changes.begin(), end = update.changes.end(); it != end; ++it) {
+        if (it->type == QGalleryTrackerResourceChange::Deleted
+                || it->urn.contains('>')
+                || it->urn.contains(' ')) {
+            return graphIds;
+        }
+        valueList += QLatin1String(" <") + QString::fromUtf8(it->urn) + QLatin1Char('>');
+    }
+
+    const QString query
+            = QLatin1String("SELECT DISTINCT ?t WHERE { VALUES ?x {")
+            + valueList
+            + QLatin1String(" } ?x a ?t }");
+
+    GError *error = 0;
+    TrackerSparqlCursor *cursor = tracker_sparql_connection_query(
+            m_connection, query.toUtf8().constData(), m_cancellable, &error);
+
+    if (error) {
+        if (!g_error_matches(error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+            qWarning() << "Error looking up changed resource types:" << error->message;
+        g_error_free(error);
+
+        if (cursor)
+            g_object_unref(cursor);
+
+        return graphIds;
+    }
+
+    QStringList rdfTypes;
+    while (tracker_sparql_cursor_next(cursor, m_cancellable, 0))
+        rdfTypes.append(QString::fromUtf8(tracker_sparql_cursor_get_string(cursor, 0, 0)));
+
+    g_object_unref(cursor);
+
+    const QList<int> typeIds = QGalleryTrackerSchema::rdfTypeUpdateIds(rdfTypes);
+
+    QList<int> ids;
+
+    typedef QList<int>::const_iterator iterator;
+    for (iterator it = typeIds.begin(), end = typeIds.end(); it != end; ++it) {
+        if (graphIds.contains(*it))
+            ids.append(*it);
+    }
+
+    return !ids.isEmpty() ? ids : graphIds;
+}
+
 static void notifierCallback(TrackerNotifier *self,
                              char *service,
                              char *graph,
@@ -54,25 +206,53 @@ static void notifierCallback(TrackerNotifier *self,
 {
     Q_UNUSED(self);
     Q_UNUSED(service);
-    Q_UNUSED(events);
     QGalleryTrackerChangeNotifier *galleryNotifier = static_cast<QGalleryTrackerChangeNotifier*>(user_data);
 
-    if (galleryNotifier) {
-        galleryNotifier->handleGraphUpdate(QString::fromLatin1(graph));
+    if (!galleryNotifier)
+        return;
+
+    QGalleryTrackerResourceChangeList changes;
+    changes.reserve(events->len);
+
+    for (guint i = 0; i < events->len; ++i) {
+        TrackerNotifierEvent *event = static_cast<TrackerNotifierEvent *>(g_ptr_array_index(events, i));
+        const char *urn = tracker_notifier_event_get_urn(event);
+
+        if (!urn) {
+            // Without an urn for every resource the changes can't be applied selectively.
+            changes.clear();
+            break;
+        }
+
+        QGalleryTrackerResourceChange change;
+        switch (tracker_notifier_event_get_event_type(event)) {
+        case TRACKER_NOTIFIER_EVENT_CREATE:
+            change.type = QGalleryTrackerResourceChange::Created;
+            break;
+        case TRACKER_NOTIFIER_EVENT_DELETE:
+            change.type = QGalleryTrackerResourceChange::Deleted;
+            break;
+        default:
+            change.type = QGalleryTrackerResourceChange::Updated;
+            break;
+        }
+        change.urn = QByteArray(urn);
+
+        changes.append(change);
     }
+
+    galleryNotifier->handleGraphUpdate(QString::fromLatin1(graph), changes);
 }
 
 QGalleryTrackerChangeNotifier::QGalleryTrackerChangeNotifier(
         TrackerSparqlConnection *connection,
         QObject *parent)
     : QObject(parent)
+    , m_notifier(0)
+    , m_lookup(0)
 {
-    m_notifier = tracker_sparql_connection_create_notifier(connection);
-    if (m_notifier) {
-        g_signal_connect(m_notifier, "events", G_CALLBACK(notifierCallback), this);
-    } else {
-        qWarning() << "Failed to create TrackerNotifier";
-    }
+    if (connection)
+        setConnection(connection);
 }
 
 QGalleryTrackerChangeNotifier::~QGalleryTrackerChangeNotifier()
@@ -80,20 +260,105 @@ QGalleryTrackerChangeNotifier::~QGalleryTrackerChangeNotifier()
     if (m_notifier) {
         g_object_unref(m_notifier);
     }
+
+    if (m_lookup) {
+        {
+            QMutexLocker locker(&m_lookup->mutex);
+
+            m_lookup->receiver = 0;
+            m_lookup->pendingUpdates.clear();
+        }
+
+        // Abort a lookup that's in progress rather than wait on the store to answer it.
+        m_lookup->cancel();
+
+        // Leave a lookup that's still running for the scheduler to delete once it's done.
+        if (!m_lookup->orphan())
+            delete m_lookup;
+    }
+}
+
+void QGalleryTrackerChangeNotifier::setConnection(TrackerSparqlConnection *connection)
+{
+    if (m_notifier)
+        g_object_unref(m_notifier);
+
+    if (!m_lookup)
+        m_lookup = new QGalleryTrackerChangeLookup(connection, this);
+
+    m_notifier = tracker_sparql_connection_create_notifier(connection);
+    if (m_notifier) {
+        g_signal_connect(m_notifier, "events", G_CALLBACK(notifierCallback), this);
+    } else {
+        qWarning() << "Failed to create TrackerNotifier";
+    }
 }
 
-void QGalleryTrackerChangeNotifier::handleGraphUpdate(const QString &graph)
+void QGalleryTrackerChangeNotifier::handleGraphUpdate(
+        const QString &graph, const QGalleryTrackerResourceChangeList &changes)
 {
     // graph in long url format, convert to tracker:GraphName
     QString shortGraph = graph.mid(graph.lastIndexOf('/') + 1);
     shortGraph.replace(QLatin1Char('#'), QLatin1Char(':'));
 
-    Q_EMIT itemsChanged(QGalleryTrackerSchema::graphUpdateIds(shortGraph));
+    if (!m_lookup) {
+        Q_EMIT itemsChanged(QGalleryTrackerSchema::graphUpdateIds(shortGraph), changes);
+        return;
+    }
+
+    const QGalleryTrackerChangeLookup::Update update = { shortGraph, changes, QList<int>() };
+    {
+        QMutexLocker locker(&m_lookup->mutex);
+
+        m_lookup->pendingUpdates.append(update);
+    }
+
+    if (!m_lookup->isActive())
+        QGalleryTrackerScheduler::instance()->start(m_lookup);
+}
+
+bool QGalleryTrackerChangeNotifier::event(QEvent *event)
+{
+    if (event->type() != QEvent::UpdateLater)
+        return QObject::event(event);
+
+    QList<QGalleryTrackerChangeLookup::Update> updates;
+    bool pending = false;
+    {
+        QMutexLocker locker(&m_lookup->mutex);
+
+        updates.swap(m_lookup->finishedUpdates);
+        pending = !m_lookup->pendingUpdates.isEmpty();
+    }
+
+    if (pending && !m_lookup->isActive())
+        QGalleryTrackerScheduler::instance()->start(m_lookup);
+
+    typedef QList<QGalleryTrackerChangeLookup::Update>::const_iterator iterator;
+    for (iterator it = updates.begin(), end = updates.end(); it != end; ++it)
+        Q_EMIT itemsChanged(it->updateIds, it->changes);
+
+    return true;
 }
 
-void QGalleryTrackerChangeNotifier::itemsEdited(const QString &service)
+void QGalleryTrackerChangeNotifier::itemsEdited(const QString &service, const QStringList &urns)
 {
-    Q_EMIT itemsChanged(QList<int>{QGalleryTrackerSchema::serviceUpdateId(service)});
+    QGalleryTrackerResourceChangeList changes;
+
+    typedef QStringList::const_iterator iterator;
+    for (iterator it = urns.begin(), end = urns.end(); it != end; ++it) {
+        const QGalleryTrackerResourceChange change = {
+                QGalleryTrackerResourceChange::Updated, it->toUtf8() };
+
+        changes.append(change);
+    }
+
+    if (!changes.isEmpty()) {
+        QList<int> updateIds;
+        updateIds.append(QGalleryTrackerSchema::serviceUpdateId(service));
+
+        Q_EMIT itemsChanged(updateIds, changes);
+    }
 }
 
 QT_END_NAMESPACE_DOCGALLERY
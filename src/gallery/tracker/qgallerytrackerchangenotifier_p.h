@@ -56,12 +56,30 @@
 #include "qgalleryglobal.h"
 
 #include <QtCore/qobject.h>
+#include <QtCore/qvector.h>
 
 #include <libtracker-sparql/tracker-sparql.h>
 
 QT_BEGIN_NAMESPACE_DOCGALLERY
 
-class QGalleryTrackerChangeNotifier : public QObject
+struct QGalleryTrackerResourceChange
+{
+    enum Type
+    {
+        Created,
+        Updated,
+        Deleted
+    };
+
+    Type type;
+    QByteArray urn;
+};
+
+typedef QVector<QGalleryTrackerResourceChange> QGalleryTrackerResourceChangeList;
+
+class QGalleryTrackerChangeLookup;
+
+class Q_GALLERY_EXPORT QGalleryTrackerChangeNotifier : public QObject
 {
     Q_OBJECT
 public:
@@ -70,16 +88,21 @@ public:
             QObject *parent = Q_NULLPTR);
     ~QGalleryTrackerChangeNotifier();
 
-    void handleGraphUpdate(const QString &graph);
+    void setConnection(TrackerSparqlConnection *connection);
+
+    void handleGraphUpdate(const QString &graph, const QGalleryTrackerResourceChangeList &changes);
+
+    bool event(QEvent *event);
 
 public Q_SLOTS:
-    void itemsEdited(const QString &service);
+    void itemsEdited(const QString &service, const QStringList &urns);
 
 Q_SIGNALS:
-    void itemsChanged(const QList<int> &updateIds);
+    void itemsChanged(const QList<int> &updateIds, const QGalleryTrackerResourceChangeList &changes);
 
 private:
     TrackerNotifier *m_notifier;
+    QGalleryTrackerChangeLookup *m_lookup;
 };
 
 QT_END_NAMESPACE_DOCGALLERY
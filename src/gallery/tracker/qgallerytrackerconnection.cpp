@@ -0,0 +1,165 @@
+/****************************************************************************
+**
+** Copyright (C) 2012 Digia Plc and/or its subsidiary(-ies).
+** Contact: http://www.qt-project.org/legal
+**
+** This file is part of the QtDocGallery module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and Digia.  For licensing terms and
+** conditions see http://qt.digia.com/licensing.  For further information
+** use the contact form at http://qt.digia.com/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU Lesser General Public License version 2.1 requirements
+** will be met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** In addition, as a special exception, Digia gives you certain additional
+** rights.  These rights are described in the Digia Qt LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3.0 as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU General Public License version 3.0 requirements will be
+** met: http://www.gnu.org/copyleft/gpl.html.
+**
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include <tracker-sparql.h>
+
+#include "qgallerytrackerconnection_p.h"
+
+#include "qgallerytrackerchangenotifier_p.h"
+#include "qgallerytrackerstatementcache_p.h"
+
+#include <QtCore/qmutex.h>
+#include <QtCore/qpointer.h>
+#include <QtCore/qdebug.h>
+
+QT_BEGIN_NAMESPACE_DOCGALLERY
+
+namespace {
+
+struct QGalleryTrackerConnectionRegistry
+{
+    QMutex mutex;
+    QWeakPointer<QGalleryTrackerConnection> instance;
+};
+
+}
+
+Q_GLOBAL_STATIC(QGalleryTrackerConnectionRegistry, qt_trackerConnectionRegistry)
+
+QGalleryTrackerConnection::QGalleryTrackerConnection()
+    : m_state(Connecting)
+    , m_cancellable(g_cancellable_new())
+    , m_connection(0)
+    , m_notifier(new QGalleryTrackerChangeNotifier(0))
+{
+    // Activating the miner can take a while, so the connection is opened in the background and
+    // the galleries hold requests until it is ready.
+    tracker_sparql_connection_bus_new_async(
+            "org.freedesktop.Tracker3.Miner.Files",
+            0,
+            0,
+            m_cancellable,
+            connectionReady,
+            new QPointer<QGalleryTrackerConnection>(this));
+}
+
+QGalleryTrackerConnection::~QGalleryTrackerConnection()
+{
+    g_cancellable_cancel(m_cancellable);
+    g_object_unref(m_cancellable);
+
+    delete m_notifier;
+    m_statements.clear();
+
+    if (m_connection)
+        g_object_unref(m_connection);
+}
+
+void QGalleryTrackerConnection::connectionReady(GObject *, GAsyncResult *result, gpointer data)
+{
+    QPointer<QGalleryTrackerConnection> *pointer
+            = static_cast<QPointer<QGalleryTrackerConnection> *>(data);
+    QGalleryTrackerConnection *connection = pointer->data();
+
+    delete pointer;
+
+    GError *error = 0;
+    TrackerSparqlConnection *sparqlConnection = tracker_sparql_connection_bus_new_finish(
+            result, &error);
+
+    if (!connection) {
+        if (sparqlConnection)
+            g_object_unref(sparqlConnection);
+        if (error)
+            g_error_free(error);
+        return;
+    }
+
+    if (error) {
+        qWarning() << "Error creating tracker connection:" << error->message;
+        g_error_free(error);
+    }
+
+    if (sparqlConnection) {
+        connection->m_connection = sparqlConnection;
+        connection->m_statements = QSharedPointer<QGalleryTrackerStatementCache>(
+                new QGalleryTrackerStatementCache(sparqlConnection));
+        connection->m_notifier->setConnection(sparqlConnection);
+        connection->m_state = Connected;
+    } else {
+        connection->m_state = Failed;
+
+        // Don't hand a failed connection to galleries created later, they'll try again.
+        QGalleryTrackerConnectionRegistry *registry = qt_trackerConnectionRegistry();
+
+        QMutexLocker locker(&registry->mutex);
+
+        if (registry->instance.data() == connection)
+            registry->instance.clear();
+    }
+
+    Q_EMIT connection->stateChanged(connection->m_state);
+}
+
+/*
+    Returns the connection shared by every gallery in the process, starting to open it if there's
+    no gallery currently holding a reference.
+*/
+
+QSharedPointer<QGalleryTrackerConnection> QGalleryTrackerConnection::instance()
+{
+    QGalleryTrackerConnectionRegistry *registry = qt_trackerConnectionRegistry();
+
+    QMutexLocker locker(&registry->mutex);
+
+    QSharedPointer<QGalleryTrackerConnection> connection = registry->instance.toStrongRef();
+
+    if (!connection) {
+        connection = QSharedPointer<QGalleryTrackerConnection>(new QGalleryTrackerConnection);
+
+        registry->instance = connection;
+    }
+    return connection;
+}
+
+QT_END_NAMESPACE_DOCGALLERY
+
+#include "moc_qgallerytrackerconnection_p.cpp"
@@ -87,7 +87,7 @@ bool QGalleryTrackerEditableResultSet::setMetaData(int key, const QVariant &valu
 {
     Q_D(QGalleryTrackerEditableResultSet);
 
-    if (!d->currentRow || key < d->valueOffset || key >= d->columnCount)
+    if (d->currentRow.isNull() || key < d->valueOffset || key >= d->columnCount)
         return false;
     else if (key >= d->aliasOffset)
         key = d->aliasColumns.at(key - d->aliasOffset) + d->valueOffset;
@@ -95,7 +95,7 @@ bool QGalleryTrackerEditableResultSet::setMetaData(int key, const QVariant &valu
     if (key >= d->compositeOffset)
         return false;
 
-    if (*(d->currentRow + key) == value)
+    if (d->currentRow.value(key) == value)
         return true;
 
     QGalleryTrackerMetaDataEdit *edit = 0;
@@ -110,27 +110,30 @@ bool QGalleryTrackerEditableResultSet::setMetaData(int key, const QVariant &valu
 
     if (!edit) {
         edit = new QGalleryTrackerMetaDataEdit(
-                d->connection,
-                (d->currentRow + 1)->toString(),
-                d->currentRow->toString(),
+                d->task->connection,
+                d->currentRow.value(1).toString(),
+                d->currentRow.value(0).toString(),
                 this);
         edit->setIndex(d->currentIndex);
 
-        connect(edit, SIGNAL(finished(QGalleryTrackerMetaDataEdit*)),
-                this, SLOT(_q_editFinished(QGalleryTrackerMetaDataEdit*)));
-
         connect(this, SIGNAL(itemsInserted(int,int)), edit, SLOT(itemsInserted(int,int)));
         connect(this, SIGNAL(itemsRemoved(int,int)), edit, SLOT(itemsRemoved(int,int)));
+        connect(this, SIGNAL(itemsMoved(int,int,int)), edit, SLOT(itemsMoved(int,int,int)));
 
         d->edits.append(edit);
 
-        d->requestUpdate();
+        d->requestCommit();
     }
 
     edit->setValue(
             d->fieldNames.at(key - d->valueOffset),
-            d->valueColumns.at(key - d->valueOffset)->toString(value),
-            (d->currentRow + key)->toString());
+            d->task->valueColumns.at(key - d->valueOffset)->toString(value),
+            d->currentRow.value(key).toString());
+    edit->setCachedValue(key, value, d->currentRow.value(key));
+
+    // Show the new value straight away rather than waiting for tracker to report it back.  While
+    // a query is running it's applied once that finishes.
+    d->applyEdit(edit, false);
 
     return true;
 }
@@ -57,7 +57,7 @@
 
 QT_BEGIN_NAMESPACE_DOCGALLERY
 
-class QGalleryTrackerMetaDataEdit;
+class QGalleryTrackerMetaDataBatch;
 
 class QGalleryTrackerEditableResultSetPrivate;
 
@@ -76,7 +76,7 @@ public:
 
 private:
     Q_DECLARE_PRIVATE(QGalleryTrackerEditableResultSet)
-    Q_PRIVATE_SLOT(d_func(), void _q_editFinished(QGalleryTrackerMetaDataEdit *))
+    Q_PRIVATE_SLOT(d_func(), void _q_editFinished(QGalleryTrackerMetaDataBatch *))
 };
 
 QT_END_NAMESPACE_DOCGALLERY
@@ -79,12 +79,17 @@ QDebug operator << (QDebug debug, TrackerSparqlValueType type)
 
 QT_BEGIN_NAMESPACE_DOCGALLERY
 
-QVariant QGalleryTrackerStringColumn::toVariant(TrackerSparqlCursor *cursor, int index) const
+void QGalleryTrackerStringColumn::appendValue(
+        TrackerSparqlCursor *cursor, int index, QGalleryTrackerValueStore *store) const
 {
     switch (TrackerSparqlValueType type = tracker_sparql_cursor_get_value_type(cursor, index)) {
     case TRACKER_SPARQL_VALUE_TYPE_URI:
-    case TRACKER_SPARQL_VALUE_TYPE_STRING:
-        return QString::fromUtf8(tracker_sparql_cursor_get_string(cursor, index, 0));
+    case TRACKER_SPARQL_VALUE_TYPE_STRING: {
+        glong length = 0;
+        const gchar *string = tracker_sparql_cursor_get_string(cursor, index, &length);
+        static_cast<QGalleryTrackerStringStore *>(store)->append(string, length);
+        return;
+    }
     case TRACKER_SPARQL_VALUE_TYPE_UNBOUND:
     case TRACKER_SPARQL_VALUE_TYPE_BLANK_NODE:
         break;
@@ -95,14 +100,19 @@ QVariant QGalleryTrackerStringColumn::toVariant(TrackerSparqlCursor *cursor, int
         }
         break;
     }
-    return QVariant();
+    store->appendNull();
 }
 
-QVariant QGalleryTrackerStringListColumn::toVariant(TrackerSparqlCursor *cursor, int index) const
+void QGalleryTrackerStringListColumn::appendValue(
+        TrackerSparqlCursor *cursor, int index, QGalleryTrackerValueStore *store) const
 {
     switch (TrackerSparqlValueType type = tracker_sparql_cursor_get_value_type(cursor, index)) {
-    case TRACKER_SPARQL_VALUE_TYPE_STRING:
-        return QString::fromUtf8(tracker_sparql_cursor_get_string(cursor, index, 0)).split(m_separatorChar, QString::SkipEmptyParts);
+    case TRACKER_SPARQL_VALUE_TYPE_STRING: {
+        glong length = 0;
+        const gchar *string = tracker_sparql_cursor_get_string(cursor, index, &length);
+        static_cast<QGalleryTrackerStringStore *>(store)->append(string, length);
+        return;
+    }
     case TRACKER_SPARQL_VALUE_TYPE_UNBOUND:
     case TRACKER_SPARQL_VALUE_TYPE_BLANK_NODE:
         break;
@@ -113,15 +123,20 @@ QVariant QGalleryTrackerStringListColumn::toVariant(TrackerSparqlCursor *cursor,
         }
         break;
     }
-    return QVariant();
+    store->appendNull();
 }
 
-QVariant QGalleryTrackerUrlColumn::toVariant(TrackerSparqlCursor *cursor, int index) const
+void QGalleryTrackerUrlColumn::appendValue(
+        TrackerSparqlCursor *cursor, int index, QGalleryTrackerValueStore *store) const
 {
     switch (TrackerSparqlValueType type = tracker_sparql_cursor_get_value_type(cursor, index)) {
     case TRACKER_SPARQL_VALUE_TYPE_URI:
-    case TRACKER_SPARQL_VALUE_TYPE_STRING:
-        return QUrl::fromEncoded(tracker_sparql_cursor_get_string(cursor, index, 0), QUrl::StrictMode);
+    case TRACKER_SPARQL_VALUE_TYPE_STRING: {
+        glong length = 0;
+        const gchar *string = tracker_sparql_cursor_get_string(cursor, index, &length);
+        static_cast<QGalleryTrackerStringStore *>(store)->append(string, length);
+        return;
+    }
     case TRACKER_SPARQL_VALUE_TYPE_UNBOUND:
     case TRACKER_SPARQL_VALUE_TYPE_BLANK_NODE:
         break;
@@ -132,8 +147,7 @@ QVariant QGalleryTrackerUrlColumn::toVariant(TrackerSparqlCursor *cursor, int in
         }
         break;
     }
-    return QVariant();
-
+    store->appendNull();
 }
 
 QString QGalleryTrackerStringListColumn::toString(const QVariant &variant) const
@@ -143,13 +157,19 @@ QString QGalleryTrackerStringListColumn::toString(const QVariant &variant) const
         : variant.toString();
 }
 
-QVariant QGalleryTrackerIntegerColumn::toVariant(TrackerSparqlCursor *cursor, int index) const
+void QGalleryTrackerIntegerColumn::appendValue(
+        TrackerSparqlCursor *cursor, int index, QGalleryTrackerValueStore *store) const
 {
+    QGalleryTrackerNumericStore<int> *integers
+            = static_cast<QGalleryTrackerNumericStore<int> *>(store);
+
     switch (TrackerSparqlValueType type = tracker_sparql_cursor_get_value_type(cursor, index)) {
     case TRACKER_SPARQL_VALUE_TYPE_INTEGER:
-        return int(tracker_sparql_cursor_get_integer(cursor, index));
+        integers->append(int(tracker_sparql_cursor_get_integer(cursor, index)));
+        return;
     case TRACKER_SPARQL_VALUE_TYPE_DOUBLE:
-        return int(tracker_sparql_cursor_get_double(cursor, index));
+        integers->append(int(tracker_sparql_cursor_get_double(cursor, index)));
+        return;
     case TRACKER_SPARQL_VALUE_TYPE_UNBOUND:
     case TRACKER_SPARQL_VALUE_TYPE_BLANK_NODE:
         break;
@@ -160,17 +180,22 @@ QVariant QGalleryTrackerIntegerColumn::toVariant(TrackerSparqlCursor *cursor, in
         }
         break;
     }
-    return QVariant();
-
+    store->appendNull();
 }
 
-QVariant QGalleryTrackerLongLongColumn::toVariant(TrackerSparqlCursor *cursor, int index) const
+void QGalleryTrackerLongLongColumn::appendValue(
+        TrackerSparqlCursor *cursor, int index, QGalleryTrackerValueStore *store) const
 {
+    QGalleryTrackerNumericStore<qint64> *integers
+            = static_cast<QGalleryTrackerNumericStore<qint64> *>(store);
+
     switch (TrackerSparqlValueType type = tracker_sparql_cursor_get_value_type(cursor, index)) {
     case TRACKER_SPARQL_VALUE_TYPE_INTEGER:
-        return qint64(tracker_sparql_cursor_get_integer(cursor, index));
+        integers->append(qint64(tracker_sparql_cursor_get_integer(cursor, index)));
+        return;
     case TRACKER_SPARQL_VALUE_TYPE_DOUBLE:
-        return qint64(tracker_sparql_cursor_get_double(cursor, index));
+        integers->append(qint64(tracker_sparql_cursor_get_double(cursor, index)));
+        return;
     case TRACKER_SPARQL_VALUE_TYPE_UNBOUND:
     case TRACKER_SPARQL_VALUE_TYPE_BLANK_NODE:
         break;
@@ -181,17 +206,22 @@ QVariant QGalleryTrackerLongLongColumn::toVariant(TrackerSparqlCursor *cursor, i
         }
         break;
     }
-    return QVariant();
-
+    store->appendNull();
 }
 
-QVariant QGalleryTrackerDoubleColumn::toVariant(TrackerSparqlCursor *cursor, int index) const
+void QGalleryTrackerDoubleColumn::appendValue(
+        TrackerSparqlCursor *cursor, int index, QGalleryTrackerValueStore *store) const
 {
+    QGalleryTrackerNumericStore<double> *doubles
+            = static_cast<QGalleryTrackerNumericStore<double> *>(store);
+
     switch (TrackerSparqlValueType type = tracker_sparql_cursor_get_value_type(cursor, index)) {
     case TRACKER_SPARQL_VALUE_TYPE_INTEGER:
-        return double(tracker_sparql_cursor_get_integer(cursor, index));
+        doubles->append(double(tracker_sparql_cursor_get_integer(cursor, index)));
+        return;
     case TRACKER_SPARQL_VALUE_TYPE_DOUBLE:
-        return tracker_sparql_cursor_get_double(cursor, index);
+        doubles->append(tracker_sparql_cursor_get_double(cursor, index));
+        return;
     case TRACKER_SPARQL_VALUE_TYPE_UNBOUND:
     case TRACKER_SPARQL_VALUE_TYPE_BLANK_NODE:
         break;
@@ -202,15 +232,22 @@ QVariant QGalleryTrackerDoubleColumn::toVariant(TrackerSparqlCursor *cursor, int
         }
         break;
     }
-    return QVariant();
+    store->appendNull();
 }
 
-QVariant QGalleryTrackerDateTimeColumn::toVariant(TrackerSparqlCursor *cursor, int index) const
+void QGalleryTrackerDateTimeColumn::appendValue(
+        TrackerSparqlCursor *cursor, int index, QGalleryTrackerValueStore *store) const
 {
     switch (TrackerSparqlValueType type = tracker_sparql_cursor_get_value_type(cursor, index)) {
-    case TRACKER_SPARQL_VALUE_TYPE_DATETIME:
-        return QDateTime::fromString(
+    case TRACKER_SPARQL_VALUE_TYPE_DATETIME: {
+        const QDateTime dateTime = QDateTime::fromString(
                     QString::fromUtf8(tracker_sparql_cursor_get_string(cursor, index, 0)), Qt::ISODate);
+        if (dateTime.isValid()) {
+            static_cast<QGalleryTrackerDateTimeStore *>(store)->append(dateTime);
+            return;
+        }
+        break;
+    }
     case TRACKER_SPARQL_VALUE_TYPE_UNBOUND:
     case TRACKER_SPARQL_VALUE_TYPE_BLANK_NODE:
         break;
@@ -221,7 +258,7 @@ QVariant QGalleryTrackerDateTimeColumn::toVariant(TrackerSparqlCursor *cursor, i
         }
         break;
     }
-    return QVariant();
+    store->appendNull();
 }
 
 QString QGalleryTrackerDateTimeColumn::toString(const QVariant &variant) const
@@ -229,27 +266,27 @@ QString QGalleryTrackerDateTimeColumn::toString(const QVariant &variant) const
     return variant.toDateTime().toString(Qt::ISODate);
 }
 
-QVariant QGalleryTrackerStaticColumn::value(QVector<QVariant>::const_iterator) const
+QVariant QGalleryTrackerStaticColumn::value(const QGalleryTrackerRow &) const
 {
     return m_value;
 }
 
-QVariant QGalleryTrackerPrefixColumn::value(QVector<QVariant>::const_iterator row) const
+QVariant QGalleryTrackerPrefixColumn::value(const QGalleryTrackerRow &row) const
 {
-    return QString(m_prefix + (row + m_column)->toString());
+    return QString(m_prefix + row.value(m_column).toString());
 }
 
-QVariant QGalleryTrackerCompositeIdColumn::value(QVector<QVariant>::const_iterator row) const
+QVariant QGalleryTrackerCompositeIdColumn::value(const QGalleryTrackerRow &row) const
 {
-    QString fragment = (row + m_columns.at(0))->toString();
+    QString fragment = row.value(m_columns.at(0)).toString();
     fragment.replace(QLatin1String("/"), QLatin1String("//"));
 
-    return QString(m_prefix + fragment + QLatin1Char('/') + (row + m_columns.at(1))->toString());
+    return QString(m_prefix + fragment + QLatin1Char('/') + row.value(m_columns.at(1)).toString());
 }
 
-QVariant QGalleryTrackerFileUrlColumn::value(QVector<QVariant>::const_iterator row) const
+QVariant QGalleryTrackerFileUrlColumn::value(const QGalleryTrackerRow &row) const
 {
-    return *(row + m_column);
+    return row.value(m_column);
 }
 
 QGalleryTrackerCompositeColumn *QGalleryTrackerFileUrlColumn::create(const QVector<int> &)
@@ -257,9 +294,9 @@ QGalleryTrackerCompositeColumn *QGalleryTrackerFileUrlColumn::create(const QVect
     return new QGalleryTrackerFileUrlColumn(QGALLERYTRACKERFILEURLCOLUMN_DEFAULT_COL);
 }
 
-QVariant QGalleryTrackerFilePathColumn::value(QVector<QVariant>::const_iterator row) const
+QVariant QGalleryTrackerFilePathColumn::value(const QGalleryTrackerRow &row) const
 {
-    return (row + QGALLERYTRACKERFILEURLCOLUMN_DEFAULT_COL)->toUrl().path();
+    return row.value(QGALLERYTRACKERFILEURLCOLUMN_DEFAULT_COL).toUrl().path();
 }
 
 QGalleryTrackerCompositeColumn *QGalleryTrackerFilePathColumn::create(const QVector<int> &)
@@ -267,9 +304,9 @@ QGalleryTrackerCompositeColumn *QGalleryTrackerFilePathColumn::create(const QVec
     return new QGalleryTrackerFilePathColumn;
 }
 
-QVariant QGalleryTrackerPathColumn::value(QVector<QVariant>::const_iterator row) const
+QVariant QGalleryTrackerPathColumn::value(const QGalleryTrackerRow &row) const
 {
-    QString filePath = (row + QGALLERYTRACKERFILEURLCOLUMN_DEFAULT_COL)->toUrl().path();
+    QString filePath = row.value(QGALLERYTRACKERFILEURLCOLUMN_DEFAULT_COL).toUrl().path();
     return filePath.section(QLatin1Char('/'), 0, -2);
 }
 
@@ -278,9 +315,9 @@ QGalleryTrackerCompositeColumn *QGalleryTrackerPathColumn::create(const QVector<
     return new QGalleryTrackerPathColumn;
 }
 
-QVariant QGalleryTrackerFileExtensionColumn::value(QVector<QVariant>::const_iterator row) const
+QVariant QGalleryTrackerFileExtensionColumn::value(const QGalleryTrackerRow &row) const
 {
-    QString fileName = (row + m_column)->toUrl().path();
+    QString fileName = row.value(m_column).toUrl().path();
     const int index = fileName.lastIndexOf(QLatin1Char('.'));
     return index > fileName.lastIndexOf(QLatin1Char('/'))
             ? QVariant(fileName.mid(index + 1))
@@ -292,9 +329,9 @@ QGalleryTrackerCompositeColumn *QGalleryTrackerFileExtensionColumn::create(const
     return new QGalleryTrackerFileExtensionColumn(QGALLERYTRACKERFILEURLCOLUMN_DEFAULT_COL);
 }
 
-QVariant QGalleryTrackerOrientationColumn::value(QVector<QVariant>::const_iterator row) const
+QVariant QGalleryTrackerOrientationColumn::value(const QGalleryTrackerRow &row) const
 {
-    QString orientation = (row + m_column)->toString();
+    QString orientation = row.value(m_column).toString();
     if (orientation == QLatin1String("http://tracker.api.gnome.org/ontology/v3/nfo#orientation-top"))
         return 0;
     else if (orientation == QLatin1String("http://tracker.api.gnome.org/ontology/v3/nfo#orientation-left"))
@@ -55,6 +55,8 @@
 
 #include "qgalleryglobal.h"
 
+#include "qgallerytrackertable_p.h"
+
 #include <QtCore/qshareddata.h>
 #include <QtCore/qvariant.h>
 #include <QtCore/qvector.h>
@@ -69,7 +71,11 @@ public:
     QGalleryTrackerValueColumn() : m_warned(false) {}
     virtual ~QGalleryTrackerValueColumn() {}
 
-    virtual QVariant toVariant(TrackerSparqlCursor *cursor, int index) const = 0;
+    virtual QGalleryTrackerValueColumn *clone() const = 0;
+
+    virtual QVariant::Type type() const = 0;
+    virtual void appendValue(
+            TrackerSparqlCursor *cursor, int index, QGalleryTrackerValueStore *store) const = 0;
     virtual QString toString(const QVariant &variant) const { return variant.toString(); }
 
 protected:
@@ -81,19 +87,27 @@ class QGalleryTrackerCompositeColumn
 public:
     virtual ~QGalleryTrackerCompositeColumn() {}
 
-    virtual QVariant value(QVector<QVariant>::const_iterator row) const = 0;
+    virtual QGalleryTrackerCompositeColumn *clone() const = 0;
+
+    virtual QVariant value(const QGalleryTrackerRow &row) const = 0;
 };
 
 class QGalleryTrackerStringColumn : public QGalleryTrackerValueColumn
 {
 public:
-    QVariant toVariant(TrackerSparqlCursor *cursor, int index) const;
+    QGalleryTrackerStringColumn *clone() const { return new QGalleryTrackerStringColumn(*this); }
+    QVariant::Type type() const { return QVariant::String; }
+    void appendValue(
+            TrackerSparqlCursor *cursor, int index, QGalleryTrackerValueStore *store) const;
 };
 
 class QGalleryTrackerUrlColumn : public QGalleryTrackerValueColumn
 {
 public:
-    QVariant toVariant(TrackerSparqlCursor *cursor, int index) const;
+    QGalleryTrackerUrlColumn *clone() const { return new QGalleryTrackerUrlColumn(*this); }
+    QVariant::Type type() const { return QVariant::Url; }
+    void appendValue(
+            TrackerSparqlCursor *cursor, int index, QGalleryTrackerValueStore *store) const;
 };
 
 class QGalleryTrackerStringListColumn : public QGalleryTrackerValueColumn
@@ -101,7 +115,10 @@ class QGalleryTrackerStringListColumn : public QGalleryTrackerValueColumn
 public:
     QGalleryTrackerStringListColumn()
         : m_separatorChar(QLatin1Char('|')), m_separatorString(QLatin1String("|")) {}
-    QVariant toVariant(TrackerSparqlCursor *cursor, int index) const;
+    QGalleryTrackerStringListColumn *clone() const { return new QGalleryTrackerStringListColumn(*this); }
+    QVariant::Type type() const { return QVariant::StringList; }
+    void appendValue(
+            TrackerSparqlCursor *cursor, int index, QGalleryTrackerValueStore *store) const;
     QString toString(const QVariant &variant) const;
 
 private:
@@ -112,25 +129,37 @@ private:
 class QGalleryTrackerIntegerColumn : public QGalleryTrackerValueColumn
 {
 public:
-    QVariant toVariant(TrackerSparqlCursor *cursor, int index) const;
+    QGalleryTrackerIntegerColumn *clone() const { return new QGalleryTrackerIntegerColumn(*this); }
+    QVariant::Type type() const { return QVariant::Int; }
+    void appendValue(
+            TrackerSparqlCursor *cursor, int index, QGalleryTrackerValueStore *store) const;
 };
 
 class QGalleryTrackerLongLongColumn : public QGalleryTrackerValueColumn
 {
 public:
-    QVariant toVariant(TrackerSparqlCursor *cursor, int index) const;
+    QGalleryTrackerLongLongColumn *clone() const { return new QGalleryTrackerLongLongColumn(*this); }
+    QVariant::Type type() const { return QVariant::LongLong; }
+    void appendValue(
+            TrackerSparqlCursor *cursor, int index, QGalleryTrackerValueStore *store) const;
 };
 
 class QGalleryTrackerDoubleColumn : public QGalleryTrackerValueColumn
 {
 public:
-    QVariant toVariant(TrackerSparqlCursor *cursor, int index) const;
+    QGalleryTrackerDoubleColumn *clone() const { return new QGalleryTrackerDoubleColumn(*this); }
+    QVariant::Type type() const { return QVariant::Double; }
+    void appendValue(
+            TrackerSparqlCursor *cursor, int index, QGalleryTrackerValueStore *store) const;
 };
 
 class QGalleryTrackerDateTimeColumn : public QGalleryTrackerValueColumn
 {
 public:
-    QVariant toVariant(TrackerSparqlCursor *cursor, int index) const;
+    QGalleryTrackerDateTimeColumn *clone() const { return new QGalleryTrackerDateTimeColumn(*this); }
+    QVariant::Type type() const { return QVariant::DateTime; }
+    void appendValue(
+            TrackerSparqlCursor *cursor, int index, QGalleryTrackerValueStore *store) const;
     QString toString(const QVariant &variant) const;
 };
 
@@ -139,7 +168,8 @@ class QGalleryTrackerStaticColumn : public QGalleryTrackerCompositeColumn
 public:
     QGalleryTrackerStaticColumn(const QVariant &value) : m_value(value) {}
 
-    QVariant value(QVector<QVariant>::const_iterator row) const;
+    QGalleryTrackerStaticColumn *clone() const { return new QGalleryTrackerStaticColumn(*this); }
+    QVariant value(const QGalleryTrackerRow &row) const;
 
 private:
     const QVariant m_value;
@@ -151,7 +181,8 @@ public:
     QGalleryTrackerPrefixColumn(int column, const QString &prefix)
         : m_column(column), m_prefix(prefix) {}
 
-    QVariant value(QVector<QVariant>::const_iterator row) const;
+    QGalleryTrackerPrefixColumn *clone() const { return new QGalleryTrackerPrefixColumn(*this); }
+    QVariant value(const QGalleryTrackerRow &row) const;
 
 private:
     const int m_column;
@@ -164,7 +195,8 @@ public:
     QGalleryTrackerCompositeIdColumn(const QVector<int> columns, const QString &prefix)
         : m_columns(columns), m_prefix(prefix) {}
 
-    QVariant value(QVector<QVariant>::const_iterator row) const;
+    QGalleryTrackerCompositeIdColumn *clone() const { return new QGalleryTrackerCompositeIdColumn(*this); }
+    QVariant value(const QGalleryTrackerRow &row) const;
 
 private:
     const QVector<int> m_columns;
@@ -178,7 +210,8 @@ class QGalleryTrackerFileUrlColumn : public QGalleryTrackerCompositeColumn
 public:
     QGalleryTrackerFileUrlColumn(int column) : m_column(column) {}
 
-    QVariant value(QVector<QVariant>::const_iterator row) const;
+    QGalleryTrackerFileUrlColumn *clone() const { return new QGalleryTrackerFileUrlColumn(*this); }
+    QVariant value(const QGalleryTrackerRow &row) const;
 
     static QGalleryTrackerCompositeColumn *create(const QVector<int> &);
 
@@ -189,7 +222,8 @@ private:
 class QGalleryTrackerFilePathColumn : public QGalleryTrackerCompositeColumn
 {
 public:
-    QVariant value(QVector<QVariant>::const_iterator row) const;
+    QGalleryTrackerFilePathColumn *clone() const { return new QGalleryTrackerFilePathColumn(*this); }
+    QVariant value(const QGalleryTrackerRow &row) const;
 
     static QGalleryTrackerCompositeColumn *create(const QVector<int> &columns);
 };
@@ -197,7 +231,8 @@ public:
 class QGalleryTrackerPathColumn : public QGalleryTrackerCompositeColumn
 {
 public:
-    QVariant value(QVector<QVariant>::const_iterator row) const;
+    QGalleryTrackerPathColumn *clone() const { return new QGalleryTrackerPathColumn(*this); }
+    QVariant value(const QGalleryTrackerRow &row) const;
 
     static QGalleryTrackerCompositeColumn *create(const QVector<int> &columns);
 };
@@ -207,7 +242,8 @@ class QGalleryTrackerFileExtensionColumn : public QGalleryTrackerCompositeColumn
 public:
     QGalleryTrackerFileExtensionColumn(int column) : m_column(column) {}
 
-    QVariant value(QVector<QVariant>::const_iterator row) const;
+    QGalleryTrackerFileExtensionColumn *clone() const { return new QGalleryTrackerFileExtensionColumn(*this); }
+    QVariant value(const QGalleryTrackerRow &row) const;
 
     static QGalleryTrackerCompositeColumn *create(const QVector<int> &);
 
@@ -222,7 +258,8 @@ public:
     QGalleryTrackerOrientationColumn(int column)
         : m_column(column) {}
 
-    QVariant value(QVector<QVariant>::const_iterator row) const;
+    QGalleryTrackerOrientationColumn *clone() const { return new QGalleryTrackerOrientationColumn(*this); }
+    QVariant value(const QGalleryTrackerRow &row) const;
 
     static QGalleryTrackerCompositeColumn *create(const QVector<int> &);
 
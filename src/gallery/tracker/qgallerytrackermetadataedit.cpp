@@ -41,6 +41,9 @@
 
 #include "qgallerytrackermetadataedit_p.h"
 
+#include "qgallerytrackerrowdiff_p.h"
+
+#include <QtCore/qpointer.h>
 #include <QtDBus/qdbuspendingcall.h>
 
 #include <QDebug>
@@ -103,36 +106,108 @@ static QString _qt_createUpdateStatement(
     return statement;
 }
 
-void QGalleryTrackerMetaDataEdit::commit()
+QString QGalleryTrackerMetaDataEdit::statement() const
 {
-    if (m_values.isEmpty()) {
-        Q_EMIT finished(this);
-    } else {
-        GError *error = 0;
-        tracker_sparql_connection_update(m_connection,
-                                         qPrintable(_qt_createUpdateStatement(m_service, m_values, m_oldValues)),
-                                         NULL, &error);
-        if (error) {
-            qWarning() << "Error executing sparql commit" << QString::fromUtf8(error->message);
-            g_error_free(error);
-        }
-
-        Q_EMIT finished(this);
-    }
+    return _qt_createUpdateStatement(m_service, m_values, m_oldValues);
 }
 
 void QGalleryTrackerMetaDataEdit::itemsInserted(int index, int count)
 {
-    if (index < m_index)
+    if (index <= m_index)
         m_index += count;
 }
 
 void QGalleryTrackerMetaDataEdit::itemsRemoved(int index, int count)
 {
-    if (index + count < m_index)
+    if (index + count <= m_index)
         m_index -= count;
-    else if (index < m_index)
+    else if (index <= m_index)
         m_index = -1;
 }
 
+void QGalleryTrackerMetaDataEdit::itemsMoved(int from, int to, int count)
+{
+    m_index = QGalleryTrackerRowDiff::movedIndex(m_index, from, to, count);
+}
+
+QGalleryTrackerMetaDataBatch::QGalleryTrackerMetaDataBatch(
+        TrackerSparqlConnection *connection, QObject *parent)
+    : QObject(parent)
+    , m_connection(connection)
+{
+}
+
+QGalleryTrackerMetaDataBatch::~QGalleryTrackerMetaDataBatch()
+{
+}
+
+void QGalleryTrackerMetaDataBatch::addEdit(QGalleryTrackerMetaDataEdit *edit)
+{
+    edit->setParent(this);
+
+    m_edits.append(edit);
+}
+
+QStringList QGalleryTrackerMetaDataBatch::resources() const
+{
+    QStringList resources;
+
+    typedef QList<QGalleryTrackerMetaDataEdit *>::const_iterator iterator;
+    for (iterator it = m_edits.constBegin(), end = m_edits.constEnd(); it != end; ++it) {
+        if (!(*it)->values().isEmpty())
+            resources.append((*it)->service());
+    }
+    return resources;
+}
+
+void QGalleryTrackerMetaDataBatch::execute()
+{
+    QStringList statements;
+
+    typedef QList<QGalleryTrackerMetaDataEdit *>::const_iterator iterator;
+    for (iterator it = m_edits.constBegin(), end = m_edits.constEnd(); it != end; ++it) {
+        const QString statement = (*it)->statement();
+
+        if (!statement.isEmpty())
+            statements.append(statement);
+    }
+
+    if (statements.isEmpty()) {
+        Q_EMIT finished(this);
+    } else {
+        // The batch may be deleted with its result set before the update completes, in which
+        // case the update still goes ahead but there is no-one left to tell.
+        tracker_sparql_connection_update_async(
+                m_connection,
+                statements.join(QLatin1String(" ; ")).toUtf8(),
+                0,
+                updateCallback,
+                new QPointer<QGalleryTrackerMetaDataBatch>(this));
+    }
+}
+
+void QGalleryTrackerMetaDataBatch::updateCallback(
+        GObject *object, GAsyncResult *result, gpointer data)
+{
+    QPointer<QGalleryTrackerMetaDataBatch> *batch
+            = static_cast<QPointer<QGalleryTrackerMetaDataBatch> *>(data);
+
+    GError *error = 0;
+    tracker_sparql_connection_update_finish(TRACKER_SPARQL_CONNECTION(object), result, &error);
+
+    if (error) {
+        qWarning() << "Error executing sparql commit" << QString::fromUtf8(error->message);
+
+        if (*batch)
+            (*batch)->m_errorString = QString::fromUtf8(error->message);
+
+        g_error_free(error);
+    }
+
+    if (*batch)
+        Q_EMIT (*batch)->finished(*batch);
+
+    delete batch;
+}
+
 QT_END_NAMESPACE_DOCGALLERY
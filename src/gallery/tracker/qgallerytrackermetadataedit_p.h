@@ -56,6 +56,7 @@
 #include "qgalleryglobal.h"
 
 #include <QtCore/qstringlist.h>
+#include <QtCore/qvariant.h>
 #include <QObject>
 #include <QMap>
 
@@ -63,7 +64,7 @@
 
 QT_BEGIN_NAMESPACE_DOCGALLERY
 
-class QGalleryTrackerMetaDataEdit : public QObject
+class Q_GALLERY_EXPORT QGalleryTrackerMetaDataEdit : public QObject
 {
     Q_OBJECT
 public:
@@ -84,18 +85,22 @@ public:
 
     QString value(const QString &field) const { return m_values.value(field); }
     void setValue(const QString &field, const QString &value, const QString &oldValue) {
-        m_values[field] = value; m_oldValues[field] = oldValue;}
+        m_values[field] = value; if (!m_oldValues.contains(field)) m_oldValues[field] = oldValue; }
 
     QMap<QString, QString> values() const { return m_values; }
 
-    void commit();
+    void setCachedValue(int key, const QVariant &value, const QVariant &originalValue) {
+        m_cachedValues[key] = value;
+        if (!m_originalValues.contains(key)) m_originalValues.insert(key, originalValue); }
+    QMap<int, QVariant> cachedValues() const { return m_cachedValues; }
+    QMap<int, QVariant> originalValues() const { return m_originalValues; }
 
-Q_SIGNALS:
-    void finished(QGalleryTrackerMetaDataEdit *edit);
+    QString statement() const;
 
 public Q_SLOTS:
     void itemsInserted(int index, int count);
     void itemsRemoved(int index, int count);
+    void itemsMoved(int from, int to, int count);
 
 private:
     int m_index;
@@ -104,6 +109,34 @@ private:
     QString m_service;
     QMap<QString, QString> m_values;
     QMap<QString, QString> m_oldValues;
+    QMap<int, QVariant> m_cachedValues;
+    QMap<int, QVariant> m_originalValues;
+};
+
+class Q_GALLERY_EXPORT QGalleryTrackerMetaDataBatch : public QObject
+{
+    Q_OBJECT
+public:
+    QGalleryTrackerMetaDataBatch(TrackerSparqlConnection *connection, QObject *parent = Q_NULLPTR);
+    ~QGalleryTrackerMetaDataBatch();
+
+    void addEdit(QGalleryTrackerMetaDataEdit *edit);
+    QList<QGalleryTrackerMetaDataEdit *> edits() const { return m_edits; }
+    QStringList resources() const;
+
+    QString errorString() const { return m_errorString; }
+
+    void execute();
+
+Q_SIGNALS:
+    void finished(QGalleryTrackerMetaDataBatch *batch);
+
+private:
+    static void updateCallback(GObject *object, GAsyncResult *result, gpointer data);
+
+    TrackerSparqlConnection *m_connection;
+    QList<QGalleryTrackerMetaDataEdit *> m_edits;
+    QString m_errorString;
 };
 
 QT_END_NAMESPACE_DOCGALLERY
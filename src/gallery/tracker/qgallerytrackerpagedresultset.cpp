@@ -0,0 +1,1078 @@
+/****************************************************************************
+**
+** Copyright (C) 2012 Digia Plc and/or its subsidiary(-ies).
+** Contact: http://www.qt-project.org/legal
+**
+** This file is part of the QtDocGallery module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and Digia.  For licensing terms and
+** conditions see http://qt.digia.com/licensing.  For further information
+** use the contact form at http://qt.digia.com/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU Lesser General Public License version 2.1 requirements
+** will be met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** In addition, as a special exception, Digia gives you certain additional
+** rights.  These rights are described in the Digia Qt LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3.0 as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU General Public License version 3.0 requirements will be
+** met: http://www.gnu.org/copyleft/gpl.html.
+**
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include <tracker-sparql.h>
+
+#include "qgallerytrackerpagedresultset_p.h"
+
+#include "qgalleryresultset_p.h"
+#include "qgallerytrackerscheduler_p.h"
+#include "qgallerytrackerstatementcache_p.h"
+#include "qgallerytrackertable_p.h"
+
+#include <QtCore/qbasictimer.h>
+#include <QtCore/qcoreapplication.h>
+#include <QtCore/qcoreevent.h>
+#include <QtCore/qdatetime.h>
+#include <QtCore/qelapsedtimer.h>
+#include <QtCore/qdebug.h>
+#include <QtCore/qhash.h>
+#include <QtCore/qmutex.h>
+#include <QtCore/qset.h>
+
+#include <qdocumentgallery.h>
+#include <qgalleryresource.h>
+
+QT_BEGIN_NAMESPACE_DOCGALLERY
+
+/*
+    The state pages are loaded with off the GUI thread.  If the result set is deleted while pages
+    are loading the task is left for the scheduler to delete once it has wound down.
+*/
+
+class QGalleryTrackerPagedResultSetTask : public QGalleryTrackerTask
+{
+public:
+    struct Page
+    {
+        explicit Page(const QVector<QVariant::Type> &types)
+            : values(types), memoryUsage(0), lastUsed(0) {}
+
+        QGalleryTrackerTable values;
+        int memoryUsage;
+        quint64 lastUsed;
+    };
+
+    struct LoadedPage
+    {
+        int index;
+        int generation;
+        Page *page;
+    };
+
+    QGalleryTrackerPagedResultSetTask(
+            TrackerSparqlConnection *connection,
+            QGalleryTrackerResultSetArguments *arguments,
+            int pageSize)
+        : connection(connection)
+        , statements(arguments->statements || !connection
+                ? arguments->statements
+                : QSharedPointer<QGalleryTrackerStatementCache>(
+                        new QGalleryTrackerStatementCache(connection)))
+        , cancellable(g_cancellable_new())
+        , tableWidth(arguments->tableWidth)
+        , pageSize(pageSize)
+        , queryOffset(arguments->offset)
+        , queryLimit(arguments->limit)
+        , pageSparql(arguments->pageSparql)
+        , countSparql(arguments->countSparql)
+        , parameters(arguments->parameters)
+        , valueColumns(arguments->valueColumns)
+        , receiver(0)
+        , generation(0)
+        , countRequested(false)
+        , resultsPosted(false)
+        , loadedCount(-1)
+        , loadedCountGeneration(0)
+        , queryError(QDocumentGallery::NoError)
+    {
+        if (connection)
+            g_object_ref(G_OBJECT(connection));
+
+        typedef QVector<QGalleryTrackerValueColumn *>::const_iterator iterator;
+        for (iterator it = valueColumns.begin(), end = valueColumns.end(); it != end; ++it)
+            columnTypes.append((*it)->type());
+    }
+
+    ~QGalleryTrackerPagedResultSetTask();
+
+    TrackerSparqlConnection *connection;
+    QSharedPointer<QGalleryTrackerStatementCache> statements;
+    GCancellable *const cancellable;
+
+    const int tableWidth;
+    const int pageSize;
+    const int queryOffset;
+    const int queryLimit;
+    const QString pageSparql;
+    const QString countSparql;
+    const QStringList parameters;
+    const QVector<QGalleryTrackerValueColumn *> valueColumns;
+    QVector<QVariant::Type> columnTypes;
+
+    // Shared with the result set.
+    QMutex mutex;
+    QObject *receiver;
+    int generation;
+    bool countRequested;
+    bool resultsPosted;
+    QList<int> pendingPages;
+    QList<LoadedPage> loadedPages;
+    int loadedCount;
+    int loadedCountGeneration;
+    int queryError;
+    QString queryErrorString;
+
+protected:
+    void run();
+    void taskFinished();
+
+private:
+    int queryCount(int *error, QString *errorString) const;
+    Page *queryPage(int index) const;
+    void postResults();
+};
+
+class QGalleryTrackerPagedResultSetPrivate : public QGalleryResultSetPrivate
+{
+    Q_DECLARE_PUBLIC(QGalleryTrackerPagedResultSet)
+public:
+    typedef QGalleryTrackerPagedResultSetTask::Page Page;
+    typedef QGalleryTrackerPagedResultSetTask::LoadedPage LoadedPage;
+
+    enum Flag
+    {
+        Cancelled   = 0x01,
+        Live        = 0x02,
+        Active      = 0x04,
+        Refresh     = 0x08
+    };
+
+    Q_DECLARE_FLAGS(Flags, Flag)
+
+    enum
+    {
+        MemoryBudget            = 8 * 1024 * 1024,
+        MinimumResidentPages    = 2,
+        MaximumPendingPages     = 8
+    };
+
+    QGalleryTrackerPagedResultSetPrivate(
+            TrackerSparqlConnection *connection,
+            QGalleryTrackerResultSetArguments *arguments,
+            int pageSize,
+            bool autoUpdate)
+        : task(new QGalleryTrackerPagedResultSetTask(connection, arguments, pageSize))
+        , idColumn(arguments->idColumn.take())
+        , urlColumn(arguments->urlColumn.take())
+        , typeColumn(arguments->typeColumn.take())
+        , updateMask(arguments->updateMask)
+        , valueOffset(arguments->valueOffset)
+        , compositeOffset(arguments->compositeOffset)
+        , aliasOffset(compositeOffset + arguments->compositeColumns.count())
+        , columnCount(aliasOffset + arguments->aliasColumns.count())
+        , pageSize(pageSize)
+        , currentIndex(-1)
+        , rowCount(0)
+        , useCount(0)
+        , propertyNames(arguments->propertyNames)
+        , propertyAttributes(arguments->propertyAttributes)
+        , propertyTypes(arguments->propertyTypes)
+        , compositeColumns(arguments->compositeColumns)
+        , aliasColumns(arguments->aliasColumns)
+        , resourceKeys(arguments->resourceKeys)
+        , priority(arguments->priority)
+    {
+        arguments->clear();
+
+        for (int i = 0; i < propertyNames.count(); ++i)
+            propertyKeys.append(valueOffset + i);
+
+        if (autoUpdate)
+            flags |= Live;
+
+        refreshClock.start();
+    }
+
+    ~QGalleryTrackerPagedResultSetPrivate();
+
+    QGalleryTrackerPagedResultSetTask *const task;
+
+    Flags flags;
+    const QScopedPointer<QGalleryTrackerCompositeColumn> idColumn;
+    const QScopedPointer<QGalleryTrackerCompositeColumn> urlColumn;
+    const QScopedPointer<QGalleryTrackerCompositeColumn> typeColumn;
+
+    const int updateMask;
+    const int valueOffset;
+    const int compositeOffset;
+    const int aliasOffset;
+    const int columnCount;
+    const int pageSize;
+    QGalleryTrackerRow currentRow;
+    int currentIndex;
+    int rowCount;
+    mutable quint64 useCount;
+    const QStringList propertyNames;
+    const QVector<QGalleryProperty::Attributes> propertyAttributes;
+    const QVector<QVariant::Type> propertyTypes;
+    const QVector<QGalleryTrackerCompositeColumn *> compositeColumns;
+    const QVector<int> aliasColumns;
+    const QVector<int> resourceKeys;
+    const QGalleryTrackerScheduler::Priority priority;
+    QList<int> propertyKeys;
+    QHash<int, Page *> pages;
+    QSet<int> requestedPages;
+    QBasicTimer updateTimer;
+    QGalleryTrackerRefreshPolicy refreshPolicy;
+    QElapsedTimer refreshClock;
+
+    void update();
+    void suspendedChanged();
+    void requestPage(int index);
+    void startLoading();
+
+    void processResults();
+    void setRowCount(int count);
+    void insertPage(int index, Page *page);
+    void evictPages();
+
+    QGalleryTrackerRow rowAt(int index) const;
+    QVariant value(const QGalleryTrackerRow &row, int key) const;
+
+    QVariant itemIdAt(int index) const;
+    QUrl itemUrlAt(int index) const;
+    QString itemTypeAt(int index) const;
+    QVariant metaDataAt(int index, int key) const;
+    void readRows(int first, int count, const QVector<int> &keys, QGalleryRowBuffer *buffer) const;
+
+    void updateCurrentRow();
+};
+
+QT_END_NAMESPACE_DOCGALLERY
+
+Q_DECLARE_OPERATORS_FOR_FLAGS(QT_DOCGALLERY_PREPEND_NAMESPACE(QGalleryTrackerPagedResultSetPrivate::Flags))
+
+QT_BEGIN_NAMESPACE_DOCGALLERY
+
+QGalleryTrackerPagedResultSetTask::~QGalleryTrackerPagedResultSetTask()
+{
+    typedef QList<LoadedPage>::const_iterator iterator;
+    for (iterator it = loadedPages.constBegin(), end = loadedPages.constEnd(); it != end; ++it)
+        delete it->page;
+
+    qDeleteAll(valueColumns);
+
+    g_object_unref(G_OBJECT(cancellable));
+
+    if (connection)
+        g_object_unref(G_OBJECT(connection));
+}
+
+QGalleryTrackerPagedResultSetPrivate::~QGalleryTrackerPagedResultSetPrivate()
+{
+    qDeleteAll(pages);
+    qDeleteAll(compositeColumns);
+
+    // Leave pages that are still loading for the scheduler to delete once they're done.
+    if (!task->orphan())
+        delete task;
+}
+
+void QGalleryTrackerPagedResultSetPrivate::update()
+{
+    updateTimer.stop();
+
+    flags &= ~Refresh;
+
+    {
+        QMutexLocker locker(&task->mutex);
+
+        task->generation += 1;
+        task->countRequested = true;
+
+        // Reload every page that is resident or still wanted so stale rows are replaced in place.
+        for (QHash<int, Page *>::const_iterator it = pages.constBegin(); it != pages.constEnd(); ++it)
+            requestedPages.insert(it.key());
+
+        task->pendingPages = requestedPages.values();
+    }
+
+    flags |= Active;
+
+    refreshPolicy.refreshed(refreshClock.elapsed());
+
+    Q_EMIT q_func()->progressChanged(0, 1);
+
+    startLoading();
+}
+
+void QGalleryTrackerPagedResultSetPrivate::suspendedChanged()
+{
+    if (suspended) {
+        if (updateTimer.isActive()) {
+            updateTimer.stop();
+
+            flags |= Refresh;
+        }
+    } else if (flags & Refresh) {
+        updateTimer.start(0, q_func());
+    }
+}
+
+void QGalleryTrackerPagedResultSetPrivate::requestPage(int index)
+{
+    if ((flags & Cancelled) || requestedPages.contains(index))
+        return;
+
+    requestedPages.insert(index);
+
+    {
+        QMutexLocker locker(&task->mutex);
+
+        task->pendingPages.append(index);
+
+        // Pages are loaded most recent request first, ones scrolled past long ago are dropped.
+        if (task->pendingPages.count() > MaximumPendingPages)
+            requestedPages.remove(task->pendingPages.takeFirst());
+    }
+
+    startLoading();
+}
+
+void QGalleryTrackerPagedResultSetPrivate::startLoading()
+{
+    // Pages requested before the gallery has connected are loaded once it has.
+    if (task->connection && !task->isActive())
+        QGalleryTrackerScheduler::instance()->start(task, priority);
+}
+
+void QGalleryTrackerPagedResultSetTask::run()
+{
+    for (;;) {
+        int index = -1;
+        int requestGeneration = 0;
+        {
+            QMutexLocker locker(&mutex);
+
+            if (countRequested)
+                countRequested = false;
+            else if (!pendingPages.isEmpty())
+                index = pendingPages.takeLast();
+            else
+                break;
+
+            requestGeneration = generation;
+        }
+
+        if (g_cancellable_is_cancelled(cancellable))
+            break;
+
+        if (index < 0) {
+            int error = QDocumentGallery::NoError;
+            QString errorString;
+
+            const int count = queryCount(&error, &errorString);
+
+            QMutexLocker locker(&mutex);
+
+            loadedCount = count;
+            loadedCountGeneration = requestGeneration;
+            queryError = error;
+            queryErrorString = errorString;
+
+            postResults();
+        } else {
+            const LoadedPage page = { index, requestGeneration, queryPage(index) };
+
+            QMutexLocker locker(&mutex);
+
+            loadedPages.append(page);
+
+            postResults();
+        }
+    }
+}
+
+void QGalleryTrackerPagedResultSetTask::taskFinished()
+{
+    // Requests made while the last page was loading may need the task to be restarted.
+    QMutexLocker locker(&mutex);
+
+    resultsPosted = false;
+    postResults();
+}
+
+int QGalleryTrackerPagedResultSetTask::queryCount(int *error, QString *errorString) const
+{
+    int count = 0;
+
+    GError *gError = 0;
+    if (TrackerSparqlCursor *cursor = statements->query(
+                countSparql, parameters, cancellable, &gError)) {
+        if (tracker_sparql_cursor_next(cursor, cancellable, 0))
+            count = tracker_sparql_cursor_get_integer(cursor, 0);
+
+        g_object_unref(G_OBJECT(cursor));
+    } else {
+        if (!g_error_matches(gError, G_IO_ERROR, G_IO_ERROR_CANCELLED)) {
+            *error = QDocumentGallery::FilterError;
+            *errorString = QString::fromUtf8(gError->message);
+        }
+        g_error_free(gError);
+    }
+
+    count = qMax(0, count - queryOffset);
+
+    return queryLimit > 0 ? qMin(count, queryLimit) : count;
+}
+
+QGalleryTrackerPagedResultSetTask::Page *QGalleryTrackerPagedResultSetTask::queryPage(
+        int index) const
+{
+    const int offset = index * pageSize;
+    const int limit = queryLimit > 0 ? qMin(pageSize, queryLimit - offset) : pageSize;
+
+    if (limit <= 0)
+        return 0;
+
+    const QString sparql = pageSparql
+            + QString::fromLatin1(" OFFSET %1 LIMIT %2").arg(queryOffset + offset).arg(limit);
+
+    GError *error = 0;
+    // Every page has a distinct OFFSET so there's nothing to gain from caching the statement.
+    TrackerSparqlCursor *cursor = statements->queryOnce(sparql, parameters, cancellable, &error);
+
+    if (!cursor) {
+        if (!g_error_matches(error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+            qWarning() << "Error loading gallery page:" << error->message;
+        g_error_free(error);
+
+        return 0;
+    }
+
+    Page *page = new Page(columnTypes);
+
+    while (tracker_sparql_cursor_next(cursor, cancellable, 0)) {
+        const int rowWidth = qMin(tableWidth, tracker_sparql_cursor_get_n_columns(cursor));
+        int i = 0;
+        for (; i < rowWidth; ++i)
+            valueColumns.at(i)->appendValue(cursor, i, page->values.column(i));
+        for (; i < tableWidth; ++i)
+            page->values.column(i)->appendNull();
+    }
+    g_object_unref(G_OBJECT(cursor));
+
+    if (g_cancellable_is_cancelled(cancellable)) {
+        delete page;
+
+        return 0;
+    }
+
+    page->memoryUsage = page->values.memoryUsage();
+
+    return page;
+}
+
+void QGalleryTrackerPagedResultSetTask::postResults()
+{
+    if (receiver && !resultsPosted) {
+        resultsPosted = true;
+
+        QCoreApplication::postEvent(receiver, new QEvent(QEvent::UpdateLater));
+    }
+}
+
+void QGalleryTrackerPagedResultSetPrivate::processResults()
+{
+    int count = -1;
+    int error = QDocumentGallery::NoError;
+    QString errorString;
+    QList<LoadedPage> loaded;
+    int currentGeneration;
+    bool pending;
+    {
+        QMutexLocker locker(&task->mutex);
+
+        task->resultsPosted = false;
+
+        if (task->loadedCount >= 0 && task->loadedCountGeneration == task->generation) {
+            count = task->loadedCount;
+            error = task->queryError;
+            errorString = task->queryErrorString;
+        }
+        task->loadedCount = -1;
+
+        loaded.swap(task->loadedPages);
+
+        currentGeneration = task->generation;
+        pending = task->countRequested || !task->pendingPages.isEmpty();
+    }
+
+    if (flags & Cancelled) {
+        typedef QList<LoadedPage>::const_iterator iterator;
+        for (iterator it = loaded.constBegin(), end = loaded.constEnd(); it != end; ++it)
+            delete it->page;
+
+        return;
+    }
+
+    if (count >= 0) {
+        setRowCount(count);
+
+        if (flags & Active) {
+            flags &= ~Active;
+
+            Q_EMIT q_func()->progressChanged(1, 1);
+
+            if (error != QDocumentGallery::NoError)
+                q_func()->error(error, errorString);
+            else
+                q_func()->finish(flags & Live);
+        }
+    }
+
+    typedef QList<LoadedPage>::const_iterator iterator;
+    for (iterator it = loaded.constBegin(), end = loaded.constEnd(); it != end; ++it) {
+        if (it->generation != currentGeneration) {
+            // The page has been requested again since, a fresh copy is on its way.
+            delete it->page;
+        } else if (!it->page) {
+            requestedPages.remove(it->index);
+        } else {
+            requestedPages.remove(it->index);
+
+            insertPage(it->index, it->page);
+        }
+    }
+
+    if (!loaded.isEmpty())
+        evictPages();
+
+    if (pending)
+        startLoading();
+}
+
+void QGalleryTrackerPagedResultSetPrivate::setRowCount(int count)
+{
+    if (count > rowCount) {
+        const int index = rowCount;
+
+        rowCount = count;
+
+        Q_EMIT q_func()->itemsInserted(index, count - index);
+    } else if (count < rowCount) {
+        const int removedCount = rowCount - count;
+
+        rowCount = count;
+
+        for (QHash<int, Page *>::iterator it = pages.begin(); it != pages.end();) {
+            if (it.key() * pageSize >= count) {
+                delete it.value();
+
+                it = pages.erase(it);
+            } else {
+                ++it;
+            }
+        }
+
+        const bool itemChanged = currentIndex >= count;
+
+        if (itemChanged)
+            currentRow = QGalleryTrackerRow();
+
+        Q_EMIT q_func()->itemsRemoved(count, removedCount);
+
+        if (itemChanged)
+            Q_EMIT q_func()->currentItemChanged();
+    }
+}
+
+void QGalleryTrackerPagedResultSetPrivate::insertPage(int index, Page *page)
+{
+    const int first = index * pageSize;
+
+    if (first >= rowCount) {
+        delete page;
+
+        return;
+    }
+
+    page->lastUsed = ++useCount;
+
+    delete pages.value(index);
+    pages.insert(index, page);
+
+    const int count = qMin(page->values.rowCount(), rowCount - first);
+
+    const bool itemChanged = currentIndex >= first && currentIndex < first + pageSize;
+
+    if (itemChanged)
+        updateCurrentRow();
+
+    if (count > 0)
+        Q_EMIT q_func()->metaDataChanged(first, count, propertyKeys);
+
+    if (itemChanged)
+        Q_EMIT q_func()->currentItemChanged();
+}
+
+void QGalleryTrackerPagedResultSetPrivate::evictPages()
+{
+    int memoryUsage = 0;
+
+    typedef QHash<int, Page *>::iterator iterator;
+    for (iterator it = pages.begin(), end = pages.end(); it != end; ++it)
+        memoryUsage += it.value()->memoryUsage;
+
+    const int currentPage = currentIndex >= 0 ? currentIndex / pageSize : -1;
+
+    while (memoryUsage > MemoryBudget && pages.count() > MinimumResidentPages) {
+        iterator oldest = pages.end();
+
+        for (iterator it = pages.begin(), end = pages.end(); it != end; ++it) {
+            if (it.key() != currentPage
+                    && (oldest == pages.end() || it.value()->lastUsed < oldest.value()->lastUsed)) {
+                oldest = it;
+            }
+        }
+
+        if (oldest == pages.end())
+            break;
+
+        memoryUsage -= oldest.value()->memoryUsage;
+
+        delete oldest.value();
+        pages.erase(oldest);
+    }
+}
+
+/*
+    Reading a row which isn't resident requests its page, a metaDataChanged() signal follows
+    once it's loaded.
+*/
+
+QGalleryTrackerRow QGalleryTrackerPagedResultSetPrivate::rowAt(int index) const
+{
+    if (index < 0 || index >= rowCount)
+        return QGalleryTrackerRow();
+
+    const int pageIndex = index / pageSize;
+
+    if (Page *page = pages.value(pageIndex)) {
+        const int row = index - (pageIndex * pageSize);
+
+        page->lastUsed = ++useCount;
+
+        if (row < page->values.rowCount())
+            return QGalleryTrackerRow(&page->values, row);
+    } else {
+        const_cast<QGalleryTrackerPagedResultSetPrivate *>(this)->requestPage(pageIndex);
+    }
+    return QGalleryTrackerRow();
+}
+
+QVariant QGalleryTrackerPagedResultSetPrivate::value(const QGalleryTrackerRow &row, int key) const
+{
+    if (row.isNull() || key < valueOffset) {
+        return QVariant();
+    } else if (key < compositeOffset) {  // Value column.
+        return row.value(key);
+    } else if (key < aliasOffset) {      // Composite column.
+        return compositeColumns.at(key - compositeOffset)->value(row);
+    } else if (key < columnCount) {      // Alias column.
+        return row.value(aliasColumns.at(key - aliasOffset) + valueOffset);
+    } else {
+        return QVariant();
+    }
+}
+
+QVariant QGalleryTrackerPagedResultSetPrivate::itemIdAt(int index) const
+{
+    const QGalleryTrackerRow row = rowAt(index);
+
+    return !row.isNull() ? idColumn->value(row) : QVariant();
+}
+
+QUrl QGalleryTrackerPagedResultSetPrivate::itemUrlAt(int index) const
+{
+    const QGalleryTrackerRow row = rowAt(index);
+
+    return !row.isNull() ? urlColumn->value(row).toUrl() : QUrl();
+}
+
+QString QGalleryTrackerPagedResultSetPrivate::itemTypeAt(int index) const
+{
+    const QGalleryTrackerRow row = rowAt(index);
+
+    return !row.isNull() ? typeColumn->value(row).toString() : QString();
+}
+
+QVariant QGalleryTrackerPagedResultSetPrivate::metaDataAt(int index, int key) const
+{
+    return value(rowAt(index), key);
+}
+
+/*
+    Rows in pages which aren't resident are left null and their pages requested, in the same way
+    as reading them one at a time.
+*/
+
+void QGalleryTrackerPagedResultSetPrivate::readRows(
+        int first, int count, const QVector<int> &keys, QGalleryRowBuffer *buffer) const
+{
+    QVector<int> columns;
+    QVector<QGalleryRowBuffer::ColumnType> types;
+    columns.reserve(keys.count());
+    types.reserve(keys.count());
+
+    typedef QVector<int>::const_iterator iterator;
+    for (iterator it = keys.constBegin(), end = keys.constEnd(); it != end; ++it) {
+        int column = -1;
+
+        if (*it >= valueOffset && *it < compositeOffset)
+            column = *it;
+        else if (*it >= aliasOffset && *it < columnCount)
+            column = aliasColumns.at(*it - aliasOffset) + valueOffset;
+
+        columns.append(column);
+        types.append(column != -1
+                ? QGalleryTrackerTable::bufferType(task->columnTypes.at(column))
+                : bufferType(propertyTypes.value(*it - valueOffset)));
+    }
+
+    buffer->reset(count, types);
+
+    for (int index = first; index < first + count;) {
+        const int pageIndex = index / pageSize;
+        const int pageEnd = qMin((pageIndex + 1) * pageSize, first + count);
+
+        if (Page *page = pages.value(pageIndex)) {
+            const QGalleryTrackerTable &table = page->values;
+            const int row = index - (pageIndex * pageSize);
+            const int available = qMin(pageEnd - index, table.rowCount() - row);
+
+            page->lastUsed = ++useCount;
+
+            for (int i = 0; i < keys.count() && available > 0; ++i) {
+                const int key = keys.at(i);
+
+                if (columns.at(i) != -1) {
+                    table.read(row, available, columns.at(i), buffer, index - first, i);
+                } else if (key >= compositeOffset && key < aliasOffset) {
+                    const QGalleryTrackerCompositeColumn *column
+                            = compositeColumns.at(key - compositeOffset);
+
+                    for (int j = 0; j < available; ++j) {
+                        buffer->setValue(
+                                index - first + j,
+                                i,
+                                column->value(QGalleryTrackerRow(&table, row + j)));
+                    }
+                }
+            }
+        } else {
+            const_cast<QGalleryTrackerPagedResultSetPrivate *>(this)->requestPage(pageIndex);
+        }
+        index = pageEnd;
+    }
+}
+
+void QGalleryTrackerPagedResultSetPrivate::updateCurrentRow()
+{
+    currentRow = rowAt(currentIndex);
+}
+
+QGalleryTrackerPagedResultSet::QGalleryTrackerPagedResultSet(
+        TrackerSparqlConnection *connection,
+        QGalleryTrackerResultSetArguments *arguments,
+        int pageSize,
+        bool autoUpdate,
+        QObject *parent)
+    : QGalleryResultSet(*new QGalleryTrackerPagedResultSetPrivate(
+            connection, arguments, pageSize, autoUpdate), parent)
+{
+    Q_D(QGalleryTrackerPagedResultSet);
+
+    d->task->receiver = this;
+
+    d->update();
+
+    // Load the first page along with the count so there is something to show straight away.
+    d->requestPage(0);
+}
+
+QGalleryTrackerPagedResultSet::~QGalleryTrackerPagedResultSet()
+{
+    Q_D(QGalleryTrackerPagedResultSet);
+
+    d->updateTimer.stop();
+
+    // Rather than wait for pages that are loading cut them off from the result set, the private
+    // data hands them over to the scheduler to delete once they're done.
+    {
+        QMutexLocker locker(&d->task->mutex);
+
+        d->task->receiver = 0;
+    }
+
+    g_cancellable_cancel(d->task->cancellable);
+}
+
+void QGalleryTrackerPagedResultSet::setConnection(
+        TrackerSparqlConnection *connection,
+        const QSharedPointer<QGalleryTrackerStatementCache> &statements)
+{
+    Q_D(QGalleryTrackerPagedResultSet);
+
+    if (d->task->connection || (d->flags & QGalleryTrackerPagedResultSetPrivate::Cancelled))
+        return;
+
+    if (!connection) {
+        d->flags &= ~(QGalleryTrackerPagedResultSetPrivate::Live
+                | QGalleryTrackerPagedResultSetPrivate::Active);
+
+        error(QDocumentGallery::ConnectionError);
+    } else {
+        d->task->connection = connection;
+        d->task->statements = statements
+                ? statements
+                : QSharedPointer<QGalleryTrackerStatementCache>(
+                        new QGalleryTrackerStatementCache(connection));
+
+        g_object_ref(G_OBJECT(connection));
+
+        d->startLoading();
+    }
+}
+
+QGalleryTrackerRefreshPolicy::Statistics QGalleryTrackerPagedResultSet::refreshStatistics() const
+{
+    return d_func()->refreshPolicy.statistics();
+}
+
+QStringList QGalleryTrackerPagedResultSet::propertyNames() const
+{
+    return d_func()->propertyNames;
+}
+
+int QGalleryTrackerPagedResultSet::propertyKey(const QString &property) const
+{
+    Q_D(const QGalleryTrackerPagedResultSet);
+
+    int index = d->propertyNames.indexOf(property);
+
+    return index >= 0
+            ? index + d->valueOffset
+            : -1;
+}
+
+QGalleryProperty::Attributes QGalleryTrackerPagedResultSet::propertyAttributes(int key) const
+{
+    return d_func()->propertyAttributes.value(key - d_func()->valueOffset);
+}
+
+QVariant::Type QGalleryTrackerPagedResultSet::propertyType(int key) const
+{
+    return d_func()->propertyTypes.value(key - d_func()->valueOffset);
+}
+
+int QGalleryTrackerPagedResultSet::itemCount() const
+{
+    return d_func()->rowCount;
+}
+
+int QGalleryTrackerPagedResultSet::currentIndex() const
+{
+    return d_func()->currentIndex;
+}
+
+bool QGalleryTrackerPagedResultSet::fetch(int index)
+{
+    Q_D(QGalleryTrackerPagedResultSet);
+
+    d->currentIndex = index;
+
+    d->updateCurrentRow();
+
+    Q_EMIT currentIndexChanged(d->currentIndex);
+    Q_EMIT currentItemChanged();
+
+    return d->currentIndex >= 0 && d->currentIndex < d->rowCount;
+}
+
+QVariant QGalleryTrackerPagedResultSet::itemId() const
+{
+    Q_D(const QGalleryTrackerPagedResultSet);
+
+    return !d->currentRow.isNull()
+            ? d->idColumn->value(d->currentRow)
+            : QVariant();
+}
+
+QUrl QGalleryTrackerPagedResultSet::itemUrl() const
+{
+    Q_D(const QGalleryTrackerPagedResultSet);
+
+    return !d->currentRow.isNull()
+            ? d->urlColumn->value(d->currentRow).toUrl()
+            : QUrl();
+}
+
+QString QGalleryTrackerPagedResultSet::itemType() const
+{
+    Q_D(const QGalleryTrackerPagedResultSet);
+
+    return !d->currentRow.isNull()
+            ? d->typeColumn->value(d->currentRow).toString()
+            : QString();
+}
+
+QList<QGalleryResource> QGalleryTrackerPagedResultSet::resources() const
+{
+    Q_D(const QGalleryTrackerPagedResultSet);
+
+    QList<QGalleryResource> resources;
+
+    if (!d->currentRow.isNull()) {
+        const QUrl url = d->urlColumn->value(d->currentRow).toUrl();
+
+        if (!url.isEmpty()) {
+            QMap<int, QVariant> attributes;
+
+            typedef QVector<int>::const_iterator iterator;
+            for (iterator it = d->resourceKeys.begin(), end = d->resourceKeys.end();
+                    it != end;
+                    ++it) {
+                QVariant value = metaData(*it);
+
+                if (!value.isNull())
+                    attributes.insert(*it, value);
+            }
+
+            resources.append(QGalleryResource(url, attributes));
+        }
+    }
+    return resources;
+}
+
+QVariant QGalleryTrackerPagedResultSet::metaData(int key) const
+{
+    Q_D(const QGalleryTrackerPagedResultSet);
+
+    return d->value(d->currentRow, key);
+}
+
+bool QGalleryTrackerPagedResultSet::setMetaData(int, const QVariant &)
+{
+    return false;
+}
+
+void QGalleryTrackerPagedResultSet::cancel()
+{
+    Q_D(QGalleryTrackerPagedResultSet);
+
+    d->flags |= QGalleryTrackerPagedResultSetPrivate::Cancelled;
+    d->flags &= ~(QGalleryTrackerPagedResultSetPrivate::Live
+            | QGalleryTrackerPagedResultSetPrivate::Active);
+
+    d->updateTimer.stop();
+
+    g_cancellable_cancel(d->task->cancellable);
+
+    QGalleryAbstractResponse::cancel();
+}
+
+bool QGalleryTrackerPagedResultSet::waitForFinished(int msecs)
+{
+    Q_D(QGalleryTrackerPagedResultSet);
+
+    QTime timer;
+    timer.start();
+
+    while (d->flags & QGalleryTrackerPagedResultSetPrivate::Active) {
+        if (!d->task->wait(msecs))
+            return false;
+
+        d->processResults();
+
+        if (msecs >= 0 && (msecs -= timer.restart()) <= 0)
+            return !(d->flags & QGalleryTrackerPagedResultSetPrivate::Active);
+    }
+    return true;
+}
+
+bool QGalleryTrackerPagedResultSet::event(QEvent *event)
+{
+    switch (event->type()) {
+    case QEvent::UpdateLater:
+        d_func()->processResults();
+
+        return true;
+    default:
+        return QGalleryAbstractResponse::event(event);
+    }
+}
+
+void QGalleryTrackerPagedResultSet::timerEvent(QTimerEvent *event)
+{
+    if (event->timerId() == d_func()->updateTimer.timerId()) {
+        d_func()->update();
+
+        event->accept();
+    }
+}
+
+void QGalleryTrackerPagedResultSet::refresh(const QList<int> &serviceIds)
+{
+    Q_D(QGalleryTrackerPagedResultSet);
+
+    if (!(d->flags & QGalleryTrackerPagedResultSetPrivate::Live))
+        return;
+
+    for (int id : serviceIds) {
+        if (d->updateMask & id) {
+            const bool pending = d->updateTimer.isActive()
+                    || (d->flags & QGalleryTrackerPagedResultSetPrivate::Refresh);
+            const int delay = d->refreshPolicy.changed(d->refreshClock.elapsed(), pending);
+
+            if (d->suspended)
+                d->flags |= QGalleryTrackerPagedResultSetPrivate::Refresh;
+            else if (!d->updateTimer.isActive())
+                d->updateTimer.start(delay, this);
+            break;
+        }
+    }
+}
+
+QT_END_NAMESPACE_DOCGALLERY
+
+#include "moc_qgallerytrackerpagedresultset_p.cpp"
@@ -0,0 +1,158 @@
+/****************************************************************************
+**
+** Copyright (C) 2012 Digia Plc and/or its subsidiary(-ies).
+** Contact: http://www.qt-project.org/legal
+**
+** This file is part of the QtDocGallery module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and Digia.  For licensing terms and
+** conditions see http://qt.digia.com/licensing.  For further information
+** use the contact form at http://qt.digia.com/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU Lesser General Public License version 2.1 requirements
+** will be met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** In addition, as a special exception, Digia gives you certain additional
+** rights.  These rights are described in the Digia Qt LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3.0 as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU General Public License version 3.0 requirements will be
+** met: http://www.gnu.org/copyleft/gpl.html.
+**
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "qgallerytrackerqueryplancache_p.h"
+
+#include "qgallerytrackerresultset_p.h"
+
+QT_BEGIN_NAMESPACE_DOCGALLERY
+
+uint qHash(const QGalleryTrackerQueryPlanKey &key, uint seed)
+{
+    return qHash(key.filter, seed)
+            ^ qHash(key.join, seed)
+            ^ qHash(key.propertyNames.join(QLatin1Char(',')), seed)
+            ^ qHash(key.sortPropertyNames.join(QLatin1Char(',')), seed)
+            ^ uint(key.itemIndex << 16)
+            ^ uint(key.offset)
+            ^ uint(key.limit << 8);
+}
+
+QGalleryTrackerQueryPlanCache::QGalleryTrackerQueryPlanCache()
+    : m_plans(MaximumPlans)
+    , m_hits(0)
+    , m_misses(0)
+{
+}
+
+QGalleryTrackerQueryPlanCache::~QGalleryTrackerQueryPlanCache()
+{
+}
+
+bool QGalleryTrackerQueryPlanCache::restore(
+        const QGalleryTrackerQueryPlanKey &key, QGalleryTrackerResultSetArguments *arguments)
+{
+    if (const QGalleryTrackerResultSetArguments *plan = m_plans.object(key)) {
+        ++m_hits;
+
+        copy(arguments, *plan);
+
+        return true;
+    } else {
+        ++m_misses;
+
+        return false;
+    }
+}
+
+void QGalleryTrackerQueryPlanCache::insert(
+        const QGalleryTrackerQueryPlanKey &key, const QGalleryTrackerResultSetArguments &arguments)
+{
+    QGalleryTrackerResultSetArguments *plan = new QGalleryTrackerResultSetArguments;
+
+    copy(plan, arguments);
+
+    m_plans.insert(key, plan);
+}
+
+void QGalleryTrackerQueryPlanCache::clear()
+{
+    m_plans.clear();
+}
+
+int QGalleryTrackerQueryPlanCache::count() const
+{
+    return m_plans.count();
+}
+
+int QGalleryTrackerQueryPlanCache::hits() const
+{
+    return m_hits;
+}
+
+int QGalleryTrackerQueryPlanCache::misses() const
+{
+    return m_misses;
+}
+
+void QGalleryTrackerQueryPlanCache::copy(
+        QGalleryTrackerResultSetArguments *target, const QGalleryTrackerResultSetArguments &source)
+{
+    // Only the parts derived from the plan key are copied, the filter parameters, priority and
+    // connection state belong to the individual request.
+    target->idColumn.reset(source.idColumn ? source.idColumn->clone() : 0);
+    target->urlColumn.reset(source.urlColumn ? source.urlColumn->clone() : 0);
+    target->typeColumn.reset(source.typeColumn ? source.typeColumn->clone() : 0);
+    target->updateMask = source.updateMask;
+    target->identityWidth = source.identityWidth;
+    target->tableWidth = source.tableWidth;
+    target->valueOffset = source.valueOffset;
+    target->compositeOffset = source.compositeOffset;
+    target->offset = source.offset;
+    target->limit = source.limit;
+    target->sparql = source.sparql;
+    target->pageSparql = source.pageSparql;
+    target->countSparql = source.countSparql;
+    target->resourceSparql = source.resourceSparql;
+    target->resourceValuesIndex = source.resourceValuesIndex;
+    target->sortColumns = source.sortColumns;
+    target->propertyNames = source.propertyNames;
+    target->fieldNames = source.fieldNames;
+    target->propertyAttributes = source.propertyAttributes;
+    target->propertyTypes = source.propertyTypes;
+    target->aliasColumns = source.aliasColumns;
+    target->resourceKeys = source.resourceKeys;
+    target->service = source.service;
+
+    qDeleteAll(target->valueColumns);
+    target->valueColumns.clear();
+    target->valueColumns.reserve(source.valueColumns.count());
+    for (int i = 0, count = source.valueColumns.count(); i < count; ++i)
+        target->valueColumns.append(source.valueColumns.at(i)->clone());
+
+    qDeleteAll(target->compositeColumns);
+    target->compositeColumns.clear();
+    target->compositeColumns.reserve(source.compositeColumns.count());
+    for (int i = 0, count = source.compositeColumns.count(); i < count; ++i)
+        target->compositeColumns.append(source.compositeColumns.at(i)->clone());
+}
+
+QT_END_NAMESPACE_DOCGALLERY
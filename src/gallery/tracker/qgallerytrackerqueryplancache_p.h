@@ -0,0 +1,124 @@
+/****************************************************************************
+**
+** Copyright (C) 2012 Digia Plc and/or its subsidiary(-ies).
+** Contact: http://www.qt-project.org/legal
+**
+** This file is part of the QtDocGallery module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and Digia.  For licensing terms and
+** conditions see http://qt.digia.com/licensing.  For further information
+** use the contact form at http://qt.digia.com/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU Lesser General Public License version 2.1 requirements
+** will be met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** In addition, as a special exception, Digia gives you certain additional
+** rights.  These rights are described in the Digia Qt LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3.0 as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU General Public License version 3.0 requirements will be
+** met: http://www.gnu.org/copyleft/gpl.html.
+**
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#ifndef QGALLERYTRACKERQUERYPLANCACHE_P_H
+#define QGALLERYTRACKERQUERYPLANCACHE_P_H
+
+#include "qgalleryglobal.h"
+
+#include <QtCore/qcache.h>
+#include <QtCore/qstringlist.h>
+
+QT_BEGIN_NAMESPACE_DOCGALLERY
+
+struct QGalleryTrackerResultSetArguments;
+
+struct QGalleryTrackerQueryPlanKey
+{
+    QGalleryTrackerQueryPlanKey() : itemIndex(-1), offset(0), limit(0) {}
+
+    int itemIndex;
+    QString filter;
+    QString join;
+    QString optionalJoin;
+    QStringList propertyNames;
+    QStringList sortPropertyNames;
+    int offset;
+    int limit;
+
+    bool operator ==(const QGalleryTrackerQueryPlanKey &other) const
+    {
+        return itemIndex == other.itemIndex
+                && offset == other.offset
+                && limit == other.limit
+                && filter == other.filter
+                && join == other.join
+                && optionalJoin == other.optionalJoin
+                && propertyNames == other.propertyNames
+                && sortPropertyNames == other.sortPropertyNames;
+    }
+};
+
+uint qHash(const QGalleryTrackerQueryPlanKey &key, uint seed = 0);
+
+class Q_GALLERY_EXPORT QGalleryTrackerQueryPlanCache
+{
+public:
+    enum { MaximumPlans = 32 };
+
+    QGalleryTrackerQueryPlanCache();
+    ~QGalleryTrackerQueryPlanCache();
+
+    bool restore(
+            const QGalleryTrackerQueryPlanKey &key, QGalleryTrackerResultSetArguments *arguments);
+    void insert(
+            const QGalleryTrackerQueryPlanKey &key, const QGalleryTrackerResultSetArguments &arguments);
+
+    void clear();
+
+    int count() const;
+    int hits() const;
+    int misses() const;
+
+private:
+    static void copy(
+            QGalleryTrackerResultSetArguments *target,
+            const QGalleryTrackerResultSetArguments &source);
+
+    QCache<QGalleryTrackerQueryPlanKey, QGalleryTrackerResultSetArguments> m_plans;
+    int m_hits;
+    int m_misses;
+};
+
+QT_END_NAMESPACE_DOCGALLERY
+
+#endif
@@ -0,0 +1,183 @@
+/****************************************************************************
+**
+** Copyright (C) 2012 Digia Plc and/or its subsidiary(-ies).
+** Contact: http://www.qt-project.org/legal
+**
+** This file is part of the QtDocGallery module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and Digia.  For licensing terms and
+** conditions see http://qt.digia.com/licensing.  For further information
+** use the contact form at http://qt.digia.com/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU Lesser General Public License version 2.1 requirements
+** will be met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** In addition, as a special exception, Digia gives you certain additional
+** rights.  These rights are described in the Digia Qt LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3.0 as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU General Public License version 3.0 requirements will be
+** met: http://www.gnu.org/copyleft/gpl.html.
+**
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "qgallerytrackerrefreshpolicy_p.h"
+
+#include <QtCore/qbytearray.h>
+#include <QtCore/qmutex.h>
+
+QT_BEGIN_NAMESPACE_DOCGALLERY
+
+namespace {
+
+struct QGalleryTrackerRefreshSettings
+{
+    QGalleryTrackerRefreshSettings()
+    {
+        bool ok = false;
+
+        int value = qgetenv("QT_GALLERY_TRACKER_REFRESH_MIN_DELAY").toInt(&ok);
+        settings.minimumDelay = ok && value >= 0 ? value : 100;
+
+        value = qgetenv("QT_GALLERY_TRACKER_REFRESH_MAX_DELAY").toInt(&ok);
+        settings.maximumDelay = ok && value >= settings.minimumDelay
+                ? value
+                : qMax(settings.minimumDelay, 3200);
+
+        value = qgetenv("QT_GALLERY_TRACKER_REFRESH_MAX_RATE").toInt(&ok);
+        settings.maximumRate = ok && value >= 0 ? value : 2;
+    }
+
+    QMutex mutex;
+    QGalleryTrackerRefreshPolicy::Settings settings;
+};
+
+}
+
+Q_GLOBAL_STATIC(QGalleryTrackerRefreshSettings, qt_galleryTrackerRefreshSettings)
+
+/*
+    Decides how long a live result set waits after being told of a change before it queries
+    again.
+
+    The first change after a quiet period is picked up after the minimum delay.  While changes keep
+    arriving within the current delay of each other it doubles, up to the maximum delay, so a
+    result set refreshes less and less often through a long import instead of querying
+    back-to-back.  Independently of the delay no more than the maximum rate of refreshes is made
+    each second; a rate of 0 disables that limit.
+
+    The defaults can be set with the QT_GALLERY_TRACKER_REFRESH_MIN_DELAY,
+    QT_GALLERY_TRACKER_REFRESH_MAX_DELAY and QT_GALLERY_TRACKER_REFRESH_MAX_RATE environment
+    variables or setDefaultSettings().
+*/
+
+QGalleryTrackerRefreshPolicy::QGalleryTrackerRefreshPolicy()
+    : m_settings(defaultSettings())
+    , m_statistics()
+    , m_lastChange(-1)
+    , m_lastRefresh(-1)
+    , m_delay(m_settings.minimumDelay)
+{
+}
+
+QGalleryTrackerRefreshPolicy::QGalleryTrackerRefreshPolicy(const Settings &settings)
+    : m_settings(settings)
+    , m_statistics()
+    , m_lastChange(-1)
+    , m_lastRefresh(-1)
+    , m_delay(settings.minimumDelay)
+{
+}
+
+QGalleryTrackerRefreshPolicy::Settings QGalleryTrackerRefreshPolicy::defaultSettings()
+{
+    QGalleryTrackerRefreshSettings *defaults = qt_galleryTrackerRefreshSettings();
+
+    QMutexLocker locker(&defaults->mutex);
+
+    return defaults->settings;
+}
+
+void QGalleryTrackerRefreshPolicy::setDefaultSettings(const Settings &settings)
+{
+    QGalleryTrackerRefreshSettings *defaults = qt_galleryTrackerRefreshSettings();
+
+    QMutexLocker locker(&defaults->mutex);
+
+    defaults->settings = settings;
+}
+
+/*
+    Records a change at \a time, in milliseconds.  If \a pending is true a refresh is already
+    scheduled or running and the change will be picked up by it.
+
+    Returns the number of milliseconds to wait before refreshing.
+*/
+
+int QGalleryTrackerRefreshPolicy::changed(qint64 time, bool pending)
+{
+    m_statistics.changeCount += 1;
+
+    if (pending)
+        m_statistics.coalescedCount += 1;
+
+    // A minimum delay of 0 still backs off, from 1 millisecond, or it could never grow.
+    const int delay = qMax(1, m_delay);
+
+    if (m_lastChange >= 0 && time - m_lastChange < delay)
+        m_delay = qMin(delay * 2, m_settings.maximumDelay);
+    else
+        m_delay = m_settings.minimumDelay;
+
+    m_lastChange = time;
+
+    return nextDelay(time);
+}
+
+/*
+    Returns the number of milliseconds from \a time to wait before refreshing for changes that have
+    already been recorded.
+*/
+
+int QGalleryTrackerRefreshPolicy::nextDelay(qint64 time) const
+{
+    if (m_settings.maximumRate > 0 && m_lastRefresh >= 0) {
+        const qint64 next = m_lastRefresh + 1000 / m_settings.maximumRate;
+
+        return qMax<qint64>(m_delay, next - time);
+    } else {
+        return m_delay;
+    }
+}
+
+void QGalleryTrackerRefreshPolicy::refreshed(qint64 time)
+{
+    m_statistics.refreshCount += 1;
+
+    m_lastRefresh = time;
+}
+
+void QGalleryTrackerRefreshPolicy::resetStatistics()
+{
+    m_statistics = Statistics();
+}
+
+QT_END_NAMESPACE_DOCGALLERY
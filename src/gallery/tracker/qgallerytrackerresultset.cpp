@@ -44,8 +44,11 @@
 #include "qgallerytrackerresultset_p_p.h"
 
 #include "qgallerytrackermetadataedit_p.h"
+#include "qgallerytrackerrowdiff_p.h"
 
 #include <QtCore/qdatetime.h>
+#include <QtCore/qelapsedtimer.h>
+#include <QtCore/qset.h>
 #include <QtDBus/qdbusreply.h>
 
 #include <qdocumentgallery.h>
@@ -53,16 +56,185 @@
 
 QT_BEGIN_NAMESPACE_DOCGALLERY
 
-void QGalleryTrackerResultSetPrivate::update()
+QGalleryTrackerResultSetTask::QGalleryTrackerResultSetTask(
+        TrackerSparqlConnection *connection, QGalleryTrackerResultSetArguments *arguments)
+    : connection(connection)
+    , statements(arguments->statements || !connection
+            ? arguments->statements
+            : QSharedPointer<QGalleryTrackerStatementCache>(
+                    new QGalleryTrackerStatementCache(connection)))
+    , cancellable(g_cancellable_new())
+    , identityWidth(arguments->identityWidth)
+    , tableWidth(arguments->tableWidth)
+    , queryError(QDocumentGallery::NoError)
+    , sparql(arguments->sparql)
+    , resourceSparql(arguments->resourceSparql)
+    , parameters(arguments->parameters)
+    , resourceValuesIndex(arguments->resourceValuesIndex)
+    , sortColumns(arguments->sortColumns)
+    , valueColumns(arguments->valueColumns)
+    , streaming(false)
+    , m_receiver(0)
+{
+    if (connection)
+        g_object_ref(G_OBJECT(connection));
+
+    typedef QVector<QGalleryTrackerValueColumn *>::const_iterator iterator;
+    for (iterator it = valueColumns.begin(), end = valueColumns.end(); it != end; ++it)
+        columnTypes.append((*it)->type());
+
+    rCache.values.setColumnTypes(columnTypes);
+    iCache.values.setColumnTypes(columnTypes);
+    streamValues.setColumnTypes(columnTypes);
+}
+
+QGalleryTrackerResultSetTask::~QGalleryTrackerResultSetTask()
+{
+    qDeleteAll(valueColumns);
+
+    g_object_unref(G_OBJECT(cancellable));
+
+    if (connection)
+        g_object_unref(G_OBJECT(connection));
+}
+
+/*
+    Sets the object finished queries and sync events are reported to, once cleared nothing the
+    task does can reach the result set.
+*/
+
+void QGalleryTrackerResultSetTask::setReceiver(QObject *receiver)
+{
+    QMutexLocker locker(&m_receiverMutex);
+
+    m_receiver = receiver;
+
+    syncEvents.setReceiver(receiver);
+}
+
+QGalleryTrackerResultSetPrivate::~QGalleryTrackerResultSetPrivate()
 {
-    flags &= ~UpdateRequested;
+    qDeleteAll(compositeColumns);
+
+    // Leave a query that's still running for the scheduler to delete once it's done.
+    if (!task->orphan())
+        delete task;
+}
+
+QVariant QGalleryTrackerResultSetPrivate::value(const QGalleryTrackerRow &row, int key) const
+{
+    if (row.isNull() || key < valueOffset) {
+        return QVariant();
+    } else if (key < compositeOffset) {  // Value column.
+        return row.value(key);
+    } else if (key < aliasOffset) {      // Composite column.
+        return compositeColumns.at(key - compositeOffset)->value(row);
+    } else if (key < columnCount) {      // Alias column.
+        return row.value(aliasColumns.at(key - aliasOffset) + valueOffset);
+    } else {
+        return QVariant();
+    }
+}
+
+QList<QGalleryResource> QGalleryTrackerResultSetPrivate::resources(
+        const QGalleryTrackerRow &row) const
+{
+    QList<QGalleryResource> resources;
+
+    if (!row.isNull()) {
+        const QUrl url = urlColumn->value(row).toUrl();
+
+        if (!url.isEmpty()) {
+            QMap<int, QVariant> attributes;
+
+            typedef QVector<int>::const_iterator iterator;
+            for (iterator it = resourceKeys.begin(), end = resourceKeys.end(); it != end; ++it) {
+                QVariant value = this->value(row, *it);
+
+                if (!value.isNull())
+                    attributes.insert(*it, value);
+            }
 
+            resources.append(QGalleryResource(url, attributes));
+        }
+    }
+    return resources;
+}
+
+/*
+    Value and alias columns are copied straight out of the caches a column at a time, only
+    composite columns have to be computed row by row.
+*/
+
+void QGalleryTrackerResultSetPrivate::readRows(
+        int first, int count, const QVector<int> &keys, QGalleryRowBuffer *buffer) const
+{
+    QVector<int> columns;
+    QVector<QGalleryRowBuffer::ColumnType> types;
+    columns.reserve(keys.count());
+    types.reserve(keys.count());
+
+    typedef QVector<int>::const_iterator iterator;
+    for (iterator it = keys.constBegin(), end = keys.constEnd(); it != end; ++it) {
+        int column = -1;
+
+        if (*it >= valueOffset && *it < compositeOffset)
+            column = *it;
+        else if (*it >= aliasOffset && *it < columnCount)
+            column = aliasColumns.at(*it - aliasOffset) + valueOffset;
+
+        columns.append(column);
+        types.append(column != -1
+                ? QGalleryTrackerTable::bufferType(task->columnTypes.at(column))
+                : bufferType(propertyTypes.value(*it - valueOffset)));
+    }
+
+    buffer->reset(count, types);
+
+    const int cutoff = qBound(first, iCache.cutoff, first + count);
+
+    readRows(iCache.values, first, cutoff - first, keys, columns, buffer, 0);
+    readRows(
+            rCache.values,
+            cutoff + rCache.offset - iCache.cutoff,
+            first + count - cutoff,
+            keys,
+            columns,
+            buffer,
+            cutoff - first);
+}
+
+void QGalleryTrackerResultSetPrivate::readRows(
+        const QGalleryTrackerTable &table,
+        int index,
+        int count,
+        const QVector<int> &keys,
+        const QVector<int> &columns,
+        QGalleryRowBuffer *buffer,
+        int row) const
+{
+    if (count <= 0)
+        return;
+
+    for (int i = 0; i < keys.count(); ++i) {
+        const int key = keys.at(i);
+
+        if (columns.at(i) != -1) {
+            table.read(index, count, columns.at(i), buffer, row, i);
+        } else if (key >= compositeOffset && key < aliasOffset) {
+            const QGalleryTrackerCompositeColumn *column = compositeColumns.at(key - compositeOffset);
+
+            for (int j = 0; j < count; ++j)
+                buffer->setValue(row + j, i, column->value(QGalleryTrackerRow(&table, index + j)));
+        }
+    }
+}
+
+void QGalleryTrackerResultSetPrivate::update()
+{
     updateTimer.stop();
 
-    typedef QList<QGalleryTrackerMetaDataEdit *>::iterator iterator;
-    for (iterator it = edits.begin(), end = edits.end(); it != end; ++it)
-        (*it)->commit();
-    edits.clear();
+    commitEdits();
 
     if (!(flags & (Active | Cancelled))) {
         query();
@@ -71,9 +243,32 @@ void QGalleryTrackerResultSetPrivate::update()
     }
 }
 
+void QGalleryTrackerResultSetPrivate::suspendedChanged()
+{
+    if (suspended) {
+        updateTimer.stop();
+    } else if ((flags & Refresh) && !(flags & Active)) {
+        // Everything that changed while suspended is caught up on with a single refresh.
+        updateTimer.start(0, q_func());
+    }
+}
+
 void QGalleryTrackerResultSetPrivate::query()
 {
-    flags &= ~(Refresh | SyncFinished);
+    task->resourceChanges.clear();
+
+    // A handful of changed resources can be re-read on their own rather than re-running the
+    // whole query.
+    if (!(flags & RefreshAll)
+            && iCache.count > 0
+            && task->resourceValuesIndex >= 0
+            && !pendingChanges.isEmpty()
+            && pendingChanges.count() <= MaximumResourceChanges) {
+        task->resourceChanges.swap(pendingChanges);
+    }
+    pendingChanges.clear();
+
+    flags &= ~(Refresh | RefreshAll | SyncFinished);
     flags |= Active;
 
     updateTimer.stop();
@@ -84,180 +279,444 @@ void QGalleryTrackerResultSetPrivate::query()
     iCache.count = 0;
     iCache.cutoff = 0;
 
-    qSwap(rCache.values, iCache.values);
+    rCache.values.swap(iCache.values);
+
+    if (currentIndex >= 0 && currentIndex < rowCount)
+        currentRow = QGalleryTrackerRow(&rCache.values, currentIndex);
 
-    parserThread.start(QThread::LowPriority);
+    // With nothing to compare against rows can be handed to the model as they are read.
+    task->streaming = rCache.count == 0;
 
-    Q_EMIT q_func()->progressChanged(progressMaximum - 1, progressMaximum);
+    // The number of rows isn't known until the cursor is exhausted, so progress is indeterminate
+    // until the query finishes.
+    progressMaximum = 0;
+
+    refreshPolicy.refreshed(refreshClock.elapsed());
+
+    // Refreshes of a result that is already populated can yield to first loads.
+    QGalleryTrackerScheduler::instance()->start(
+            task, rCache.count > 0 ? QGalleryTrackerScheduler::LowPriority : priority);
+
+    Q_EMIT q_func()->progressChanged(0, progressMaximum);
 }
 
-void QGalleryTrackerResultSetPrivate::run()
+void QGalleryTrackerResultSetPrivate::commitEdits()
 {
-    iCache.values.clear();
+    flags &= ~CommitRequested;
+
+    if (edits.isEmpty())
+        return;
+
+    // All pending edits go to tracker as a single asynchronous update.  Their values are
+    // already in the cache, tracker's change notification confirms them.
+    QGalleryTrackerMetaDataBatch *batch = new QGalleryTrackerMetaDataBatch(
+            task->connection, q_func());
+
+    QObject::connect(batch, SIGNAL(finished(QGalleryTrackerMetaDataBatch*)),
+            q_func(), SLOT(_q_editFinished(QGalleryTrackerMetaDataBatch*)));
+
+    typedef QList<QGalleryTrackerMetaDataEdit *>::iterator iterator;
+    for (iterator it = edits.begin(), end = edits.end(); it != end; ++it)
+        batch->addEdit(*it);
+    edits.clear();
+
+    batches.append(batch);
+
+    batch->execute();
+}
+
+void QGalleryTrackerResultSetPrivate::applyEdit(
+        const QGalleryTrackerMetaDataEdit *edit, bool rollback)
+{
+    const int index = edit->index();
+
+    // The row is only written while no query is reading the cache.
+    if (index < 0 || index >= iCache.count || (flags & Active))
+        return;
+
+    if (iCache.values.value(index, 0).toString() != edit->service())
+        return;
+
+    const QMap<int, QVariant> values = rollback ? edit->originalValues() : edit->cachedValues();
+
+    QList<int> keys;
+
+    for (QMap<int, QVariant>::const_iterator it = values.constBegin(); it != values.constEnd(); ++it) {
+        if (iCache.values.value(index, it.key()) == it.value())
+            continue;
+
+        iCache.values.setValue(index, it.key(), it.value());
+
+        keys.append(it.key());
+
+        for (int i = 0; i < aliasColumns.count(); ++i) {
+            if (aliasColumns.at(i) + valueOffset == it.key())
+                keys.append(aliasOffset + i);
+        }
+    }
+
+    if (!keys.isEmpty()) {
+        Q_EMIT q_func()->metaDataChanged(index, 1, keys);
+
+        if (index == currentIndex)
+            Q_EMIT q_func()->currentItemChanged();
+    }
+}
+
+void QGalleryTrackerResultSetPrivate::reapplyEdits()
+{
+    typedef QList<QGalleryTrackerMetaDataEdit *>::const_iterator iterator;
+
+    for (iterator it = edits.constBegin(), end = edits.constEnd(); it != end; ++it)
+        applyEdit(*it, false);
+
+    typedef QList<QGalleryTrackerMetaDataBatch *>::const_iterator batch_iterator;
+    for (batch_iterator batch = batches.constBegin(); batch != batches.constEnd(); ++batch) {
+        const QList<QGalleryTrackerMetaDataEdit *> batchEdits = (*batch)->edits();
+
+        for (iterator it = batchEdits.constBegin(), end = batchEdits.constEnd(); it != end; ++it)
+            applyEdit(*it, false);
+    }
+}
+
+void QGalleryTrackerResultSetPrivate::addChanges(const QGalleryTrackerResourceChangeList &changes)
+{
+    if (flags & RefreshAll)
+        return;
+
+    // Without a list of the resources that changed any row may have, and past a point it's
+    // cheaper to re-read everything than track each resource.
+    if (changes.isEmpty() || pendingChanges.count() + changes.count() > MaximumResourceChanges) {
+        pendingChanges.clear();
+
+        flags |= RefreshAll;
+
+        return;
+    }
+
+    typedef QGalleryTrackerResourceChangeList::const_iterator iterator;
+    for (iterator it = changes.constBegin(), end = changes.constEnd(); it != end; ++it) {
+        QHash<QByteArray, QGalleryTrackerResourceChange::Type>::iterator change
+                = pendingChanges.find(it->urn);
+
+        if (change == pendingChanges.end())
+            pendingChanges.insert(it->urn, it->type);
+        else if (it->type != QGalleryTrackerResourceChange::Updated
+                || *change != QGalleryTrackerResourceChange::Created)
+            *change = it->type;
+    }
+}
+
+void QGalleryTrackerResultSetTask::run()
+{
+    if (!resourceChanges.isEmpty() && refreshResources())
+        return;
+
+    QGalleryTrackerTable streamBatch(columnTypes);
+    QGalleryTrackerTable &values = streaming ? streamBatch : iCache.values;
+
+    values.clear();
+
+    QElapsedTimer batchTimer;
+    batchTimer.start();
+
+    int rowsRead = 0;
 
     GError *error = 0;
-    if (TrackerSparqlCursor *cursor = tracker_sparql_connection_query(
-                connection, sparql.toUtf8(), 0, &error)) {
-        const QVariant variant;
-        while (tracker_sparql_cursor_next(cursor, 0, 0)) {
+    if (TrackerSparqlCursor *cursor = statements->query(sparql, parameters, cancellable, &error)) {
+        while (tracker_sparql_cursor_next(cursor, cancellable, 0)) {
             const int rowWidth = qMin(tableWidth, tracker_sparql_cursor_get_n_columns(cursor));
             int i = 0;
             for (; i < rowWidth; ++i) {
-                iCache.values.append(valueColumns.at(i)->toVariant(cursor, i));
+                valueColumns.at(i)->appendValue(cursor, i, values.column(i));
             }
             for (; i < tableWidth; ++i)
-                iCache.values.append(variant);
+                values.column(i)->appendNull();
+
+            ++rowsRead;
+
+            if (streaming
+                    && (values.rowCount() >= StreamBatchSize
+                        || batchTimer.elapsed() >= StreamBatchInterval)) {
+                postStreamValues(&values);
+
+                batchTimer.restart();
+            }
         }
         g_object_unref(G_OBJECT(cursor));
     } else {
-        queryError = QDocumentGallery::FilterError;
-        queryErrorString = QString::fromUtf8(error->message);
+        if (!g_error_matches(error, G_IO_ERROR, G_IO_ERROR_CANCELLED)) {
+            queryError = QDocumentGallery::FilterError;
+            queryErrorString = QString::fromUtf8(error->message);
+        }
         g_error_free(error);
     }
 
-    iCache.count = iCache.values.count() / tableWidth;
+    const bool cancelled = g_cancellable_is_cancelled(cancellable);
+
+    if (streaming) {
+        if (cancelled)
+            rowsRead -= values.rowCount();
+        else if (values.rowCount() > 0)
+            postStreamValues(&values);
+
+        postSyncEvent(SyncEvent::finishEvent(0, rowsRead));
+    } else if (cancelled) {
+        // Nothing has been handed to the model yet, restore the previous rows and leave it as is.
+        iCache.values.clear();
+        iCache.values.append(rCache.values);
+        iCache.count = rCache.count;
+
+        postSyncEvent(SyncEvent::finishEvent(rCache.count, iCache.count));
+    } else {
+        iCache.count = values.rowCount();
+
+        synchronize();
+    }
+}
+
+void QGalleryTrackerResultSetTask::taskFinished()
+{
+    QMutexLocker locker(&m_receiverMutex);
 
-    synchronize();
+    if (m_receiver)
+        QMetaObject::invokeMethod(m_receiver, "_q_parseFinished", Qt::QueuedConnection);
 }
 
-void QGalleryTrackerResultSetPrivate::synchronize()
+bool QGalleryTrackerResultSetTask::refreshResources()
 {
-    const const_row_iterator rEnd(rCache.values.constEnd(), tableWidth);
-    const const_row_iterator iEnd(iCache.values.constEnd(), tableWidth);
+    typedef QHash<QByteArray, QGalleryTrackerResourceChange::Type>::const_iterator change_iterator;
 
-    const_row_iterator rBegin(rCache.values.constBegin(), tableWidth);
-    const_row_iterator iBegin(iCache.values.constBegin(), tableWidth);
+    QString valueList;
+    for (change_iterator it = resourceChanges.constBegin(); it != resourceChanges.constEnd(); ++it) {
+        if (it.key().contains('>') || it.key().contains(' '))
+            return false;
 
-    const int rStep = qMax(64, rEnd - rBegin) / 16;
-    const int iStep = qMax(64, iEnd - iBegin) / 16;
+        if (it.value() != QGalleryTrackerResourceChange::Deleted)
+            valueList += QLatin1String(" <") + QString::fromUtf8(it.key()) + QLatin1Char('>');
+    }
 
-    for (bool equal = true; equal && rBegin != rEnd && iBegin != iEnd; ) {
-        bool changed = false;
+    QGalleryTrackerTable rows(columnTypes);
 
-        do {    // Skip over identical rows.
-            if ((equal = rBegin.isEqual(iBegin, identityWidth))
-                    && !(changed = !rBegin.isEqual(iBegin, identityWidth, tableWidth))) {
-                ++rBegin;
-                ++iBegin;
-            } else {
-                break;
-            }
-        } while (rBegin != rEnd && iBegin != iEnd);
+    if (!valueList.isEmpty()) {
+        QString resourceQuery = resourceSparql;
+        resourceQuery.insert(
+                resourceValuesIndex, QLatin1String(" VALUES ?x {") + valueList + QLatin1String(" }"));
 
-        if (changed) {
-            const_row_iterator rIt = rBegin;
-            const_row_iterator iIt = iBegin;
+        GError *error = 0;
+        TrackerSparqlCursor *cursor = statements->queryOnce(
+                resourceQuery, parameters, cancellable, &error);
 
-            do {    // Skip over rows with equal IDs but different values.
-                if ((equal = rIt.isEqual(iIt, identityWidth))
-                        && rIt.isEqual(iIt, identityWidth, tableWidth)) {
-                    ++rIt;
-                    ++iIt;
-                } else {
-                    ++rIt;
-                    ++iIt;
+        // Leave errors and cancellation to be reported by the full query.
+        if (!cursor) {
+            g_error_free(error);
 
-                    break;
-                }
-            } while (rIt != rEnd && iIt != iEnd);
+            return false;
+        }
 
-            const int rIndex = rCacheIndex(rBegin);
-            const int iIndex = iCacheIndex(iBegin);
-            const int count = iIt - iBegin;
+        while (tracker_sparql_cursor_next(cursor, cancellable, 0)) {
+            const int rowWidth = qMin(tableWidth, tracker_sparql_cursor_get_n_columns(cursor));
+            int i = 0;
+            for (; i < rowWidth; ++i)
+                valueColumns.at(i)->appendValue(cursor, i, rows.column(i));
+            for (; i < tableWidth; ++i)
+                rows.column(i)->appendNull();
+        }
+        g_object_unref(G_OBJECT(cursor));
 
-            postSyncEvent(SyncEvent::updateEvent(rIndex, iIndex, count));
+        if (g_cancellable_is_cancelled(cancellable))
+            return false;
+    }
 
-            rBegin = rIt;
-            iBegin = iIt;
+    QHash<QByteArray, int> changedRows;
+    for (int row = 0; row < rows.rowCount(); ++row)
+        changedRows.insert(rows.identity(row, identityWidth), row);
 
+    // Find the rows the changed resources occupy, a row whose sort keys changed may have to move.
+    QVector<QPair<int, int> > matches;
+    QVector<bool> placed(rows.rowCount(), false);
+    QSet<QByteArray> cachedResources;
+
+    for (int rIndex = 0; rIndex < rCache.count && matches.count() < resourceChanges.count(); ++rIndex) {
+        const QByteArray identity = rCache.values.identity(rIndex, identityWidth);
+
+        if (!resourceChanges.contains(identity))
             continue;
-        } else if (equal) {
-            postSyncEvent(SyncEvent::finishEvent(rCacheIndex(rBegin), iCacheIndex(iBegin)));
 
-            return;
-        }
+        const int row = changedRows.value(identity, -1);
 
-        const_row_iterator rOuterEnd = rBegin + ((((rEnd - rBegin) + iStep - 1) / rStep) * rStep);
-        const_row_iterator iOuterEnd = iBegin + ((((iEnd - iBegin) + iStep - 1) / iStep) * iStep);
-
-        const_row_iterator rInnerEnd = qMin(rBegin + rStep * 2, rEnd);
-        const_row_iterator iInnerEnd = qMin(iBegin + iStep * 2, iEnd);
-
-        for (const_row_iterator rOuter = rBegin, iOuter = iBegin;
-                !equal && rOuter != rOuterEnd && iOuter != iOuterEnd;
-                rOuter += rStep, iOuter += iStep) {
-            for (const_row_iterator rInner = rBegin, iInner = iBegin;
-                    rInner != rInnerEnd && iInner != iInnerEnd;
-                    ++rInner, ++iInner) {
-                if ((equal = rInner.isEqual(iOuter, identityWidth))) {
-                    const_row_iterator rIt;
-                    const_row_iterator iIt;
-
-                    do {
-                        rIt = rInner;
-                        iIt = iOuter;
-                    } while (rInner-- != rBegin && iOuter-- != iBegin
-                             && rInner.isEqual(iOuter, identityWidth));
-
-                    const int rIndex = rCacheIndex(rOuter);
-                    const int iIndex = iCacheIndex(iBegin);
-                    const int rCount = rIt - rBegin;
-                    const int iCount = iIt - iBegin;
-
-                    postSyncEvent(SyncEvent::replaceEvent(rIndex, rCount, iIndex, iCount));
-
-                    rBegin = rIt;
-                    iBegin = iIt;
-
-                    break;
-                } else if ((equal = iInner.isEqual(rOuter, identityWidth))) {
-                    const_row_iterator rIt;
-                    const_row_iterator iIt;
-
-                    do {
-                        rIt = rOuter;
-                        iIt = iInner;
-                    } while (iInner-- != iBegin && rOuter-- != rBegin
-                           && iInner.isEqual(rOuter, identityWidth));
-
-                    const int rIndex = rCacheIndex(rBegin);
-                    const int iIndex = iCacheIndex(iOuter);
-                    const int rCount = rIt - rBegin;
-                    const int iCount = iIt - iBegin;
-
-                    postSyncEvent(SyncEvent::replaceEvent(rIndex, rCount, iIndex, iCount));
-
-                    rBegin = rIt;
-                    iBegin = iIt;
-
-                    break;
-                }
+        if (row >= 0) {
+            for (QVector<int>::const_iterator it = sortColumns.constBegin(); it != sortColumns.constEnd(); ++it) {
+                if (!rCache.values.column(*it)->isEqual(rIndex, rows.column(*it), row))
+                    return false;
             }
+            placed[row] = true;
+        }
+        matches.append(qMakePair(rIndex, row));
+        cachedResources.insert(identity);
+    }
+
+    // New rows can only be placed at the end of an unsorted result, and an update to a resource
+    // that isn't a row, such as the artist of a track, may change any row.
+    for (change_iterator it = resourceChanges.constBegin(); it != resourceChanges.constEnd(); ++it) {
+        const int row = changedRows.value(it.key(), -1);
+
+        if (row >= 0 && !placed.at(row)) {
+            if (!sortColumns.isEmpty())
+                return false;
+        } else if (row < 0
+                && it.value() == QGalleryTrackerResourceChange::Updated
+                && !cachedResources.contains(it.key())) {
+            return false;
+        }
+    }
+
+    QVector<SyncEvent> events;
+
+    iCache.values.clear();
+
+    int rIndex = 0;
+    for (QVector<QPair<int, int> >::const_iterator it = matches.constBegin(); it != matches.constEnd(); ++it) {
+        iCache.values.append(rCache.values, rIndex, it->first - rIndex);
+
+        const int iIndex = iCache.values.rowCount();
+
+        if (it->second < 0) {
+            events.append(SyncEvent::replaceEvent(it->first, 1, iIndex, 0));
+        } else if (!rCache.values.isEqual(it->first, rows, it->second, identityWidth, tableWidth)) {
+            iCache.values.append(rows, it->second, 1);
+
+            events.append(SyncEvent::updateEvent(it->first, iIndex, 1));
+        } else {
+            iCache.values.append(rCache.values, it->first, 1);
         }
+        rIndex = it->first + 1;
     }
+    iCache.values.append(rCache.values, rIndex, rCache.count - rIndex);
+
+    const int iIndex = iCache.values.rowCount();
 
-    postSyncEvent(SyncEvent::finishEvent(rCacheIndex(rBegin), iCacheIndex(iBegin)));
+    for (int row = 0; row < rows.rowCount(); ++row) {
+        if (!placed.at(row))
+            iCache.values.append(rows, row, 1);
+    }
+
+    iCache.count = iCache.values.rowCount();
+
+    events.append(SyncEvent::finishEvent(rCache.count, iIndex));
+
+    // Only hand out events once the table they refer to is complete.
+    for (QVector<SyncEvent>::const_iterator it = events.constBegin(); it != events.constEnd(); ++it)
+        postSyncEvent(*it);
+
+    return true;
 }
 
-void QGalleryTrackerResultSetPrivate::processSyncEvents()
+void QGalleryTrackerResultSetTask::postStreamValues(QGalleryTrackerTable *values)
 {
-    while (SyncEvent *event = syncEvents.dequeue()) {
-        switch (event->type) {
+    {
+        QMutexLocker locker(&streamMutex);
+
+        streamValues.append(*values);
+    }
+    values->clear();
+
+    postSyncEvent(SyncEvent::streamEvent());
+}
+
+void QGalleryTrackerResultSetTask::synchronize()
+{
+    const QGalleryTrackerRowDiff rowDiff(identityWidth, tableWidth);
+    const QVector<QGalleryTrackerRowDiff::Edit> edits = rowDiff.diff(rCache.values, iCache.values);
+
+    typedef QVector<QGalleryTrackerRowDiff::Edit>::const_iterator iterator;
+
+    int changedCount = 0;
+    for (iterator it = edits.constBegin(), end = edits.constEnd(); it != end; ++it) {
+        switch (it->type) {
+        case QGalleryTrackerRowDiff::Edit::Update:
+        case QGalleryTrackerRowDiff::Edit::Move:
+            changedCount += it->rCount;
+            break;
+        case QGalleryTrackerRowDiff::Edit::Replace:
+            changedCount += qMax(it->rCount, it->iCount);
+            break;
+        case QGalleryTrackerRowDiff::Edit::Finish:
+            changedCount += qMax(rCache.count - it->rIndex, iCache.count - it->iIndex);
+            break;
+        default:
+            break;
+        }
+    }
+
+    // When most rows have changed removing and inserting everything at once is cheaper for a view
+    // than applying each change.
+    if (changedCount >= SyncResetMinimum
+            && changedCount * 100 > qMax(rCache.count, iCache.count) * SyncResetPercentage) {
+        postSyncEvent(SyncEvent::finishEvent(0, 0));
+
+        return;
+    }
+
+    for (iterator it = edits.constBegin(), end = edits.constEnd(); it != end; ++it) {
+        switch (it->type) {
+        case QGalleryTrackerRowDiff::Edit::Update:
+            postSyncEvent(SyncEvent::updateEvent(it->rIndex, it->iIndex, it->iCount));
+            break;
+        case QGalleryTrackerRowDiff::Edit::Replace:
+            postSyncEvent(SyncEvent::replaceEvent(it->rIndex, it->rCount, it->iIndex, it->iCount));
+            break;
+        case QGalleryTrackerRowDiff::Edit::Move:
+            postSyncEvent(SyncEvent::moveEvent(it->rIndex, it->rCount, it->iIndex));
+            break;
+        case QGalleryTrackerRowDiff::Edit::Finish:
+            postSyncEvent(SyncEvent::finishEvent(it->rIndex, it->iIndex));
+            break;
+        default:
+            break;
+        }
+    }
+}
+
+/*
+    Applies queued sync events, if \a msecs is not negative it stops once that long has passed so
+    the event loop isn't held up by a large refresh.
+
+    Returns true if there are no events left to apply.
+*/
+
+bool QGalleryTrackerResultSetPrivate::processSyncEvents(int msecs)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    SyncEvent event;
+
+    while (task->syncEvents.dequeue(&event)) {
+        switch (event.type) {
         case SyncEvent::Update:
-            syncUpdate(event->rIndex, event->rCount, event->iIndex, event->iCount);
+            syncUpdate(event.rIndex, event.rCount, event.iIndex, event.iCount);
             break;
         case SyncEvent::Replace:
-            syncReplace(event->rIndex, event->rCount, event->iIndex, event->iCount);
+            syncReplace(event.rIndex, event.rCount, event.iIndex, event.iCount);
+            break;
+        case SyncEvent::Move:
+            syncMove(event.rIndex, event.rCount, event.iIndex);
+            break;
+        case SyncEvent::Stream:
+            syncStream();
             break;
         case SyncEvent::Finish:
-            syncFinish(event->rIndex, event->iIndex);
+            syncFinish(event.rIndex, event.iIndex);
             break;
         default:
             break;
         }
 
-        delete event;
+        if (msecs >= 0 && timer.elapsed() >= msecs)
+            return task->syncEvents.isEmpty();
     }
+    return true;
 }
 
 void QGalleryTrackerResultSetPrivate::removeItems(
@@ -272,10 +731,10 @@ void QGalleryTrackerResultSetPrivate::removeItems(
         currentIndex = iIndex;
 
         if (currentIndex < rCache.count) {
-            currentRow = rCache.values.constBegin()
-                    + ((currentIndex + rCache.offset - iCache.cutoff) * tableWidth);
+            currentRow = QGalleryTrackerRow(
+                    &rCache.values, currentIndex + rCache.offset - iCache.cutoff);
         } else {
-            currentRow = 0;
+            currentRow = QGalleryTrackerRow();
         }
     }
 
@@ -306,7 +765,7 @@ void QGalleryTrackerResultSetPrivate::syncUpdate(
     bool itemChanged = false;
 
     if (currentIndex >= iCache.cutoff && currentIndex < iIndex + iCount) {
-        currentRow = iCache.values.constBegin() + (currentIndex * tableWidth);
+        currentRow = QGalleryTrackerRow(&iCache.values, currentIndex);
 
         itemChanged = true;
     }
@@ -328,7 +787,7 @@ void QGalleryTrackerResultSetPrivate::syncReplace(
         removeItems(rIndex, iIndex, rCount);
 
     if (currentIndex >= iCache.cutoff && currentIndex < iIndex + iCount) {
-        currentRow = iCache.values.constBegin() + (currentIndex * tableWidth);
+        currentRow = QGalleryTrackerRow(&iCache.values, currentIndex);
 
         itemChanged = true;
     }
@@ -340,6 +799,62 @@ void QGalleryTrackerResultSetPrivate::syncReplace(
         Q_EMIT q_func()->currentItemChanged();
 }
 
+void QGalleryTrackerResultSetPrivate::syncMove(
+        const int rIndex, const int rCount, const int rTo)
+{
+    rCache.values.moveRows(rIndex, rCount, rTo);
+
+    const int from = iCache.cutoff + rIndex - rCache.offset;
+    const int to = iCache.cutoff + rTo - rCache.offset;
+
+    const int originalIndex = currentIndex;
+
+    currentIndex = QGalleryTrackerRowDiff::movedIndex(currentIndex, from, to, rCount);
+
+    if (currentIndex >= qMin(from, to) && currentIndex < qMax(from + rCount, to)) {
+        currentRow = QGalleryTrackerRow(
+                &rCache.values, currentIndex + rCache.offset - iCache.cutoff);
+    }
+
+    Q_EMIT q_func()->itemsMoved(from, to, rCount);
+
+    if (originalIndex != currentIndex)
+        Q_EMIT q_func()->currentIndexChanged(currentIndex);
+}
+
+void QGalleryTrackerResultSetPrivate::syncStream()
+{
+    QGalleryTrackerTable values(task->columnTypes);
+    {
+        QMutexLocker locker(&task->streamMutex);
+
+        values.swap(task->streamValues);
+    }
+
+    const int count = values.rowCount();
+
+    if (count == 0)
+        return;
+
+    const int index = iCache.count;
+
+    iCache.values.append(values);
+    iCache.count += count;
+    iCache.cutoff = iCache.count;
+
+    const bool itemChanged = currentIndex >= index && currentIndex < iCache.count;
+
+    if (itemChanged)
+        currentRow = QGalleryTrackerRow(&iCache.values, currentIndex);
+
+    rowCount += count;
+
+    Q_EMIT q_func()->itemsInserted(index, count);
+
+    if (itemChanged)
+        Q_EMIT q_func()->currentItemChanged();
+}
+
 void QGalleryTrackerResultSetPrivate::syncFinish(const int rIndex, const int iIndex)
 {
     const int rCount = rCache.count - rIndex;
@@ -353,7 +868,7 @@ void QGalleryTrackerResultSetPrivate::syncFinish(const int rIndex, const int iIn
         rCache.offset = rCache.count;
 
     if (currentIndex >= iCache.cutoff && currentIndex < iCache.count) {
-        currentRow = iCache.values.constBegin() + (currentIndex * tableWidth);
+        currentRow = QGalleryTrackerRow(&iCache.values, currentIndex);
 
         itemChanged = true;
     }
@@ -381,7 +896,7 @@ bool QGalleryTrackerResultSetPrivate::waitForSyncFinish(int msecs)
             return true;
         }
 
-        if (!syncEvents.waitForEvent(msecs))
+        if (!task->syncEvents.waitForEvent(msecs))
             return false;
     } while ((msecs -= timer.restart()) > 0);
 
@@ -390,7 +905,15 @@ bool QGalleryTrackerResultSetPrivate::waitForSyncFinish(int msecs)
 
 void QGalleryTrackerResultSetPrivate::_q_parseFinished()
 {
-    processSyncEvents();
+    // waitForFinished() may have already completed the query this notification is for.
+    if (!(flags & Active) || task->isActive())
+        return;
+
+    if (!processSyncEvents(SyncEventInterval)) {
+        QMetaObject::invokeMethod(q_func(), "_q_parseFinished", Qt::QueuedConnection);
+
+        return;
+    }
 
     Q_ASSERT(rCache.offset == rCache.count);
     Q_ASSERT(iCache.cutoff == iCache.count);
@@ -400,24 +923,54 @@ void QGalleryTrackerResultSetPrivate::_q_parseFinished()
 
     flags &= ~Active;
 
-    if (flags & Refresh)
-        update();
-    else
-        Q_EMIT q_func()->progressChanged(progressMaximum, progressMaximum);
+    // The query may have read values of edits tracker hasn't applied yet.
+    reapplyEdits();
 
-    if (queryError != QDocumentGallery::NoError) {
+    progressMaximum = rowCount;
+
+    // Changes that arrived during the query are picked up after a delay rather than straight away,
+    // otherwise a steady stream of changes would keep the result set querying back-to-back.
+    if ((flags & Refresh) && !suspended)
+        updateTimer.start(refreshPolicy.nextDelay(refreshClock.elapsed()), q_func());
+
+    Q_EMIT q_func()->progressChanged(progressMaximum, progressMaximum);
+
+    if (flags & Cancelled) {
+        q_func()->QGalleryAbstractResponse::cancel();
+    } else if (task->queryError != QDocumentGallery::NoError) {
         q_func()->finish(flags & Live);
     } else  {
-        q_func()->error(queryError, queryErrorString);
-        queryError = QDocumentGallery::NoError;
+        q_func()->error(task->queryError, task->queryErrorString);
+        task->queryError = QDocumentGallery::NoError;
     }
 }
 
-void QGalleryTrackerResultSetPrivate::_q_editFinished(QGalleryTrackerMetaDataEdit *edit)
+void QGalleryTrackerResultSetPrivate::_q_editFinished(QGalleryTrackerMetaDataBatch *batch)
 {
-    edit->deleteLater();
+    batch->deleteLater();
+    batches.removeAll(batch);
+
+    if (batch->errorString().isEmpty()) {
+        Q_EMIT q_func()->itemEdited(m_service, batch->resources());
+    } else {
+        // Put back the values the items had before they were edited, or if a query is reading
+        // the cache re-read the items once it's done.
+        const QList<QGalleryTrackerMetaDataEdit *> batchEdits = batch->edits();
 
-    Q_EMIT q_func()->itemEdited(m_service);
+        typedef QList<QGalleryTrackerMetaDataEdit *>::const_iterator iterator;
+        for (iterator it = batchEdits.constBegin(), end = batchEdits.constEnd(); it != end; ++it) {
+            if (flags & Active) {
+                const QGalleryTrackerResourceChange change = {
+                        QGalleryTrackerResourceChange::Updated, (*it)->service().toUtf8() };
+
+                addChanges(QGalleryTrackerResourceChangeList() << change);
+
+                flags |= Refresh;
+            } else {
+                applyEdit(*it, true);
+            }
+        }
+    }
 }
 
 QGalleryTrackerResultSet::QGalleryTrackerResultSet(
@@ -429,11 +982,11 @@ QGalleryTrackerResultSet::QGalleryTrackerResultSet(
 {
     Q_D(QGalleryTrackerResultSet);
 
-    g_object_ref(G_OBJECT(d->connection));
-
-    connect(&d->parserThread, SIGNAL(finished()), this, SLOT(_q_parseFinished()));
+    d->task->setReceiver(this);
 
-    d_func()->query();
+    // Without a connection the query is held back until the gallery has one, see setConnection().
+    if (d->task->connection)
+        d->query();
 }
 
 QGalleryTrackerResultSet::QGalleryTrackerResultSet(
@@ -443,24 +996,56 @@ QGalleryTrackerResultSet::QGalleryTrackerResultSet(
 {
     Q_D(QGalleryTrackerResultSet);
 
-    g_object_ref(G_OBJECT(d->connection));
-
-    connect(&d->parserThread, SIGNAL(finished()), this, SLOT(_q_parseFinished()));
+    d->task->setReceiver(this);
 
-    d_func()->query();
+    if (d->task->connection)
+        d->query();
 }
 
 QGalleryTrackerResultSet::~QGalleryTrackerResultSet()
 {
     Q_D(QGalleryTrackerResultSet);
 
-    typedef QList<QGalleryTrackerMetaDataEdit *>::iterator iterator;
-    for (iterator it = d->edits.begin(), end = d->edits.end(); it != end; ++it)
-        (*it)->commit();
+    d->commitEdits();
+
+    d->updateTimer.stop();
+
+    // Rather than wait for an in-flight query to wind down cut it off from the result set, the
+    // private data hands it over to the scheduler to delete once it has.
+    d->task->setReceiver(0);
+
+    g_cancellable_cancel(d->task->cancellable);
+}
+
+void QGalleryTrackerResultSet::setConnection(
+        TrackerSparqlConnection *connection,
+        const QSharedPointer<QGalleryTrackerStatementCache> &statements)
+{
+    Q_D(QGalleryTrackerResultSet);
+
+    if (d->task->connection || (d->flags & QGalleryTrackerResultSetPrivate::Cancelled))
+        return;
+
+    if (!connection) {
+        d->flags &= ~QGalleryTrackerResultSetPrivate::Live;
 
-    d->parserThread.wait();
+        error(QDocumentGallery::ConnectionError);
+    } else {
+        d->task->connection = connection;
+        d->task->statements = statements
+                ? statements
+                : QSharedPointer<QGalleryTrackerStatementCache>(
+                        new QGalleryTrackerStatementCache(connection));
+
+        g_object_ref(G_OBJECT(connection));
 
-    g_object_unref(G_OBJECT(d->connection));
+        d->query();
+    }
+}
+
+QGalleryTrackerRefreshPolicy::Statistics QGalleryTrackerResultSet::refreshStatistics() const
+{
+    return d_func()->refreshPolicy.statistics();
 }
 
 QStringList QGalleryTrackerResultSet::propertyNames() const
@@ -504,28 +1089,19 @@ bool QGalleryTrackerResultSet::fetch(int index)
     Q_D(QGalleryTrackerResultSet);
 
     d->currentIndex = index;
-
-    if (d->currentIndex < 0 || d->currentIndex >= d->rowCount) {
-        d->currentRow = 0;
-    } else if (d->currentIndex < d->iCache.cutoff) {
-        d->currentRow = d->iCache.values.constBegin() + (d->currentIndex * d->tableWidth);
-    } else {
-        d->currentRow
-                = d->rCache.values.constBegin()
-                + ((d->currentIndex + d->rCache.offset - d->iCache.cutoff) * d->tableWidth);
-    }
+    d->currentRow = d->rowAt(index);
 
     Q_EMIT currentIndexChanged(d->currentIndex);
     Q_EMIT currentItemChanged();
 
-    return d->currentRow != 0;
+    return !d->currentRow.isNull();
 }
 
 QVariant QGalleryTrackerResultSet::itemId() const
 {
     Q_D(const QGalleryTrackerResultSet);
 
-    return d->currentRow
+    return !d->currentRow.isNull()
             ? d->idColumn->value(d->currentRow)
             : QVariant();
 }
@@ -534,7 +1110,7 @@ QUrl QGalleryTrackerResultSet::itemUrl() const
 {
     Q_D(const QGalleryTrackerResultSet);
 
-    return d->currentRow
+    return !d->currentRow.isNull()
             ? d->urlColumn->value(d->currentRow).toUrl()
             : QUrl();
 }
@@ -543,7 +1119,7 @@ QString QGalleryTrackerResultSet::itemType() const
 {
     Q_D(const QGalleryTrackerResultSet);
 
-    return d->currentRow
+    return !d->currentRow.isNull()
             ? d->typeColumn->value(d->currentRow).toString()
             : QString();
 }
@@ -552,45 +1128,14 @@ QList<QGalleryResource> QGalleryTrackerResultSet::resources() const
 {
     Q_D(const QGalleryTrackerResultSet);
 
-    QList<QGalleryResource> resources;
-
-    if (d->currentRow) {
-        const QUrl url = d->urlColumn->value(d->currentRow).toUrl();
-
-        if (!url.isEmpty()) {
-            QMap<int, QVariant> attributes;
-
-            typedef QVector<int>::const_iterator iterator;
-            for (iterator it = d->resourceKeys.begin(), end = d->resourceKeys.end();
-                    it != end;
-                    ++it) {
-                QVariant value = metaData(*it);
-
-                if (!value.isNull())
-                    attributes.insert(*it, value);
-            }
-
-            resources.append(QGalleryResource(url, attributes));
-        }
-    }
-    return resources;
+    return d->resources(d->currentRow);
 }
 
 QVariant QGalleryTrackerResultSet::metaData(int key) const
 {
     Q_D(const QGalleryTrackerResultSet);
 
-    if (!d->currentRow || key < d->valueOffset) {
-        return QVariant();
-    } else if (key < d->compositeOffset) {  // Value column.
-        return *(d->currentRow + key);
-    } else if (key < d->aliasOffset) {      // Composite column.
-        return d->compositeColumns.at(key - d->compositeOffset)->value(d->currentRow);
-    } else if (key < d->columnCount) {      // Alias column.
-        return *(d->currentRow + d->aliasColumns.at(key - d->aliasOffset) + d->valueOffset);
-    } else {
-        return QVariant();
-    }
+    return d->value(d->currentRow, key);
 }
 
 bool QGalleryTrackerResultSet::setMetaData(int, const QVariant &)
@@ -605,6 +1150,8 @@ void QGalleryTrackerResultSet::cancel()
 
     if (!(d_func()->flags &QGalleryTrackerResultSetPrivate::Active))
         QGalleryAbstractResponse::cancel();
+    else
+        g_cancellable_cancel(d_func()->task->cancellable);
 }
 
 bool QGalleryTrackerResultSet::waitForFinished(int msecs)
@@ -617,7 +1164,7 @@ bool QGalleryTrackerResultSet::waitForFinished(int msecs)
     do {
         if (d->flags & QGalleryTrackerResultSetPrivate::Active) {
             if (d->waitForSyncFinish(msecs)) {
-                d->parserThread.wait();
+                d->task->wait();
 
                 d->_q_parseFinished();
 
@@ -640,11 +1187,13 @@ bool QGalleryTrackerResultSet::event(QEvent *event)
 {
     switch (event->type()) {
     case QEvent::UpdateRequest:
-        d_func()->update();
+        d_func()->commitEdits();
 
         return true;
     case QEvent::UpdateLater:
-        d_func()->processSyncEvents();
+        // Yield to the event loop between slices of a large refresh.
+        if (!d_func()->processSyncEvents(QGalleryTrackerResultSetPrivate::SyncEventInterval))
+            QCoreApplication::postEvent(this, new QEvent(QEvent::UpdateLater));
 
         return true;
     default:
@@ -661,21 +1210,30 @@ void QGalleryTrackerResultSet::timerEvent(QTimerEvent *event)
    }
 }
 
-void QGalleryTrackerResultSet::refresh(const QList<int> &serviceIds)
+void QGalleryTrackerResultSet::refresh(
+        const QList<int> &serviceIds, const QGalleryTrackerResourceChangeList &changes)
 {
     Q_D(QGalleryTrackerResultSet);
 
+    if (!(d->flags & QGalleryTrackerResultSetPrivate::Live))
+        return;
+
     for (int id : serviceIds) {
-        if ((d->updateMask & id)
-                && !d->updateTimer.isActive()
-                && (d->flags & QGalleryTrackerResultSetPrivate::Live)) {
+        if (d->updateMask & id) {
+            d->addChanges(changes);
 
+            const int delay = d->refreshPolicy.changed(
+                    d->refreshClock.elapsed(),
+                    d->flags & QGalleryTrackerResultSetPrivate::Refresh);
 
             d->flags |= QGalleryTrackerResultSetPrivate::Refresh;
 
-            if (!(d->flags & QGalleryTrackerResultSetPrivate::Active)) {
-                d->updateTimer.start(100, this);
+            if (!(d->flags & QGalleryTrackerResultSetPrivate::Active)
+                    && !d->updateTimer.isActive()
+                    && !d->suspended) {
+                d->updateTimer.start(delay, this);
             }
+            break;
         }
     }
 }
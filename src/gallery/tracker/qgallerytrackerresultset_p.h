@@ -55,7 +55,12 @@
 
 #include <qgalleryresultset.h>
 
+#include "qgallerytrackerchangenotifier_p.h"
 #include "qgallerytrackerlistcolumn_p.h"
+#include "qgallerytrackerrefreshpolicy_p.h"
+#include "qgallerytrackerscheduler_p.h"
+
+#include <QtCore/qsharedpointer.h>
 
 class QDBusPendingCallWatcher;
 
@@ -65,6 +70,7 @@ QT_BEGIN_NAMESPACE_DOCGALLERY
 
 class QGalleryTrackerImageColumn;
 class QGalleryTrackerSchema;
+class QGalleryTrackerStatementCache;
 
 class QGalleryTrackerResultSetPrivate;
 
@@ -79,6 +85,10 @@ struct QGalleryTrackerResultSetArguments
         , tableWidth(0)
         , valueOffset(0)
         , compositeOffset(0)
+        , offset(0)
+        , limit(0)
+        , resourceValuesIndex(-1)
+        , priority(QGalleryTrackerScheduler::NormalPriority)
     {
     }
 
@@ -102,7 +112,15 @@ struct QGalleryTrackerResultSetArguments
     int tableWidth;
     int valueOffset;
     int compositeOffset;
+    int offset;
+    int limit;
     QString sparql;
+    QString pageSparql;
+    QString countSparql;
+    QString resourceSparql;
+    QStringList parameters;
+    int resourceValuesIndex;
+    QVector<int> sortColumns;
     QStringList propertyNames;
     QStringList fieldNames;
     QVector<QGalleryProperty::Attributes> propertyAttributes;
@@ -112,9 +130,11 @@ struct QGalleryTrackerResultSetArguments
     QVector<int> aliasColumns;
     QVector<int> resourceKeys;
     QString service;
+    QGalleryTrackerScheduler::Priority priority;
+    QSharedPointer<QGalleryTrackerStatementCache> statements;
 };
 
-class QGalleryTrackerResultSet : public QGalleryResultSet
+class Q_GALLERY_EXPORT QGalleryTrackerResultSet : public QGalleryResultSet
 {
     Q_OBJECT
 public:
@@ -125,6 +145,12 @@ public:
             QObject *parent = Q_NULLPTR);
     ~QGalleryTrackerResultSet();
 
+    void setConnection(
+            TrackerSparqlConnection *connection,
+            const QSharedPointer<QGalleryTrackerStatementCache> &statements);
+
+    QGalleryTrackerRefreshPolicy::Statistics refreshStatistics() const;
+
     QStringList propertyNames() const;
     int propertyKey(const QString &property) const;
     QGalleryProperty::Attributes propertyAttributes(int key) const;
@@ -150,10 +176,12 @@ public:
     bool event(QEvent *event);
 
 public Q_SLOTS:
-    void refresh(const QList<int> &serviceIds = QList<int>());
+    void refresh(
+            const QList<int> &serviceIds = QList<int>(),
+            const QGalleryTrackerResourceChangeList &changes = QGalleryTrackerResourceChangeList());
 
 Q_SIGNALS:
-    void itemEdited(const QString &service);
+    void itemEdited(const QString &service, const QStringList &urns);
 
 protected:
     QGalleryTrackerResultSet(QGalleryTrackerResultSetPrivate &dd, QObject *parent);
@@ -163,6 +191,9 @@ protected:
 private:
     Q_DECLARE_PRIVATE(QGalleryTrackerResultSet)
     Q_PRIVATE_SLOT(d_func(), void _q_parseFinished())
+
+    friend class QGalleryTrackerResultSetCursor;
+    friend class QGalleryTrackerResultSetCursorPrivate;
 };
 
 QT_END_NAMESPACE_DOCGALLERY
@@ -58,252 +58,168 @@
 
 #include "qgallerytrackerlistcolumn_p.h"
 #include "qgallerytrackermetadataedit_p.h"
+#include "qgallerytrackerscheduler_p.h"
 #include "qgallerytrackerschema_p.h"
+#include "qgallerytrackerstatementcache_p.h"
+#include "qgallerytrackersynceventqueue_p.h"
 
 #include <QtCore/qcoreapplication.h>
 #include <QtCore/qbasictimer.h>
 #include <QtCore/qcoreevent.h>
+#include <QtCore/qelapsedtimer.h>
+#include <QtCore/qhash.h>
 #include <QtCore/qmutex.h>
-#include <QtCore/qqueue.h>
-#include <QtCore/qrunnable.h>
-#include <QtCore/qthread.h>
-#include <QtCore/qwaitcondition.h>
 
-QT_BEGIN_NAMESPACE_DOCGALLERY
-
-class QGalleryTrackerResultSetThread : public QThread
-{
-public:
-    QGalleryTrackerResultSetThread(QRunnable *runnable) : runnable(runnable) {}
+typedef struct _GCancellable GCancellable;
 
-    void run() { runnable->run(); }
+QT_BEGIN_NAMESPACE_DOCGALLERY
 
-private:
-    QRunnable *runnable;
-};
+/*
+    The state a query reads and writes off the GUI thread.  If the result set is deleted while a
+    query is running the task is left for the scheduler to delete once the query has wound down.
+*/
 
-class QGalleryTrackerResultSetPrivate : public QGalleryResultSetPrivate, public QRunnable
+class QGalleryTrackerResultSetTask : public QGalleryTrackerTask
 {
-    Q_DECLARE_PUBLIC(QGalleryTrackerResultSet)
 public:
-    struct SyncEvent
-    {
-        enum Type
-        {
-            Update,
-            Replace,
-            Finish
-        };
-
-        const Type type;
-        const int rIndex;
-        const int rCount;
-        const int iIndex;
-        const int iCount;
-
-        static SyncEvent *updateEvent(int aIndex, int iIndex, int count) {
-            return new SyncEvent(Update, aIndex, count, iIndex, count); }
-
-        static SyncEvent *replaceEvent(int aIndex, int aCount, int iIndex, int iCount) {
-            return new SyncEvent(Replace, aIndex, aCount, iIndex, iCount); }
-
-        static SyncEvent *finishEvent(int aIndex, int iIndex) {
-            return new SyncEvent(Finish, aIndex, 0, iIndex, 0); }
-
-    private:
-        SyncEvent(Type type, int rIndex, int rCount, int iIndex, int iCount)
-            : type(type), rIndex(rIndex), rCount(rCount), iIndex(iIndex), iCount(iCount) {}
+    typedef QGalleryTrackerSyncEvent SyncEvent;
 
-    };
-
-    class SyncEventQueue
+    struct Cache
     {
-    public:
-        SyncEventQueue() {}
-        ~SyncEventQueue() { qDeleteAll(m_queue); }
-
-        bool enqueue(SyncEvent *event)
-        {
-            QMutexLocker locker(&m_mutex);
-
-            m_queue.enqueue(event);
-            m_wait.wakeOne();
-
-            return m_queue.count() == 1;
-        }
-
-        SyncEvent *dequeue()
-        {
-            QMutexLocker locker(&m_mutex);
-
-            return !m_queue.isEmpty() ? m_queue.dequeue() : 0;
-        }
+        Cache() : count(0), cutoff(0) {}
 
-        bool waitForEvent(int msecs)
+        int count;
+        union
         {
-            QMutexLocker locker(&m_mutex);
-
-            if (!m_queue.isEmpty())
-                return true;
-
-            return m_wait.wait(&m_mutex, msecs);
-        }
-
-    private:
-        QQueue<SyncEvent *> m_queue;
-        QMutex m_mutex;
-        QWaitCondition m_wait;
-    };
-
-    struct Row
-    {
-        Row() {}
-        Row(QVector<QVariant>::iterator begin, QVector<QVariant>::iterator end)
-            : begin(begin), end(end) {}
-
-        QVector<QVariant>::iterator begin;
-        QVector<QVariant>::iterator end;
+            int offset;
+            int cutoff;
+        };
+        QGalleryTrackerTable values;
     };
 
-    struct row_iterator
+    enum
     {
-        row_iterator() {}
-        row_iterator(QVector<QVariant>::iterator begin, int width) : begin(begin), width(width) {}
-
-        bool operator != (const row_iterator &other) const { return begin != other.begin; }
-        bool operator <(const row_iterator &other) const { return begin < other.begin; }
-
-        row_iterator &operator ++() { begin += width; return *this; }
-        row_iterator &operator --() { begin -= width; return *this; }
-
-        row_iterator operator ++(int) { row_iterator n(*this); begin += width; return n; }
-        row_iterator operator --(int) { row_iterator n(*this); begin -= width; return n; }
-
-        int operator -(const row_iterator &other) const { return (begin - other.begin) / width; }
-        int operator -(const QVector<QVariant>::const_iterator &iterator) const {
-            return (begin - iterator) / width; }
-
-        row_iterator operator +(int span) const {
-            return row_iterator(begin + (span * width), width); }
-
-        row_iterator &operator +=(int span) { begin += span * width; return *this; }
-
-        Row &operator *() {  return row = Row(begin, begin + width); }
-        const Row &operator *() const {  return row = Row(begin, begin + width); }
-
-        bool isEqual(const row_iterator &other, int count) const {
-            return std::equal(begin, begin + count, other.begin); }
-        bool isEqual(const row_iterator &other, int index, int count) {
-            return std::equal(begin + index, begin + count, other.begin + index); }
-
-        const QVariant &operator[] (int column) const { return *(begin + column); }
-
-        QVector<QVariant>::iterator begin;
-        int width;
-        mutable Row row;
+        StreamBatchSize         = 256,
+        StreamBatchInterval     = 100,
+        SyncResetMinimum        = 64,
+        SyncResetPercentage     = 50
     };
 
-    struct const_row_iterator
-    {
-        const_row_iterator() {}
-        const_row_iterator(QVector<QVariant>::const_iterator begin, int width)
-            : begin(begin), width(width) {}
-
-        bool operator != (const const_row_iterator &other) const { return begin != other.begin; }
-        bool operator <(const const_row_iterator &other) const { return begin < other.begin; }
+    QGalleryTrackerResultSetTask(
+            TrackerSparqlConnection *connection, QGalleryTrackerResultSetArguments *arguments);
+    ~QGalleryTrackerResultSetTask();
 
-        const_row_iterator &operator ++() { begin += width; return *this; }
-        const_row_iterator operator --(int) {
-            const_row_iterator n(*this); begin -= width; return n; }
+    TrackerSparqlConnection *connection;
+    QSharedPointer<QGalleryTrackerStatementCache> statements;
+    GCancellable *const cancellable;
 
-        int operator -(const const_row_iterator &other) const {
-            return (begin - other.begin) / width; }
-        int operator -(const QVector<QVariant>::const_iterator &iterator) const {
-            return (begin - iterator) / width; }
+    const int identityWidth;
+    const int tableWidth;
+    int queryError;
+    QString queryErrorString;
+    const QString sparql;
+    const QString resourceSparql;
+    const QStringList parameters;
+    const int resourceValuesIndex;
+    const QVector<int> sortColumns;
+    const QVector<QGalleryTrackerValueColumn *> valueColumns;
+    QVector<QVariant::Type> columnTypes;
+    Cache rCache;   // Remove cache.
+    Cache iCache;   // Insert cache.
+    QHash<QByteArray, QGalleryTrackerResourceChange::Type> resourceChanges;
+    QGalleryTrackerSyncEventQueue syncEvents;
+    QMutex streamMutex;
+    QGalleryTrackerTable streamValues;
+    bool streaming;
 
-        const_row_iterator operator +(int span) const {
-            return const_row_iterator(begin + (span * width), width); }
+    void setReceiver(QObject *receiver);
 
-        const_row_iterator &operator +=(int span) { begin += span * width; return *this; }
+protected:
+    void run();
+    void taskFinished();
 
-        bool isEqual(const const_row_iterator &other, int count) const {
-            return std::equal(begin, begin + count, other.begin); }
-        bool isEqual(const const_row_iterator &other, int index, int count) {
-            return std::equal(begin + index, begin + count, other.begin + index); }
+private:
+    bool refreshResources();
+    void synchronize();
 
-        QVector<QVariant>::const_iterator begin;
-        int width;
-    };
+    void postSyncEvent(const SyncEvent &event) { syncEvents.enqueue(event); }
+    void postStreamValues(QGalleryTrackerTable *values);
 
-    struct Cache
-    {
-        Cache() : count(0), cutoff(0) {}
+    QMutex m_receiverMutex;
+    QObject *m_receiver;
+};
 
-        int count;
-        union
-        {
-            int offset;
-            int cutoff;
-        };
-        QVector<QVariant> values;
-    };
+class QGalleryTrackerResultSetPrivate : public QGalleryResultSetPrivate
+{
+    Q_DECLARE_PUBLIC(QGalleryTrackerResultSet)
+public:
+    typedef QGalleryTrackerSyncEvent SyncEvent;
+    typedef QGalleryTrackerResultSetTask::Cache Cache;
 
     enum Flag
     {
         Cancelled       = 0x01,
         Live            = 0x02,
         Refresh         = 0x04,
-        UpdateRequested = 0x10,
+        RefreshAll      = 0x08,
+        CommitRequested = 0x10,
         Active          = 0x20,
         SyncFinished    = 0x40
     };
 
+    enum
+    {
+        MaximumResourceChanges  = 128,
+        SyncEventInterval       = 8
+    };
+
     Q_DECLARE_FLAGS(Flags, Flag)
 
     QGalleryTrackerResultSetPrivate(
             TrackerSparqlConnection *connection,
             QGalleryTrackerResultSetArguments *arguments,
             bool autoUpdate)
-        : connection(connection)
+        : task(new QGalleryTrackerResultSetTask(connection, arguments))
+        , rCache(task->rCache)
+        , iCache(task->iCache)
         , m_service( arguments->service )
         , idColumn(arguments->idColumn.take())
         , urlColumn(arguments->urlColumn.take())
         , typeColumn(arguments->typeColumn.take())
         , updateMask(arguments->updateMask)
-        , identityWidth(arguments->identityWidth)
-        , tableWidth(arguments->tableWidth)
         , valueOffset(arguments->valueOffset)
         , compositeOffset(arguments->compositeOffset)
         , aliasOffset(compositeOffset + arguments->compositeColumns.count())
         , columnCount(aliasOffset + arguments->aliasColumns.count())
-        , currentRow(0)
         , currentIndex(-1)
         , rowCount(0)
         , progressMaximum(0)
-        , queryError(QDocumentGallery::NoError)
-        , sparql(arguments->sparql)
         , propertyNames(arguments->propertyNames)
         , propertyAttributes(arguments->propertyAttributes)
         , propertyTypes(arguments->propertyTypes)
-        , valueColumns(arguments->valueColumns)
         , compositeColumns(arguments->compositeColumns)
         , aliasColumns(arguments->aliasColumns)
         , resourceKeys(arguments->resourceKeys)
-        , parserThread(this)
+        , priority(arguments->priority)
+        , viewCount(0)
+        , suspendedViewCount(0)
     {
         arguments->clear();
 
+        for (int i = 0; i < propertyNames.count(); ++i)
+            propertyKeys.append(valueOffset + i);
+
         if (autoUpdate)
             flags |= Live;
-    }
 
-    ~QGalleryTrackerResultSetPrivate()
-    {
-        qDeleteAll(valueColumns);
-        qDeleteAll(compositeColumns);
+        refreshClock.start();
     }
 
-    TrackerSparqlConnection *connection;
+    ~QGalleryTrackerResultSetPrivate();
+
+    QGalleryTrackerResultSetTask *const task;
+    Cache &rCache;  // Remove cache, read by the query.
+    Cache &iCache;  // Insert cache, written by the query.
 
     QString m_service;
 
@@ -313,86 +229,111 @@ public:
     const QScopedPointer<QGalleryTrackerCompositeColumn> typeColumn;
 
     const int updateMask;
-    const int identityWidth;
-    const int tableWidth;
     const int valueOffset;
     const int compositeOffset;
     const int aliasOffset;
     const int columnCount;
-    QVector<QVariant>::const_iterator currentRow;
+    QGalleryTrackerRow currentRow;
     int currentIndex;
     int rowCount;
     int progressMaximum;
-    int queryError;
-    QString queryErrorString;
-    const QString sparql;
     const QStringList propertyNames;
-    const QList<int> propertyKeys;
+    QList<int> propertyKeys;
     const QVector<QGalleryProperty::Attributes> propertyAttributes;
     const QVector<QVariant::Type> propertyTypes;
-    const QVector<QGalleryTrackerValueColumn *> valueColumns;
     const QVector<QGalleryTrackerCompositeColumn *> compositeColumns;
     const QVector<int> aliasColumns;
     const QVector<int> resourceKeys;
-    Cache rCache;   // Remove cache.
-    Cache iCache;   // Insert cache.
 
-    QGalleryTrackerResultSetThread parserThread;
+    const QGalleryTrackerScheduler::Priority priority;
     QList<QGalleryTrackerMetaDataEdit *> edits;
+    QList<QGalleryTrackerMetaDataBatch *> batches;
     QBasicTimer updateTimer;
-    SyncEventQueue syncEvents;
+    QGalleryTrackerRefreshPolicy refreshPolicy;
+    QElapsedTimer refreshClock;
+    QHash<QByteArray, QGalleryTrackerResourceChange::Type> pendingChanges;
+    int viewCount;
+    int suspendedViewCount;
 
-    inline int rCacheIndex(const const_row_iterator &iterator) const {
-        return iterator - rCache.values.begin(); }
-    inline int iCacheIndex(const const_row_iterator &iterator) const {
-        return iterator - iCache.values.begin(); }
+    QGalleryTrackerRow rowAt(int index) const
+    {
+        if (index < 0 || index >= rowCount)
+            return QGalleryTrackerRow();
+        else if (index < iCache.cutoff)
+            return QGalleryTrackerRow(&iCache.values, index);
+        else
+            return QGalleryTrackerRow(&rCache.values, index + rCache.offset - iCache.cutoff);
+    }
 
-    void update();
-    void requestUpdate()
+    QVariant value(const QGalleryTrackerRow &row, int key) const;
+    QList<QGalleryResource> resources(const QGalleryTrackerRow &row) const;
+
+    QVariant itemIdAt(int index) const
     {
-        if (!(flags & UpdateRequested)) {
-            flags |= UpdateRequested;
-            QCoreApplication::postEvent(q_func(), new QEvent(QEvent::UpdateRequest));
-        }
+        const QGalleryTrackerRow row = rowAt(index);
+
+        return !row.isNull() ? idColumn->value(row) : QVariant();
     }
 
-    void query();
+    QUrl itemUrlAt(int index) const
+    {
+        const QGalleryTrackerRow row = rowAt(index);
 
-    void run();
+        return !row.isNull() ? urlColumn->value(row).toUrl() : QUrl();
+    }
 
-    void synchronize();
+    QString itemTypeAt(int index) const
+    {
+        const QGalleryTrackerRow row = rowAt(index);
+
+        return !row.isNull() ? typeColumn->value(row).toString() : QString();
+    }
+
+    QVariant metaDataAt(int index, int key) const { return value(rowAt(index), key); }
 
-    void postSyncEvent(SyncEvent *event)
+    void readRows(int first, int count, const QVector<int> &keys, QGalleryRowBuffer *buffer) const;
+    void readRows(
+            const QGalleryTrackerTable &table,
+            int index,
+            int count,
+            const QVector<int> &keys,
+            const QVector<int> &columns,
+            QGalleryRowBuffer *buffer,
+            int row) const;
+
+    void update();
+    void suspendedChanged();
+    void requestCommit()
     {
-        if (syncEvents.enqueue(event))
-            QCoreApplication::postEvent(q_func(), new QEvent(QEvent::UpdateLater));
+        if (!(flags & CommitRequested)) {
+            flags |= CommitRequested;
+            QCoreApplication::postEvent(q_func(), new QEvent(QEvent::UpdateRequest));
+        }
     }
 
-    void processSyncEvents();
+    void query();
+    void commitEdits();
+    void applyEdit(const QGalleryTrackerMetaDataEdit *edit, bool rollback);
+    void reapplyEdits();
+    void addChanges(const QGalleryTrackerResourceChangeList &changes);
+
+    bool processSyncEvents(int msecs = -1);
     void removeItems(const int rIndex, const int iIndex, const int count);
     void insertItems(const int rIndex, const int iIndex, const int count);
     void syncUpdate(const int aIndex, const int aCount, const int iIndex, const int iCount);
     void syncReplace(const int aIndex, const int aCount, const int iIndex, const int iCount);
+    void syncMove(const int rIndex, const int rCount, const int rTo);
+    void syncStream();
     void syncFinish(const int aIndex, const int iIndex);
     bool waitForSyncFinish(int msecs);
 
     void _q_queryFinished(QDBusPendingCallWatcher *watcher);
     void _q_parseFinished();
-    void _q_editFinished(QGalleryTrackerMetaDataEdit *edit);
+    void _q_editFinished(QGalleryTrackerMetaDataBatch *batch);
 };
 
 QT_END_NAMESPACE_DOCGALLERY
 
-template <> inline void qSwap<QT_DOCGALLERY_PREPEND_NAMESPACE(QGalleryTrackerResultSetPrivate::Row)>(
-        QT_DOCGALLERY_PREPEND_NAMESPACE(QGalleryTrackerResultSetPrivate::Row) &row1,
-        QT_DOCGALLERY_PREPEND_NAMESPACE(QGalleryTrackerResultSetPrivate::Row) &row2)
-{
-    typedef QVector<QVariant>::iterator iterator;
-
-    for (iterator it1 = row1.begin, it2 = row2.begin; it1 != row1.end; ++it1, ++it2)
-        qSwap(*it1, *it2);
-}
-
 #endif
 
 Q_DECLARE_OPERATORS_FOR_FLAGS(QT_DOCGALLERY_PREPEND_NAMESPACE(QGalleryTrackerResultSetPrivate::Flags))
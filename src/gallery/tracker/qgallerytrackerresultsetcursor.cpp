@@ -0,0 +1,292 @@
+/****************************************************************************
+**
+** Copyright (C) 2012 Digia Plc and/or its subsidiary(-ies).
+** Contact: http://www.qt-project.org/legal
+**
+** This file is part of the QtDocGallery module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and Digia.  For licensing terms and
+** conditions see http://qt.digia.com/licensing.  For further information
+** use the contact form at http://qt.digia.com/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU Lesser General Public License version 2.1 requirements
+** will be met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** In addition, as a special exception, Digia gives you certain additional
+** rights.  These rights are described in the Digia Qt LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3.0 as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU General Public License version 3.0 requirements will be
+** met: http://www.gnu.org/copyleft/gpl.html.
+**
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "qgallerytrackerresultsetcursor_p.h"
+
+#include "qgallerytrackerresultset_p_p.h"
+#include "qgallerytrackerrowdiff_p.h"
+
+#include <qgalleryresource.h>
+
+QT_BEGIN_NAMESPACE_DOCGALLERY
+
+class QGalleryTrackerResultSetCursorPrivate : public QGalleryResultSetPrivate
+{
+public:
+    const QGalleryTrackerResultSetPrivate *shared() const
+    {
+        return static_cast<QGalleryTrackerResultSetCursor *>(q_ptr)->m_resultSet->d_func();
+    }
+
+    void suspendedChanged()
+    {
+        static_cast<QGalleryTrackerResultSetCursor *>(q_ptr)->updateSuspended(
+                suspended ? 1 : -1, 0);
+    }
+
+    QVariant itemIdAt(int index) const { return shared()->itemIdAt(index); }
+    QUrl itemUrlAt(int index) const { return shared()->itemUrlAt(index); }
+    QString itemTypeAt(int index) const { return shared()->itemTypeAt(index); }
+    QVariant metaDataAt(int index, int key) const { return shared()->metaDataAt(index, key); }
+
+    void readRows(int first, int count, const QVector<int> &keys, QGalleryRowBuffer *buffer) const
+    {
+        shared()->readRows(first, count, keys, buffer);
+    }
+};
+
+/*
+    A view onto a result set shared by several equivalent live requests.  Each cursor has its own
+    current index but reads rows straight from the shared result set's caches, so there's only
+    one query and one copy of the results however many views there are.
+*/
+
+QGalleryTrackerResultSetCursor::QGalleryTrackerResultSetCursor(
+        const QSharedPointer<QGalleryTrackerResultSet> &resultSet, QObject *parent)
+    : QGalleryResultSet(*new QGalleryTrackerResultSetCursorPrivate, parent)
+    , m_resultSet(resultSet)
+    , m_currentIndex(-1)
+{
+    updateSuspended(0, 1);
+
+    QGalleryTrackerResultSet *const set = m_resultSet.data();
+
+    connect(set, SIGNAL(finished()), this, SLOT(_q_finished()));
+    connect(set, SIGNAL(resumed()), this, SLOT(_q_resumed()));
+    connect(set, SIGNAL(progressChanged(int,int)), this, SIGNAL(progressChanged(int,int)));
+    connect(set, SIGNAL(itemsInserted(int,int)), this, SLOT(_q_itemsInserted(int,int)));
+    connect(set, SIGNAL(itemsRemoved(int,int)), this, SLOT(_q_itemsRemoved(int,int)));
+    connect(set, SIGNAL(itemsMoved(int,int,int)), this, SLOT(_q_itemsMoved(int,int,int)));
+    connect(set, SIGNAL(metaDataChanged(int,int,QList<int>)),
+            this, SLOT(_q_metaDataChanged(int,int,QList<int>)));
+
+    if (!set->isActive())
+        _q_finished();
+}
+
+QGalleryTrackerResultSetCursor::~QGalleryTrackerResultSetCursor()
+{
+    updateSuspended(isSuspended() ? -1 : 0, -1);
+}
+
+/*
+    The shared result set is only suspended while every cursor over it is.
+*/
+
+void QGalleryTrackerResultSetCursor::updateSuspended(int suspendedViews, int views)
+{
+    QGalleryTrackerResultSetPrivate *d = m_resultSet->d_func();
+
+    d->suspendedViewCount += suspendedViews;
+    d->viewCount += views;
+
+    if (d->viewCount > 0)
+        m_resultSet->setSuspended(d->suspendedViewCount == d->viewCount);
+}
+
+QSharedPointer<QGalleryTrackerResultSet> QGalleryTrackerResultSetCursor::resultSet() const
+{
+    return m_resultSet;
+}
+
+QStringList QGalleryTrackerResultSetCursor::propertyNames() const
+{
+    return m_resultSet->propertyNames();
+}
+
+int QGalleryTrackerResultSetCursor::propertyKey(const QString &property) const
+{
+    return m_resultSet->propertyKey(property);
+}
+
+QGalleryProperty::Attributes QGalleryTrackerResultSetCursor::propertyAttributes(int key) const
+{
+    return m_resultSet->propertyAttributes(key);
+}
+
+QVariant::Type QGalleryTrackerResultSetCursor::propertyType(int key) const
+{
+    return m_resultSet->propertyType(key);
+}
+
+int QGalleryTrackerResultSetCursor::itemCount() const
+{
+    return m_resultSet->itemCount();
+}
+
+int QGalleryTrackerResultSetCursor::currentIndex() const
+{
+    return m_currentIndex;
+}
+
+bool QGalleryTrackerResultSetCursor::fetch(int index)
+{
+    if (index != m_currentIndex) {
+        m_currentIndex = index;
+
+        Q_EMIT currentIndexChanged(m_currentIndex);
+        Q_EMIT currentItemChanged();
+    }
+
+    return !m_resultSet->d_func()->rowAt(m_currentIndex).isNull();
+}
+
+QVariant QGalleryTrackerResultSetCursor::itemId() const
+{
+    const QGalleryTrackerResultSetPrivate *d = m_resultSet->d_func();
+    const QGalleryTrackerRow row = d->rowAt(m_currentIndex);
+
+    return !row.isNull() ? d->idColumn->value(row) : QVariant();
+}
+
+QUrl QGalleryTrackerResultSetCursor::itemUrl() const
+{
+    const QGalleryTrackerResultSetPrivate *d = m_resultSet->d_func();
+    const QGalleryTrackerRow row = d->rowAt(m_currentIndex);
+
+    return !row.isNull() ? d->urlColumn->value(row).toUrl() : QUrl();
+}
+
+QString QGalleryTrackerResultSetCursor::itemType() const
+{
+    const QGalleryTrackerResultSetPrivate *d = m_resultSet->d_func();
+    const QGalleryTrackerRow row = d->rowAt(m_currentIndex);
+
+    return !row.isNull() ? d->typeColumn->value(row).toString() : QString();
+}
+
+QList<QGalleryResource> QGalleryTrackerResultSetCursor::resources() const
+{
+    const QGalleryTrackerResultSetPrivate *d = m_resultSet->d_func();
+
+    return d->resources(d->rowAt(m_currentIndex));
+}
+
+QVariant QGalleryTrackerResultSetCursor::metaData(int key) const
+{
+    const QGalleryTrackerResultSetPrivate *d = m_resultSet->d_func();
+
+    return d->value(d->rowAt(m_currentIndex), key);
+}
+
+bool QGalleryTrackerResultSetCursor::setMetaData(int key, const QVariant &value)
+{
+    // Edits are made through the shared result set's own current item, it reports the change
+    // back to every cursor.
+    m_resultSet->fetch(m_currentIndex);
+
+    return m_resultSet->setMetaData(key, value);
+}
+
+void QGalleryTrackerResultSetCursor::cancel()
+{
+    // Other cursors still depend on the shared result set, so it keeps running and this cursor
+    // keeps following its rows to stay consistent; only the response state is canceled.
+    QGalleryAbstractResponse::cancel();
+}
+
+bool QGalleryTrackerResultSetCursor::waitForFinished(int msecs)
+{
+    m_resultSet->waitForFinished(msecs);
+
+    return !isActive();
+}
+
+void QGalleryTrackerResultSetCursor::_q_finished()
+{
+    if (m_resultSet->error() != QDocumentGallery::NoError)
+        error(m_resultSet->error(), m_resultSet->errorString());
+    else
+        finish(m_resultSet->isIdle());
+}
+
+void QGalleryTrackerResultSetCursor::_q_resumed()
+{
+    resume();
+}
+
+void QGalleryTrackerResultSetCursor::_q_itemsInserted(int index, int count)
+{
+    Q_EMIT itemsInserted(index, count);
+
+    if (m_currentIndex >= index && m_currentIndex < m_resultSet->itemCount())
+        Q_EMIT currentItemChanged();
+}
+
+void QGalleryTrackerResultSetCursor::_q_itemsRemoved(int index, int count)
+{
+    const int originalIndex = m_currentIndex;
+
+    if (m_currentIndex >= index && m_currentIndex < index + count)
+        m_currentIndex = index;
+
+    Q_EMIT itemsRemoved(index, count);
+
+    if (originalIndex != m_currentIndex)
+        Q_EMIT currentIndexChanged(m_currentIndex);
+    if (m_currentIndex >= index)
+        Q_EMIT currentItemChanged();
+}
+
+void QGalleryTrackerResultSetCursor::_q_itemsMoved(int from, int to, int count)
+{
+    const int originalIndex = m_currentIndex;
+
+    m_currentIndex = QGalleryTrackerRowDiff::movedIndex(m_currentIndex, from, to, count);
+
+    Q_EMIT itemsMoved(from, to, count);
+
+    if (originalIndex != m_currentIndex)
+        Q_EMIT currentIndexChanged(m_currentIndex);
+}
+
+void QGalleryTrackerResultSetCursor::_q_metaDataChanged(
+        int index, int count, const QList<int> &keys)
+{
+    Q_EMIT metaDataChanged(index, count, keys);
+
+    if (m_currentIndex >= index && m_currentIndex < index + count)
+        Q_EMIT currentItemChanged();
+}
+
+QT_END_NAMESPACE_DOCGALLERY
+
+#include "moc_qgallerytrackerresultsetcursor_p.cpp"
@@ -0,0 +1,302 @@
+/****************************************************************************
+**
+** Copyright (C) 2012 Digia Plc and/or its subsidiary(-ies).
+** Contact: http://www.qt-project.org/legal
+**
+** This file is part of the QtDocGallery module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and Digia.  For licensing terms and
+** conditions see http://qt.digia.com/licensing.  For further information
+** use the contact form at http://qt.digia.com/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU Lesser General Public License version 2.1 requirements
+** will be met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** In addition, as a special exception, Digia gives you certain additional
+** rights.  These rights are described in the Digia Qt LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3.0 as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU General Public License version 3.0 requirements will be
+** met: http://www.gnu.org/copyleft/gpl.html.
+**
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "qgallerytrackerrowdiff_p.h"
+
+#include "qgallerytrackertable_p.h"
+
+#include <QtCore/qhash.h>
+
+#include <algorithm>
+
+QT_BEGIN_NAMESPACE_DOCGALLERY
+
+QGalleryTrackerRowDiff::QGalleryTrackerRowDiff(int identityWidth, int tableWidth)
+    : m_identityWidth(identityWidth)
+    , m_tableWidth(tableWidth)
+{
+}
+
+/*
+    Returns the position of the row at \a index after \a count rows starting at \a from are moved
+    in front of the row at \a to, with \a to given as an index before the move in the same way
+    as QAbstractItemModel::beginMoveRows().
+*/
+
+int QGalleryTrackerRowDiff::movedIndex(int index, int from, int to, int count)
+{
+    if (index >= from && index < from + count)
+        return index + (to < from ? to - from : to - from - count);
+    else if (to < from && index >= to && index < from)
+        return index + count;
+    else if (to > from && index >= from + count && index < to)
+        return index - count;
+    else
+        return index;
+}
+
+/*
+    Pairs up rows with the same identity and keeps the longest run of pairs which appear in
+    the same order in both caches.  If only a few of the remaining pairs are out of order they
+    are moved into place, otherwise they are reported as removed and inserted along with the
+    unpaired rows.
+*/
+
+void QGalleryTrackerRowDiff::matchRows(
+        QVector<Edit> *edits,
+        QVector<Anchor> *anchors,
+        const QGalleryTrackerTable &rTable,
+        int rBegin,
+        int rEnd,
+        const QGalleryTrackerTable &iTable,
+        int iBegin,
+        int iEnd) const
+{
+    QHash<QByteArray, int> rIndexes;
+    rIndexes.reserve(rEnd - rBegin);
+
+    // Insert in reverse so the first of any duplicate identities is the one matched.
+    for (int rIndex = rEnd - 1; rIndex >= rBegin; --rIndex)
+        rIndexes.insert(rTable.identity(rIndex, m_identityWidth), rIndex);
+
+    QVector<int> matches(iEnd - iBegin, -1);
+    int matchCount = 0;
+
+    for (int iIndex = iBegin; iIndex < iEnd; ++iIndex) {
+        QHash<QByteArray, int>::iterator it = rIndexes.find(
+                iTable.identity(iIndex, m_identityWidth));
+
+        if (it != rIndexes.end()) {
+            matches[iIndex - iBegin] = it.value();
+
+            rIndexes.erase(it);
+
+            ++matchCount;
+        }
+    }
+
+    // Longest increasing subsequence of the matched remove cache indexes.
+    QVector<int> tails;
+    QVector<int> previous(matches.count(), -1);
+
+    for (int i = 0; i < matches.count(); ++i) {
+        const int rIndex = matches.at(i);
+
+        if (rIndex < 0)
+            continue;
+
+        int lower = 0;
+        int upper = tails.count();
+        while (lower < upper) {
+            const int middle = (lower + upper) / 2;
+
+            if (matches.at(tails.at(middle)) < rIndex)
+                lower = middle + 1;
+            else
+                upper = middle;
+        }
+
+        if (lower > 0)
+            previous[i] = tails.at(lower - 1);
+
+        if (lower == tails.count())
+            tails.append(i);
+        else
+            tails[lower] = i;
+    }
+
+    QVector<bool> anchored(matches.count(), false);
+    for (int i = !tails.isEmpty() ? tails.last() : -1; i >= 0; i = previous.at(i))
+        anchored[i] = true;
+
+    const int moveCount = matchCount - tails.count();
+
+    if (moveCount == 0 || moveCount > MaximumMoves) {
+        for (int i = 0; i < matches.count(); ++i) {
+            if (anchored.at(i)) {
+                const Anchor anchor = { matches.at(i), iBegin + i, matches.at(i) };
+                anchors->append(anchor);
+            }
+        }
+        return;
+    }
+
+    // Move each out of order row, or run of rows, to follow the row which precedes it in
+    // the insert cache.  The order and position vectors track the effect of the moves on
+    // the remove cache.
+    QVector<int> order(rEnd - rBegin);
+    QVector<int> position(rEnd - rBegin);
+    for (int rIndex = rBegin; rIndex < rEnd; ++rIndex) {
+        order[rIndex - rBegin] = rIndex;
+        position[rIndex - rBegin] = rIndex;
+    }
+
+    for (int i = 0, preceding = -1; i < matches.count(); ) {
+        const int rIndex = matches.at(i);
+
+        if (rIndex < 0) {
+            i += 1;
+        } else if (anchored.at(i)) {
+            preceding = rIndex;
+
+            i += 1;
+        } else {
+            const int from = position.at(rIndex - rBegin);
+
+            int count = 1;
+            while (i + count < matches.count()
+                    && !anchored.at(i + count)
+                    && matches.at(i + count) == rIndex + count
+                    && position.at(rIndex + count - rBegin) == from + count) {
+                ++count;
+            }
+
+            const int to = preceding >= 0 ? position.at(preceding - rBegin) + 1 : rBegin;
+
+            if (to < from || to > from + count) {
+                const Edit edit = { Edit::Move, from, count, to, 0 };
+                edits->append(edit);
+
+                const QVector<int>::iterator begin = order.begin();
+                if (to < from) {
+                    std::rotate(
+                            begin + (to - rBegin),
+                            begin + (from - rBegin),
+                            begin + (from + count - rBegin));
+                } else {
+                    std::rotate(
+                            begin + (from - rBegin),
+                            begin + (from + count - rBegin),
+                            begin + (to - rBegin));
+                }
+
+                for (int n = qMin(from, to), end = qMax(from + count, to); n < end; ++n)
+                    position[order.at(n - rBegin) - rBegin] = n;
+            }
+
+            preceding = rIndex + count - 1;
+
+            i += count;
+        }
+    }
+
+    for (int i = 0; i < matches.count(); ++i) {
+        if (matches.at(i) >= 0) {
+            const Anchor anchor = {
+                position.at(matches.at(i) - rBegin), iBegin + i, matches.at(i) };
+            anchors->append(anchor);
+        }
+    }
+}
+
+QVector<QGalleryTrackerRowDiff::Edit> QGalleryTrackerRowDiff::diff(
+        const QGalleryTrackerTable &rTable, const QGalleryTrackerTable &iTable) const
+{
+    const int rCount = rTable.rowCount();
+    const int iCount = iTable.rowCount();
+
+    int prefix = 0;
+    while (prefix < rCount
+            && prefix < iCount
+            && rTable.isEqual(prefix, iTable, prefix, 0, m_identityWidth)) {
+        ++prefix;
+    }
+
+    int suffix = 0;
+    while (suffix < rCount - prefix
+            && suffix < iCount - prefix
+            && rTable.isEqual(
+                rCount - suffix - 1, iTable, iCount - suffix - 1, 0, m_identityWidth)) {
+        ++suffix;
+    }
+
+    QVector<Anchor> anchors;
+    anchors.reserve(qMin(rCount, iCount));
+
+    QVector<Edit> edits;
+
+    for (int n = 0; n < prefix; ++n) {
+        const Anchor anchor = { n, n, n };
+        anchors.append(anchor);
+    }
+
+    if (prefix < rCount - suffix && prefix < iCount - suffix)
+        matchRows(&edits, &anchors, rTable, prefix, rCount - suffix, iTable, prefix, iCount - suffix);
+
+    for (int n = suffix; n > 0; --n) {
+        const Anchor anchor = { rCount - n, iCount - n, rCount - n };
+        anchors.append(anchor);
+    }
+
+    int rIndex = 0;
+    int iIndex = 0;
+
+    for (QVector<Anchor>::const_iterator it = anchors.constBegin(); it != anchors.constEnd(); ++it) {
+        if (it->rIndex > rIndex || it->iIndex > iIndex) {
+            const Edit edit = {
+                Edit::Replace, rIndex, it->rIndex - rIndex, iIndex, it->iIndex - iIndex };
+            edits.append(edit);
+        }
+
+        if (!rTable.isEqual(it->rRow, iTable, it->iIndex, m_identityWidth, m_tableWidth)) {
+            if (!edits.isEmpty()
+                    && edits.last().type == Edit::Update
+                    && edits.last().rIndex + edits.last().rCount == it->rIndex
+                    && edits.last().iIndex + edits.last().iCount == it->iIndex) {
+                edits.last().rCount += 1;
+                edits.last().iCount += 1;
+            } else {
+                const Edit edit = { Edit::Update, it->rIndex, 1, it->iIndex, 1 };
+                edits.append(edit);
+            }
+        }
+
+        rIndex = it->rIndex + 1;
+        iIndex = it->iIndex + 1;
+    }
+
+    const Edit edit = { Edit::Finish, rIndex, rCount - rIndex, iIndex, iCount - iIndex };
+    edits.append(edit);
+
+    return edits;
+}
+
+QT_END_NAMESPACE_DOCGALLERY
@@ -0,0 +1,246 @@
+/****************************************************************************
+**
+** Copyright (C) 2012 Digia Plc and/or its subsidiary(-ies).
+** Contact: http://www.qt-project.org/legal
+**
+** This file is part of the QtDocGallery module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and Digia.  For licensing terms and
+** conditions see http://qt.digia.com/licensing.  For further information
+** use the contact form at http://qt.digia.com/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU Lesser General Public License version 2.1 requirements
+** will be met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** In addition, as a special exception, Digia gives you certain additional
+** rights.  These rights are described in the Digia Qt LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3.0 as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU General Public License version 3.0 requirements will be
+** met: http://www.gnu.org/copyleft/gpl.html.
+**
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "qgallerytrackerscheduler_p.h"
+
+#include <QtCore/qelapsedtimer.h>
+#include <QtCore/qthread.h>
+
+QT_BEGIN_NAMESPACE_DOCGALLERY
+
+class QGalleryTrackerTaskRunner : public QRunnable
+{
+public:
+    QGalleryTrackerTaskRunner(QGalleryTrackerScheduler *scheduler, QGalleryTrackerTask *task)
+        : m_scheduler(scheduler)
+        , m_task(task)
+    {
+        m_queueTimer.start();
+    }
+
+    void run()
+    {
+        m_scheduler->taskStarted(m_queueTimer.elapsed());
+
+        m_task->run();
+
+        m_scheduler->taskDone();
+
+        // The task may be destroyed as soon as it is released, so nothing past this point can
+        // reference it.
+        QMutexLocker locker(&m_task->m_mutex);
+
+        m_task->m_active = false;
+
+        if (m_task->m_orphaned) {
+            locker.unlock();
+
+            delete m_task;
+        } else {
+            m_task->taskFinished();
+            m_task->m_wait.wakeAll();
+        }
+    }
+
+private:
+    QGalleryTrackerScheduler *const m_scheduler;
+    QGalleryTrackerTask *const m_task;
+    QElapsedTimer m_queueTimer;
+};
+
+QGalleryTrackerTask::QGalleryTrackerTask()
+    : m_active(false)
+    , m_orphaned(false)
+{
+}
+
+QGalleryTrackerTask::~QGalleryTrackerTask()
+{
+    Q_ASSERT(!m_active);
+}
+
+bool QGalleryTrackerTask::isActive() const
+{
+    QMutexLocker locker(&m_mutex);
+
+    return m_active;
+}
+
+bool QGalleryTrackerTask::wait(int msecs)
+{
+    QMutexLocker locker(&m_mutex);
+
+    QElapsedTimer timer;
+    timer.start();
+
+    while (m_active) {
+        if (msecs < 0) {
+            m_wait.wait(&m_mutex);
+        } else {
+            const qint64 remaining = msecs - timer.elapsed();
+
+            if (remaining <= 0 || !m_wait.wait(&m_mutex, remaining))
+                return !m_active;
+        }
+    }
+    return true;
+}
+
+/*
+    Hands ownership of an active task over to the scheduler, which will delete it once it has run.
+
+    Returns true if the task was active and is now owned by the scheduler, and false if the
+    caller remains responsible for it.
+*/
+
+bool QGalleryTrackerTask::orphan()
+{
+    QMutexLocker locker(&m_mutex);
+
+    m_orphaned = m_active;
+
+    return m_orphaned;
+}
+
+Q_GLOBAL_STATIC(QGalleryTrackerScheduler, qt_galleryTrackerScheduler)
+
+QGalleryTrackerScheduler::QGalleryTrackerScheduler()
+    : m_statistics()
+{
+    bool ok = false;
+    const int threadCount = qgetenv("QT_GALLERY_TRACKER_THREADS").toInt(&ok);
+
+    // Tracker serves queries from a single process, beyond a few concurrent queries more
+    // threads only add contention.
+    m_pool.setMaxThreadCount(ok && threadCount > 0
+            ? threadCount
+            : qBound(1, QThread::idealThreadCount(), 4));
+}
+
+QGalleryTrackerScheduler::~QGalleryTrackerScheduler()
+{
+    m_pool.waitForDone();
+}
+
+QGalleryTrackerScheduler *QGalleryTrackerScheduler::instance()
+{
+    return qt_galleryTrackerScheduler();
+}
+
+int QGalleryTrackerScheduler::maxThreadCount() const
+{
+    return m_pool.maxThreadCount();
+}
+
+void QGalleryTrackerScheduler::setMaxThreadCount(int count)
+{
+    m_pool.setMaxThreadCount(qMax(1, count));
+}
+
+void QGalleryTrackerScheduler::start(QGalleryTrackerTask *task, Priority priority)
+{
+    {
+        QMutexLocker locker(&task->m_mutex);
+
+        Q_ASSERT(!task->m_active);
+
+        task->m_active = true;
+    }
+    {
+        QMutexLocker locker(&m_mutex);
+
+        m_statistics.queueDepth += 1;
+        m_statistics.maximumQueueDepth = qMax(
+                m_statistics.maximumQueueDepth, m_statistics.queueDepth);
+    }
+
+    m_pool.start(new QGalleryTrackerTaskRunner(this, task), priority);
+}
+
+bool QGalleryTrackerScheduler::waitForDone(int msecs)
+{
+    return m_pool.waitForDone(msecs);
+}
+
+int QGalleryTrackerScheduler::queueDepth() const
+{
+    QMutexLocker locker(&m_mutex);
+
+    return m_statistics.queueDepth;
+}
+
+QGalleryTrackerScheduler::Statistics QGalleryTrackerScheduler::statistics() const
+{
+    QMutexLocker locker(&m_mutex);
+
+    return m_statistics;
+}
+
+void QGalleryTrackerScheduler::resetStatistics()
+{
+    QMutexLocker locker(&m_mutex);
+
+    // Queued and running tasks are still accounted for when they complete.
+    m_statistics.maximumQueueDepth = m_statistics.queueDepth;
+    m_statistics.finishedCount = 0;
+    m_statistics.totalWaitTime = 0;
+    m_statistics.maximumWaitTime = 0;
+}
+
+void QGalleryTrackerScheduler::taskStarted(qint64 waitTime)
+{
+    QMutexLocker locker(&m_mutex);
+
+    m_statistics.queueDepth -= 1;
+    m_statistics.activeCount += 1;
+    m_statistics.totalWaitTime += waitTime;
+    m_statistics.maximumWaitTime = qMax(m_statistics.maximumWaitTime, waitTime);
+}
+
+void QGalleryTrackerScheduler::taskDone()
+{
+    QMutexLocker locker(&m_mutex);
+
+    m_statistics.activeCount -= 1;
+    m_statistics.finishedCount += 1;
+}
+
+QT_END_NAMESPACE_DOCGALLERY
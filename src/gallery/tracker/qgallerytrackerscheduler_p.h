@@ -0,0 +1,140 @@
+/****************************************************************************
+**
+** Copyright (C) 2012 Digia Plc and/or its subsidiary(-ies).
+** Contact: http://www.qt-project.org/legal
+**
+** This file is part of the QtDocGallery module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and Digia.  For licensing terms and
+** conditions see http://qt.digia.com/licensing.  For further information
+** use the contact form at http://qt.digia.com/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU Lesser General Public License version 2.1 requirements
+** will be met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** In addition, as a special exception, Digia gives you certain additional
+** rights.  These rights are described in the Digia Qt LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3.0 as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU General Public License version 3.0 requirements will be
+** met: http://www.gnu.org/copyleft/gpl.html.
+**
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#ifndef QGALLERYTRACKERSCHEDULER_P_H
+#define QGALLERYTRACKERSCHEDULER_P_H
+
+#include "qgalleryglobal.h"
+
+#include <QtCore/qmutex.h>
+#include <QtCore/qthreadpool.h>
+#include <QtCore/qwaitcondition.h>
+
+QT_BEGIN_NAMESPACE_DOCGALLERY
+
+class QGalleryTrackerTaskRunner;
+
+class Q_GALLERY_EXPORT QGalleryTrackerTask
+{
+public:
+    QGalleryTrackerTask();
+    virtual ~QGalleryTrackerTask();
+
+    bool isActive() const;
+    bool wait(int msecs = -1);
+
+    bool orphan();
+
+protected:
+    virtual void run() = 0;
+    virtual void taskFinished() {}
+
+private:
+    mutable QMutex m_mutex;
+    QWaitCondition m_wait;
+    bool m_active;
+    bool m_orphaned;
+
+    friend class QGalleryTrackerScheduler;
+    friend class QGalleryTrackerTaskRunner;
+};
+
+class Q_GALLERY_EXPORT QGalleryTrackerScheduler
+{
+public:
+    enum Priority
+    {
+        LowPriority,
+        NormalPriority,
+        HighPriority
+    };
+
+    struct Statistics
+    {
+        int queueDepth;
+        int maximumQueueDepth;
+        int activeCount;
+        int finishedCount;
+        qint64 totalWaitTime;
+        qint64 maximumWaitTime;
+    };
+
+    QGalleryTrackerScheduler();
+    ~QGalleryTrackerScheduler();
+
+    static QGalleryTrackerScheduler *instance();
+
+    int maxThreadCount() const;
+    void setMaxThreadCount(int count);
+
+    void start(QGalleryTrackerTask *task, Priority priority = NormalPriority);
+
+    bool waitForDone(int msecs = -1);
+
+    int queueDepth() const;
+    Statistics statistics() const;
+    void resetStatistics();
+
+private:
+    void taskStarted(qint64 waitTime);
+    void taskDone();
+
+    QThreadPool m_pool;
+    mutable QMutex m_mutex;
+    Statistics m_statistics;
+
+    friend class QGalleryTrackerTaskRunner;
+};
+
+QT_END_NAMESPACE_DOCGALLERY
+
+#endif
@@ -46,9 +46,11 @@
 #include "qgalleryabstractrequest.h"
 #include "qgallerytrackerresultset_p.h"
 #include "qgallerytrackerlistcolumn_p.h"
+#include "qgallerytrackerqueryplancache_p.h"
 
 #include <QtCore/qdatetime.h>
 #include <QtCore/qdir.h>
+#include <QtCore/qhash.h>
 #include <QtCore/qmetatype.h>
 #include <QtCore/qsettings.h>
 #include <QtCore/qstringlist.h>
@@ -98,6 +100,7 @@ namespace
         bool (*writeFilterCondition)(
                 QDocumentGallery::Error *error,
                 QString *query,
+                QStringList *parameters,
                 const QGalleryCompositeProperty &property,
                 const QGalleryMetaDataFilter &filter);
     };
@@ -116,10 +119,9 @@ namespace
         TextId          = 0x0080,
         ArtistId = 0x0100,
         AlbumId = 0x0200,
-        AlbumArtistId = ArtistId,
         PhotoAlbumId = 0x0400,
-        AudioGenreId = 0x0000
-
+        AlbumArtistId = 0x0800,
+        AudioGenreId = 0x1000
     };
 
     enum UpdateMask
@@ -139,12 +141,13 @@ namespace
         VideoMask       = VideoId,
         PlaylistMask    = PlaylistId,
         TextMask        = TextId,
-        ArtistMask = ArtistId,
-        AlbumMask = AlbumId,
-        AlbumArtistMask = AlbumArtistId,
+        // Artists, albums and genres are only listed while they have tracks, so they're also
+        // refreshed when tracks change.
+        ArtistMask = ArtistId | AudioId,
+        AlbumMask = AlbumId | AudioId,
+        AlbumArtistMask = AlbumArtistId | ArtistId | AlbumId | AudioId,
         PhotoAlbumMask = PhotoAlbumId,
-        AudioGenreMask = AudioMask
-
+        AudioGenreMask = AudioGenreId | AudioId
     };
 
     struct QGalleryTypePrefix : public QLatin1String
@@ -192,64 +195,6 @@ namespace
 
     typedef QGalleryTypeList<QGalleryItemType> QGalleryItemTypeList;
 
-    template <typename T>
-    int QGalleryPropertyList<T>::indexOfProperty(const QString &name) const
-    {
-        for (int i = 0; i < count; ++i) {
-            if (items[i].name == name)
-                return i;
-        }
-        return -1;
-    }
-
-    template <typename T>
-    int QGalleryTypeList<T>::indexOfType(const QString &type) const
-    {
-        for (int i = 0; i < count; ++i) {
-            if (items[i].itemType == type)
-                return i;
-        }
-        return -1;
-    }
-
-    template <typename T>
-    int QGalleryTypeList<T>::indexOfItemId(const QString &itemId) const
-    {
-        for (int i = 0; i < count; ++i) {
-            if (itemId.startsWith(items[i].prefix))
-                return i;
-        }
-        return -1;
-    }
-
-    template <typename T>
-    int QGalleryTypeList<T>::indexOfService(const QString &service) const
-    {
-        for (int i = 0; i < count; ++i) {
-            if (items[i].service == service)
-                return i;
-        }
-        return -1;
-    }
-
-    template <typename T>
-    int QGalleryTypeList<T>::indexOfRdfTypes(const QStringList &rdfTypes) const
-    {
-        int index = -1;
-        int rdfIndex = -1;
-        for (int i = 0; i < count; ++i) {
-            for (int j = rdfTypes.count() - 1; j >= 0; --j) {
-                if (rdfTypes.at(j).endsWith(items[i].rdfSuffix)) {
-                    if (j > rdfIndex) {
-                        index = i;
-                        rdfIndex = j;
-                    }
-                    break;
-                }
-            }
-        }
-        return index;
-    }
     // Re-declare to cut down on prefixes.
     enum
     {
@@ -373,6 +318,7 @@ static void qt_appendJoin(QString *currentJoin, const QString &typeJoin, const Q
 static bool qt_writeCondition(
         QDocumentGallery::Error *error,
         QString *query,
+        QStringList *parameters,
         QString *join,
         const QString &typeJoin,
         const QGalleryFilter &filter,
@@ -382,6 +328,7 @@ static bool qt_writeCondition(
 static bool qt_writeConditionHelper(
         QDocumentGallery::Error *error,
         QString *query,
+        QStringList *parameters,
         QString *join,
         const QString &typeJoin,
         const QList<QGalleryFilter> &filters,
@@ -397,7 +344,7 @@ static bool qt_writeConditionHelper(
         for (QList<QGalleryFilter>::const_iterator it = filters.begin(), end = filters.end();
                 it != end;
                 ++it) {
-            if (!qt_writeCondition(error, query, join, typeJoin, *it, properties, composites))
+            if (!qt_writeCondition(error, query, parameters, join, typeJoin, *it, properties, composites))
                 return false;
             if ( --count > 0 )
                 *query += op;
@@ -410,25 +357,33 @@ static bool qt_writeConditionHelper(
 static bool qt_writeCondition(
         QDocumentGallery::Error *error,
         QString *query,
+        QStringList *parameters,
         QString *join,
         const QString &typeJoin,
         const QGalleryIntersectionFilter &filter,
         const QGalleryItemPropertyList &properties,
         const QGalleryCompositePropertyList &composites)
 {
-    return qt_writeConditionHelper(error, query, join, typeJoin, filter.filters(), properties, composites, QLatin1String("&&"));
+    return qt_writeConditionHelper(error, query, parameters, join, typeJoin, filter.filters(), properties, composites, QLatin1String("&&"));
 }
 
 static bool qt_writeCondition(
         QDocumentGallery::Error *error,
         QString *query,
+        QStringList *parameters,
         QString *join,
         const QString &typeJoin,
         const QGalleryUnionFilter &filter,
         const QGalleryItemPropertyList &properties,
         const QGalleryCompositePropertyList &composites)
 {
-    return qt_writeConditionHelper(error, query, join, typeJoin, filter.filters(), properties, composites, QLatin1String("||"));
+    return qt_writeConditionHelper(error, query, parameters, join, typeJoin, filter.filters(), properties, composites, QLatin1String("||"));
+}
+
+static void qt_write_parameter(QString *query, QStringList *parameters, const QString &value)
+{
+    *query += QLatin1String("~p") + QString::number(parameters->count());
+    parameters->append(value);
 }
 
 static bool qt_write_comparison(
@@ -437,6 +392,7 @@ static bool qt_write_comparison(
         const QVariant &value,
         const char *op,
         QString *query,
+        QStringList *parameters,
         QVariant::Type type = QVariant::String)
 {
     QString stringValue;
@@ -452,10 +408,9 @@ static bool qt_write_comparison(
 
     *query += QLatin1String("(")
             + field
-            + QLatin1String(op)
-            + QLatin1String("'")
-            + stringValue
-            + QLatin1String("')");
+            + QLatin1String(op);
+    qt_write_parameter(query, parameters, stringValue);
+    *query += QLatin1Char(')');
 
     return true;
 }
@@ -465,14 +420,15 @@ static bool qt_write_function(
         const char *function,
         const QString &field,
         const QRegExp &regExp,
-        QString *query)
+        QString *query,
+        QStringList *parameters)
 {
     *query += QLatin1String(function)
             + QLatin1String("(")
             + field
-            + QLatin1String(",'")
-            + regExp.pattern()
-            + QLatin1String("')");
+            + QLatin1Char(',');
+    qt_write_parameter(query, parameters, regExp.pattern());
+    *query += QLatin1Char(')');
     return true;
 }
 
@@ -482,6 +438,7 @@ static bool qt_write_function(
         const QString &field,
         const QVariant &value,
         QString *query,
+        QStringList *parameters,
         QVariant::Type type = QVariant::String)
 {
     QString stringValue;
@@ -498,9 +455,9 @@ static bool qt_write_function(
     *query += QLatin1String(function)
             + QLatin1String("(")
             + field
-            + QLatin1String(",'")
-            + stringValue
-            + QLatin1String("')");
+            + QLatin1Char(',');
+    qt_write_parameter(query, parameters, stringValue);
+    *query += QLatin1Char(')');
 
     return true;
 }
@@ -508,6 +465,7 @@ static bool qt_write_function(
 static bool qt_writeCondition(
         QDocumentGallery::Error *error,
         QString *query,
+        QStringList *parameters,
         QString *join,
         const QString &typeJoin,
         const QGalleryMetaDataFilter &filter,
@@ -531,28 +489,28 @@ static bool qt_writeCondition(
         switch (filter.comparator()) {
         case QGalleryFilter::Equals:
             return value.type() != QVariant::RegExp
-                    ? qt_write_comparison(error, property.field, value, "=", query, property.type)
-                    : qt_write_function(error, "REGEX", properties[index].field, value.toRegExp(), query);
+                    ? qt_write_comparison(error, property.field, value, "=", query, parameters, property.type)
+                    : qt_write_function(error, "REGEX", properties[index].field, value.toRegExp(), query, parameters);
         case QGalleryFilter::LessThan:
-            return qt_write_comparison(error, property.field, value, "<", query, property.type);
+            return qt_write_comparison(error, property.field, value, "<", query, parameters, property.type);
         case QGalleryFilter::GreaterThan:
-            return qt_write_comparison(error, property.field, value, ">", query, property.type);
+            return qt_write_comparison(error, property.field, value, ">", query, parameters, property.type);
         case QGalleryFilter::LessThanEquals:
-            return qt_write_comparison(error, property.field, value, "<=", query, property.type);
+            return qt_write_comparison(error, property.field, value, "<=", query, parameters, property.type);
         case QGalleryFilter::GreaterThanEquals:
-            return qt_write_comparison(error, property.field, value, ">=", query, property.type);
+            return qt_write_comparison(error, property.field, value, ">=", query, parameters, property.type);
         case QGalleryFilter::Contains:
-            return  qt_write_function(error, "fn:contains", property.field, value, query, property.type);
+            return  qt_write_function(error, "fn:contains", property.field, value, query, parameters, property.type);
         case QGalleryFilter::StartsWith:
-            return qt_write_function(error, "fn:starts-with", property.field, value, query, property.type);
+            return qt_write_function(error, "fn:starts-with", property.field, value, query, parameters, property.type);
         case QGalleryFilter::EndsWith:
-            return qt_write_function(error, "fn:ends-with", property.field, value, query, property.type);
+            return qt_write_function(error, "fn:ends-with", property.field, value, query, parameters, property.type);
         case QGalleryFilter::Wildcard:
-            return qt_write_function(error, "fn:contains", property.field, value, query, property.type);
+            return qt_write_function(error, "fn:contains", property.field, value, query, parameters, property.type);
         case QGalleryFilter::RegExp:
             return value.type() != QVariant::RegExp
-                    ? qt_write_function(error, "REGEX", property.field, value, query, property.type)
-                    : qt_write_function(error, "REGEX", property.field, value.toRegExp(), query);
+                    ? qt_write_function(error, "REGEX", property.field, value, query, parameters, property.type)
+                    : qt_write_function(error, "REGEX", property.field, value.toRegExp(), query, parameters);
         default:
             *error = QDocumentGallery::FilterError;
 
@@ -561,7 +519,7 @@ static bool qt_writeCondition(
         return true;
     } else if ((index = composites.indexOfProperty(propertyName)) != -1
             && composites[index].writeFilterCondition) {
-        return composites[index].writeFilterCondition(error, query, composites[index], filter);
+        return composites[index].writeFilterCondition(error, query, parameters, composites[index], filter);
     } else {
         *error = QDocumentGallery::FilterError;
         return false;
@@ -571,6 +529,7 @@ static bool qt_writeCondition(
 static bool qt_writeCondition(
         QDocumentGallery::Error *error,
         QString *query,
+        QStringList *parameters,
         QString *join,
         const QString &typeJoin,
         const QGalleryFilter &filter,
@@ -580,11 +539,13 @@ static bool qt_writeCondition(
     switch (filter.type()) {
     case QGalleryFilter::Intersection:
         return qt_writeCondition(
-                error, query, join, typeJoin, filter.toIntersectionFilter(), properties, composites);
+                error, query, parameters, join, typeJoin, filter.toIntersectionFilter(), properties, composites);
     case QGalleryFilter::Union:
-        return qt_writeCondition(error, query, join, typeJoin, filter.toUnionFilter(), properties, composites);
+        return qt_writeCondition(
+                error, query, parameters, join, typeJoin, filter.toUnionFilter(), properties, composites);
     case QGalleryFilter::MetaData:
-        return qt_writeCondition(error, query, join, typeJoin, filter.toMetaDataFilter(), properties, composites);
+        return qt_writeCondition(
+                error, query, parameters, join, typeJoin, filter.toMetaDataFilter(), properties, composites);
     default:
         Q_ASSERT(filter.type() != QGalleryFilter::Invalid);
         *error = QDocumentGallery::FilterError;
@@ -594,21 +555,18 @@ static bool qt_writeCondition(
 
 static QString qt_encodedFilePathUrl(const QString &filePath)
 {
-    QString encodedUrl = QUrl::fromLocalFile(filePath).toString(QUrl::FullyEncoded);
-    encodedUrl.replace(QLatin1Char('\''), QLatin1String("\\\'"));
-    return encodedUrl;
+    return QUrl::fromLocalFile(filePath).toString(QUrl::FullyEncoded);
 }
 
 static QString qt_encodedFilePathFragment(const QString &fragment)
 {
-    QString encodedFragment = QUrl(fragment).toString(QUrl::FullyEncoded);
-    encodedFragment.replace(QLatin1Char('\''), QLatin1String("\\\'"));
-    return encodedFragment;
+    return QUrl(fragment).toString(QUrl::FullyEncoded);
 }
 
 static bool qt_writeFilePathUrlCondition(
         QDocumentGallery::Error *error,
         QString *query,
+        QStringList *parameters,
         const QLatin1String &property,
         const QGalleryMetaDataFilter &filter)
 {
@@ -623,31 +581,31 @@ static bool qt_writeFilePathUrlCondition(
         switch (filter.comparator()) {
         case QGalleryFilter::Equals:
             return qt_write_comparison(
-                    error, property, qt_encodedFilePathUrl(filePath), "=", query);
+                    error, property, qt_encodedFilePathUrl(filePath), "=", query, parameters);
         case QGalleryFilter::LessThan:
             return qt_write_comparison(
-                    error, property, qt_encodedFilePathUrl(filePath), "<", query);
+                    error, property, qt_encodedFilePathUrl(filePath), "<", query, parameters);
         case QGalleryFilter::GreaterThan:
             return qt_write_comparison(
-                    error, property, qt_encodedFilePathUrl(filePath), ">", query);
+                    error, property, qt_encodedFilePathUrl(filePath), ">", query, parameters);
         case QGalleryFilter::LessThanEquals:
             return qt_write_comparison(
-                    error, property, qt_encodedFilePathUrl(filePath), "<=", query);
+                    error, property, qt_encodedFilePathUrl(filePath), "<=", query, parameters);
         case QGalleryFilter::GreaterThanEquals:
             return qt_write_comparison(
-                    error, property, qt_encodedFilePathUrl(filePath), ">=", query);
+                    error, property, qt_encodedFilePathUrl(filePath), ">=", query, parameters);
         case QGalleryFilter::Contains:
             return  qt_write_function(
-                    error, "fn:contains", property, qt_encodedFilePathFragment(filePath), query);
+                    error, "fn:contains", property, qt_encodedFilePathFragment(filePath), query, parameters);
         case QGalleryFilter::StartsWith:
             return qt_write_function(
-                    error, "fn:starts-with", property, qt_encodedFilePathUrl(filePath), query);
+                    error, "fn:starts-with", property, qt_encodedFilePathUrl(filePath), query, parameters);
         case QGalleryFilter::EndsWith:
             return qt_write_function(
-                    error, "fn:ends-with", property, qt_encodedFilePathFragment(filePath), query);
+                    error, "fn:ends-with", property, qt_encodedFilePathFragment(filePath), query, parameters);
         case QGalleryFilter::Wildcard:
             return qt_write_function(
-                    error, "fn:contains", property, qt_encodedFilePathUrl(filePath), query);
+                    error, "fn:contains", property, qt_encodedFilePathUrl(filePath), query, parameters);
         case QGalleryFilter::RegExp:    // Unsupported.
         default:
             *error = QDocumentGallery::FilterError;
@@ -659,24 +617,27 @@ static bool qt_writeFilePathUrlCondition(
 static bool qt_writeFilePathCondition(
         QDocumentGallery::Error *error,
         QString *query,
+        QStringList *parameters,
         const QGalleryCompositeProperty &,
         const QGalleryMetaDataFilter &filter)
 {
-    return qt_writeFilePathUrlCondition(error, query, QLatin1String("nie:isStoredAs(?x)"), filter);
+    return qt_writeFilePathUrlCondition(error, query, parameters, QLatin1String("nie:isStoredAs(?x)"), filter);
 }
 
 static bool qt_writeFilePathCondition_fs(
         QDocumentGallery::Error *error,
         QString *query,
+        QStringList *parameters,
         const QGalleryCompositeProperty &,
         const QGalleryMetaDataFilter &filter)
 {
-    return qt_writeFilePathUrlCondition(error, query, QLatin1String("?x"), filter);
+    return qt_writeFilePathUrlCondition(error, query, parameters, QLatin1String("?x"), filter);
 }
 
 static bool qt_writeFileExtensionCondition_helper(
         QDocumentGallery::Error *error,
         QString *query,
+        QStringList *parameters,
         const QGalleryCompositeProperty &,
         const QGalleryMetaDataFilter &filter, bool direct)
 {
@@ -684,31 +645,34 @@ static bool qt_writeFileExtensionCondition_helper(
         *error = QDocumentGallery::FilterError;
         return false;
     } else {
-        *query += (direct ? QLatin1String("fn:ends-with(nfo:fileName(?x),'.")
-                          : QLatin1String("fn:ends-with(nfo:fileName(nie:isStoredAs(?x)),'."))
-                + filter.value().toString()
-                + QLatin1String("')");
+        *query += direct ? QLatin1String("fn:ends-with(nfo:fileName(?x),")
+                         : QLatin1String("fn:ends-with(nfo:fileName(nie:isStoredAs(?x)),");
+        qt_write_parameter(query, parameters, QLatin1Char('.') + filter.value().toString());
+        *query += QLatin1Char(')');
         return true;
     }
 }
 
 static bool qt_writeFileExtensionCondition(QDocumentGallery::Error *error, QString *query,
+                                           QStringList *parameters,
                                            const QGalleryCompositeProperty &property,
                                            const QGalleryMetaDataFilter &filter)
 {
-    return qt_writeFileExtensionCondition_helper(error, query, property, filter, false);
+    return qt_writeFileExtensionCondition_helper(error, query, parameters, property, filter, false);
 }
 
 static bool qt_writeFileExtensionCondition_fs(QDocumentGallery::Error *error, QString *query,
+                                              QStringList *parameters,
                                               const QGalleryCompositeProperty &property,
                                               const QGalleryMetaDataFilter &filter)
 {
-    return qt_writeFileExtensionCondition_helper(error, query, property, filter, true);
+    return qt_writeFileExtensionCondition_helper(error, query, parameters, property, filter, true);
 }
 
 static bool qt_writeOrientationCondition(
         QDocumentGallery::Error *error,
         QString *query,
+        QStringList *,
         const QGalleryCompositeProperty &,
         const QGalleryMetaDataFilter &filter)
 {
@@ -1095,12 +1059,135 @@ static const QGalleryItemType qt_galleryItemTypeList[] =
     QT_GALLERY_AGGREGATE_TYPE_NO_COMPOSITE(AudioGenre, "tracker:Audio", nmm, MusicPiece, nfo:genre(?x), audioGenre, AudioGenre),
 };
 
+namespace
+{
+    // Hashes of the names in the static schema tables, built once on first use so lookups
+    // don't have to scan the tables comparing each entry.
+    class QGallerySchemaIndex
+    {
+    public:
+        QGallerySchemaIndex();
+
+        QHash<const void *, QHash<QString, int> > properties;
+        QHash<QString, int> types;
+        QHash<QString, int> prefixes;
+        QHash<QString, int> services;
+        QHash<QString, int> rdfSuffixes;
+        QHash<QString, QList<int> > graphUpdateIds;
+        QHash<QString, QList<int> > rdfTypeUpdateIds;
+
+    private:
+        template <typename T> void insertProperties(const QGalleryPropertyList<T> &list);
+    };
+
+    QGallerySchemaIndex::QGallerySchemaIndex()
+    {
+        const QGalleryItemTypeList itemTypes(qt_galleryItemTypeList);
+
+        for (int i = 0; i < itemTypes.count; ++i) {
+            const QGalleryItemType &type = itemTypes[i];
+
+            if (!types.contains(type.itemType))
+                types.insert(type.itemType, i);
+            if (!prefixes.contains(type.prefix))
+                prefixes.insert(type.prefix, i);
+            if (!services.contains(type.service))
+                services.insert(type.service, i);
+            if (!rdfSuffixes.contains(type.rdfSuffix))
+                rdfSuffixes.insert(type.rdfSuffix, i);
+            graphUpdateIds[type.trackerGraph].append(type.updateId);
+            rdfTypeUpdateIds[type.rdfSuffix].append(type.updateId);
+
+            insertProperties(type.itemProperties);
+            insertProperties(type.compositeProperties);
+
+            for (int j = 0; j < type.compositeProperties.count; ++j)
+                insertProperties(type.compositeProperties[j].dependencies);
+        }
+    }
+
+    template <typename T>
+    void QGallerySchemaIndex::insertProperties(const QGalleryPropertyList<T> &list)
+    {
+        if (list.count == 0 || properties.contains(list.items))
+            return;
+
+        QHash<QString, int> &names = properties[list.items];
+        names.reserve(list.count);
+
+        for (int i = 0; i < list.count; ++i) {
+            if (!names.contains(list.items[i].name))
+                names.insert(list.items[i].name, i);
+        }
+    }
+}
+
+Q_GLOBAL_STATIC(QGallerySchemaIndex, qt_gallerySchemaIndex)
+
+namespace
+{
+    template <typename T>
+    int QGalleryPropertyList<T>::indexOfProperty(const QString &name) const
+    {
+        if (count == 0)
+            return -1;
+
+        const QHash<const void *, QHash<QString, int> >::const_iterator names
+                = qt_gallerySchemaIndex()->properties.constFind(items);
+        if (names != qt_gallerySchemaIndex()->properties.constEnd())
+            return names->value(name, -1);
+
+        for (int i = 0; i < count; ++i) {
+            if (items[i].name == name)
+                return i;
+        }
+        return -1;
+    }
+
+    template <typename T>
+    int QGalleryTypeList<T>::indexOfType(const QString &type) const
+    {
+        return qt_gallerySchemaIndex()->types.value(type, -1);
+    }
+
+    template <typename T>
+    int QGalleryTypeList<T>::indexOfItemId(const QString &itemId) const
+    {
+        const int length = itemId.indexOf(QLatin1String("::"));
+
+        return length != -1
+                ? qt_gallerySchemaIndex()->prefixes.value(itemId.left(length + 2), -1)
+                : -1;
+    }
+
+    template <typename T>
+    int QGalleryTypeList<T>::indexOfService(const QString &service) const
+    {
+        return qt_gallerySchemaIndex()->services.value(service, -1);
+    }
+
+    template <typename T>
+    int QGalleryTypeList<T>::indexOfRdfTypes(const QStringList &rdfTypes) const
+    {
+        // Types are listed from the least to the most derived, take the last one that's known.
+        for (int j = rdfTypes.count() - 1; j >= 0; --j) {
+            const QString &rdfType = rdfTypes.at(j);
+            const int index = qt_gallerySchemaIndex()->rdfSuffixes.value(
+                    rdfType.mid(rdfType.lastIndexOf(QLatin1Char('/'))), -1);
+            if (index != -1)
+                return index;
+        }
+        return -1;
+    }
+}
+
 class QGalleryTrackerServicePrefixColumn : public QGalleryTrackerCompositeColumn
 {
 public:
     QGalleryTrackerServicePrefixColumn() {}
 
-    QVariant value(QVector<QVariant>::const_iterator row) const;
+    QGalleryTrackerServicePrefixColumn *clone() const { return new QGalleryTrackerServicePrefixColumn(*this); }
+    QVariant value(const QGalleryTrackerRow &row) const;
 };
 
 class QGalleryTrackerServiceTypeColumn : public QGalleryTrackerCompositeColumn
@@ -1108,7 +1195,8 @@ class QGalleryTrackerServiceTypeColumn : public QGalleryTrackerCompositeColumn
 public:
     QGalleryTrackerServiceTypeColumn() {}
 
-    QVariant value(QVector<QVariant>::const_iterator row) const;
+    QGalleryTrackerServiceTypeColumn *clone() const { return new QGalleryTrackerServiceTypeColumn(*this); }
+    QVariant value(const QGalleryTrackerRow &row) const;
 };
 
 class QGalleryTrackerServiceIndexColumn : public QGalleryTrackerValueColumn
@@ -1116,37 +1204,44 @@ class QGalleryTrackerServiceIndexColumn : public QGalleryTrackerValueColumn
 public:
     QGalleryTrackerServiceIndexColumn() {}
 
-    QVariant toVariant(TrackerSparqlCursor *cursor, int index) const;
+    QGalleryTrackerServiceIndexColumn *clone() const { return new QGalleryTrackerServiceIndexColumn(*this); }
+    QVariant::Type type() const { return QVariant::Int; }
+    void appendValue(
+            TrackerSparqlCursor *cursor, int index, QGalleryTrackerValueStore *store) const;
 };
 
-QVariant QGalleryTrackerServicePrefixColumn::value(QVector<QVariant>::const_iterator row) const
+QVariant QGalleryTrackerServicePrefixColumn::value(const QGalleryTrackerRow &row) const
 {
     QGalleryItemTypeList itemTypes(qt_galleryItemTypeList);
 
-    const int index = (row + 2)->toInt();
+    const int index = row.value(2).toInt();
 
     return index != -1
-            ? QVariant(QString(itemTypes[index].prefix) + row->toString())
-            : QVariant(QLatin1String("file::") + row->toString());
+            ? QVariant(QString(itemTypes[index].prefix) + row.value(0).toString())
+            : QVariant(QLatin1String("file::") + row.value(0).toString());
 }
 
-QVariant QGalleryTrackerServiceTypeColumn::value(QVector<QVariant>::const_iterator row) const
+QVariant QGalleryTrackerServiceTypeColumn::value(const QGalleryTrackerRow &row) const
 {
     QGalleryItemTypeList itemTypes(qt_galleryItemTypeList);
 
-    const int index = (row + 2)->toInt();
+    const int index = row.value(2).toInt();
 
     return index != -1
             ? QVariant(itemTypes[index].itemType)
             : QVariant(QLatin1String("File"));
 }
 
-QVariant QGalleryTrackerServiceIndexColumn::toVariant(TrackerSparqlCursor *cursor, int index) const
+void QGalleryTrackerServiceIndexColumn::appendValue(
+        TrackerSparqlCursor *cursor, int index, QGalleryTrackerValueStore *store) const
 {
     QGalleryItemTypeList itemTypes(qt_galleryItemTypeList);
 
-    return itemTypes.indexOfRdfTypes(QString::fromUtf8(
-                tracker_sparql_cursor_get_string(cursor, index, 0)).split(QLatin1Char(',')));
+    const QStringList rdfTypes = QString::fromUtf8(
+                tracker_sparql_cursor_get_string(cursor, index, 0)).split(QLatin1Char(','));
+
+    static_cast<QGalleryTrackerNumericStore<int> *>(store)->append(
+                itemTypes.indexOfRdfTypes(rdfTypes));
 }
 
 QGalleryTrackerSchema::QGalleryTrackerSchema(const QString &itemType)
@@ -1182,15 +1277,26 @@ int QGalleryTrackerSchema::serviceUpdateId(const QString &service)
 
 QList<int> QGalleryTrackerSchema::graphUpdateIds(const QString &graph)
 {
-    QList<int> result;
-    QGalleryItemTypeList itemTypes(qt_galleryItemTypeList);
-    for (int i = 0; i < itemTypes.count; ++i) {
-        if (itemTypes[i].trackerGraph == graph) {
-            result.append(itemTypes[i].updateId);
+    return qt_gallerySchemaIndex()->graphUpdateIds.value(graph);
+}
+
+QList<int> QGalleryTrackerSchema::rdfTypeUpdateIds(const QStringList &rdfTypes)
+{
+    const QHash<QString, QList<int> > &typeUpdateIds = qt_gallerySchemaIndex()->rdfTypeUpdateIds;
+
+    QList<int> updateIds;
+
+    typedef QStringList::const_iterator iterator;
+    for (iterator it = rdfTypes.begin(), end = rdfTypes.end(); it != end; ++it) {
+        const QList<int> ids = typeUpdateIds.value(it->mid(it->lastIndexOf(QLatin1Char('/'))));
+
+        typedef QList<int>::const_iterator id_iterator;
+        for (id_iterator id = ids.begin(), idEnd = ids.end(); id != idEnd; ++id) {
+            if (!updateIds.contains(*id))
+                updateIds.append(*id);
         }
     }
-
-    return result;
+    return updateIds;
 }
 
 QStringList QGalleryTrackerSchema::supportedPropertyNames() const
@@ -1254,24 +1360,60 @@ QDocumentGallery::Error QGalleryTrackerSchema::prepareQueryResponse(
         const QStringList &propertyNames,
         const QStringList &sortPropertyNames,
         int offset,
-        int limit) const
+        int limit,
+        QGalleryTrackerQueryPlanCache *planCache) const
 {
     if (m_itemIndex < 0) {
         return QDocumentGallery::ItemTypeError;
     } else {
-        QString query;
-        QString join;
-        QString optionalJoin;
-
-        QDocumentGallery::Error error = buildFilterQuery(&query, &join, &optionalJoin, scope, rootItemId, filter);
+        QGalleryTrackerQueryPlanKey key;
+
+        // Filter values are bound as parameters so the filter text only depends on the shape
+        // of the filter and identifies the plan along with the rest of the request.
+        QDocumentGallery::Error error = buildFilterQuery(
+                &key.filter,
+                &arguments->parameters,
+                &key.join,
+                &key.optionalJoin,
+                scope,
+                rootItemId,
+                filter);
 
         if (error != QDocumentGallery::NoError) {
             return error;
-        } else {
+        } else if (!planCache) {
             populateItemArguments(
-                    arguments, query, join, optionalJoin, propertyNames, sortPropertyNames, offset, limit);
+                    arguments,
+                    key.filter,
+                    key.join,
+                    key.optionalJoin,
+                    propertyNames,
+                    sortPropertyNames,
+                    offset,
+                    limit);
 
             return QDocumentGallery::NoError;
+        } else {
+            key.itemIndex = m_itemIndex;
+            key.propertyNames = propertyNames;
+            key.sortPropertyNames = sortPropertyNames;
+            key.offset = offset;
+            key.limit = limit;
+
+            if (!planCache->restore(key, arguments)) {
+                populateItemArguments(
+                        arguments,
+                        key.filter,
+                        key.join,
+                        key.optionalJoin,
+                        propertyNames,
+                        sortPropertyNames,
+                        offset,
+                        limit);
+
+                planCache->insert(key, *arguments);
+            }
+            return QDocumentGallery::NoError;
         }
     }
 }
@@ -1325,6 +1467,7 @@ QDocumentGallery::Error QGalleryTrackerSchema::prepareTypeResponse(
 
 QDocumentGallery::Error QGalleryTrackerSchema::buildFilterQuery(
         QString *query,
+        QStringList *parameters,
         QString *join,
         QString *optionalJoin,
         QGalleryQueryRequest::Scope scope,
@@ -1447,6 +1590,7 @@ QDocumentGallery::Error QGalleryTrackerSchema::buildFilterQuery(
         qt_writeCondition(
                 &result,
                 &filterStatement,
+                parameters,
                 optionalJoin,
                 *join,
                 filter,
@@ -1684,14 +1828,17 @@ void QGalleryTrackerSchema::populateItemArguments(
         parameterSelectList += QString::fromLatin1("%1 as ?p%2 ").arg(fieldNames.at(i)).arg(i);
     }
 
-    arguments->sparql
+    const QString selectFragment
             = QLatin1String("SELECT ")
             + parameterList
             + QLatin1String(" WHERE { GRAPH ")
             + qt_galleryItemTypeList[m_itemIndex].trackerGraph
             + QLatin1String(" { SELECT ")
             + parameterSelectList
-            + QLatin1String("WHERE {")
+            + QLatin1String("WHERE {");
+
+    arguments->pageSparql
+            = selectFragment
             + qt_galleryItemTypeList[m_itemIndex].typeFragment
             + join
             + completeJoin
@@ -1702,11 +1849,59 @@ void QGalleryTrackerSchema::populateItemArguments(
             + sortFragment
             + QLatin1String("}}");
 
+    arguments->sparql = arguments->pageSparql;
+
     if (offset > 0)
         arguments->sparql += QString::fromLatin1(" OFFSET %1").arg(offset);
     if (limit > 0)
         arguments->sparql += QString::fromLatin1(" LIMIT %1").arg(limit);
 
+    arguments->offset = offset;
+    arguments->limit = limit;
+
+    // Changed resources of plain item types can be re-read on their own by restricting ?x to a
+    // VALUES list inserted at the start of the inner WHERE clause.  Placing them again requires
+    // an unwindowed query and the sort keys of every row.
+    bool refreshResources = (qt_galleryItemTypeList[m_itemIndex].updateId & FileMask)
+            && offset <= 0
+            && limit <= 0;
+
+    for (QStringList::const_iterator it = sortPropertyNames.constBegin();
+            refreshResources && it != sortPropertyNames.constEnd();
+            ++it) {
+        const int propertyIndex = it->startsWith(QLatin1Char('-')) || it->startsWith(QLatin1Char('+'))
+                ? itemProperties.indexOfProperty(it->mid(1))
+                : itemProperties.indexOfProperty(*it);
+
+        if (propertyIndex != -1) {
+            const int fieldIndex = arguments->fieldNames.indexOf(itemProperties[propertyIndex].field);
+
+            if (fieldIndex >= 0)
+                arguments->sortColumns.append(arguments->valueOffset + fieldIndex);
+            else
+                refreshResources = false;
+        }
+    }
+
+    if (refreshResources) {
+        arguments->resourceSparql = arguments->pageSparql;
+        arguments->resourceValuesIndex = selectFragment.length();
+    } else {
+        arguments->sortColumns.clear();
+    }
+
+    arguments->countSparql
+            = QLatin1String("SELECT COUNT(DISTINCT ")
+            + qt_galleryItemTypeList[m_itemIndex].identity
+            + QLatin1String(") WHERE { GRAPH ")
+            + qt_galleryItemTypeList[m_itemIndex].trackerGraph
+            + QLatin1String(" {")
+            + qt_galleryItemTypeList[m_itemIndex].typeFragment
+            + join
+            + optionalJoin
+            + query
+            + QLatin1String("}}");
+
     arguments->propertyNames = valueNames + compositeNames + aliasNames;
     arguments->propertyAttributes = valueAttributes + compositeAttributes + aliasAttributes;
     arguments->propertyTypes = valueTypes + compositeTypes + aliasTypes;
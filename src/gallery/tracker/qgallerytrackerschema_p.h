@@ -66,6 +66,7 @@ QT_BEGIN_NAMESPACE_DOCGALLERY
 
 class QGalleryDBusInterfaceFactory;
 class QGalleryTrackerImageColumn;
+class QGalleryTrackerQueryPlanCache;
 class QGalleryTrackerValueColumn;
 
 struct QGalleryTrackerResultSetArguments;
@@ -84,6 +85,7 @@ public:
 
     static int serviceUpdateId(const QString &service);
     static QList<int> graphUpdateIds(const QString &graph);
+    static QList<int> rdfTypeUpdateIds(const QStringList &rdfTypes);
     static QString graphForType(const QString &galleryType);
     static QString serviceForType( const QString &galleryType );
 
@@ -103,7 +105,8 @@ public:
             const QStringList &propertyNames,
             const QStringList &sortPropertyNames,
             int offset,
-            int limit) const;
+            int limit,
+            QGalleryTrackerQueryPlanCache *planCache = 0) const;
 
     QDocumentGallery::Error prepareTypeResponse(
             QGalleryTrackerResultSetArguments *arguments) const;
@@ -113,6 +116,7 @@ private:
 
     QDocumentGallery::Error buildFilterQuery(
             QString *query,
+            QStringList *parameters,
             QString *join,
             QString *optionalJoin,
             QGalleryQueryRequest::Scope scope,
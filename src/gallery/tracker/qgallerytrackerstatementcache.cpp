@@ -0,0 +1,171 @@
+/****************************************************************************
+**
+** Copyright (C) 2012 Digia Plc and/or its subsidiary(-ies).
+** Contact: http://www.qt-project.org/legal
+**
+** This file is part of the QtDocGallery module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and Digia.  For licensing terms and
+** conditions see http://qt.digia.com/licensing.  For further information
+** use the contact form at http://qt.digia.com/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU Lesser General Public License version 2.1 requirements
+** will be met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** In addition, as a special exception, Digia gives you certain additional
+** rights.  These rights are described in the Digia Qt LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3.0 as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU General Public License version 3.0 requirements will be
+** met: http://www.gnu.org/copyleft/gpl.html.
+**
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include <tracker-sparql.h>
+
+#include "qgallerytrackerstatementcache_p.h"
+
+QT_BEGIN_NAMESPACE_DOCGALLERY
+
+QGalleryTrackerStatementCache::Statement::~Statement()
+{
+    if (statement)
+        g_object_unref(G_OBJECT(statement));
+}
+
+QGalleryTrackerStatementCache::QGalleryTrackerStatementCache(TrackerSparqlConnection *connection)
+    : m_connection(connection)
+    , m_clock(0)
+{
+    g_object_ref(G_OBJECT(m_connection));
+}
+
+QGalleryTrackerStatementCache::~QGalleryTrackerStatementCache()
+{
+    m_statements.clear();
+
+    g_object_unref(G_OBJECT(m_connection));
+}
+
+TrackerSparqlCursor *QGalleryTrackerStatementCache::query(
+        const QString &sparql,
+        const QStringList &parameters,
+        GCancellable *cancellable,
+        GError **error)
+{
+    QSharedPointer<Statement> statement;
+    {
+        QMutexLocker locker(&m_mutex);
+
+        statement = m_statements.value(sparql);
+
+        if (!statement) {
+            if (m_statements.count() >= MaximumStatements) {
+                typedef QHash<QString, QSharedPointer<Statement> >::iterator iterator;
+
+                iterator oldest = m_statements.begin();
+                for (iterator it = oldest, end = m_statements.end(); it != end; ++it) {
+                    if ((*it)->lastUsed < (*oldest)->lastUsed)
+                        oldest = it;
+                }
+                // A statement evicted while another thread is executing it stays alive until
+                // that thread releases its reference.
+                m_statements.erase(oldest);
+            }
+
+            statement = QSharedPointer<Statement>(new Statement);
+            m_statements.insert(sparql, statement);
+        }
+        statement->lastUsed = ++m_clock;
+    }
+
+    // Bindings are state on the statement so it can only be executed by one thread at a time.
+    // The cursor of a bus connection is independent of the statement once it's returned.
+    QMutexLocker locker(&statement->mutex);
+
+    if (!statement->statement) {
+        statement->statement = tracker_sparql_connection_query_statement(
+                m_connection, sparql.toUtf8().constData(), cancellable, error);
+
+        if (!statement->statement)
+            return 0;
+    }
+
+    return execute(statement->statement, parameters, cancellable, error);
+}
+
+TrackerSparqlCursor *QGalleryTrackerStatementCache::queryOnce(
+        const QString &sparql,
+        const QStringList &parameters,
+        GCancellable *cancellable,
+        GError **error)
+{
+    if (parameters.isEmpty()) {
+        return tracker_sparql_connection_query(
+                m_connection, sparql.toUtf8().constData(), cancellable, error);
+    }
+
+    TrackerSparqlStatement *statement = tracker_sparql_connection_query_statement(
+            m_connection, sparql.toUtf8().constData(), cancellable, error);
+
+    if (!statement)
+        return 0;
+
+    TrackerSparqlCursor *cursor = execute(statement, parameters, cancellable, error);
+
+    g_object_unref(G_OBJECT(statement));
+
+    return cursor;
+}
+
+int QGalleryTrackerStatementCache::count() const
+{
+    QMutexLocker locker(&m_mutex);
+
+    return m_statements.count();
+}
+
+bool QGalleryTrackerStatementCache::contains(const QString &sparql) const
+{
+    QMutexLocker locker(&m_mutex);
+
+    return m_statements.contains(sparql);
+}
+
+TrackerSparqlCursor *QGalleryTrackerStatementCache::execute(
+        TrackerSparqlStatement *statement,
+        const QStringList &parameters,
+        GCancellable *cancellable,
+        GError **error)
+{
+    tracker_sparql_statement_clear_bindings(statement);
+
+    for (int i = 0, count = parameters.count(); i < count; ++i) {
+        tracker_sparql_statement_bind_string(
+                statement,
+                QByteArray("p" + QByteArray::number(i)).constData(),
+                parameters.at(i).toUtf8().constData());
+    }
+
+    return tracker_sparql_statement_execute(statement, cancellable, error);
+}
+
+QT_END_NAMESPACE_DOCGALLERY
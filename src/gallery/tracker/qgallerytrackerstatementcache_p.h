@@ -0,0 +1,118 @@
+/****************************************************************************
+**
+** Copyright (C) 2012 Digia Plc and/or its subsidiary(-ies).
+** Contact: http://www.qt-project.org/legal
+**
+** This file is part of the QtDocGallery module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and Digia.  For licensing terms and
+** conditions see http://qt.digia.com/licensing.  For further information
+** use the contact form at http://qt.digia.com/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU Lesser General Public License version 2.1 requirements
+** will be met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** In addition, as a special exception, Digia gives you certain additional
+** rights.  These rights are described in the Digia Qt LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3.0 as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU General Public License version 3.0 requirements will be
+** met: http://www.gnu.org/copyleft/gpl.html.
+**
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#ifndef QGALLERYTRACKERSTATEMENTCACHE_P_H
+#define QGALLERYTRACKERSTATEMENTCACHE_P_H
+
+#include "qgalleryglobal.h"
+
+#include <QtCore/qhash.h>
+#include <QtCore/qmutex.h>
+#include <QtCore/qsharedpointer.h>
+#include <QtCore/qstringlist.h>
+
+typedef struct _GCancellable GCancellable;
+typedef struct _GError GError;
+typedef struct _TrackerSparqlConnection TrackerSparqlConnection;
+typedef struct _TrackerSparqlCursor TrackerSparqlCursor;
+typedef struct _TrackerSparqlStatement TrackerSparqlStatement;
+
+QT_BEGIN_NAMESPACE_DOCGALLERY
+
+class Q_GALLERY_EXPORT QGalleryTrackerStatementCache
+{
+public:
+    enum { MaximumStatements = 32 };
+
+    explicit QGalleryTrackerStatementCache(TrackerSparqlConnection *connection);
+    ~QGalleryTrackerStatementCache();
+
+    TrackerSparqlCursor *query(
+            const QString &sparql,
+            const QStringList &parameters,
+            GCancellable *cancellable,
+            GError **error);
+    TrackerSparqlCursor *queryOnce(
+            const QString &sparql,
+            const QStringList &parameters,
+            GCancellable *cancellable,
+            GError **error);
+
+    int count() const;
+    bool contains(const QString &sparql) const;
+
+private:
+    struct Statement
+    {
+        Statement() : statement(0), lastUsed(0) {}
+        ~Statement();
+
+        TrackerSparqlStatement *statement;
+        QMutex mutex;
+        quint64 lastUsed;
+    };
+
+    static TrackerSparqlCursor *execute(
+            TrackerSparqlStatement *statement,
+            const QStringList &parameters,
+            GCancellable *cancellable,
+            GError **error);
+
+    TrackerSparqlConnection *const m_connection;
+    mutable QMutex m_mutex;
+    QHash<QString, QSharedPointer<Statement> > m_statements;
+    quint64 m_clock;
+};
+
+QT_END_NAMESPACE_DOCGALLERY
+
+#endif
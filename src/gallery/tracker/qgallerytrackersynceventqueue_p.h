@@ -0,0 +1,246 @@
+/****************************************************************************
+**
+** Copyright (C) 2012 Digia Plc and/or its subsidiary(-ies).
+** Contact: http://www.qt-project.org/legal
+**
+** This file is part of the QtDocGallery module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and Digia.  For licensing terms and
+** conditions see http://qt.digia.com/licensing.  For further information
+** use the contact form at http://qt.digia.com/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU Lesser General Public License version 2.1 requirements
+** will be met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** In addition, as a special exception, Digia gives you certain additional
+** rights.  These rights are described in the Digia Qt LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3.0 as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU General Public License version 3.0 requirements will be
+** met: http://www.gnu.org/copyleft/gpl.html.
+**
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#ifndef QGALLERYTRACKERSYNCEVENTQUEUE_P_H
+#define QGALLERYTRACKERSYNCEVENTQUEUE_P_H
+
+#include "qgalleryglobal.h"
+
+#include <QtCore/qatomic.h>
+#include <QtCore/qcoreapplication.h>
+#include <QtCore/qcoreevent.h>
+#include <QtCore/qmutex.h>
+#include <QtCore/qqueue.h>
+#include <QtCore/qwaitcondition.h>
+
+QT_BEGIN_NAMESPACE_DOCGALLERY
+
+struct QGalleryTrackerSyncEvent
+{
+    enum Type
+    {
+        Update,
+        Replace,
+        Move,
+        Stream,
+        Finish
+    };
+
+    Type type;
+    int rIndex;
+    int rCount;
+    int iIndex;
+    int iCount;
+
+    QGalleryTrackerSyncEvent() : type(Finish), rIndex(0), rCount(0), iIndex(0), iCount(0) {}
+
+    static QGalleryTrackerSyncEvent updateEvent(int aIndex, int iIndex, int count) {
+        return QGalleryTrackerSyncEvent(Update, aIndex, count, iIndex, count); }
+
+    static QGalleryTrackerSyncEvent replaceEvent(int aIndex, int aCount, int iIndex, int iCount) {
+        return QGalleryTrackerSyncEvent(Replace, aIndex, aCount, iIndex, iCount); }
+
+    static QGalleryTrackerSyncEvent moveEvent(int aIndex, int aCount, int aTo) {
+        return QGalleryTrackerSyncEvent(Move, aIndex, aCount, aTo, 0); }
+
+    static QGalleryTrackerSyncEvent streamEvent() {
+        return QGalleryTrackerSyncEvent(Stream, 0, 0, 0, 0); }
+
+    static QGalleryTrackerSyncEvent finishEvent(int aIndex, int iIndex) {
+        return QGalleryTrackerSyncEvent(Finish, aIndex, 0, iIndex, 0); }
+
+    // Updates or replacements of adjacent rows can be applied as one, and a stream event
+    // takes all rows read so far so any that follow it straight away have nothing to add.
+    bool canMerge(const QGalleryTrackerSyncEvent &event) const
+    {
+        return event.type == type
+                && type != Move
+                && type != Finish
+                && event.rIndex == rIndex + rCount
+                && event.iIndex == iIndex + iCount;
+    }
+
+    void merge(const QGalleryTrackerSyncEvent &event)
+    {
+        rCount += event.rCount;
+        iCount += event.iCount;
+    }
+
+private:
+    QGalleryTrackerSyncEvent(Type type, int rIndex, int rCount, int iIndex, int iCount)
+        : type(type), rIndex(rIndex), rCount(rCount), iIndex(iIndex), iCount(iCount) {}
+};
+
+/*
+    Hands sync events from the thread reading a query to the thread that owns the result set.
+
+    There must be only one thread enqueuing and one dequeuing.  Events are copied into a fixed
+    ring buffer so passing one on takes neither an allocation nor a lock.  If the reader gets too
+    far ahead events spill into a locked queue instead of blocking it, and the ring isn't used
+    again until that has been emptied so events are always dequeued in order.
+
+    The mutex is otherwise only taken to wake the receiver when an event is added to an empty
+    queue.
+*/
+
+class QGalleryTrackerSyncEventQueue
+{
+public:
+    enum { Capacity = 256 };
+
+    QGalleryTrackerSyncEventQueue() : m_receiver(0) {}
+
+    void setReceiver(QObject *receiver)
+    {
+        QMutexLocker locker(&m_mutex);
+
+        m_receiver = receiver;
+    }
+
+    void enqueue(const QGalleryTrackerSyncEvent &event)
+    {
+        const quint32 tail = m_tail.load();
+
+        if (m_overflowCount.loadAcquire() == 0 && tail - m_head.loadAcquire() < quint32(Capacity)) {
+            m_events[tail & (Capacity - 1)] = event;
+            m_tail.storeRelease(tail + 1);
+        } else {
+            QMutexLocker locker(&m_mutex);
+
+            m_overflow.enqueue(event);
+            m_overflowCount.fetchAndAddOrdered(1);
+        }
+
+        if (m_count.fetchAndAddOrdered(1) == 0) {
+            QMutexLocker locker(&m_mutex);
+
+            m_wait.wakeOne();
+
+            if (m_receiver)
+                QCoreApplication::postEvent(m_receiver, new QEvent(QEvent::UpdateLater));
+        }
+    }
+
+    bool dequeue(QGalleryTrackerSyncEvent *event)
+    {
+        if (!take(event))
+            return false;
+
+        while (const QGalleryTrackerSyncEvent *next = head()) {
+            if (!event->canMerge(*next))
+                break;
+
+            event->merge(*next);
+
+            m_head.storeRelease(m_head.load() + 1);
+            m_count.fetchAndSubOrdered(1);
+        }
+        return true;
+    }
+
+    bool isEmpty() const { return m_count.loadAcquire() <= 0; }
+
+    bool waitForEvent(int msecs)
+    {
+        QMutexLocker locker(&m_mutex);
+
+        if (!isEmpty())
+            return true;
+
+        return m_wait.wait(&m_mutex, msecs);
+    }
+
+private:
+    bool take(QGalleryTrackerSyncEvent *event)
+    {
+        // Nothing is added to the ring while there are events in the overflow queue, so if it's
+        // empty having seen an overflow those events are next.
+        const bool overflowed = m_overflowCount.loadAcquire() > 0;
+        const quint32 head = m_head.load();
+
+        if (head != m_tail.loadAcquire()) {
+            *event = m_events[head & (Capacity - 1)];
+            m_head.storeRelease(head + 1);
+        } else if (overflowed) {
+            QMutexLocker locker(&m_mutex);
+
+            *event = m_overflow.dequeue();
+            m_overflowCount.fetchAndSubOrdered(1);
+        } else {
+            return false;
+        }
+        m_count.fetchAndSubOrdered(1);
+
+        return true;
+    }
+
+    const QGalleryTrackerSyncEvent *head() const
+    {
+        const quint32 head = m_head.load();
+
+        return head != m_tail.loadAcquire() ? &m_events[head & (Capacity - 1)] : 0;
+    }
+
+    QGalleryTrackerSyncEvent m_events[Capacity];
+    QAtomicInteger<quint32> m_head;
+    QAtomicInteger<quint32> m_tail;
+    QAtomicInt m_count;
+    QAtomicInt m_overflowCount;
+    QObject *m_receiver;
+    QQueue<QGalleryTrackerSyncEvent> m_overflow;
+    QMutex m_mutex;
+    QWaitCondition m_wait;
+};
+
+QT_END_NAMESPACE_DOCGALLERY
+
+#endif
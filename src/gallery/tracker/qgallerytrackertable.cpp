@@ -0,0 +1,382 @@
+/****************************************************************************
+**
+** Copyright (C) 2012 Digia Plc and/or its subsidiary(-ies).
+** Contact: http://www.qt-project.org/legal
+**
+** This file is part of the QtDocGallery module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and Digia.  For licensing terms and
+** conditions see http://qt.digia.com/licensing.  For further information
+** use the contact form at http://qt.digia.com/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU Lesser General Public License version 2.1 requirements
+** will be met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** In addition, as a special exception, Digia gives you certain additional
+** rights.  These rights are described in the Digia Qt LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3.0 as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU General Public License version 3.0 requirements will be
+** met: http://www.gnu.org/copyleft/gpl.html.
+**
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "qgallerytrackertable_p.h"
+
+#include <QtCore/qdatetime.h>
+#include <QtCore/qstringlist.h>
+#include <QtCore/qurl.h>
+
+#include <string.h>
+
+QT_BEGIN_NAMESPACE_DOCGALLERY
+
+void QGalleryTrackerNullMask::rotate(int begin, int middle, int end)
+{
+    QVector<bool> nulls(end - begin);
+    for (int i = begin; i < end; ++i)
+        nulls[i - begin] = isNull(i);
+
+    std::rotate(nulls.begin(), nulls.begin() + (middle - begin), nulls.end());
+
+    for (int i = begin; i < end; ++i)
+        setNull(i, nulls.at(i - begin));
+}
+
+QVariant QGalleryTrackerDateTimeStore::value(int index) const
+{
+    if (m_nulls.isNull(index))
+        return QVariant();
+
+    const int offset = m_offsets.at(index);
+
+    // A zero offset from UTC is returned as a UTC date time.
+    return offset != LocalTime
+            ? QVariant(QDateTime::fromMSecsSinceEpoch(m_values.at(index), Qt::OffsetFromUTC, offset))
+            : QVariant(QDateTime::fromMSecsSinceEpoch(m_values.at(index), Qt::LocalTime));
+}
+
+void QGalleryTrackerDateTimeStore::setValue(int index, const QVariant &value)
+{
+    const QDateTime dateTime = value.toDateTime();
+
+    m_values[index] = dateTime.isValid() ? dateTime.toMSecsSinceEpoch() : 0;
+    m_nulls.setNull(index, !dateTime.isValid());
+
+    if (!dateTime.isValid())
+        m_offsets[index] = 0;
+    else if (dateTime.timeSpec() == Qt::LocalTime)
+        m_offsets[index] = LocalTime;
+    else
+        m_offsets[index] = dateTime.offsetFromUtc();
+}
+
+void QGalleryTrackerDateTimeStore::append(const QDateTime &dateTime)
+{
+    m_values.append(0);
+    m_offsets.append(0);
+    m_nulls.resize(m_values.count());
+
+    setValue(m_values.count() - 1, dateTime);
+}
+
+QVariant QGalleryTrackerStringStore::value(int index) const
+{
+    const Entry &entry = m_entries.at(index);
+
+    if (entry.length < 0)
+        return QVariant();
+
+    const char *data = m_data.constData() + entry.offset;
+
+    switch (m_format) {
+    case Url:
+        return QUrl::fromEncoded(QByteArray::fromRawData(data, entry.length), QUrl::StrictMode);
+    case StringList:
+        return QString::fromUtf8(data, entry.length).split(
+                QLatin1Char('|'), QString::SkipEmptyParts);
+    default:
+        return QString::fromUtf8(data, entry.length);
+    }
+}
+
+QByteArray QGalleryTrackerStringStore::encode(const QVariant &value) const
+{
+    switch (m_format) {
+    case Url:
+        return value.toUrl().toEncoded();
+    case StringList:
+        return value.type() == QVariant::StringList
+                ? value.toStringList().join(QLatin1String("|")).toUtf8()
+                : value.toString().toUtf8();
+    default:
+        return value.toString().toUtf8();
+    }
+}
+
+/*
+    A value which fits in the space of the one it replaces is written over it, otherwise it's
+    appended and the space of the old value is reclaimed once more than half the data is unused.
+*/
+
+void QGalleryTrackerStringStore::setValue(int index, const QVariant &value)
+{
+    Entry &entry = m_entries[index];
+
+    const int length = qMax(0, entry.length);
+
+    if (value.isNull()) {
+        entry.length = -1;
+
+        m_garbage += length;
+    } else {
+        const QByteArray data = encode(value);
+
+        if (data.size() <= length) {
+            memcpy(m_data.data() + entry.offset, data.constData(), data.size());
+
+            m_garbage += length - data.size();
+        } else {
+            entry.offset = m_data.size();
+
+            m_data.append(data);
+
+            m_garbage += length;
+        }
+        entry.length = data.size();
+    }
+
+    if (m_garbage > m_data.size() / 2)
+        compact();
+}
+
+void QGalleryTrackerStringStore::compact()
+{
+    QByteArray data;
+    data.reserve(m_data.size() - m_garbage);
+
+    typedef QVector<Entry>::iterator iterator;
+    for (iterator it = m_entries.begin(), end = m_entries.end(); it != end; ++it) {
+        if (it->length >= 0) {
+            const int offset = data.size();
+
+            data.append(m_data.constData() + it->offset, it->length);
+
+            it->offset = offset;
+        }
+    }
+
+    m_data.swap(data);
+    m_garbage = 0;
+}
+
+void QGalleryTrackerStringStore::append(
+        const QGalleryTrackerValueStore *other, int index, int count)
+{
+    const QGalleryTrackerStringStore *store = static_cast<const QGalleryTrackerStringStore *>(other);
+
+    m_entries.reserve(m_entries.count() + count);
+
+    for (int i = index; i < index + count; ++i) {
+        const Entry &entry = store->m_entries.at(i);
+
+        if (entry.length >= 0)
+            append(store->m_data.constData() + entry.offset, entry.length);
+        else
+            appendNull();
+    }
+}
+
+bool QGalleryTrackerStringStore::isEqual(
+        int index, const QGalleryTrackerValueStore *other, int otherIndex) const
+{
+    const QGalleryTrackerStringStore *store = static_cast<const QGalleryTrackerStringStore *>(other);
+
+    const Entry &entry = m_entries.at(index);
+    const Entry &otherEntry = store->m_entries.at(otherIndex);
+
+    return entry.length == otherEntry.length
+            && (entry.length <= 0 || memcmp(
+                    m_data.constData() + entry.offset,
+                    store->m_data.constData() + otherEntry.offset,
+                    entry.length) == 0);
+}
+
+QByteArray QGalleryTrackerStringStore::key(int index) const
+{
+    const Entry &entry = m_entries.at(index);
+
+    return entry.length >= 0
+            ? QByteArray::fromRawData(m_data.constData() + entry.offset, entry.length)
+            : QByteArray();
+}
+
+void QGalleryTrackerStringStore::read(
+        int index, int count, QGalleryRowBuffer *buffer, int column, int row) const
+{
+    for (int i = 0; i < count; ++i) {
+        const Entry &entry = m_entries.at(index + i);
+
+        if (entry.length >= 0)
+            buffer->setText(row + i, column, m_data.constData() + entry.offset, entry.length);
+    }
+}
+
+QGalleryTrackerTable::~QGalleryTrackerTable()
+{
+    qDeleteAll(m_columns);
+}
+
+void QGalleryTrackerTable::setColumnTypes(const QVector<QVariant::Type> &types)
+{
+    qDeleteAll(m_columns);
+    m_columns.clear();
+    m_columns.reserve(types.count());
+
+    typedef QVector<QVariant::Type>::const_iterator iterator;
+    for (iterator it = types.constBegin(), end = types.constEnd(); it != end; ++it) {
+        switch (*it) {
+        case QVariant::Int:
+            m_columns.append(new QGalleryTrackerNumericStore<int>);
+            break;
+        case QVariant::LongLong:
+            m_columns.append(new QGalleryTrackerNumericStore<qint64>);
+            break;
+        case QVariant::Double:
+            m_columns.append(new QGalleryTrackerNumericStore<double>);
+            break;
+        case QVariant::DateTime:
+            m_columns.append(new QGalleryTrackerDateTimeStore);
+            break;
+        case QVariant::Url:
+            m_columns.append(new QGalleryTrackerStringStore(QGalleryTrackerStringStore::Url));
+            break;
+        case QVariant::StringList:
+            m_columns.append(new QGalleryTrackerStringStore(QGalleryTrackerStringStore::StringList));
+            break;
+        default:
+            m_columns.append(new QGalleryTrackerStringStore(QGalleryTrackerStringStore::String));
+            break;
+        }
+    }
+}
+
+/*
+    The layout of the buffer columns a value column of the given type is read into, this must
+    agree with the stores created by setColumnTypes().
+*/
+
+QGalleryRowBuffer::ColumnType QGalleryTrackerTable::bufferType(QVariant::Type type)
+{
+    switch (type) {
+    case QVariant::Int:
+    case QVariant::LongLong:
+        return QGalleryRowBuffer::Integer;
+    case QVariant::Double:
+        return QGalleryRowBuffer::Real;
+    case QVariant::DateTime:
+        return QGalleryRowBuffer::DateTime;
+    default:
+        return QGalleryRowBuffer::Text;
+    }
+}
+
+int QGalleryTrackerTable::memoryUsage() const
+{
+    int usage = 0;
+
+    typedef QVector<QGalleryTrackerValueStore *>::const_iterator iterator;
+    for (iterator it = m_columns.constBegin(), end = m_columns.constEnd(); it != end; ++it)
+        usage += (*it)->memoryUsage();
+
+    return usage;
+}
+
+void QGalleryTrackerTable::clear()
+{
+    typedef QVector<QGalleryTrackerValueStore *>::const_iterator iterator;
+    for (iterator it = m_columns.constBegin(), end = m_columns.constEnd(); it != end; ++it)
+        (*it)->clear();
+}
+
+void QGalleryTrackerTable::appendRow(const QVector<QVariant> &values)
+{
+    for (int i = 0; i < m_columns.count(); ++i) {
+        if (i < values.count())
+            m_columns.at(i)->appendValue(values.at(i));
+        else
+            m_columns.at(i)->appendNull();
+    }
+}
+
+void QGalleryTrackerTable::append(const QGalleryTrackerTable &other)
+{
+    append(other, 0, other.rowCount());
+}
+
+void QGalleryTrackerTable::append(const QGalleryTrackerTable &other, int row, int count)
+{
+    for (int i = 0; i < m_columns.count(); ++i)
+        m_columns.at(i)->append(other.m_columns.at(i), row, count);
+}
+
+void QGalleryTrackerTable::moveRows(int from, int count, int to)
+{
+    typedef QVector<QGalleryTrackerValueStore *>::const_iterator iterator;
+    for (iterator it = m_columns.constBegin(), end = m_columns.constEnd(); it != end; ++it) {
+        if (to < from)
+            (*it)->rotate(to, from, from + count);
+        else
+            (*it)->rotate(from, from + count, to);
+    }
+}
+
+bool QGalleryTrackerTable::isEqual(
+        int row,
+        const QGalleryTrackerTable &other,
+        int otherRow,
+        int beginColumn,
+        int endColumn) const
+{
+    for (int i = beginColumn; i < endColumn; ++i) {
+        if (!m_columns.at(i)->isEqual(row, other.m_columns.at(i), otherRow))
+            return false;
+    }
+    return true;
+}
+
+QByteArray QGalleryTrackerTable::identity(int row, int width) const
+{
+    if (width == 1)
+        return m_columns.first()->key(row);
+
+    QByteArray identity;
+    for (int i = 0; i < width; ++i) {
+        const QByteArray key = m_columns.at(i)->key(row);
+
+        identity.append(QByteArray::number(key.size()));
+        identity.append(':');
+        identity.append(key);
+    }
+    return identity;
+}
+
+QT_END_NAMESPACE_DOCGALLERY
@@ -0,0 +1,453 @@
+/****************************************************************************
+**
+** Copyright (C) 2012 Digia Plc and/or its subsidiary(-ies).
+** Contact: http://www.qt-project.org/legal
+**
+** This file is part of the QtDocGallery module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and Digia.  For licensing terms and
+** conditions see http://qt.digia.com/licensing.  For further information
+** use the contact form at http://qt.digia.com/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU Lesser General Public License version 2.1 requirements
+** will be met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** In addition, as a special exception, Digia gives you certain additional
+** rights.  These rights are described in the Digia Qt LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3.0 as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU General Public License version 3.0 requirements will be
+** met: http://www.gnu.org/copyleft/gpl.html.
+**
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#ifndef QGALLERYTRACKERTABLE_P_H
+#define QGALLERYTRACKERTABLE_P_H
+
+#include "qgalleryglobal.h"
+#include "qgalleryrowbuffer.h"
+
+#include <QtCore/qbytearray.h>
+#include <QtCore/qdatetime.h>
+#include <QtCore/qvariant.h>
+#include <QtCore/qvector.h>
+
+#include <algorithm>
+#include <limits.h>
+
+QT_BEGIN_NAMESPACE_DOCGALLERY
+
+class QGalleryTrackerValueStore
+{
+public:
+    virtual ~QGalleryTrackerValueStore() {}
+
+    virtual QGalleryTrackerValueStore *create() const = 0;
+
+    virtual int count() const = 0;
+    virtual void clear() = 0;
+
+    virtual int memoryUsage() const = 0;
+
+    virtual QVariant value(int index) const = 0;
+    virtual void setValue(int index, const QVariant &value) = 0;
+
+    virtual void appendNull() = 0;
+    virtual void appendValue(const QVariant &value) = 0;
+    virtual void append(const QGalleryTrackerValueStore *other, int index, int count) = 0;
+
+    virtual void rotate(int begin, int middle, int end) = 0;
+
+    virtual bool isEqual(int index, const QGalleryTrackerValueStore *other, int otherIndex) const = 0;
+    virtual QByteArray key(int index) const = 0;
+
+    virtual void read(int index, int count, QGalleryRowBuffer *buffer, int column, int row) const = 0;
+};
+
+class QGalleryTrackerNullMask
+{
+public:
+    bool isNull(int index) const { return m_bits.at(index >> 5) & (1u << (index & 31)); }
+    void setNull(int index, bool null)
+    {
+        if (null)
+            m_bits[index >> 5] |= 1u << (index & 31);
+        else
+            m_bits[index >> 5] &= ~(1u << (index & 31));
+    }
+
+    void resize(int count) { m_bits.resize((count + 31) >> 5); }
+    void clear() { m_bits.clear(); }
+
+    int memoryUsage() const { return m_bits.capacity() * sizeof(quint32); }
+
+    void rotate(int begin, int middle, int end);
+
+private:
+    QVector<quint32> m_bits;
+};
+
+template <typename T>
+struct QGalleryTrackerBufferValues
+{
+    static qint64 *data(QGalleryRowBuffer *buffer, int column) { return buffer->integers(column); }
+};
+
+template <>
+struct QGalleryTrackerBufferValues<double>
+{
+    static double *data(QGalleryRowBuffer *buffer, int column) { return buffer->reals(column); }
+};
+
+template <typename T>
+class QGalleryTrackerNumericStore : public QGalleryTrackerValueStore
+{
+public:
+    QGalleryTrackerValueStore *create() const { return new QGalleryTrackerNumericStore<T>; }
+
+    int count() const { return m_values.count(); }
+    void clear() { m_values.clear(); m_nulls.clear(); }
+
+    int memoryUsage() const { return m_values.capacity() * sizeof(T) + m_nulls.memoryUsage(); }
+
+    QVariant value(int index) const {
+        return !m_nulls.isNull(index) ? QVariant(m_values.at(index)) : QVariant(); }
+    void setValue(int index, const QVariant &value)
+    {
+        m_values[index] = value.value<T>();
+        m_nulls.setNull(index, value.isNull());
+    }
+
+    void append(T value)
+    {
+        m_values.append(value);
+        m_nulls.resize(m_values.count());
+    }
+
+    void appendNull()
+    {
+        m_values.append(T());
+        m_nulls.resize(m_values.count());
+        m_nulls.setNull(m_values.count() - 1, true);
+    }
+
+    void appendValue(const QVariant &value)
+    {
+        m_values.append(T());
+        m_nulls.resize(m_values.count());
+
+        setValue(m_values.count() - 1, value);
+    }
+
+    void append(const QGalleryTrackerValueStore *other, int index, int count)
+    {
+        const QGalleryTrackerNumericStore<T> *store
+                = static_cast<const QGalleryTrackerNumericStore<T> *>(other);
+
+        const int offset = m_values.count();
+
+        m_values.resize(offset + count);
+        m_nulls.resize(offset + count);
+
+        for (int i = 0; i < count; ++i) {
+            m_values[offset + i] = store->m_values.at(index + i);
+            m_nulls.setNull(offset + i, store->m_nulls.isNull(index + i));
+        }
+    }
+
+    void rotate(int begin, int middle, int end)
+    {
+        const typename QVector<T>::iterator values = m_values.begin();
+
+        std::rotate(values + begin, values + middle, values + end);
+
+        m_nulls.rotate(begin, middle, end);
+    }
+
+    bool isEqual(int index, const QGalleryTrackerValueStore *other, int otherIndex) const
+    {
+        const QGalleryTrackerNumericStore<T> *store
+                = static_cast<const QGalleryTrackerNumericStore<T> *>(other);
+
+        const bool null = m_nulls.isNull(index);
+
+        return null == store->m_nulls.isNull(otherIndex)
+                && (null || m_values.at(index) == store->m_values.at(otherIndex));
+    }
+
+    QByteArray key(int index) const
+    {
+        return !m_nulls.isNull(index)
+                ? QByteArray(reinterpret_cast<const char *>(&m_values.at(index)), sizeof(T))
+                : QByteArray();
+    }
+
+    void read(int index, int count, QGalleryRowBuffer *buffer, int column, int row) const
+    {
+        const typename QVector<T>::const_iterator values = m_values.constBegin() + index;
+
+        std::copy(values, values + count, QGalleryTrackerBufferValues<T>::data(buffer, column) + row);
+
+        for (int i = 0; i < count; ++i)
+            buffer->setNull(row + i, column, m_nulls.isNull(index + i));
+    }
+
+protected:
+    QVector<T> m_values;
+    QGalleryTrackerNullMask m_nulls;
+};
+
+/*
+    Date times are stored as milliseconds since the epoch with the offset from UTC they were read
+    with alongside, so values are returned with the same time spec they were stored with.
+*/
+
+class QGalleryTrackerDateTimeStore : public QGalleryTrackerNumericStore<qint64>
+{
+public:
+    enum { LocalTime = INT_MIN };
+
+    QGalleryTrackerValueStore *create() const { return new QGalleryTrackerDateTimeStore; }
+
+    void clear() { QGalleryTrackerNumericStore<qint64>::clear(); m_offsets.clear(); }
+
+    int memoryUsage() const {
+        return QGalleryTrackerNumericStore<qint64>::memoryUsage() + m_offsets.capacity() * sizeof(int); }
+
+    QVariant value(int index) const;
+    void setValue(int index, const QVariant &value);
+
+    void append(const QDateTime &dateTime);
+
+    void appendNull()
+    {
+        QGalleryTrackerNumericStore<qint64>::appendNull();
+        m_offsets.append(0);
+    }
+
+    void appendValue(const QVariant &value)
+    {
+        QGalleryTrackerNumericStore<qint64>::appendNull();
+        m_offsets.append(0);
+
+        setValue(m_values.count() - 1, value);
+    }
+
+    void append(const QGalleryTrackerValueStore *other, int index, int count)
+    {
+        QGalleryTrackerNumericStore<qint64>::append(other, index, count);
+
+        m_offsets += static_cast<const QGalleryTrackerDateTimeStore *>(other)->m_offsets.mid(
+                index, count);
+    }
+
+    void rotate(int begin, int middle, int end)
+    {
+        QGalleryTrackerNumericStore<qint64>::rotate(begin, middle, end);
+
+        const QVector<int>::iterator offsets = m_offsets.begin();
+
+        std::rotate(offsets + begin, offsets + middle, offsets + end);
+    }
+
+    bool isEqual(int index, const QGalleryTrackerValueStore *other, int otherIndex) const
+    {
+        return QGalleryTrackerNumericStore<qint64>::isEqual(index, other, otherIndex)
+                && m_offsets.at(index) == static_cast<const QGalleryTrackerDateTimeStore *>(
+                        other)->m_offsets.at(otherIndex);
+    }
+
+    QByteArray key(int index) const
+    {
+        QByteArray key = QGalleryTrackerNumericStore<qint64>::key(index);
+
+        if (!key.isNull())
+            key.append(reinterpret_cast<const char *>(&m_offsets.at(index)), sizeof(int));
+
+        return key;
+    }
+
+private:
+    QVector<int> m_offsets;
+};
+
+class QGalleryTrackerStringStore : public QGalleryTrackerValueStore
+{
+public:
+    enum Format
+    {
+        String,
+        Url,
+        StringList
+    };
+
+    explicit QGalleryTrackerStringStore(Format format) : m_format(format), m_garbage(0) {}
+
+    QGalleryTrackerValueStore *create() const { return new QGalleryTrackerStringStore(m_format); }
+
+    int count() const { return m_entries.count(); }
+    void clear() { m_entries.clear(); m_data.clear(); m_garbage = 0; }
+
+    int memoryUsage() const {
+        return m_entries.capacity() * sizeof(Entry) + m_data.capacity(); }
+
+    QVariant value(int index) const;
+    void setValue(int index, const QVariant &value);
+
+    void append(const char *data, int length)
+    {
+        const Entry entry = { m_data.size(), length };
+
+        m_data.append(data, length);
+        m_entries.append(entry);
+    }
+
+    void appendNull()
+    {
+        const Entry entry = { m_data.size(), -1 };
+
+        m_entries.append(entry);
+    }
+
+    void appendValue(const QVariant &value)
+    {
+        appendNull();
+
+        setValue(m_entries.count() - 1, value);
+    }
+
+    void append(const QGalleryTrackerValueStore *other, int index, int count);
+
+    void rotate(int begin, int middle, int end)
+    {
+        const QVector<Entry>::iterator entries = m_entries.begin();
+
+        std::rotate(entries + begin, entries + middle, entries + end);
+    }
+
+    bool isEqual(int index, const QGalleryTrackerValueStore *other, int otherIndex) const;
+    QByteArray key(int index) const;
+
+    void read(int index, int count, QGalleryRowBuffer *buffer, int column, int row) const;
+
+private:
+    struct Entry
+    {
+        int offset;
+        int length;
+    };
+
+    QByteArray encode(const QVariant &value) const;
+    void compact();
+
+    const Format m_format;
+    QVector<Entry> m_entries;
+    QByteArray m_data;
+    int m_garbage;
+};
+
+class Q_GALLERY_EXPORT QGalleryTrackerTable
+{
+public:
+    QGalleryTrackerTable() {}
+    explicit QGalleryTrackerTable(const QVector<QVariant::Type> &types) { setColumnTypes(types); }
+    ~QGalleryTrackerTable();
+
+    void setColumnTypes(const QVector<QVariant::Type> &types);
+
+    static QGalleryRowBuffer::ColumnType bufferType(QVariant::Type type);
+
+    int columnCount() const { return m_columns.count(); }
+    int rowCount() const { return !m_columns.isEmpty() ? m_columns.first()->count() : 0; }
+    int memoryUsage() const;
+
+    QGalleryTrackerValueStore *column(int index) { return m_columns.at(index); }
+    const QGalleryTrackerValueStore *column(int index) const { return m_columns.at(index); }
+
+    QVariant value(int row, int column) const { return m_columns.at(column)->value(row); }
+    void setValue(int row, int column, const QVariant &value) {
+        m_columns.at(column)->setValue(row, value); }
+
+    void clear();
+    void swap(QGalleryTrackerTable &other) { qSwap(m_columns, other.m_columns); }
+
+    void appendRow(const QVector<QVariant> &values);
+    void append(const QGalleryTrackerTable &other);
+    void append(const QGalleryTrackerTable &other, int row, int count);
+
+    void moveRows(int from, int count, int to);
+
+    void read(
+            int row,
+            int count,
+            int column,
+            QGalleryRowBuffer *buffer,
+            int bufferRow,
+            int bufferColumn) const {
+        m_columns.at(column)->read(row, count, buffer, bufferColumn, bufferRow); }
+
+    bool isEqual(
+            int row,
+            const QGalleryTrackerTable &other,
+            int otherRow,
+            int beginColumn,
+            int endColumn) const;
+    QByteArray identity(int row, int width) const;
+
+private:
+    Q_DISABLE_COPY(QGalleryTrackerTable)
+
+    QVector<QGalleryTrackerValueStore *> m_columns;
+};
+
+class QGalleryTrackerRow
+{
+public:
+    QGalleryTrackerRow() : m_table(0), m_index(-1) {}
+    QGalleryTrackerRow(const QGalleryTrackerTable *table, int index)
+        : m_table(table), m_index(index) {}
+
+    bool isNull() const { return !m_table; }
+
+    const QGalleryTrackerTable *table() const { return m_table; }
+    int index() const { return m_index; }
+
+    QVariant value(int column) const { return m_table->value(m_index, column); }
+
+private:
+    const QGalleryTrackerTable *m_table;
+    int m_index;
+};
+
+QT_END_NAMESPACE_DOCGALLERY
+
+#endif
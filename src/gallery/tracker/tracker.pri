@@ -6,19 +6,39 @@ CONFIG += link_pkgconfig
 PKGCONFIG_PRIVATE += tracker-sparql-3.0
 
 PRIVATE_HEADERS += \
+        $$PWD/qdocumentgallery_tracker_p.h \
         $$PWD/qgallerytrackerchangenotifier_p.h \
+        $$PWD/qgallerytrackerconnection_p.h \
         $$PWD/qgallerytrackereditableresultset_p.h \
         $$PWD/qgallerytrackerlistcolumn_p.h \
         $$PWD/qgallerytrackermetadataedit_p.h \
+        $$PWD/qgallerytrackerpagedresultset_p.h \
+        $$PWD/qgallerytrackerqueryplancache_p.h \
+        $$PWD/qgallerytrackerrefreshpolicy_p.h \
         $$PWD/qgallerytrackerresultset_p.h \
         $$PWD/qgallerytrackerresultset_p_p.h \
-        $$PWD/qgallerytrackerschema_p.h
+        $$PWD/qgallerytrackerresultsetcursor_p.h \
+        $$PWD/qgallerytrackerrowdiff_p.h \
+        $$PWD/qgallerytrackerscheduler_p.h \
+        $$PWD/qgallerytrackerschema_p.h \
+        $$PWD/qgallerytrackerstatementcache_p.h \
+        $$PWD/qgallerytrackersynceventqueue_p.h \
+        $$PWD/qgallerytrackertable_p.h
 
 SOURCES += \
         $$PWD/qdocumentgallery_tracker.cpp \
         $$PWD/qgallerytrackerchangenotifier.cpp \
+        $$PWD/qgallerytrackerconnection.cpp \
         $$PWD/qgallerytrackereditableresultset.cpp \
         $$PWD/qgallerytrackerlistcolumn.cpp \
         $$PWD/qgallerytrackermetadataedit.cpp \
+        $$PWD/qgallerytrackerpagedresultset.cpp \
+        $$PWD/qgallerytrackerqueryplancache.cpp \
+        $$PWD/qgallerytrackerrefreshpolicy.cpp \
         $$PWD/qgallerytrackerresultset.cpp \
-        $$PWD/qgallerytrackerschema.cpp
+        $$PWD/qgallerytrackerresultsetcursor.cpp \
+        $$PWD/qgallerytrackerrowdiff.cpp \
+        $$PWD/qgallerytrackerscheduler.cpp \
+        $$PWD/qgallerytrackerschema.cpp \
+        $$PWD/qgallerytrackerstatementcache.cpp \
+        $$PWD/qgallerytrackertable.cpp
@@ -49,6 +49,8 @@
 #include <QtQml/qjsengine.h>
 #include <QtCore/qcoreapplication.h>
 
+#include <algorithm>
+
 QT_BEGIN_NAMESPACE_DOCGALLERY
 
 QDeclarativeGalleryQueryModel::QDeclarativeGalleryQueryModel(QObject *parent)
@@ -123,6 +125,15 @@ void QDeclarativeGalleryQueryModel::setAutoUpdate(bool enabled)
     }
 }
 
+void QDeclarativeGalleryQueryModel::setSuspended(bool suspended)
+{
+    if (m_request.isSuspended() != suspended) {
+        m_request.setSuspended(suspended);
+
+        Q_EMIT suspendedChanged();
+    }
+}
+
 void QDeclarativeGalleryQueryModel::setScope(Scope scope)
 {
     if (m_request.scope() != QGalleryQueryRequest::Scope(scope)) {
@@ -182,6 +193,17 @@ void QDeclarativeGalleryQueryModel::setLimit(int limit)
     }
 }
 
+void QDeclarativeGalleryQueryModel::setPageSize(int size)
+{
+    if (m_request.pageSize() != size) {
+        m_request.setPageSize(size);
+
+        deferredExecute();
+
+        Q_EMIT pageSizeChanged();
+    }
+}
+
 void QDeclarativeGalleryQueryModel::reload()
 {
     if (m_updateStatus == PendingUpdate)
@@ -217,17 +239,14 @@ int QDeclarativeGalleryQueryModel::rowCount(const QModelIndex &parent) const
 QVariant QDeclarativeGalleryQueryModel::data(const QModelIndex &index, int role) const
 {
     if (index.isValid()) {
-        if (m_resultSet->currentIndex() != index.row())
-            m_resultSet->fetch(index.row());
-
         switch (role) {
         case ItemId:
-            return m_resultSet->itemId();
+            return m_resultSet->itemId(index.row());
         case ItemType:
-            return itemType(m_resultSet->itemType());
+            return itemType(m_resultSet->itemType(index.row()));
         default:
             {
-                QVariant value = m_resultSet->metaData(role - MetaDataOffset);
+                QVariant value = m_resultSet->metaData(index.row(), role - MetaDataOffset);
 
                 return value.isNull()
                         ? QVariant(m_resultSet->propertyType(role - MetaDataOffset))
@@ -269,21 +288,21 @@ QJSValue QDeclarativeGalleryQueryModel::get(const QJSValue &index) const
 
     const int i = index.toInt();
 
-    if (i < 0 || i >= m_rowCount || (i != m_resultSet->currentIndex() && !m_resultSet->fetch(i)))
+    if (i < 0 || i >= m_rowCount)
        return QJSValue();
 
     QJSValue object = scriptEngine->newObject();
 
     object.setProperty(
-            QLatin1String("itemId"), scriptEngine->toScriptValue(m_resultSet->itemId()));
+            QLatin1String("itemId"), scriptEngine->toScriptValue(m_resultSet->itemId(i)));
     object.setProperty(
-            QLatin1String("itemUrl"), scriptEngine->toScriptValue(m_resultSet->itemUrl()));
+            QLatin1String("itemUrl"), scriptEngine->toScriptValue(m_resultSet->itemUrl(i)));
 
     typedef QVector<QPair<int, QString> >::const_iterator iterator;
     for (iterator it = m_propertyNames.constBegin(), end = m_propertyNames.constEnd();
             it != end;
             ++it) {
-        QVariant value = m_resultSet->metaData(it->first);
+        QVariant value = m_resultSet->metaData(i, it->first);
 
         if (value.isNull())
             value = QVariant(m_resultSet->propertyType(it->first));
@@ -296,20 +315,17 @@ QJSValue QDeclarativeGalleryQueryModel::get(const QJSValue &index) const
 
 QVariant QDeclarativeGalleryQueryModel::property(int index, const QString &property) const
 {
-    if (index < 0
-            || index >= m_rowCount
-            || (m_resultSet->currentIndex() != index && !m_resultSet->fetch(index))) {
+    if (index < 0 || index >= m_rowCount)
         return QVariant();
-    }
 
     if (property == QLatin1String("itemId")) {
-        return m_resultSet->itemId();
+        return m_resultSet->itemId(index);
     } else if (property == QLatin1String("itemType")) {
-        return itemType(m_resultSet->itemType());
+        return itemType(m_resultSet->itemType(index));
     } else {
         const int propertyKey = m_resultSet->propertyKey(property);
 
-        const QVariant value = m_resultSet->metaData(propertyKey);
+        const QVariant value = m_resultSet->metaData(index, propertyKey);
 
         return value.isNull()
                 ? QVariant(m_resultSet->propertyType(propertyKey))
@@ -375,6 +391,10 @@ bool QDeclarativeGalleryQueryModel::event(QEvent *event)
             m_request.execute();
         }
 
+        return true;
+    } else if (event->type() == QEvent::UpdateLater) {
+        flushDataChanges();
+
         return true;
     } else {
         return QAbstractListModel::event(event);
@@ -420,6 +440,8 @@ void QDeclarativeGalleryQueryModel::_q_stateChanged()
 
 void QDeclarativeGalleryQueryModel::_q_setResultSet(QGalleryResultSet *resultSet)
 {
+    m_dataChanges.clear();
+
     if (m_rowCount > 0) {
         beginRemoveRows(QModelIndex(), 0, m_rowCount - 1);
         m_rowCount = 0;
@@ -458,7 +480,7 @@ void QDeclarativeGalleryQueryModel::_q_setResultSet(QGalleryResultSet *resultSet
         connect(m_resultSet, SIGNAL(itemsMoved(int,int,int)),
                 this, SLOT(_q_itemsMoved(int,int,int)));
         connect(m_resultSet, SIGNAL(metaDataChanged(int,int,QList<int>)),
-                this, SLOT(_q_itemsChanged(int,int)));
+                this, SLOT(_q_itemsChanged(int,int,QList<int>)));
 
         const int rowCount = m_resultSet->itemCount();
         if (rowCount > 0) {
@@ -473,6 +495,8 @@ void QDeclarativeGalleryQueryModel::_q_setResultSet(QGalleryResultSet *resultSet
 
 void QDeclarativeGalleryQueryModel::_q_itemsInserted(int index, int count)
 {
+    flushDataChanges();
+
     beginInsertRows(QModelIndex(), index, index + count - 1);
     m_rowCount += count;
     endInsertRows();
@@ -482,6 +506,8 @@ void QDeclarativeGalleryQueryModel::_q_itemsInserted(int index, int count)
 
 void QDeclarativeGalleryQueryModel::_q_itemsRemoved(int index, int count)
 {
+    flushDataChanges();
+
     beginRemoveRows(QModelIndex(), index, index + count - 1);
     m_rowCount -= count;
     endRemoveRows();
@@ -491,13 +517,59 @@ void QDeclarativeGalleryQueryModel::_q_itemsRemoved(int index, int count)
 
 void QDeclarativeGalleryQueryModel::_q_itemsMoved(int from, int to, int count)
 {
+    flushDataChanges();
+
     beginMoveRows(QModelIndex(), from, from + count - 1, QModelIndex(), to);
     endMoveRows();
 }
 
-void QDeclarativeGalleryQueryModel::_q_itemsChanged(int index, int count)
+/*
+    Changes are held until control returns to the event loop so the many small updates of a
+    single refresh reach the views as a few ranges, each naming only the roles that changed.
+    Ranges are only merged with others that changed the same roles.  Pending changes are flushed
+    before any rows are inserted, removed or moved so their indexes stay valid.
+*/
+
+void QDeclarativeGalleryQueryModel::_q_itemsChanged(int index, int count, const QList<int> &keys)
+{
+    DataChange change;
+    change.first = index;
+    change.last = index + count - 1;
+    change.roles.reserve(keys.count());
+
+    typedef QList<int>::const_iterator iterator;
+    for (iterator it = keys.constBegin(), end = keys.constEnd(); it != end; ++it)
+        change.roles.append(*it + MetaDataOffset);
+
+    std::sort(change.roles.begin(), change.roles.end());
+    change.roles.erase(std::unique(change.roles.begin(), change.roles.end()), change.roles.end());
+
+    if (m_dataChanges.isEmpty())
+        QCoreApplication::postEvent(this, new QEvent(QEvent::UpdateLater));
+
+    typedef QVector<DataChange>::iterator change_iterator;
+    for (change_iterator it = m_dataChanges.begin(), end = m_dataChanges.end(); it != end; ++it) {
+        if (it->roles == change.roles
+                && change.first <= it->last + 1
+                && change.last >= it->first - 1) {
+            it->first = qMin(it->first, change.first);
+            it->last = qMax(it->last, change.last);
+
+            return;
+        }
+    }
+
+    m_dataChanges.append(change);
+}
+
+void QDeclarativeGalleryQueryModel::flushDataChanges()
 {
-    Q_EMIT dataChanged(createIndex(index, 0), createIndex(index + count - 1, 0));
+    const QVector<DataChange> changes = m_dataChanges;
+    m_dataChanges.clear();
+
+    typedef QVector<DataChange>::const_iterator iterator;
+    for (iterator it = changes.constBegin(), end = changes.constEnd(); it != end; ++it)
+        Q_EMIT dataChanged(createIndex(it->first, 0), createIndex(it->last, 0), it->roles);
 }
 
 /*!
@@ -622,6 +694,19 @@ void QDeclarativeDocumentGalleryModel::classBegin()
     automatically.
 */
 
+/*!
+    \qmlproperty bool DocumentGalleryModel::suspended
+
+    This property holds whether automatic refreshes of a query's results are
+    suspended.
+
+    A model that isn't visible can be suspended to stop it refreshing every
+    time the gallery changes without discarding its results.  When it is no
+    longer suspended it refreshes once if anything changed in the meantime.
+
+    The default value is false.
+*/
+
 /*!
     \qmlproperty int DocumentGalleryModel::offset
 
@@ -634,6 +719,19 @@ void QDeclarativeDocumentGalleryModel::classBegin()
     This property contains the maximum number of items returned by a query.
 */
 
+/*!
+    \qmlproperty int DocumentGalleryModel::pageSize
+
+    This property contains the number of items a query should load at a time.
+
+    If the page size is greater than zero the \l count of a query may be
+    reported before its items have loaded, and the properties of items will
+    then be loaded a page at a time as they are accessed.  Properties of items
+    which have not loaded yet have undefined values.
+
+    The default value is 0, which loads all items up front.
+*/
+
 /*!
     \qmlproperty enum DocumentGalleryModel::rootType
 
@@ -78,10 +78,12 @@ class QDeclarativeGalleryQueryModel : public QAbstractListModel, public QQmlPars
     Q_PROPERTY(QStringList properties READ propertyNames WRITE setPropertyNames NOTIFY propertyNamesChanged)
     Q_PROPERTY(QStringList sortProperties READ sortPropertyNames WRITE setSortPropertyNames NOTIFY sortPropertyNamesChanged)
     Q_PROPERTY(bool autoUpdate READ autoUpdate WRITE setAutoUpdate NOTIFY autoUpdateChanged)
+    Q_PROPERTY(bool suspended READ isSuspended WRITE setSuspended NOTIFY suspendedChanged)
     Q_PROPERTY(QVariant rootItem READ rootItem WRITE setRootItem NOTIFY rootItemChanged)
     Q_PROPERTY(Scope scope READ scope WRITE setScope NOTIFY scopeChanged)
     Q_PROPERTY(int offset READ offset WRITE setOffset NOTIFY offsetChanged)
     Q_PROPERTY(int limit READ limit WRITE setLimit NOTIFY limitChanged)
+    Q_PROPERTY(int pageSize READ pageSize WRITE setPageSize NOTIFY pageSizeChanged)
     Q_PROPERTY(int count READ count NOTIFY countChanged)
     Q_PROPERTY(QDocGallery::QDeclarativeGalleryFilterBase* filter READ filter WRITE setFilter NOTIFY filterChanged)
 public:
@@ -124,6 +126,9 @@ public:
     bool autoUpdate() const { return m_request.autoUpdate(); }
     void setAutoUpdate(bool enabled);
 
+    bool isSuspended() const { return m_request.isSuspended(); }
+    void setSuspended(bool suspended);
+
     Scope scope() const { return Scope(m_request.scope()); }
     void setScope(Scope scope);
 
@@ -139,6 +144,9 @@ public:
     int limit() const { return m_request.limit(); }
     void setLimit(int limit);
 
+    int pageSize() const { return m_request.pageSize(); }
+    void setPageSize(int size);
+
     int rowCount(const QModelIndex &parent) const;
 
     QVariant data(const QModelIndex &index, int role) const;
@@ -167,11 +175,13 @@ Q_SIGNALS:
     void propertyNamesChanged();
     void sortPropertyNamesChanged();
     void autoUpdateChanged();
+    void suspendedChanged();
     void rootItemChanged();
     void scopeChanged();
     void filterChanged();
     void offsetChanged();
     void limitChanged();
+    void pageSizeChanged();
     void countChanged();
 
 protected Q_SLOTS:
@@ -192,10 +202,20 @@ protected:
 
     bool event(QEvent *event);
 
+    void flushDataChanges();
+
+    struct DataChange
+    {
+        int first;
+        int last;
+        QVector<int> roles;
+    };
+
     QGalleryQueryRequest m_request;
     QPointer<QDeclarativeGalleryFilterBase> m_filter;
     QGalleryResultSet *m_resultSet;
     QVector<QPair<int, QString> > m_propertyNames;
+    QVector<DataChange> m_dataChanges;
     Status m_status;
     int m_rowCount;
     UpdateStatus m_updateStatus;
@@ -206,7 +226,7 @@ private Q_SLOTS:
     void _q_itemsInserted(int index, int count);
     void _q_itemsRemoved(int index, int count);
     void _q_itemsMoved(int from, int to, int count);
-    void _q_itemsChanged(int index, int count);
+    void _q_itemsChanged(int index, int count, const QList<int> &keys);
 };
 
 class QDeclarativeDocumentGalleryModel : public QDeclarativeGalleryQueryModel
@@ -9,6 +9,7 @@ SUBDIRS += \
     qgalleryquerymodel \
     qgalleryqueryrequest \
     qgalleryresource \
+    qgalleryrowbuffer \
     qgallerytyperequest \
 #    qdeclarativedocumentgalleryitem \
 #    qdeclarativedocumentgallerymodel \
@@ -16,7 +17,17 @@ SUBDIRS += \
 
 linux-*:qtHaveModule(dbus):contains(tracker_enabled, yes) {
     SUBDIRS += \
-            qgallerytrackerschema_tracker
-#        qgallerytrackerresultset_tracker \
+            qdocumentgallery_tracker \
+            qgallerytrackerchangenotifier_tracker \
+            qgallerytrackermetadataedit_tracker \
+            qgallerytrackerpagedresultset_tracker \
+            qgallerytrackerrefreshpolicy_tracker \
+            qgallerytrackerresultset_tracker \
+            qgallerytrackerresultsetcursor_tracker \
+            qgallerytrackerrowdiff_tracker \
+            qgallerytrackerscheduler_tracker \
+            qgallerytrackerschema_tracker \
+            qgallerytrackerstatementcache_tracker \
+            qgallerytrackertable_tracker
 }
 
@@ -2895,26 +2895,63 @@ void tst_QDeclarativeDocumentGalleryModel::metaDataChanged()
     QAbstractItemModel *model = qobject_cast<QAbstractItemModel *>(object.data());
     QVERIFY(model);
 
-    QSignalSpy spy(model, SIGNAL(dataChanged(QModelIndex,QModelIndex)));
+    QSignalSpy spy(model, SIGNAL(dataChanged(QModelIndex,QModelIndex,QVector<int>)));
 
     QCOMPARE(model->rowCount(), 5);
     QCOMPARE(model->columnCount(), 1);
 
+    const int fileNameRole = model->roleNames().key("fileName");
+    const int titleRole = model->roleNames().key("title");
+
     QList<int> keys;
-    keys.append(model->roleNames().key("fileName"));
-    keys.append(model->roleNames().key("title"));
+    keys.append(titleRole - QDeclarativeGalleryQueryModel::MetaDataOffset);
+    keys.append(fileNameRole - QDeclarativeGalleryQueryModel::MetaDataOffset);
+
+    QVector<int> roles;
+    roles.append(qMin(fileNameRole, titleRole));
+    roles.append(qMax(fileNameRole, titleRole));
 
     gallery.response()->metaDataChanged(1, 1, keys);
 
+    QCOMPARE(spy.count(), 0);
+    QCoreApplication::processEvents();
+
     QCOMPARE(spy.count(), 1);
     QCOMPARE(spy.last().value(0).value<QModelIndex>(), model->index(1, 0));
     QCOMPARE(spy.last().value(1).value<QModelIndex>(), model->index(1, 0));
+    QCOMPARE(spy.last().value(2).value<QVector<int> >(), roles);
 
     gallery.response()->metaDataChanged(2, 3, QList<int>());
 
+    QCoreApplication::processEvents();
+
     QCOMPARE(spy.count(), 2);
     QCOMPARE(spy.last().value(0).value<QModelIndex>(), model->index(2, 0));
     QCOMPARE(spy.last().value(1).value<QModelIndex>(), model->index(4, 0));
+    QCOMPARE(spy.last().value(2).value<QVector<int> >(), QVector<int>());
+
+    // Adjacent changes to the same properties are coalesced, changes to others aren't.
+    gallery.response()->metaDataChanged(0, 1, keys.mid(0, 1));
+    gallery.response()->metaDataChanged(1, 2, keys.mid(0, 1));
+    gallery.response()->metaDataChanged(1, 1, keys.mid(1, 1));
+    gallery.response()->metaDataChanged(3, 1, keys.mid(0, 1));
+
+    QCoreApplication::processEvents();
+
+    QCOMPARE(spy.count(), 4);
+    QCOMPARE(spy.at(2).value(0).value<QModelIndex>(), model->index(0, 0));
+    QCOMPARE(spy.at(2).value(1).value<QModelIndex>(), model->index(3, 0));
+    QCOMPARE(spy.at(2).value(2).value<QVector<int> >(), QVector<int>() << titleRole);
+    QCOMPARE(spy.at(3).value(0).value<QModelIndex>(), model->index(1, 0));
+    QCOMPARE(spy.at(3).value(1).value<QModelIndex>(), model->index(1, 0));
+    QCOMPARE(spy.at(3).value(2).value<QVector<int> >(), QVector<int>() << fileNameRole);
+
+    // Pending changes are delivered before rows are removed.
+    gallery.response()->metaDataChanged(4, 1, keys);
+    gallery.response()->removeRows(0, 1);
+
+    QCOMPARE(spy.count(), 5);
+    QCOMPARE(spy.last().value(0).value<QModelIndex>().row(), 4);
 }
 
 void tst_QDeclarativeDocumentGalleryModel::asyncResponse()
@@ -0,0 +1,324 @@
+/****************************************************************************
+**
+** Copyright (C) 2012 Digia Plc and/or its subsidiary(-ies).
+** Contact: http://www.qt-project.org/legal
+**
+** This file is part of the Qt Mobility Components.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and Digia.  For licensing terms and
+** conditions see http://qt.digia.com/licensing.  For further information
+** use the contact form at http://qt.digia.com/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU Lesser General Public License version 2.1 requirements
+** will be met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** In addition, as a special exception, Digia gives you certain additional
+** rights.  These rights are described in the Digia Qt LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3.0 as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU General Public License version 3.0 requirements will be
+** met: http://www.gnu.org/copyleft/gpl.html.
+**
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+//TESTED_COMPONENT=src/gallery
+
+#include <private/qdocumentgallery_tracker_p.h>
+#include <private/qgallerytrackerscheduler_p.h>
+#include <private/qgallerytrackerstatementcache_p.h>
+
+#include <qgalleryqueryrequest.h>
+#include <qgallerytyperequest.h>
+
+#include <QtTest/QtTest>
+
+#include <libtracker-sparql/tracker-sparql.h>
+
+QT_USE_DOCGALLERY_NAMESPACE
+
+class tst_QDocumentGalleryTracker : public QObject
+{
+    Q_OBJECT
+public:
+    tst_QDocumentGalleryTracker() : m_connection(0) {}
+
+public Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+    void cleanup();
+
+private Q_SLOTS:
+    void shareConnection();
+    void startPendingRequests();
+    void failPendingRequests();
+    void cancelPendingRequest();
+
+private:
+    TrackerSparqlConnection *m_connection;
+};
+
+/*
+    Gives the tests the gallery's private data, where its tracker connection is replaced by an
+    in-memory store which only becomes available when the test sets it.
+*/
+
+class QtTestDocumentGallery : public QDocumentGallery
+{
+public:
+    QtTestDocumentGallery()
+    {
+        QDocumentGalleryPrivate *d = this->d();
+
+        QObject::disconnect(d->trackerConnection.data(), 0, this, 0);
+
+        d->connection = 0;
+        d->connectionFailed = false;
+        d->statements.clear();
+    }
+
+    QDocumentGalleryPrivate *d() { return static_cast<QDocumentGalleryPrivate *>(d_ptr.data()); }
+};
+
+void tst_QDocumentGalleryTracker::initTestCase()
+{
+    GFile *ontology = tracker_sparql_get_ontology_nepomuk();
+
+    GError *error = 0;
+    m_connection = tracker_sparql_connection_new(
+            TRACKER_SPARQL_CONNECTION_FLAGS_NONE, 0, ontology, 0, &error);
+
+    g_object_unref(ontology);
+
+    if (!m_connection) {
+        const QByteArray message = error->message;
+        g_error_free(error);
+
+        QFAIL(message.constData());
+    }
+}
+
+void tst_QDocumentGalleryTracker::cleanupTestCase()
+{
+    if (m_connection)
+        g_object_unref(m_connection);
+}
+
+void tst_QDocumentGalleryTracker::cleanup()
+{
+    QGalleryTrackerScheduler::instance()->waitForDone(5000);
+
+    QCoreApplication::sendPostedEvents(0, QEvent::DeferredDelete);
+}
+
+void tst_QDocumentGalleryTracker::shareConnection()
+{
+    QWeakPointer<QGalleryTrackerConnection> connection;
+    {
+        QScopedPointer<QtTestDocumentGallery> galleryA(new QtTestDocumentGallery);
+        QScopedPointer<QtTestDocumentGallery> galleryB(new QtTestDocumentGallery);
+
+        QVERIFY(galleryA->d()->trackerConnection);
+        QCOMPARE(galleryA->d()->trackerConnection, galleryB->d()->trackerConnection);
+        QVERIFY(galleryA->d()->m_notifier);
+        QCOMPARE(galleryA->d()->m_notifier, galleryB->d()->m_notifier);
+
+        // Plan caches and live result sets are used from the gallery's own thread so they
+        // aren't shared.
+        QVERIFY(&galleryA->d()->planCache != &galleryB->d()->planCache);
+
+        connection = galleryA->d()->trackerConnection;
+
+        galleryA.reset();
+
+        QVERIFY(!connection.isNull());
+        QCOMPARE(galleryB->d()->trackerConnection, connection.toStrongRef());
+    }
+
+    // The connection is closed with the last gallery using it.
+    QVERIFY(connection.isNull());
+}
+
+void tst_QDocumentGalleryTracker::startPendingRequests()
+{
+    QtTestDocumentGallery gallery;
+
+    QDocumentGalleryPrivate *d = gallery.d();
+
+    QSignalSpy readySpy(&gallery, SIGNAL(readyChanged()));
+
+    QCOMPARE(gallery.isReady(), false);
+
+    QGalleryQueryRequest staticRequest(&gallery);
+    staticRequest.setRootType(QDocumentGallery::Document);
+    staticRequest.setPropertyNames(QStringList() << QLatin1String("title"));
+
+    QGalleryQueryRequest liveRequest(&gallery);
+    liveRequest.setRootType(QDocumentGallery::Document);
+    liveRequest.setPropertyNames(QStringList() << QLatin1String("title"));
+    liveRequest.setAutoUpdate(true);
+
+    QGalleryQueryRequest pagedRequest(&gallery);
+    pagedRequest.setRootType(QDocumentGallery::Document);
+    pagedRequest.setPropertyNames(QStringList() << QLatin1String("title"));
+    pagedRequest.setPageSize(16);
+
+    QGalleryTypeRequest typeRequest(&gallery);
+    typeRequest.setItemType(QDocumentGallery::Document);
+
+    staticRequest.execute();
+    liveRequest.execute();
+    pagedRequest.execute();
+    typeRequest.execute();
+
+    // Without a connection the requests are held back rather than failed.
+    QCOMPARE(d->pendingResponses.count(), 4);
+
+    QCOMPARE(staticRequest.state(), QGalleryAbstractRequest::Active);
+    QCOMPARE(liveRequest.state(), QGalleryAbstractRequest::Active);
+    QCOMPARE(pagedRequest.state(), QGalleryAbstractRequest::Active);
+    QCOMPARE(typeRequest.state(), QGalleryAbstractRequest::Active);
+
+    QTest::qWait(50);
+
+    QCOMPARE(staticRequest.state(), QGalleryAbstractRequest::Active);
+    QCOMPARE(typeRequest.state(), QGalleryAbstractRequest::Active);
+    QCOMPARE(readySpy.count(), 0);
+
+    d->setConnection(m_connection, QSharedPointer<QGalleryTrackerStatementCache>(
+            new QGalleryTrackerStatementCache(m_connection)));
+
+    QCOMPARE(gallery.isReady(), true);
+    QCOMPARE(readySpy.count(), 1);
+    QCOMPARE(d->pendingResponses.count(), 0);
+
+    QVERIFY(staticRequest.waitForFinished(5000));
+    QVERIFY(liveRequest.waitForFinished(5000));
+    QVERIFY(pagedRequest.waitForFinished(5000));
+    QVERIFY(typeRequest.waitForFinished(5000));
+
+    QCOMPARE(staticRequest.error(), int(QDocumentGallery::NoError));
+    QCOMPARE(liveRequest.error(), int(QDocumentGallery::NoError));
+    QCOMPARE(pagedRequest.error(), int(QDocumentGallery::NoError));
+    QCOMPARE(typeRequest.error(), int(QDocumentGallery::NoError));
+
+    // Requests executed once the connection is open start straight away.
+    QGalleryQueryRequest lateRequest(&gallery);
+    lateRequest.setRootType(QDocumentGallery::Document);
+    lateRequest.setPropertyNames(QStringList() << QLatin1String("title"));
+    lateRequest.execute();
+
+    QCOMPARE(d->pendingResponses.count(), 0);
+    QVERIFY(lateRequest.waitForFinished(5000));
+    QCOMPARE(lateRequest.error(), int(QDocumentGallery::NoError));
+}
+
+void tst_QDocumentGalleryTracker::failPendingRequests()
+{
+    QtTestDocumentGallery gallery;
+
+    QDocumentGalleryPrivate *d = gallery.d();
+
+    QSignalSpy readySpy(&gallery, SIGNAL(readyChanged()));
+
+    QGalleryQueryRequest liveRequest(&gallery);
+    liveRequest.setRootType(QDocumentGallery::Document);
+    liveRequest.setPropertyNames(QStringList() << QLatin1String("title"));
+    liveRequest.setAutoUpdate(true);
+
+    QGalleryQueryRequest pagedRequest(&gallery);
+    pagedRequest.setRootType(QDocumentGallery::Document);
+    pagedRequest.setPropertyNames(QStringList() << QLatin1String("title"));
+    pagedRequest.setPageSize(16);
+
+    QGalleryTypeRequest typeRequest(&gallery);
+    typeRequest.setItemType(QDocumentGallery::Document);
+
+    liveRequest.execute();
+    pagedRequest.execute();
+    typeRequest.execute();
+
+    QCOMPARE(d->pendingResponses.count(), 3);
+
+    d->setConnection(0, QSharedPointer<QGalleryTrackerStatementCache>());
+
+    QCOMPARE(gallery.isReady(), false);
+    QCOMPARE(readySpy.count(), 0);
+    QCOMPARE(d->pendingResponses.count(), 0);
+
+    QCOMPARE(liveRequest.state(), QGalleryAbstractRequest::Error);
+    QCOMPARE(liveRequest.error(), int(QDocumentGallery::ConnectionError));
+    QCOMPARE(pagedRequest.state(), QGalleryAbstractRequest::Error);
+    QCOMPARE(pagedRequest.error(), int(QDocumentGallery::ConnectionError));
+    QCOMPARE(typeRequest.state(), QGalleryAbstractRequest::Error);
+    QCOMPARE(typeRequest.error(), int(QDocumentGallery::ConnectionError));
+
+    // Once the connection has failed new requests fail straight away.
+    QGalleryQueryRequest lateRequest(&gallery);
+    lateRequest.setRootType(QDocumentGallery::Document);
+    lateRequest.setPropertyNames(QStringList() << QLatin1String("title"));
+    lateRequest.execute();
+
+    QCOMPARE(d->pendingResponses.count(), 0);
+    QCOMPARE(lateRequest.state(), QGalleryAbstractRequest::Error);
+    QCOMPARE(lateRequest.error(), int(QDocumentGallery::ConnectionError));
+}
+
+void tst_QDocumentGalleryTracker::cancelPendingRequest()
+{
+    QtTestDocumentGallery gallery;
+
+    QDocumentGalleryPrivate *d = gallery.d();
+
+    QGalleryQueryRequest cancelledRequest(&gallery);
+    cancelledRequest.setRootType(QDocumentGallery::Document);
+    cancelledRequest.setPropertyNames(QStringList() << QLatin1String("title"));
+
+    QGalleryQueryRequest deletedRequest(&gallery);
+    deletedRequest.setRootType(QDocumentGallery::Document);
+    deletedRequest.setPropertyNames(QStringList() << QLatin1String("title"));
+
+    cancelledRequest.execute();
+    deletedRequest.execute();
+
+    QCOMPARE(d->pendingResponses.count(), 2);
+
+    cancelledRequest.cancel();
+    QCOMPARE(cancelledRequest.state(), QGalleryAbstractRequest::Canceled);
+
+    // Clearing a request deletes its response, which is dropped from the pending list.
+    deletedRequest.clear();
+    QCoreApplication::sendPostedEvents(0, QEvent::DeferredDelete);
+
+    d->setConnection(m_connection, QSharedPointer<QGalleryTrackerStatementCache>(
+            new QGalleryTrackerStatementCache(m_connection)));
+
+    QCOMPARE(d->pendingResponses.count(), 0);
+
+    // A response cancelled while it was waiting for the connection is never started.
+    QTest::qWait(50);
+
+    QCOMPARE(cancelledRequest.state(), QGalleryAbstractRequest::Canceled);
+    QCOMPARE(deletedRequest.state(), QGalleryAbstractRequest::Inactive);
+}
+
+QTEST_MAIN(tst_QDocumentGalleryTracker)
+
+#include "tst_qdocumentgallery_tracker.moc"
@@ -71,12 +71,14 @@ private Q_SLOTS:
     void autoUpdate();
     void offset();
     void limit();
+    void pageSize();
     void rootType();
     void rootItem();
     void scope();
     void filter();
     void indexes();
     void data();
+    void sparseRoles();
     void flags();
     void headerData();
     void addColumn();
@@ -87,6 +89,7 @@ private Q_SLOTS:
     void itemsRemoved();
     void itemsMoved();
     void metaDataChanged();
+    void fetchMore();
     void invalidIndex();
     void hierarchy();
     void setGallery();
@@ -505,6 +508,35 @@ void tst_QGalleryQueryModel::limit()
     QCOMPARE(spy.count(), 2);
 }
 
+void tst_QGalleryQueryModel::pageSize()
+{
+    QGalleryQueryModel model;
+
+    QSignalSpy spy(&model, SIGNAL(pageSizeChanged()));
+
+    QCOMPARE(model.pageSize(), 0);
+
+    model.setPageSize(0);
+    QCOMPARE(model.pageSize(), 0);
+    QCOMPARE(spy.count(), 0);
+
+    model.setPageSize(-21);
+    QCOMPARE(model.pageSize(), 0);
+    QCOMPARE(spy.count(), 0);
+
+    model.setPageSize(64);
+    QCOMPARE(model.pageSize(), 64);
+    QCOMPARE(spy.count(), 1);
+
+    model.setPageSize(64);
+    QCOMPARE(model.pageSize(), 64);
+    QCOMPARE(spy.count(), 1);
+
+    model.setPageSize(-21);
+    QCOMPARE(model.pageSize(), 0);
+    QCOMPARE(spy.count(), 2);
+}
+
 void tst_QGalleryQueryModel::rootType()
 {
     const QString itemType = QLatin1String("Audio");
@@ -887,6 +919,24 @@ void tst_QGalleryQueryModel::data()
     QCOMPARE(model.itemType(index), QString::fromLatin1("Audio"));
 }
 
+void tst_QGalleryQueryModel::sparseRoles()
+{
+    QtTestGallery gallery;
+    populateGallery(&gallery);
+
+    QGalleryQueryModel model(&gallery);
+
+    model.addColumn(QLatin1String("albumTitle"), Qt::UserRole + 4096);
+    model.addColumn(QLatin1String("displayName"), Qt::DisplayRole);
+    model.execute();
+
+    QCOMPARE(model.index(0, 0).data(Qt::UserRole + 4096), QVariant(QLatin1String("Greatest Hits")));
+    QCOMPARE(model.index(0, 0).data(Qt::DisplayRole), QVariant());
+    QCOMPARE(model.index(0, 1).data(Qt::DisplayRole), QVariant(QLatin1String("Interlude")));
+    QCOMPARE(model.index(0, 1).data(Qt::UserRole + 4096), QVariant());
+    QCOMPARE(model.index(1, 1).data(Qt::DisplayRole), QVariant(QLatin1String("beep.wav")));
+}
+
 void tst_QGalleryQueryModel::flags()
 {
     QtTestGallery gallery;
@@ -1700,6 +1750,71 @@ void tst_QGalleryQueryModel::metaDataChanged()
     QCOMPARE(dataSpy.count(), 7);
 }
 
+void tst_QGalleryQueryModel::fetchMore()
+{
+    QtTestGallery gallery;
+    for (int i = 0; i < 5; ++i)
+        gallery.addRow();
+
+    QGalleryQueryModel model(&gallery);
+    model.setPageSize(2);
+    model.execute();
+    QVERIFY(gallery.request() != 0);
+
+    QtTestResultSet *resultSet = qobject_cast<QtTestResultSet *>(gallery.request()->resultSet());
+    QVERIFY(resultSet != 0);
+
+    QCOMPARE(resultSet->itemCount(), 5);
+    QCOMPARE(model.rowCount(), 2);
+    QCOMPARE(model.canFetchMore(QModelIndex()), true);
+    QCOMPARE(model.canFetchMore(model.index(0, 0)), false);
+
+    QSignalSpy insertSpy(&model, SIGNAL(rowsInserted(QModelIndex,int,int)));
+    QSignalSpy removeSpy(&model, SIGNAL(rowsRemoved(QModelIndex,int,int)));
+
+    model.fetchMore(QModelIndex());
+    QCOMPARE(model.rowCount(), 4);
+    QCOMPARE(insertSpy.count(), 1);
+    QCOMPARE(insertSpy.last().at(1).toInt(), 2);
+    QCOMPARE(insertSpy.last().at(2).toInt(), 3);
+    QCOMPARE(model.canFetchMore(QModelIndex()), true);
+
+    // Rows inserted past the fetched rows aren't exposed.
+    resultSet->beginInsertRows(5);
+    resultSet->addRow();
+    resultSet->endInsertRows();
+    QCOMPARE(model.rowCount(), 4);
+    QCOMPARE(insertSpy.count(), 1);
+
+    // Rows inserted amongst the fetched rows are.
+    resultSet->beginInsertRows(1);
+    resultSet->addRow();
+    resultSet->endInsertRows();
+    QCOMPARE(model.rowCount(), 5);
+    QCOMPARE(insertSpy.count(), 2);
+    QCOMPARE(insertSpy.last().at(1).toInt(), 1);
+    QCOMPARE(insertSpy.last().at(2).toInt(), 1);
+
+    // Only the fetched part of a removed range is reported.
+    resultSet->removeRows(3, 3);
+    QCOMPARE(resultSet->itemCount(), 4);
+    QCOMPARE(model.rowCount(), 3);
+    QCOMPARE(removeSpy.count(), 1);
+    QCOMPARE(removeSpy.last().at(1).toInt(), 3);
+    QCOMPARE(removeSpy.last().at(2).toInt(), 4);
+
+    model.fetchMore(QModelIndex());
+    QCOMPARE(model.rowCount(), 4);
+    QCOMPARE(insertSpy.count(), 3);
+    QCOMPARE(insertSpy.last().at(1).toInt(), 3);
+    QCOMPARE(insertSpy.last().at(2).toInt(), 3);
+    QCOMPARE(model.canFetchMore(QModelIndex()), false);
+
+    model.fetchMore(QModelIndex());
+    QCOMPARE(model.rowCount(), 4);
+    QCOMPARE(insertSpy.count(), 3);
+}
+
 void tst_QGalleryQueryModel::invalidIndex()
 {
     QtTestGallery gallery;
@@ -47,6 +47,7 @@
 #include <qgalleryabstractresponse.h>
 #include <qgalleryresultset.h>
 #include <qgalleryresource.h>
+#include <qgalleryrowbuffer.h>
 #include <qgallerytype.h>
 
 #include <QtTest/QtTest>
@@ -65,14 +66,17 @@ private Q_SLOTS:
     void propertyNames();
     void sortPropertyNames();
     void autoUpdate();
+    void suspended();
     void offset();
     void limit();
+    void pageSize();
     void rootType();
     void rootItem();
     void scope();
     void filter();
     void executeSynchronous();
     void executeAsynchronous();
+    void randomAccess();
     void noResponse();
 };
 
@@ -281,6 +285,39 @@ void tst_QGalleryQueryRequest::autoUpdate()
     QCOMPARE(spy.count(), 2);
 }
 
+void tst_QGalleryQueryRequest::suspended()
+{
+    QtTestGallery gallery;
+    gallery.setState(QGalleryAbstractRequest::Idle);
+
+    QGalleryQueryRequest request(&gallery);
+
+    QSignalSpy spy(&request, SIGNAL(suspendedChanged()));
+
+    QCOMPARE(request.isSuspended(), false);
+
+    request.setSuspended(true);
+    QCOMPARE(request.isSuspended(), true);
+    QCOMPARE(spy.count(), 1);
+
+    request.setSuspended(true);
+    QCOMPARE(spy.count(), 1);
+
+    // A response created while suspended starts out suspended.
+    request.execute();
+    QVERIFY(request.resultSet() != 0);
+    QCOMPARE(request.resultSet()->isSuspended(), true);
+
+    request.setSuspended(false);
+    QCOMPARE(request.isSuspended(), false);
+    QCOMPARE(request.resultSet()->isSuspended(), false);
+    QCOMPARE(spy.count(), 2);
+
+    request.setSuspended(true);
+    QCOMPARE(request.resultSet()->isSuspended(), true);
+    QCOMPARE(spy.count(), 3);
+}
+
 void tst_QGalleryQueryRequest::offset()
 {
     QGalleryQueryRequest request;
@@ -339,6 +376,35 @@ void tst_QGalleryQueryRequest::limit()
     QCOMPARE(spy.count(), 2);
 }
 
+void tst_QGalleryQueryRequest::pageSize()
+{
+    QGalleryQueryRequest request;
+
+    QSignalSpy spy(&request, SIGNAL(pageSizeChanged()));
+
+    QCOMPARE(request.pageSize(), 0);
+
+    request.setPageSize(0);
+    QCOMPARE(request.pageSize(), 0);
+    QCOMPARE(spy.count(), 0);
+
+    request.setPageSize(-21);
+    QCOMPARE(request.pageSize(), 0);
+    QCOMPARE(spy.count(), 0);
+
+    request.setPageSize(64);
+    QCOMPARE(request.pageSize(), 64);
+    QCOMPARE(spy.count(), 1);
+
+    request.setPageSize(64);
+    QCOMPARE(request.pageSize(), 64);
+    QCOMPARE(spy.count(), 1);
+
+    request.setPageSize(-21);
+    QCOMPARE(request.pageSize(), 0);
+    QCOMPARE(spy.count(), 2);
+}
+
 void tst_QGalleryQueryRequest::rootType()
 {
     const QString itemType = QLatin1String("Audio");
@@ -594,6 +660,55 @@ void tst_QGalleryQueryRequest::executeAsynchronous()
     QCOMPARE(spy.last().at(0).value<QGalleryResultSet*>(), request.resultSet());
 }
 
+void tst_QGalleryQueryRequest::randomAccess()
+{
+    QtTestGallery gallery;
+    gallery.setState(QGalleryAbstractRequest::Finished);
+    gallery.setCount(3);
+
+    QGalleryQueryRequest request(&gallery);
+    request.setPropertyNames(QStringList()
+            << QLatin1String("title")
+            << QLatin1String("artist"));
+    request.execute();
+
+    QGalleryResultSet *resultSet = request.resultSet();
+    QVERIFY(resultSet != 0);
+
+    QSignalSpy spy(resultSet, SIGNAL(currentIndexChanged(int)));
+
+    const QVector<int> keys = QVector<int>() << 0 << 1;
+    QGalleryRowBuffer buffer;
+
+    // The test response has no random access of its own, every row is read by repositioning the
+    // result set once however many keys are read from it.
+    QCOMPARE(resultSet->readRows(0, 3, keys, &buffer), 3);
+    QCOMPARE(buffer.rowCount(), 3);
+    QCOMPARE(spy.count(), 3);
+    QCOMPARE(spy.at(0).at(0).toInt(), 0);
+    QCOMPARE(spy.at(1).at(0).toInt(), 1);
+    QCOMPARE(spy.at(2).at(0).toInt(), 2);
+    QCOMPARE(resultSet->currentIndex(), 2);
+
+    // Reading the row the result set is already positioned on doesn't move it.
+    QCOMPARE(resultSet->readRows(2, 1, keys, &buffer), 1);
+    QCOMPARE(spy.count(), 3);
+
+    QCOMPARE(resultSet->readRows(1, 1, keys, &buffer), 1);
+    QCOMPARE(spy.count(), 4);
+    QCOMPARE(spy.last().at(0).toInt(), 1);
+    QCOMPARE(resultSet->currentIndex(), 1);
+
+    QCOMPARE(resultSet->readRows(1, 1, keys, &buffer), 1);
+    QCOMPARE(spy.count(), 4);
+
+    // Rows past the end aren't read at all.
+    QCOMPARE(resultSet->readRows(3, 2, keys, &buffer), 0);
+    QCOMPARE(buffer.rowCount(), 0);
+    QCOMPARE(spy.count(), 4);
+    QCOMPARE(resultSet->currentIndex(), 1);
+}
+
 void tst_QGalleryQueryRequest::noResponse()
 {
     QGalleryQueryRequest request;
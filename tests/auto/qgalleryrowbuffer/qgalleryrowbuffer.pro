@@ -0,0 +1,3 @@
+include(../auto.pri)
+
+SOURCES += tst_qgalleryrowbuffer.cpp
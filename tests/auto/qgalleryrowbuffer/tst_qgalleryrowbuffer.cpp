@@ -0,0 +1,199 @@
+/****************************************************************************
+**
+** Copyright (C) 2012 Digia Plc and/or its subsidiary(-ies).
+** Contact: http://www.qt-project.org/legal
+**
+** This file is part of the Qt Mobility Components.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and Digia.  For licensing terms and
+** conditions see http://qt.digia.com/licensing.  For further information
+** use the contact form at http://qt.digia.com/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU Lesser General Public License version 2.1 requirements
+** will be met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** In addition, as a special exception, Digia gives you certain additional
+** rights.  These rights are described in the Digia Qt LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3.0 as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU General Public License version 3.0 requirements will be
+** met: http://www.gnu.org/copyleft/gpl.html.
+**
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+//TESTED_COMPONENT=src/gallery
+
+#include <qgalleryrowbuffer.h>
+
+#include <QtTest/QtTest>
+
+QT_USE_DOCGALLERY_NAMESPACE
+
+class tst_QGalleryRowBuffer : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void null();
+    void reset();
+    void integers();
+    void reals();
+    void dateTimes();
+    void text();
+    void reuse();
+};
+
+void tst_QGalleryRowBuffer::null()
+{
+    QGalleryRowBuffer buffer;
+
+    QCOMPARE(buffer.rowCount(), 0);
+    QCOMPARE(buffer.columnCount(), 0);
+}
+
+void tst_QGalleryRowBuffer::reset()
+{
+    QGalleryRowBuffer buffer;
+
+    buffer.reset(3, QVector<QGalleryRowBuffer::ColumnType>()
+            << QGalleryRowBuffer::Integer
+            << QGalleryRowBuffer::Text);
+
+    QCOMPARE(buffer.rowCount(), 3);
+    QCOMPARE(buffer.columnCount(), 2);
+    QCOMPARE(buffer.columnType(0), QGalleryRowBuffer::Integer);
+    QCOMPARE(buffer.columnType(1), QGalleryRowBuffer::Text);
+
+    for (int row = 0; row < 3; ++row) {
+        QCOMPARE(buffer.isNull(row, 0), true);
+        QCOMPARE(buffer.isNull(row, 1), true);
+        QCOMPARE(buffer.value(row, 0), QVariant());
+        QCOMPARE(buffer.value(row, 1), QVariant());
+    }
+
+    buffer.clear();
+
+    QCOMPARE(buffer.rowCount(), 0);
+    QCOMPARE(buffer.columnCount(), 0);
+}
+
+void tst_QGalleryRowBuffer::integers()
+{
+    QGalleryRowBuffer buffer;
+
+    buffer.reset(3, QVector<QGalleryRowBuffer::ColumnType>() << QGalleryRowBuffer::Integer);
+
+    qint64 *values = buffer.integers(0);
+    values[0] = 7;
+    values[2] = -3;
+    buffer.setNull(0, 0, false);
+    buffer.setNull(2, 0, false);
+
+    buffer.setValue(1, 0, QVariant(QLatin1String("45")));
+
+    QCOMPARE(buffer.isNull(0, 0), false);
+    QCOMPARE(buffer.isNull(1, 0), false);
+    QCOMPARE(buffer.integer(0, 0), Q_INT64_C(7));
+    QCOMPARE(buffer.integer(1, 0), Q_INT64_C(45));
+    QCOMPARE(buffer.integer(2, 0), Q_INT64_C(-3));
+    QCOMPARE(buffer.value(2, 0), QVariant(Q_INT64_C(-3)));
+
+    buffer.setValue(1, 0, QVariant());
+
+    QCOMPARE(buffer.isNull(1, 0), true);
+    QCOMPARE(buffer.value(1, 0), QVariant());
+}
+
+void tst_QGalleryRowBuffer::reals()
+{
+    QGalleryRowBuffer buffer;
+
+    buffer.reset(2, QVector<QGalleryRowBuffer::ColumnType>() << QGalleryRowBuffer::Real);
+
+    buffer.setValue(0, 0, 1.5);
+    buffer.reals(0)[1] = 0.25;
+    buffer.setNull(1, 0, false);
+
+    QCOMPARE(buffer.real(0, 0), 1.5);
+    QCOMPARE(buffer.real(1, 0), 0.25);
+    QCOMPARE(static_cast<const QGalleryRowBuffer &>(buffer).reals(0)[1], 0.25);
+    QCOMPARE(buffer.value(0, 0), QVariant(1.5));
+}
+
+void tst_QGalleryRowBuffer::dateTimes()
+{
+    const QDateTime dateTime(QDate(2011, 3, 14), QTime(9, 26, 53), Qt::UTC);
+
+    QGalleryRowBuffer buffer;
+
+    buffer.reset(2, QVector<QGalleryRowBuffer::ColumnType>() << QGalleryRowBuffer::DateTime);
+
+    buffer.setValue(0, 0, dateTime);
+    buffer.setValue(1, 0, QDateTime());
+
+    QCOMPARE(buffer.integer(0, 0), dateTime.toMSecsSinceEpoch());
+    QCOMPARE(buffer.value(0, 0), QVariant(dateTime));
+    QCOMPARE(buffer.isNull(1, 0), true);
+}
+
+void tst_QGalleryRowBuffer::text()
+{
+    QGalleryRowBuffer buffer;
+
+    buffer.reset(4, QVector<QGalleryRowBuffer::ColumnType>() << QGalleryRowBuffer::Text);
+
+    buffer.setText(2, 0, "abc", 3);
+    buffer.setValue(0, 0, QUrl(QLatin1String("file:///a/b c")));
+    buffer.setValue(1, 0, QStringList() << QLatin1String("x") << QLatin1String("y"));
+
+    QCOMPARE(buffer.text(0, 0), QByteArray("file:///a/b%20c"));
+    QCOMPARE(buffer.string(1, 0), QLatin1String("x|y"));
+    QCOMPARE(buffer.text(2, 0), QByteArray("abc"));
+    QCOMPARE(buffer.value(2, 0), QVariant(QLatin1String("abc")));
+    QCOMPARE(buffer.isNull(3, 0), true);
+    QCOMPARE(buffer.text(3, 0), QByteArray());
+    QCOMPARE(buffer.string(3, 0), QString());
+}
+
+void tst_QGalleryRowBuffer::reuse()
+{
+    QGalleryRowBuffer buffer;
+
+    buffer.reset(2, QVector<QGalleryRowBuffer::ColumnType>() << QGalleryRowBuffer::Text);
+    buffer.setText(0, 0, "first", 5);
+    buffer.setText(1, 0, "second", 6);
+
+    buffer.reset(1, QVector<QGalleryRowBuffer::ColumnType>()
+            << QGalleryRowBuffer::Integer
+            << QGalleryRowBuffer::Text);
+
+    QCOMPARE(buffer.rowCount(), 1);
+    QCOMPARE(buffer.columnType(0), QGalleryRowBuffer::Integer);
+    QCOMPARE(buffer.isNull(0, 0), true);
+    QCOMPARE(buffer.isNull(0, 1), true);
+
+    buffer.setText(0, 1, "third", 5);
+
+    QCOMPARE(buffer.text(0, 1), QByteArray("third"));
+}
+
+QTEST_MAIN(tst_QGalleryRowBuffer)
+
+#include "tst_qgalleryrowbuffer.moc"
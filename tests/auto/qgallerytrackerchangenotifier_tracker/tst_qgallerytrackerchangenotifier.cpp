@@ -0,0 +1,306 @@
+/****************************************************************************
+**
+** Copyright (C) 2012 Digia Plc and/or its subsidiary(-ies).
+** Contact: http://www.qt-project.org/legal
+**
+** This file is part of the Qt Mobility Components.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and Digia.  For licensing terms and
+** conditions see http://qt.digia.com/licensing.  For further information
+** use the contact form at http://qt.digia.com/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU Lesser General Public License version 2.1 requirements
+** will be met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** In addition, as a special exception, Digia gives you certain additional
+** rights.  These rights are described in the Digia Qt LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3.0 as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU General Public License version 3.0 requirements will be
+** met: http://www.gnu.org/copyleft/gpl.html.
+**
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+//TESTED_COMPONENT=src/gallery
+
+#include <private/qgallerytrackerchangenotifier_p.h>
+#include <private/qgallerytrackerscheduler_p.h>
+#include <private/qgallerytrackerschema_p.h>
+
+#include <QtTest/QtTest>
+
+#include <libtracker-sparql/tracker-sparql.h>
+
+QT_USE_DOCGALLERY_NAMESPACE
+
+Q_DECLARE_METATYPE(QGalleryTrackerResourceChangeList)
+
+class tst_QGalleryTrackerChangeNotifier : public QObject
+{
+    Q_OBJECT
+public:
+    tst_QGalleryTrackerChangeNotifier() : m_connection(0) {}
+
+public Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+    void cleanup();
+
+private Q_SLOTS:
+    void updateIds_data();
+    void updateIds();
+    void lookupError();
+    void deleteWhileLookingUp();
+    void itemsEdited();
+
+private:
+    QList<int> lookup(const QGalleryTrackerResourceChangeList &changes);
+
+    TrackerSparqlConnection *m_connection;
+};
+
+static const char *qt_audioGraph = "http://tracker.api.gnome.org/ontology/v3/tracker#Audio";
+
+static QGalleryTrackerResourceChange qt_resourceChange(
+        QGalleryTrackerResourceChange::Type type, const char *urn)
+{
+    const QGalleryTrackerResourceChange change = { type, QByteArray(urn) };
+
+    return change;
+}
+
+void tst_QGalleryTrackerChangeNotifier::initTestCase()
+{
+    GFile *ontology = tracker_sparql_get_ontology_nepomuk();
+
+    GError *error = 0;
+    m_connection = tracker_sparql_connection_new(
+            TRACKER_SPARQL_CONNECTION_FLAGS_NONE, 0, ontology, 0, &error);
+
+    g_object_unref(ontology);
+
+    if (!m_connection) {
+        const QByteArray message = error->message;
+        g_error_free(error);
+
+        QFAIL(message.constData());
+    }
+
+    // The resources are inserted before any notifier exists so the store never reports them
+    // itself.
+    tracker_sparql_connection_update(
+            m_connection,
+            "INSERT DATA {"
+            " <urn:test:playlist> a nmm:Playlist ."
+            " <urn:test:album> a nmm:MusicAlbum "
+            "}",
+            0,
+            &error);
+
+    if (error) {
+        const QByteArray message = error->message;
+        g_error_free(error);
+
+        QFAIL(message.constData());
+    }
+}
+
+void tst_QGalleryTrackerChangeNotifier::cleanupTestCase()
+{
+    if (m_connection)
+        g_object_unref(m_connection);
+}
+
+void tst_QGalleryTrackerChangeNotifier::cleanup()
+{
+    QGalleryTrackerScheduler::instance()->waitForDone(5000);
+}
+
+/*
+    Passes \a changes to a new notifier as an update of the tracker:Audio graph and returns the
+    update ids it reports, or an empty list if it doesn't report exactly one update.
+*/
+
+QList<int> tst_QGalleryTrackerChangeNotifier::lookup(const QGalleryTrackerResourceChangeList &changes)
+{
+    QGalleryTrackerChangeNotifier notifier(m_connection);
+
+    QList<QList<int> > updates;
+    QList<int> changeCounts;
+
+    connect(&notifier, &QGalleryTrackerChangeNotifier::itemsChanged,
+            [&updates, &changeCounts](const QList<int> &updateIds, const QGalleryTrackerResourceChangeList &changes) {
+        updates.append(updateIds);
+        changeCounts.append(changes.count());
+    });
+
+    notifier.handleGraphUpdate(QLatin1String(qt_audioGraph), changes);
+
+    QElapsedTimer timer;
+    timer.start();
+    while (updates.isEmpty() && timer.elapsed() < 5000)
+        QTest::qWait(10);
+
+    // Allow any redundant updates to arrive.
+    QTest::qWait(50);
+
+    if (updates.count() != 1 || changeCounts.first() != changes.count())
+        return QList<int>();
+
+    QList<int> updateIds = updates.first();
+    std::sort(updateIds.begin(), updateIds.end());
+
+    return updateIds;
+}
+
+void tst_QGalleryTrackerChangeNotifier::updateIds_data()
+{
+    QTest::addColumn<QGalleryTrackerResourceChangeList>("changes");
+    QTest::addColumn<QList<int> >("updateIds");
+
+    QList<int> graphIds = QGalleryTrackerSchema::graphUpdateIds(QLatin1String("tracker:Audio"));
+    std::sort(graphIds.begin(), graphIds.end());
+
+    QTest::newRow("created playlist")
+            << (QGalleryTrackerResourceChangeList()
+                    << qt_resourceChange(QGalleryTrackerResourceChange::Created, "urn:test:playlist"))
+            << (QList<int>() << 0x0040);
+
+    QTest::newRow("updated playlist and album")
+            << (QGalleryTrackerResourceChangeList()
+                    << qt_resourceChange(QGalleryTrackerResourceChange::Updated, "urn:test:playlist")
+                    << qt_resourceChange(QGalleryTrackerResourceChange::Updated, "urn:test:album"))
+            << (QList<int>() << 0x0040 << 0x0200);
+
+    QTest::newRow("deleted resource")
+            << (QGalleryTrackerResourceChangeList()
+                    << qt_resourceChange(QGalleryTrackerResourceChange::Updated, "urn:test:playlist")
+                    << qt_resourceChange(QGalleryTrackerResourceChange::Deleted, "urn:test:removed"))
+            << graphIds;
+
+    QTest::newRow("unknown resource")
+            << (QGalleryTrackerResourceChangeList()
+                    << qt_resourceChange(QGalleryTrackerResourceChange::Created, "urn:test:unknown"))
+            << graphIds;
+
+    QTest::newRow("unescapable urn")
+            << (QGalleryTrackerResourceChangeList()
+                    << qt_resourceChange(QGalleryTrackerResourceChange::Created, "urn:test:a>b"))
+            << graphIds;
+
+    {
+        QGalleryTrackerResourceChangeList changes;
+        for (int i = 0; i < 256; ++i)
+            changes << qt_resourceChange(QGalleryTrackerResourceChange::Updated, "urn:test:playlist");
+
+        QTest::newRow("256 resources")
+                << changes
+                << (QList<int>() << 0x0040);
+
+        changes << qt_resourceChange(QGalleryTrackerResourceChange::Updated, "urn:test:playlist");
+
+        QTest::newRow("257 resources")
+                << changes
+                << graphIds;
+    }
+}
+
+void tst_QGalleryTrackerChangeNotifier::updateIds()
+{
+    QFETCH(QGalleryTrackerResourceChangeList, changes);
+    QFETCH(QList<int>, updateIds);
+
+    QCOMPARE(lookup(changes), updateIds);
+}
+
+void tst_QGalleryTrackerChangeNotifier::lookupError()
+{
+    QList<int> graphIds = QGalleryTrackerSchema::graphUpdateIds(QLatin1String("tracker:Audio"));
+    std::sort(graphIds.begin(), graphIds.end());
+
+    // A quote isn't valid in an IRI so the query fails to parse.
+    QTest::ignoreMessage(
+            QtWarningMsg, QRegularExpression(QLatin1String("^Error looking up changed resource types:")));
+
+    QCOMPARE(lookup(QGalleryTrackerResourceChangeList()
+                    << qt_resourceChange(QGalleryTrackerResourceChange::Created, "urn:test:\"invalid")),
+             graphIds);
+}
+
+void tst_QGalleryTrackerChangeNotifier::deleteWhileLookingUp()
+{
+    QGalleryTrackerChangeNotifier *notifier = new QGalleryTrackerChangeNotifier(m_connection);
+
+    int updateCount = 0;
+
+    connect(notifier, &QGalleryTrackerChangeNotifier::itemsChanged, [&updateCount]() {
+        ++updateCount;
+    });
+
+    notifier->handleGraphUpdate(
+            QLatin1String(qt_audioGraph),
+            QGalleryTrackerResourceChangeList()
+                    << qt_resourceChange(QGalleryTrackerResourceChange::Created, "urn:test:playlist"));
+
+    // The lookup is cancelled and left to the scheduler to clean up.
+    delete notifier;
+
+    QVERIFY(QGalleryTrackerScheduler::instance()->waitForDone(5000));
+
+    QTest::qWait(50);
+
+    QCOMPARE(updateCount, 0);
+}
+
+void tst_QGalleryTrackerChangeNotifier::itemsEdited()
+{
+    QGalleryTrackerChangeNotifier notifier(m_connection);
+
+    QList<QList<int> > updates;
+    QList<QGalleryTrackerResourceChangeList> changeLists;
+
+    connect(&notifier, &QGalleryTrackerChangeNotifier::itemsChanged,
+            [&updates, &changeLists](const QList<int> &updateIds, const QGalleryTrackerResourceChangeList &changes) {
+        updates.append(updateIds);
+        changeLists.append(changes);
+    });
+
+    // Edits made through the gallery are already known so they're reported without a lookup.
+    notifier.itemsEdited(
+            QLatin1String("nmm:Playlist"),
+            QStringList() << QLatin1String("urn:test:playlist") << QLatin1String("urn:test:album"));
+
+    QCOMPARE(updates.count(), 1);
+    QCOMPARE(updates.first(), QList<int>() << 0x0040);
+    QCOMPARE(changeLists.first().count(), 2);
+    QCOMPARE(changeLists.first().at(0).type, QGalleryTrackerResourceChange::Updated);
+    QCOMPARE(changeLists.first().at(0).urn, QByteArray("urn:test:playlist"));
+    QCOMPARE(changeLists.first().at(1).type, QGalleryTrackerResourceChange::Updated);
+    QCOMPARE(changeLists.first().at(1).urn, QByteArray("urn:test:album"));
+
+    notifier.itemsEdited(QLatin1String("nmm:Playlist"), QStringList());
+
+    QCOMPARE(updates.count(), 1);
+}
+
+QTEST_MAIN(tst_QGalleryTrackerChangeNotifier)
+
+#include "tst_qgallerytrackerchangenotifier.moc"
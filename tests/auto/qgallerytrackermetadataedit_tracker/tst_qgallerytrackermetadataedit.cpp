@@ -0,0 +1,353 @@
+/****************************************************************************
+**
+** Copyright (C) 2012 Digia Plc and/or its subsidiary(-ies).
+** Contact: http://www.qt-project.org/legal
+**
+** This file is part of the Qt Mobility Components.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and Digia.  For licensing terms and
+** conditions see http://qt.digia.com/licensing.  For further information
+** use the contact form at http://qt.digia.com/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU Lesser General Public License version 2.1 requirements
+** will be met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** In addition, as a special exception, Digia gives you certain additional
+** rights.  These rights are described in the Digia Qt LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3.0 as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU General Public License version 3.0 requirements will be
+** met: http://www.gnu.org/copyleft/gpl.html.
+**
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+//TESTED_COMPONENT=src/gallery
+
+#include <private/qgallerytrackermetadataedit_p.h>
+
+#include <QtTest/QtTest>
+
+#include <libtracker-sparql/tracker-sparql.h>
+
+QT_USE_DOCGALLERY_NAMESPACE
+
+class tst_QGalleryTrackerMetaDataEdit : public QObject
+{
+    Q_OBJECT
+public:
+    tst_QGalleryTrackerMetaDataEdit() : m_connection(0) {}
+
+public Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+
+private Q_SLOTS:
+    void itemsInserted_data();
+    void itemsInserted();
+    void itemsRemoved_data();
+    void itemsRemoved();
+    void itemsMoved_data();
+    void itemsMoved();
+    void sequence();
+    void cachedValues();
+    void executeBatch();
+    void executeEmptyBatch();
+    void executeBatchError();
+
+private:
+    QString title(const QString &urn);
+
+    TrackerSparqlConnection *m_connection;
+};
+
+void tst_QGalleryTrackerMetaDataEdit::initTestCase()
+{
+    GFile *ontology = tracker_sparql_get_ontology_nepomuk();
+
+    GError *error = 0;
+    m_connection = tracker_sparql_connection_new(
+            TRACKER_SPARQL_CONNECTION_FLAGS_NONE, 0, ontology, 0, &error);
+
+    g_object_unref(ontology);
+
+    if (!m_connection) {
+        const QByteArray message = error->message;
+        g_error_free(error);
+
+        QFAIL(message.constData());
+    }
+
+    tracker_sparql_connection_update(
+            m_connection,
+            "INSERT DATA {"
+            " <urn:test:a> a nfo:PaginatedTextDocument ; nie:title \"a\" ."
+            " <urn:test:b> a nfo:PaginatedTextDocument ; nie:title \"b\" "
+            "}",
+            0,
+            &error);
+
+    if (error) {
+        const QByteArray message = error->message;
+        g_error_free(error);
+
+        QFAIL(message.constData());
+    }
+}
+
+void tst_QGalleryTrackerMetaDataEdit::cleanupTestCase()
+{
+    if (m_connection)
+        g_object_unref(m_connection);
+}
+
+QString tst_QGalleryTrackerMetaDataEdit::title(const QString &urn)
+{
+    const QByteArray sparql = QString(QLatin1String(
+            "SELECT ?title WHERE { <%1> nie:title ?title }")).arg(urn).toUtf8();
+
+    TrackerSparqlCursor *cursor = tracker_sparql_connection_query(
+            m_connection, sparql.constData(), 0, 0);
+
+    QString title;
+    if (cursor) {
+        if (tracker_sparql_cursor_next(cursor, 0, 0))
+            title = QString::fromUtf8(tracker_sparql_cursor_get_string(cursor, 0, 0));
+
+        g_object_unref(cursor);
+    }
+    return title;
+}
+
+void tst_QGalleryTrackerMetaDataEdit::itemsInserted_data()
+{
+    QTest::addColumn<int>("editIndex");
+    QTest::addColumn<int>("index");
+    QTest::addColumn<int>("count");
+    QTest::addColumn<int>("expectedIndex");
+
+    QTest::newRow("before") << 5 << 2 << 3 << 8;
+    QTest::newRow("at") << 5 << 5 << 3 << 8;
+    QTest::newRow("after") << 5 << 6 << 3 << 5;
+    QTest::newRow("front") << 0 << 0 << 1 << 1;
+    QTest::newRow("no index") << -1 << 0 << 3 << -1;
+}
+
+void tst_QGalleryTrackerMetaDataEdit::itemsInserted()
+{
+    QFETCH(int, editIndex);
+    QFETCH(int, index);
+    QFETCH(int, count);
+    QFETCH(int, expectedIndex);
+
+    QGalleryTrackerMetaDataEdit edit(0, QLatin1String("urn:test:a"), QLatin1String("urn:test:a"));
+    edit.setIndex(editIndex);
+
+    edit.itemsInserted(index, count);
+
+    QCOMPARE(edit.index(), expectedIndex);
+}
+
+void tst_QGalleryTrackerMetaDataEdit::itemsRemoved_data()
+{
+    QTest::addColumn<int>("editIndex");
+    QTest::addColumn<int>("index");
+    QTest::addColumn<int>("count");
+    QTest::addColumn<int>("expectedIndex");
+
+    QTest::newRow("before") << 5 << 1 << 3 << 2;
+    QTest::newRow("immediately before") << 5 << 2 << 3 << 2;
+    QTest::newRow("including") << 5 << 3 << 3 << -1;
+    QTest::newRow("starting at") << 5 << 5 << 3 << -1;
+    QTest::newRow("only") << 5 << 5 << 1 << -1;
+    QTest::newRow("after") << 5 << 6 << 3 << 5;
+    QTest::newRow("no index") << -1 << 0 << 3 << -1;
+}
+
+void tst_QGalleryTrackerMetaDataEdit::itemsRemoved()
+{
+    QFETCH(int, editIndex);
+    QFETCH(int, index);
+    QFETCH(int, count);
+    QFETCH(int, expectedIndex);
+
+    QGalleryTrackerMetaDataEdit edit(0, QLatin1String("urn:test:a"), QLatin1String("urn:test:a"));
+    edit.setIndex(editIndex);
+
+    edit.itemsRemoved(index, count);
+
+    QCOMPARE(edit.index(), expectedIndex);
+}
+
+void tst_QGalleryTrackerMetaDataEdit::itemsMoved_data()
+{
+    QTest::addColumn<int>("editIndex");
+    QTest::addColumn<int>("from");
+    QTest::addColumn<int>("to");
+    QTest::addColumn<int>("count");
+    QTest::addColumn<int>("expectedIndex");
+
+    // Destinations are given in the same way as QAbstractItemModel::beginMoveRows().
+    QTest::newRow("moved forward") << 2 << 2 << 8 << 2 << 6;
+    QTest::newRow("moved backward") << 6 << 5 << 1 << 2 << 2;
+    QTest::newRow("shifted backward") << 4 << 2 << 8 << 2 << 2;
+    QTest::newRow("shifted forward") << 3 << 5 << 1 << 2 << 5;
+    QTest::newRow("behind move") << 9 << 2 << 8 << 2 << 9;
+    QTest::newRow("ahead of move") << 0 << 5 << 1 << 2 << 0;
+    QTest::newRow("no index") << -1 << 2 << 8 << 2 << -1;
+}
+
+void tst_QGalleryTrackerMetaDataEdit::itemsMoved()
+{
+    QFETCH(int, editIndex);
+    QFETCH(int, from);
+    QFETCH(int, to);
+    QFETCH(int, count);
+    QFETCH(int, expectedIndex);
+
+    QGalleryTrackerMetaDataEdit edit(0, QLatin1String("urn:test:a"), QLatin1String("urn:test:a"));
+    edit.setIndex(editIndex);
+
+    edit.itemsMoved(from, to, count);
+
+    QCOMPARE(edit.index(), expectedIndex);
+}
+
+void tst_QGalleryTrackerMetaDataEdit::sequence()
+{
+    QGalleryTrackerMetaDataEdit edit(0, QLatin1String("urn:test:a"), QLatin1String("urn:test:a"));
+    edit.setIndex(4);
+
+    edit.itemsInserted(0, 2);
+    QCOMPARE(edit.index(), 6);
+
+    edit.itemsMoved(6, 0, 1);
+    QCOMPARE(edit.index(), 0);
+
+    edit.itemsRemoved(1, 4);
+    QCOMPARE(edit.index(), 0);
+
+    edit.itemsInserted(1, 4);
+    QCOMPARE(edit.index(), 0);
+
+    edit.itemsRemoved(0, 1);
+    QCOMPARE(edit.index(), -1);
+
+    // Once its row is gone the edit stays detached from the result set.
+    edit.itemsInserted(0, 2);
+    edit.itemsMoved(0, 4, 2);
+    QCOMPARE(edit.index(), -1);
+}
+
+void tst_QGalleryTrackerMetaDataEdit::cachedValues()
+{
+    QGalleryTrackerMetaDataEdit edit(0, QLatin1String("urn:test:a"), QLatin1String("urn:test:a"));
+
+    edit.setCachedValue(1, QLatin1String("b"), QLatin1String("a"));
+    edit.setCachedValue(1, QLatin1String("c"), QLatin1String("b"));
+    edit.setCachedValue(2, 3, 2);
+
+    QCOMPARE(edit.cachedValues().value(1), QVariant(QLatin1String("c")));
+    QCOMPARE(edit.cachedValues().value(2), QVariant(3));
+
+    // The original value is the one cached before the first edit.
+    QCOMPARE(edit.originalValues().value(1), QVariant(QLatin1String("a")));
+    QCOMPARE(edit.originalValues().value(2), QVariant(2));
+}
+
+void tst_QGalleryTrackerMetaDataEdit::executeBatch()
+{
+    QGalleryTrackerMetaDataBatch batch(m_connection);
+
+    QGalleryTrackerMetaDataEdit *aEdit = new QGalleryTrackerMetaDataEdit(
+            m_connection, QLatin1String("file:///a"), QLatin1String("urn:test:a"));
+    aEdit->setValue(QLatin1String("nie:title"), QLatin1String("c"), QLatin1String("a"));
+
+    QGalleryTrackerMetaDataEdit *bEdit = new QGalleryTrackerMetaDataEdit(
+            m_connection, QLatin1String("file:///b"), QLatin1String("urn:test:b"));
+    bEdit->setValue(QLatin1String("nie:title"), QLatin1String("d"), QLatin1String("b"));
+
+    QGalleryTrackerMetaDataEdit *emptyEdit = new QGalleryTrackerMetaDataEdit(
+            m_connection, QLatin1String("file:///e"), QLatin1String("urn:test:e"));
+
+    batch.addEdit(aEdit);
+    batch.addEdit(bEdit);
+    batch.addEdit(emptyEdit);
+
+    QCOMPARE(aEdit->parent(), &batch);
+    QCOMPARE(batch.edits().count(), 3);
+    QCOMPARE(batch.resources(), QStringList()
+            << QLatin1String("urn:test:a")
+            << QLatin1String("urn:test:b"));
+
+    QSignalSpy spy(&batch, SIGNAL(finished(QGalleryTrackerMetaDataBatch*)));
+
+    batch.execute();
+
+    // Both edits are committed together in a single asynchronous update.
+    QCOMPARE(spy.count(), 0);
+    QTRY_COMPARE(spy.count(), 1);
+    QCOMPARE(batch.errorString(), QString());
+    QCOMPARE(title(QLatin1String("urn:test:a")), QLatin1String("c"));
+    QCOMPARE(title(QLatin1String("urn:test:b")), QLatin1String("d"));
+}
+
+void tst_QGalleryTrackerMetaDataEdit::executeEmptyBatch()
+{
+    QGalleryTrackerMetaDataBatch batch(m_connection);
+
+    batch.addEdit(new QGalleryTrackerMetaDataEdit(
+            m_connection, QLatin1String("file:///a"), QLatin1String("urn:test:a")));
+
+    QCOMPARE(batch.resources(), QStringList());
+
+    QSignalSpy spy(&batch, SIGNAL(finished(QGalleryTrackerMetaDataBatch*)));
+
+    // With nothing to write the batch finishes straight away.
+    batch.execute();
+
+    QCOMPARE(spy.count(), 1);
+    QCOMPARE(batch.errorString(), QString());
+}
+
+void tst_QGalleryTrackerMetaDataEdit::executeBatchError()
+{
+    QGalleryTrackerMetaDataBatch batch(m_connection);
+
+    QGalleryTrackerMetaDataEdit *edit = new QGalleryTrackerMetaDataEdit(
+            m_connection, QLatin1String("file:///a"), QLatin1String("urn:test:a"));
+    edit->setValue(QLatin1String("nie:unknownProperty"), QLatin1String("x"), QString());
+
+    batch.addEdit(edit);
+
+    QSignalSpy spy(&batch, SIGNAL(finished(QGalleryTrackerMetaDataBatch*)));
+
+    QTest::ignoreMessage(
+            QtWarningMsg, QRegularExpression(QLatin1String("^Error executing sparql commit")));
+
+    batch.execute();
+
+    QTRY_COMPARE(spy.count(), 1);
+    QVERIFY(!batch.errorString().isEmpty());
+}
+
+QTEST_MAIN(tst_QGalleryTrackerMetaDataEdit)
+
+#include "tst_qgallerytrackermetadataedit.moc"
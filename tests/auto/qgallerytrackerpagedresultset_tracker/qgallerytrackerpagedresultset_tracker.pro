@@ -0,0 +1,8 @@
+include(../auto.pri)
+
+QT += docgallery docgallery-private
+
+CONFIG += link_pkgconfig
+PKGCONFIG += tracker-sparql-3.0
+
+SOURCES += tst_qgallerytrackerpagedresultset.cpp
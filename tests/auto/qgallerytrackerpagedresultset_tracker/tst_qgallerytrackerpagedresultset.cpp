@@ -0,0 +1,427 @@
+/****************************************************************************
+**
+** Copyright (C) 2012 Digia Plc and/or its subsidiary(-ies).
+** Contact: http://www.qt-project.org/legal
+**
+** This file is part of the Qt Mobility Components.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and Digia.  For licensing terms and
+** conditions see http://qt.digia.com/licensing.  For further information
+** use the contact form at http://qt.digia.com/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU Lesser General Public License version 2.1 requirements
+** will be met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** In addition, as a special exception, Digia gives you certain additional
+** rights.  These rights are described in the Digia Qt LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3.0 as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU General Public License version 3.0 requirements will be
+** met: http://www.gnu.org/copyleft/gpl.html.
+**
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+//TESTED_COMPONENT=src/gallery
+
+#include <private/qgallerytrackerpagedresultset_p.h>
+#include <private/qgallerytrackerlistcolumn_p.h>
+#include <private/qgallerytrackerscheduler_p.h>
+#include <private/qgallerytrackertable_p.h>
+
+#include <qgalleryrowbuffer.h>
+
+#include <QtTest/QtTest>
+
+#include <libtracker-sparql/tracker-sparql.h>
+
+QT_USE_DOCGALLERY_NAMESPACE
+
+class tst_QGalleryTrackerPagedResultSet : public QObject
+{
+    Q_OBJECT
+public:
+    tst_QGalleryTrackerPagedResultSet() : m_connection(0) {}
+
+public Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+    void cleanup();
+
+private Q_SLOTS:
+    void query();
+    void fetchPage();
+    void readRows();
+    void deleteWhileLoading();
+
+private:
+    void populateArguments(QGalleryTrackerResultSetArguments *arguments);
+    bool update(const QString &sparql);
+    bool setCount(int count);
+
+    TrackerSparqlConnection *m_connection;
+};
+
+class QtTestStringColumn : public QGalleryTrackerValueColumn
+{
+public:
+    QtTestStringColumn *clone() const { return new QtTestStringColumn; }
+    QVariant::Type type() const { return QVariant::String; }
+    void appendValue(TrackerSparqlCursor *cursor, int index, QGalleryTrackerValueStore *store) const
+    {
+        if (tracker_sparql_cursor_get_value_type(cursor, index) == TRACKER_SPARQL_VALUE_TYPE_UNBOUND)
+            store->appendNull();
+        else
+            store->appendValue(QString::fromUtf8(tracker_sparql_cursor_get_string(cursor, index, 0)));
+    }
+};
+
+class QtTestIntegerColumn : public QGalleryTrackerValueColumn
+{
+public:
+    QtTestIntegerColumn *clone() const { return new QtTestIntegerColumn; }
+    QVariant::Type type() const { return QVariant::Int; }
+    void appendValue(TrackerSparqlCursor *cursor, int index, QGalleryTrackerValueStore *store) const
+    {
+        if (tracker_sparql_cursor_get_value_type(cursor, index) == TRACKER_SPARQL_VALUE_TYPE_UNBOUND)
+            store->appendNull();
+        else
+            store->appendValue(int(tracker_sparql_cursor_get_integer(cursor, index)));
+    }
+};
+
+class QtTestIdentityColumn : public QGalleryTrackerCompositeColumn
+{
+public:
+    QtTestIdentityColumn(int column) : m_column(column) {}
+
+    QtTestIdentityColumn *clone() const { return new QtTestIdentityColumn(m_column); }
+    QVariant value(const QGalleryTrackerRow &row) const { return row.value(m_column); }
+
+private:
+    const int m_column;
+};
+
+class QtTestStaticColumn : public QGalleryTrackerCompositeColumn
+{
+public:
+    QtTestStaticColumn(const QVariant &value) : m_value(value) {}
+
+    QtTestStaticColumn *clone() const { return new QtTestStaticColumn(m_value); }
+    QVariant value(const QGalleryTrackerRow &) const { return m_value; }
+
+private:
+    const QVariant m_value;
+};
+
+static const char *qt_documentQuery =
+        "SELECT ?x ?title ?pages "
+        "WHERE {"
+        " ?x a nfo:PaginatedTextDocument ; nie:title ?title ."
+        " OPTIONAL { ?x nfo:pageCount ?pages }"
+        "} "
+        "ORDER BY ?title";
+
+static const char *qt_documentCountQuery =
+        "SELECT COUNT(?x) WHERE { ?x a nfo:PaginatedTextDocument }";
+
+static QString qt_title(int index)
+{
+    return QString(QLatin1String("a-%1")).arg(index, 4, 10, QLatin1Char('0'));
+}
+
+void tst_QGalleryTrackerPagedResultSet::initTestCase()
+{
+    GFile *ontology = tracker_sparql_get_ontology_nepomuk();
+
+    GError *error = 0;
+    m_connection = tracker_sparql_connection_new(
+            TRACKER_SPARQL_CONNECTION_FLAGS_NONE, 0, ontology, 0, &error);
+
+    g_object_unref(ontology);
+
+    if (!m_connection) {
+        const QByteArray message = error->message;
+        g_error_free(error);
+
+        QFAIL(message.constData());
+    }
+}
+
+void tst_QGalleryTrackerPagedResultSet::cleanupTestCase()
+{
+    if (m_connection)
+        g_object_unref(m_connection);
+}
+
+void tst_QGalleryTrackerPagedResultSet::cleanup()
+{
+    QGalleryTrackerScheduler::instance()->waitForDone(5000);
+
+    update(QLatin1String(
+            "DELETE { ?x a rdfs:Resource } WHERE { ?x a nfo:PaginatedTextDocument }"));
+}
+
+bool tst_QGalleryTrackerPagedResultSet::update(const QString &sparql)
+{
+    GError *error = 0;
+    tracker_sparql_connection_update(m_connection, sparql.toUtf8().constData(), 0, &error);
+
+    if (error) {
+        qWarning("%s", error->message);
+        g_error_free(error);
+
+        return false;
+    }
+    return true;
+}
+
+/*
+    Inserts \a count documents titled a-0000 and up, each with a page count equal to its number.
+*/
+
+bool tst_QGalleryTrackerPagedResultSet::setCount(int count)
+{
+    QString sparql = QLatin1String("INSERT DATA {");
+
+    for (int i = 0; i < count; ++i) {
+        sparql += QString(QLatin1String(
+                " <urn:test:%1> a nfo:PaginatedTextDocument ;"
+                " nie:title \"%1\" ; nfo:pageCount %2 ."))
+                .arg(qt_title(i))
+                .arg(i);
+    }
+    sparql += QLatin1String(" }");
+
+    return update(sparql);
+}
+
+void tst_QGalleryTrackerPagedResultSet::populateArguments(
+        QGalleryTrackerResultSetArguments *arguments)
+{
+    arguments->idColumn.reset(new QtTestIdentityColumn(1));
+    arguments->urlColumn.reset(new QtTestStaticColumn(QUrl()));
+    arguments->typeColumn.reset(new QtTestStaticColumn(QLatin1String("Document")));
+    arguments->updateMask = 0x01;
+    arguments->identityWidth = 1;
+    arguments->tableWidth = 3;
+    arguments->valueOffset = 1;
+    arguments->compositeOffset = 3;
+    arguments->pageSparql = QLatin1String(qt_documentQuery);
+    arguments->countSparql = QLatin1String(qt_documentCountQuery);
+    arguments->propertyNames = QStringList()
+            << QLatin1String("title")
+            << QLatin1String("pageCount");
+    arguments->propertyAttributes = QVector<QGalleryProperty::Attributes>()
+            << (QGalleryProperty::CanRead | QGalleryProperty::CanSort)
+            << (QGalleryProperty::CanRead);
+    arguments->propertyTypes = QVector<QVariant::Type>()
+            << QVariant::String
+            << QVariant::Int;
+    arguments->valueColumns = QVector<QGalleryTrackerValueColumn *>()
+            << new QtTestStringColumn
+            << new QtTestStringColumn
+            << new QtTestIntegerColumn;
+}
+
+void tst_QGalleryTrackerPagedResultSet::query()
+{
+    QVERIFY(setCount(40));
+
+    QGalleryTrackerResultSetArguments arguments;
+    populateArguments(&arguments);
+
+    QGalleryTrackerPagedResultSet resultSet(m_connection, &arguments, 16, false);
+
+    QSignalSpy insertSpy(&resultSet, SIGNAL(itemsInserted(int,int)));
+    QSignalSpy changeSpy(&resultSet, SIGNAL(metaDataChanged(int,int,QList<int>)));
+
+    QCOMPARE(resultSet.isActive(), true);
+    QCOMPARE(resultSet.itemCount(), 0);
+
+    QVERIFY(resultSet.waitForFinished(5000));
+
+    QCOMPARE(resultSet.isActive(), false);
+    QCOMPARE(resultSet.itemCount(), 40);
+    QCOMPARE(insertSpy.count(), 1);
+    QCOMPARE(insertSpy.last().value(0).toInt(), 0);
+    QCOMPARE(insertSpy.last().value(1).toInt(), 40);
+
+    // The first page is loaded along with the count, and only the first page.
+    QTRY_COMPARE(changeSpy.count(), 1);
+    QCOMPARE(changeSpy.last().value(0).toInt(), 0);
+    QCOMPARE(changeSpy.last().value(1).toInt(), 16);
+    QCOMPARE(changeSpy.last().value(2).value<QList<int> >(), QList<int>() << 1 << 2);
+
+    QCOMPARE(resultSet.fetch(15), true);
+    QCOMPARE(resultSet.itemId(), QVariant(qt_title(15)));
+    QCOMPARE(resultSet.itemType(), QLatin1String("Document"));
+    QCOMPARE(resultSet.metaData(1), QVariant(qt_title(15)));
+    QCOMPARE(resultSet.metaData(2), QVariant(15));
+
+    QCOMPARE(QGalleryTrackerScheduler::instance()->waitForDone(5000), true);
+    QCoreApplication::sendPostedEvents();
+
+    QCOMPARE(changeSpy.count(), 1);
+}
+
+void tst_QGalleryTrackerPagedResultSet::fetchPage()
+{
+    QVERIFY(setCount(40));
+
+    QGalleryTrackerResultSetArguments arguments;
+    populateArguments(&arguments);
+
+    QGalleryTrackerPagedResultSet resultSet(m_connection, &arguments, 16, false);
+    QVERIFY(resultSet.waitForFinished(5000));
+    QCOMPARE(resultSet.fetch(0), true);
+    QTRY_VERIFY(!resultSet.itemId().isNull());
+
+    QSignalSpy changeSpy(&resultSet, SIGNAL(metaDataChanged(int,int,QList<int>)));
+    QSignalSpy itemSpy(&resultSet, SIGNAL(currentItemChanged()));
+
+    // The index is valid but the row isn't resident, it's null until its page has been loaded.
+    QCOMPARE(resultSet.fetch(20), true);
+    QCOMPARE(resultSet.currentIndex(), 20);
+    QCOMPARE(resultSet.itemId(), QVariant());
+    QCOMPARE(resultSet.metaData(1), QVariant());
+    QCOMPARE(itemSpy.count(), 1);
+
+    QTRY_COMPARE(changeSpy.count(), 1);
+    QCOMPARE(changeSpy.last().value(0).toInt(), 16);
+    QCOMPARE(changeSpy.last().value(1).toInt(), 16);
+    QCOMPARE(itemSpy.count(), 2);
+
+    QCOMPARE(resultSet.itemId(), QVariant(qt_title(20)));
+    QCOMPARE(resultSet.metaData(2), QVariant(20));
+
+    // The last page is short.
+    QCOMPARE(resultSet.fetch(39), true);
+    QCOMPARE(resultSet.itemId(), QVariant());
+
+    QTRY_COMPARE(changeSpy.count(), 2);
+    QCOMPARE(changeSpy.last().value(0).toInt(), 32);
+    QCOMPARE(changeSpy.last().value(1).toInt(), 8);
+
+    QCOMPARE(resultSet.itemId(), QVariant(qt_title(39)));
+
+    QCOMPARE(resultSet.fetch(40), false);
+    QCOMPARE(resultSet.itemId(), QVariant());
+
+    // Resident pages are read without being loaded again.
+    QCOMPARE(resultSet.fetch(17), true);
+    QCOMPARE(resultSet.itemId(), QVariant(qt_title(17)));
+
+    QCOMPARE(QGalleryTrackerScheduler::instance()->waitForDone(5000), true);
+    QCoreApplication::sendPostedEvents();
+
+    QCOMPARE(changeSpy.count(), 2);
+}
+
+void tst_QGalleryTrackerPagedResultSet::readRows()
+{
+    QVERIFY(setCount(40));
+
+    QGalleryTrackerResultSetArguments arguments;
+    populateArguments(&arguments);
+
+    QGalleryTrackerPagedResultSet resultSet(m_connection, &arguments, 16, false);
+
+    QSignalSpy changeSpy(&resultSet, SIGNAL(metaDataChanged(int,int,QList<int>)));
+    QSignalSpy indexSpy(&resultSet, SIGNAL(currentIndexChanged(int)));
+
+    QVERIFY(resultSet.waitForFinished(5000));
+    QTRY_COMPARE(changeSpy.count(), 1);
+
+    const QVector<int> keys = QVector<int>() << 1 << 2;
+
+    QGalleryRowBuffer buffer;
+
+    // Rows spanning a page that isn't resident are null, and reading them requests the page.
+    QCOMPARE(resultSet.readRows(8, 16, keys, &buffer), 16);
+    QCOMPARE(buffer.rowCount(), 16);
+
+    for (int i = 8; i < 24; ++i) {
+        if (i < 16) {
+            QCOMPARE(buffer.string(i - 8, 0), qt_title(i));
+            QCOMPARE(buffer.integer(i - 8, 1), qint64(i));
+        } else {
+            QCOMPARE(buffer.isNull(i - 8, 0), true);
+            QCOMPARE(buffer.isNull(i - 8, 1), true);
+        }
+    }
+
+    QTRY_COMPARE(changeSpy.count(), 2);
+    QCOMPARE(changeSpy.last().value(0).toInt(), 16);
+    QCOMPARE(changeSpy.last().value(1).toInt(), 16);
+
+    QCOMPARE(resultSet.readRows(8, 16, keys, &buffer), 16);
+
+    for (int i = 8; i < 24; ++i) {
+        QCOMPARE(buffer.string(i - 8, 0), qt_title(i));
+        QCOMPARE(buffer.integer(i - 8, 1), qint64(i));
+    }
+
+    QCOMPARE(indexSpy.count(), 0);
+    QCOMPARE(resultSet.currentIndex(), -1);
+}
+
+void tst_QGalleryTrackerPagedResultSet::deleteWhileLoading()
+{
+    QVERIFY(setCount(1024));
+
+    for (int i = 0; i < 8; ++i) {
+        QGalleryTrackerResultSetArguments arguments;
+        populateArguments(&arguments);
+
+        QGalleryTrackerPagedResultSet *resultSet = new QGalleryTrackerPagedResultSet(
+                m_connection, &arguments, 256, true);
+
+        QCOMPARE(resultSet->isActive(), true);
+
+        delete resultSet;
+    }
+
+    {
+        QGalleryTrackerResultSetArguments arguments;
+        populateArguments(&arguments);
+
+        QGalleryTrackerPagedResultSet *resultSet = new QGalleryTrackerPagedResultSet(
+                m_connection, &arguments, 256, true);
+
+        QVERIFY(resultSet->waitForFinished(5000));
+        QCOMPARE(resultSet->itemCount(), 1024);
+
+        // Request the remaining pages and delete the result set while they load.
+        QGalleryRowBuffer buffer;
+        QCOMPARE(resultSet->readRows(256, 768, QVector<int>() << 1 << 2, &buffer), 768);
+
+        delete resultSet;
+    }
+
+    // The pages finish loading on their own and are posted to nothing.
+    QVERIFY(QGalleryTrackerScheduler::instance()->waitForDone(5000));
+
+    QCoreApplication::sendPostedEvents();
+}
+
+QTEST_MAIN(tst_QGalleryTrackerPagedResultSet)
+
+#include "tst_qgallerytrackerpagedresultset.moc"
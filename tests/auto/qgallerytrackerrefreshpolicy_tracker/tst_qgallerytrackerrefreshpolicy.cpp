@@ -0,0 +1,185 @@
+/****************************************************************************
+**
+** Copyright (C) 2012 Digia Plc and/or its subsidiary(-ies).
+** Contact: http://www.qt-project.org/legal
+**
+** This file is part of the Qt Mobility Components.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and Digia.  For licensing terms and
+** conditions see http://qt.digia.com/licensing.  For further information
+** use the contact form at http://qt.digia.com/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU Lesser General Public License version 2.1 requirements
+** will be met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** In addition, as a special exception, Digia gives you certain additional
+** rights.  These rights are described in the Digia Qt LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3.0 as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU General Public License version 3.0 requirements will be
+** met: http://www.gnu.org/copyleft/gpl.html.
+**
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+//TESTED_COMPONENT=src/gallery
+
+#include <private/qgallerytrackerrefreshpolicy_p.h>
+
+#include <QtTest/QtTest>
+
+QT_USE_DOCGALLERY_NAMESPACE
+
+class tst_QGalleryTrackerRefreshPolicy : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void defaultSettings();
+    void quietChanges();
+    void backOff();
+    void backOffFromZero();
+    void maximumDelay();
+    void maximumRate();
+    void unlimitedRate();
+    void statistics();
+
+private:
+    static QGalleryTrackerRefreshPolicy::Settings settings(
+            int minimumDelay, int maximumDelay, int maximumRate)
+    {
+        const QGalleryTrackerRefreshPolicy::Settings settings
+                = { minimumDelay, maximumDelay, maximumRate };
+        return settings;
+    }
+};
+
+void tst_QGalleryTrackerRefreshPolicy::defaultSettings()
+{
+    const QGalleryTrackerRefreshPolicy::Settings original
+            = QGalleryTrackerRefreshPolicy::defaultSettings();
+
+    QVERIFY(original.minimumDelay >= 0);
+    QVERIFY(original.maximumDelay >= original.minimumDelay);
+
+    QGalleryTrackerRefreshPolicy::setDefaultSettings(settings(50, 400, 5));
+
+    QGalleryTrackerRefreshPolicy policy;
+    QCOMPARE(policy.settings().minimumDelay, 50);
+    QCOMPARE(policy.settings().maximumDelay, 400);
+    QCOMPARE(policy.settings().maximumRate, 5);
+    QCOMPARE(policy.delay(), 50);
+
+    QGalleryTrackerRefreshPolicy::setDefaultSettings(original);
+}
+
+void tst_QGalleryTrackerRefreshPolicy::quietChanges()
+{
+    QGalleryTrackerRefreshPolicy policy(settings(100, 1600, 0));
+
+    QCOMPARE(policy.changed(0, false), 100);
+    QCOMPARE(policy.changed(1000, false), 100);
+    QCOMPARE(policy.changed(2000, false), 100);
+}
+
+void tst_QGalleryTrackerRefreshPolicy::backOff()
+{
+    QGalleryTrackerRefreshPolicy policy(settings(100, 1600, 0));
+
+    QCOMPARE(policy.changed(0, false), 100);
+    QCOMPARE(policy.changed(50, true), 200);
+    QCOMPARE(policy.changed(150, true), 400);
+    QCOMPARE(policy.changed(450, true), 800);
+
+    // A gap longer than the current delay starts over from the minimum.
+    QCOMPARE(policy.changed(1500, false), 100);
+}
+
+void tst_QGalleryTrackerRefreshPolicy::backOffFromZero()
+{
+    QGalleryTrackerRefreshPolicy policy(settings(0, 1600, 0));
+
+    QCOMPARE(policy.changed(0, false), 0);
+    QCOMPARE(policy.changed(0, true), 2);
+    QCOMPARE(policy.changed(1, true), 4);
+    QCOMPARE(policy.changed(3, true), 8);
+
+    QCOMPARE(policy.changed(100, false), 0);
+}
+
+void tst_QGalleryTrackerRefreshPolicy::maximumDelay()
+{
+    QGalleryTrackerRefreshPolicy policy(settings(100, 300, 0));
+
+    QCOMPARE(policy.changed(0, false), 100);
+    QCOMPARE(policy.changed(10, true), 200);
+    QCOMPARE(policy.changed(20, true), 300);
+    QCOMPARE(policy.changed(30, true), 300);
+}
+
+void tst_QGalleryTrackerRefreshPolicy::maximumRate()
+{
+    QGalleryTrackerRefreshPolicy policy(settings(100, 1600, 2));
+
+    QCOMPARE(policy.changed(0, false), 100);
+
+    policy.refreshed(100);
+
+    // No more than two refreshes a second, the next can't start before 600.
+    QCOMPARE(policy.changed(300, false), 300);
+    QCOMPARE(policy.nextDelay(300), 300);
+    QCOMPARE(policy.nextDelay(550), 100);
+    QCOMPARE(policy.changed(1000, false), 100);
+}
+
+void tst_QGalleryTrackerRefreshPolicy::unlimitedRate()
+{
+    QGalleryTrackerRefreshPolicy policy(settings(100, 1600, 0));
+
+    policy.refreshed(0);
+
+    QCOMPARE(policy.changed(10, false), 100);
+    QCOMPARE(policy.nextDelay(10), 100);
+}
+
+void tst_QGalleryTrackerRefreshPolicy::statistics()
+{
+    QGalleryTrackerRefreshPolicy policy(settings(100, 1600, 0));
+
+    policy.changed(0, false);
+    policy.changed(10, true);
+    policy.changed(20, true);
+    policy.refreshed(100);
+    policy.changed(500, false);
+    policy.refreshed(600);
+
+    QCOMPARE(policy.statistics().changeCount, 4);
+    QCOMPARE(policy.statistics().coalescedCount, 2);
+    QCOMPARE(policy.statistics().refreshCount, 2);
+
+    policy.resetStatistics();
+
+    QCOMPARE(policy.statistics().changeCount, 0);
+    QCOMPARE(policy.statistics().coalescedCount, 0);
+    QCOMPARE(policy.statistics().refreshCount, 0);
+}
+
+QTEST_MAIN(tst_QGalleryTrackerRefreshPolicy)
+
+#include "tst_qgallerytrackerrefreshpolicy.moc"
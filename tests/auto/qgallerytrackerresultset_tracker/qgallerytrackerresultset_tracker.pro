@@ -1,6 +1,8 @@
 include(../auto.pri)
 
-QT += gallery-private
+QT += docgallery docgallery-private
+
+CONFIG += link_pkgconfig
+PKGCONFIG += tracker-sparql-3.0
 
 SOURCES += tst_qgallerytrackerresultset.cpp
-DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0
@@ -0,0 +1,484 @@
+/****************************************************************************
+**
+** Copyright (C) 2012 Digia Plc and/or its subsidiary(-ies).
+** Contact: http://www.qt-project.org/legal
+**
+** This file is part of the Qt Mobility Components.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and Digia.  For licensing terms and
+** conditions see http://qt.digia.com/licensing.  For further information
+** use the contact form at http://qt.digia.com/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU Lesser General Public License version 2.1 requirements
+** will be met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** In addition, as a special exception, Digia gives you certain additional
+** rights.  These rights are described in the Digia Qt LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3.0 as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU General Public License version 3.0 requirements will be
+** met: http://www.gnu.org/copyleft/gpl.html.
+**
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+//TESTED_COMPONENT=src/gallery
+
+#include <private/qdocumentgallery_tracker_p.h>
+#include <private/qgallerytrackerresultset_p.h>
+#include <private/qgallerytrackerresultsetcursor_p.h>
+#include <private/qgallerytrackerlistcolumn_p.h>
+#include <private/qgallerytrackerscheduler_p.h>
+#include <private/qgallerytrackerstatementcache_p.h>
+
+#include <qgalleryqueryrequest.h>
+
+#include <QtTest/QtTest>
+
+#include <libtracker-sparql/tracker-sparql.h>
+
+QT_USE_DOCGALLERY_NAMESPACE
+
+class tst_QGalleryTrackerResultSetCursor : public QObject
+{
+    Q_OBJECT
+public:
+    tst_QGalleryTrackerResultSetCursor() : m_connection(0) {}
+
+public Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+    void cleanup();
+
+private Q_SLOTS:
+    void shareLiveRequests();
+    void fetch();
+    void cancelCursor();
+    void releaseResultSet();
+    void suspended();
+
+private:
+    QSharedPointer<QGalleryTrackerResultSet> createResultSet();
+    bool update(const QString &sparql);
+    bool setCount(char group, int count);
+
+    TrackerSparqlConnection *m_connection;
+};
+
+/*
+    Gives the tests the gallery's private data, where its tracker connection is swapped for an
+    in-memory store.
+*/
+
+class QtTestDocumentGallery : public QDocumentGallery
+{
+public:
+    QDocumentGalleryPrivate *d() { return static_cast<QDocumentGalleryPrivate *>(d_ptr.data()); }
+};
+
+class QtTestStringColumn : public QGalleryTrackerValueColumn
+{
+public:
+    QtTestStringColumn *clone() const { return new QtTestStringColumn; }
+    QVariant::Type type() const { return QVariant::String; }
+    void appendValue(TrackerSparqlCursor *cursor, int index, QGalleryTrackerValueStore *store) const
+    {
+        if (tracker_sparql_cursor_get_value_type(cursor, index) == TRACKER_SPARQL_VALUE_TYPE_UNBOUND)
+            store->appendNull();
+        else
+            store->appendValue(QString::fromUtf8(tracker_sparql_cursor_get_string(cursor, index, 0)));
+    }
+};
+
+class QtTestIdentityColumn : public QGalleryTrackerCompositeColumn
+{
+public:
+    QtTestIdentityColumn(int column) : m_column(column) {}
+
+    QtTestIdentityColumn *clone() const { return new QtTestIdentityColumn(m_column); }
+    QVariant value(const QGalleryTrackerRow &row) const { return row.value(m_column); }
+
+private:
+    const int m_column;
+};
+
+class QtTestStaticColumn : public QGalleryTrackerCompositeColumn
+{
+public:
+    QtTestStaticColumn(const QVariant &value) : m_value(value) {}
+
+    QtTestStaticColumn *clone() const { return new QtTestStaticColumn(m_value); }
+    QVariant value(const QGalleryTrackerRow &) const { return m_value; }
+
+private:
+    const QVariant m_value;
+};
+
+static const char *qt_documentQuery =
+        "SELECT ?x ?title "
+        "WHERE { ?x a nfo:PaginatedTextDocument ; nie:title ?title } "
+        "ORDER BY ?title";
+
+void tst_QGalleryTrackerResultSetCursor::initTestCase()
+{
+    GFile *ontology = tracker_sparql_get_ontology_nepomuk();
+
+    GError *error = 0;
+    m_connection = tracker_sparql_connection_new(
+            TRACKER_SPARQL_CONNECTION_FLAGS_NONE, 0, ontology, 0, &error);
+
+    g_object_unref(ontology);
+
+    if (!m_connection) {
+        const QByteArray message = error->message;
+        g_error_free(error);
+
+        QFAIL(message.constData());
+    }
+}
+
+void tst_QGalleryTrackerResultSetCursor::cleanupTestCase()
+{
+    if (m_connection)
+        g_object_unref(m_connection);
+}
+
+void tst_QGalleryTrackerResultSetCursor::cleanup()
+{
+    QGalleryTrackerScheduler::instance()->waitForDone(5000);
+
+    QCoreApplication::sendPostedEvents(0, QEvent::DeferredDelete);
+
+    update(QLatin1String(
+            "DELETE { ?x a rdfs:Resource } WHERE { ?x a nfo:PaginatedTextDocument }"));
+}
+
+bool tst_QGalleryTrackerResultSetCursor::update(const QString &sparql)
+{
+    GError *error = 0;
+    tracker_sparql_connection_update(m_connection, sparql.toUtf8().constData(), 0, &error);
+
+    if (error) {
+        qWarning("%s", error->message);
+        g_error_free(error);
+
+        return false;
+    }
+    return true;
+}
+
+/*
+    Replaces the documents in \a group with \a count new ones titled \a group-000 and up.
+*/
+
+bool tst_QGalleryTrackerResultSetCursor::setCount(char group, int count)
+{
+    QString sparql = QString(QLatin1String(
+            "DELETE { ?x a rdfs:Resource } WHERE {"
+            " ?x a nfo:PaginatedTextDocument ; nie:title ?title ."
+            " FILTER(STRSTARTS(?title, \"%1-\"))"
+            "}")).arg(QLatin1Char(group));
+
+    if (count > 0) {
+        sparql += QLatin1String(" ; INSERT DATA {");
+
+        for (int i = 0; i < count; ++i) {
+            sparql += QString(QLatin1String(
+                    " <urn:test:%1-%2> a nfo:PaginatedTextDocument ; nie:title \"%1-%2\" ."))
+                    .arg(QLatin1Char(group))
+                    .arg(i, 3, 10, QLatin1Char('0'));
+        }
+        sparql += QLatin1String(" }");
+    }
+    return update(sparql);
+}
+
+/*
+    Creates a live result set owned the same way as the gallery's shared result sets.
+*/
+
+QSharedPointer<QGalleryTrackerResultSet> tst_QGalleryTrackerResultSetCursor::createResultSet()
+{
+    QGalleryTrackerResultSetArguments arguments;
+
+    arguments.idColumn.reset(new QtTestIdentityColumn(1));
+    arguments.urlColumn.reset(new QtTestStaticColumn(QUrl()));
+    arguments.typeColumn.reset(new QtTestStaticColumn(QLatin1String("Document")));
+    arguments.updateMask = 0x01;
+    arguments.identityWidth = 1;
+    arguments.tableWidth = 2;
+    arguments.valueOffset = 1;
+    arguments.compositeOffset = 2;
+    arguments.sparql = QLatin1String(qt_documentQuery);
+    arguments.propertyNames = QStringList()
+            << QLatin1String("title");
+    arguments.propertyAttributes = QVector<QGalleryProperty::Attributes>()
+            << (QGalleryProperty::CanRead | QGalleryProperty::CanSort);
+    arguments.propertyTypes = QVector<QVariant::Type>()
+            << QVariant::String;
+    arguments.valueColumns = QVector<QGalleryTrackerValueColumn *>()
+            << new QtTestStringColumn
+            << new QtTestStringColumn;
+
+    return QSharedPointer<QGalleryTrackerResultSet>(
+            new QGalleryTrackerResultSet(m_connection, &arguments, true), &QObject::deleteLater);
+}
+
+void tst_QGalleryTrackerResultSetCursor::shareLiveRequests()
+{
+    QtTestDocumentGallery gallery;
+
+    QDocumentGalleryPrivate *d = gallery.d();
+
+    // Keep the gallery on the in-memory store whatever becomes of its own connection.
+    QObject::disconnect(d->trackerConnection.data(), 0, &gallery, 0);
+
+    d->setConnection(m_connection, QSharedPointer<QGalleryTrackerStatementCache>(
+            new QGalleryTrackerStatementCache(m_connection)));
+
+    QGalleryQueryRequest requestA(&gallery);
+    requestA.setRootType(QDocumentGallery::Document);
+    requestA.setPropertyNames(QStringList() << QLatin1String("title"));
+    requestA.setAutoUpdate(true);
+
+    QGalleryQueryRequest requestB(&gallery);
+    requestB.setRootType(QDocumentGallery::Document);
+    requestB.setPropertyNames(QStringList() << QLatin1String("title"));
+    requestB.setAutoUpdate(true);
+
+    QGalleryQueryRequest sortedRequest(&gallery);
+    sortedRequest.setRootType(QDocumentGallery::Document);
+    sortedRequest.setPropertyNames(QStringList() << QLatin1String("title"));
+    sortedRequest.setSortPropertyNames(QStringList() << QLatin1String("title"));
+    sortedRequest.setAutoUpdate(true);
+
+    QGalleryQueryRequest staticRequest(&gallery);
+    staticRequest.setRootType(QDocumentGallery::Document);
+    staticRequest.setPropertyNames(QStringList() << QLatin1String("title"));
+
+    requestA.execute();
+    requestB.execute();
+    sortedRequest.execute();
+    staticRequest.execute();
+
+    QGalleryTrackerResultSetCursor *cursorA
+            = qobject_cast<QGalleryTrackerResultSetCursor *>(requestA.resultSet());
+    QGalleryTrackerResultSetCursor *cursorB
+            = qobject_cast<QGalleryTrackerResultSetCursor *>(requestB.resultSet());
+    QGalleryTrackerResultSetCursor *sortedCursor
+            = qobject_cast<QGalleryTrackerResultSetCursor *>(sortedRequest.resultSet());
+
+    QVERIFY(cursorA);
+    QVERIFY(cursorB);
+    QVERIFY(sortedCursor);
+    QVERIFY(cursorA != cursorB);
+
+    // The identical requests get a cursor each over one result set running one query.
+    QVERIFY(cursorA->resultSet());
+    QCOMPARE(cursorA->resultSet(), cursorB->resultSet());
+    QCOMPARE(d->sharedResultSets.count(), 2);
+
+    QVERIFY(sortedCursor->resultSet() != cursorA->resultSet());
+
+    // Requests which aren't live get a result set of their own.
+    QVERIFY(staticRequest.resultSet());
+    QVERIFY(!qobject_cast<QGalleryTrackerResultSetCursor *>(staticRequest.resultSet()));
+
+    QVERIFY(requestA.waitForFinished(5000));
+    QVERIFY(requestB.waitForFinished(5000));
+    QVERIFY(sortedRequest.waitForFinished(5000));
+    QVERIFY(staticRequest.waitForFinished(5000));
+}
+
+void tst_QGalleryTrackerResultSetCursor::fetch()
+{
+    QVERIFY(setCount('a', 4));
+
+    QGalleryTrackerResultSetCursor cursor(createResultSet());
+    QVERIFY(cursor.waitForFinished(5000));
+    QCOMPARE(cursor.itemCount(), 4);
+
+    QSignalSpy indexSpy(&cursor, SIGNAL(currentIndexChanged(int)));
+    QSignalSpy itemSpy(&cursor, SIGNAL(currentItemChanged()));
+
+    QCOMPARE(cursor.fetch(1), true);
+    QCOMPARE(cursor.currentIndex(), 1);
+    QCOMPARE(cursor.itemId(), QVariant(QLatin1String("a-001")));
+    QCOMPARE(indexSpy.count(), 1);
+    QCOMPARE(indexSpy.last().value(0).toInt(), 1);
+    QCOMPARE(itemSpy.count(), 1);
+
+    // Fetching the current index again changes nothing.
+    QCOMPARE(cursor.fetch(1), true);
+    QCOMPARE(cursor.currentIndex(), 1);
+    QCOMPARE(indexSpy.count(), 1);
+    QCOMPARE(itemSpy.count(), 1);
+
+    QCOMPARE(cursor.fetch(4), false);
+    QCOMPARE(cursor.currentIndex(), 4);
+    QCOMPARE(cursor.itemId(), QVariant());
+    QCOMPARE(indexSpy.count(), 2);
+    QCOMPARE(itemSpy.count(), 2);
+
+    QCOMPARE(cursor.fetch(4), false);
+    QCOMPARE(indexSpy.count(), 2);
+    QCOMPARE(itemSpy.count(), 2);
+}
+
+void tst_QGalleryTrackerResultSetCursor::cancelCursor()
+{
+    QVERIFY(setCount('a', 4));
+
+    const QSharedPointer<QGalleryTrackerResultSet> resultSet = createResultSet();
+
+    QGalleryTrackerResultSetCursor cursorA(resultSet);
+    QGalleryTrackerResultSetCursor cursorB(resultSet);
+
+    QSignalSpy canceledSpyA(&cursorA, SIGNAL(canceled()));
+    QSignalSpy canceledSpyB(&cursorB, SIGNAL(canceled()));
+    QSignalSpy finishedSpyB(&cursorB, SIGNAL(finished()));
+    QSignalSpy insertSpyA(&cursorA, SIGNAL(itemsInserted(int,int)));
+    QSignalSpy insertSpyB(&cursorB, SIGNAL(itemsInserted(int,int)));
+
+    QCOMPARE(cursorA.isActive(), true);
+    QCOMPARE(cursorB.isActive(), true);
+
+    cursorA.cancel();
+
+    QCOMPARE(canceledSpyA.count(), 1);
+    QCOMPARE(cursorA.isActive(), false);
+
+    // The shared query and the other cursor carry on as if nothing happened.
+    QCOMPARE(resultSet->isActive(), true);
+    QCOMPARE(cursorB.isActive(), true);
+
+    QVERIFY(cursorB.waitForFinished(5000));
+
+    QCOMPARE(canceledSpyB.count(), 0);
+    QCOMPARE(finishedSpyB.count(), 1);
+    QCOMPARE(cursorB.error(), int(QDocumentGallery::NoError));
+    QCOMPARE(cursorB.itemCount(), 4);
+
+    QCOMPARE(cursorB.fetch(3), true);
+    QCOMPARE(cursorB.itemId(), QVariant(QLatin1String("a-003")));
+
+    QVERIFY(setCount('b', 2));
+
+    resultSet->refresh(QList<int>() << 0x01);
+    QVERIFY(resultSet->waitForFinished(5000));
+
+    QCOMPARE(cursorB.itemCount(), 6);
+    QCOMPARE(insertSpyB.last().value(0).toInt(), 4);
+    QCOMPARE(insertSpyB.last().value(1).toInt(), 2);
+
+    QCOMPARE(cursorB.fetch(5), true);
+    QCOMPARE(cursorB.itemId(), QVariant(QLatin1String("b-001")));
+
+    // The canceled cursor keeps following the rows so it stays consistent with them.
+    QCOMPARE(cursorA.itemCount(), 6);
+    QCOMPARE(insertSpyA.count(), insertSpyB.count());
+    QCOMPARE(canceledSpyA.count(), 1);
+}
+
+void tst_QGalleryTrackerResultSetCursor::releaseResultSet()
+{
+    QVERIFY(setCount('a', 4));
+
+    QWeakPointer<QGalleryTrackerResultSet> weakResultSet;
+    QPointer<QGalleryTrackerResultSet> resultSetObject;
+
+    QGalleryTrackerResultSetCursor *cursorA = 0;
+    QGalleryTrackerResultSetCursor *cursorB = 0;
+    {
+        const QSharedPointer<QGalleryTrackerResultSet> resultSet = createResultSet();
+
+        weakResultSet = resultSet;
+        resultSetObject = resultSet.data();
+
+        cursorA = new QGalleryTrackerResultSetCursor(resultSet);
+        cursorB = new QGalleryTrackerResultSetCursor(resultSet);
+    }
+
+    QVERIFY(cursorA->waitForFinished(5000));
+
+    delete cursorA;
+
+    QVERIFY(!weakResultSet.isNull());
+    QCOMPARE(cursorB->itemCount(), 4);
+
+    // Once the last cursor has gone nothing holds the result set and it's deleted.
+    delete cursorB;
+
+    QVERIFY(weakResultSet.isNull());
+
+    QCoreApplication::sendPostedEvents(0, QEvent::DeferredDelete);
+
+    QVERIFY(resultSetObject.isNull());
+}
+
+void tst_QGalleryTrackerResultSetCursor::suspended()
+{
+    QVERIFY(setCount('a', 4));
+
+    const QSharedPointer<QGalleryTrackerResultSet> resultSet = createResultSet();
+
+    QGalleryTrackerResultSetCursor cursorA(resultSet);
+    QVERIFY(cursorA.waitForFinished(5000));
+
+    QGalleryTrackerResultSetCursor *cursorB = new QGalleryTrackerResultSetCursor(resultSet);
+
+    QCOMPARE(resultSet->isSuspended(), false);
+
+    cursorA.setSuspended(true);
+    QCOMPARE(cursorA.isSuspended(), true);
+    QCOMPARE(resultSet->isSuspended(), false);
+
+    // Only suspended once every cursor is.
+    cursorB->setSuspended(true);
+    QCOMPARE(resultSet->isSuspended(), true);
+
+    cursorA.setSuspended(false);
+    QCOMPARE(resultSet->isSuspended(), false);
+
+    // Suspending a cursor twice counts once.
+    cursorB->setSuspended(true);
+    QCOMPARE(resultSet->isSuspended(), false);
+
+    // A suspended cursor going away leaves the remaining cursor in charge.
+    delete cursorB;
+    QCOMPARE(resultSet->isSuspended(), false);
+
+    cursorA.setSuspended(true);
+    QCOMPARE(resultSet->isSuspended(), true);
+
+    // An active cursor holds the result set up until it goes away.
+    cursorB = new QGalleryTrackerResultSetCursor(resultSet);
+    QCOMPARE(resultSet->isSuspended(), false);
+
+    delete cursorB;
+    QCOMPARE(resultSet->isSuspended(), true);
+
+    cursorA.setSuspended(false);
+    QCOMPARE(resultSet->isSuspended(), false);
+}
+
+QTEST_MAIN(tst_QGalleryTrackerResultSetCursor)
+
+#include "tst_qgallerytrackerresultsetcursor.moc"
@@ -0,0 +1,309 @@
+/****************************************************************************
+**
+** Copyright (C) 2012 Digia Plc and/or its subsidiary(-ies).
+** Contact: http://www.qt-project.org/legal
+**
+** This file is part of the Qt Mobility Components.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and Digia.  For licensing terms and
+** conditions see http://qt.digia.com/licensing.  For further information
+** use the contact form at http://qt.digia.com/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU Lesser General Public License version 2.1 requirements
+** will be met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** In addition, as a special exception, Digia gives you certain additional
+** rights.  These rights are described in the Digia Qt LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3.0 as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU General Public License version 3.0 requirements will be
+** met: http://www.gnu.org/copyleft/gpl.html.
+**
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+//TESTED_COMPONENT=src/gallery
+
+#include <private/qgallerytrackerrowdiff_p.h>
+#include <private/qgallerytrackertable_p.h>
+
+#include <QtTest/QtTest>
+
+#include <algorithm>
+
+QT_USE_DOCGALLERY_NAMESPACE
+
+class tst_QGalleryTrackerRowDiff : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void diff_data();
+    void diff();
+    void movedIndex_data();
+    void movedIndex();
+
+private:
+    static void populate(QGalleryTrackerTable *table, const QStringList &rows);
+    static QVector<QVariant> row(const QGalleryTrackerTable &table, int index);
+};
+
+/*
+    Rows are given as "identity" or "identity=value" and are stored in a table with an identity
+    string column and an integer value column.
+*/
+
+void tst_QGalleryTrackerRowDiff::populate(QGalleryTrackerTable *table, const QStringList &rows)
+{
+    table->setColumnTypes(QVector<QVariant::Type>() << QVariant::String << QVariant::Int);
+
+    foreach (const QString &row, rows) {
+        const int separator = row.indexOf(QLatin1Char('='));
+
+        table->appendRow(QVector<QVariant>()
+                << row.left(separator)
+                << (separator >= 0 ? QVariant(row.mid(separator + 1).toInt()) : QVariant(0)));
+    }
+}
+
+QVector<QVariant> tst_QGalleryTrackerRowDiff::row(const QGalleryTrackerTable &table, int index)
+{
+    QVector<QVariant> values;
+    for (int column = 0; column < table.columnCount(); ++column)
+        values.append(table.value(index, column));
+    return values;
+}
+
+static QStringList sequence(int begin, int end, const QString &suffix = QString())
+{
+    QStringList rows;
+    for (int i = begin; i < end; ++i)
+        rows.append(QString::number(i) + suffix);
+    return rows;
+}
+
+void tst_QGalleryTrackerRowDiff::diff_data()
+{
+    QTest::addColumn<QStringList>("rRows");
+    QTest::addColumn<QStringList>("iRows");
+
+    QStringList reversed = sequence(0, 32);
+    std::reverse(reversed.begin(), reversed.end());
+
+    QStringList manyMoves = sequence(0, 200);
+    std::reverse(manyMoves.begin() + 20, manyMoves.begin() + 120);
+
+    QStringList fewMoves = sequence(0, 200);
+    std::rotate(fewMoves.begin() + 10, fewMoves.begin() + 150, fewMoves.begin() + 160);
+    std::swap(fewMoves[50], fewMoves[180]);
+
+    QTest::newRow("empty")
+            << QStringList()
+            << QStringList();
+    QTest::newRow("empty to many")
+            << QStringList()
+            << sequence(0, 16);
+    QTest::newRow("many to empty")
+            << sequence(0, 16)
+            << QStringList();
+    QTest::newRow("unchanged")
+            << sequence(0, 16)
+            << sequence(0, 16);
+    QTest::newRow("updated")
+            << (QStringList() << "a" << "b" << "c" << "d" << "e")
+            << (QStringList() << "a=1" << "b" << "c=1" << "d=1" << "e");
+    QTest::newRow("inserted")
+            << (QStringList() << "a" << "c" << "e")
+            << (QStringList() << "0" << "a" << "b" << "c" << "d" << "e" << "f");
+    QTest::newRow("removed")
+            << (QStringList() << "0" << "a" << "b" << "c" << "d" << "e" << "f")
+            << (QStringList() << "a" << "c" << "e");
+    QTest::newRow("replaced")
+            << (QStringList() << "a" << "b" << "c" << "d")
+            << (QStringList() << "a" << "x" << "y" << "z" << "d");
+    QTest::newRow("reversed")
+            << sequence(0, 32)
+            << reversed;
+    QTest::newRow("few moves")
+            << sequence(0, 200)
+            << fewMoves;
+    QTest::newRow("more than maximum moves")
+            << sequence(0, 200)
+            << manyMoves;
+    QTest::newRow("more than maximum moves, updated")
+            << sequence(0, 200)
+            << manyMoves.replaceInStrings(QRegExp(QLatin1String("^(\\d*[02468])$")), "\\1=1");
+    QTest::newRow("duplicate identities")
+            << (QStringList() << "a" << "a" << "b" << "b" << "c")
+            << (QStringList() << "b=1" << "a" << "c" << "a=1" << "b");
+    QTest::newRow("duplicate identities, removed")
+            << (QStringList() << "a" << "a" << "a" << "b")
+            << (QStringList() << "a" << "b");
+    QTest::newRow("shared prefix and suffix")
+            << (sequence(0, 8) << "a" << "b" << "c" << "d" << sequence(8, 16))
+            << (sequence(0, 8) << "d" << "x" << "b=1" << "a" << sequence(8, 16));
+    QTest::newRow("shared prefix and suffix, moved across")
+            << (sequence(0, 8) << "a" << "b" << "c" << sequence(8, 16))
+            << (QStringList() << "c" << sequence(0, 8) << "b" << sequence(8, 16) << "a");
+}
+
+/*
+    Replays the edits onto the rows of the remove table the same way the result set does and
+    checks the result matches the insert table.  Rows before the cutoff have been taken from the
+    insert table and rows from the remove offset onwards are still those of the remove table.
+*/
+
+void tst_QGalleryTrackerRowDiff::diff()
+{
+    QFETCH(QStringList, rRows);
+    QFETCH(QStringList, iRows);
+
+    QGalleryTrackerTable rTable;
+    QGalleryTrackerTable iTable;
+
+    populate(&rTable, rRows);
+    populate(&iTable, iRows);
+
+    const QGalleryTrackerRowDiff rowDiff(1, 2);
+    const QVector<QGalleryTrackerRowDiff::Edit> edits = rowDiff.diff(rTable, iTable);
+
+    QVERIFY(!edits.isEmpty());
+    QCOMPARE(edits.last().type, QGalleryTrackerRowDiff::Edit::Finish);
+
+    QVector<QVector<QVariant> > rows;
+    for (int i = 0; i < rTable.rowCount(); ++i)
+        rows.append(row(rTable, i));
+
+    int rOffset = 0;
+    int iCutoff = 0;
+
+    typedef QVector<QGalleryTrackerRowDiff::Edit>::const_iterator iterator;
+    for (iterator it = edits.constBegin(); it != edits.constEnd(); ++it) {
+        QVERIFY(it->rIndex >= rOffset);
+        QVERIFY(it->rCount >= 0);
+
+        switch (it->type) {
+        case QGalleryTrackerRowDiff::Edit::Move: {
+            QVERIFY(it + 1 != edits.constEnd());
+            QVERIFY(it->iIndex >= rOffset);
+            QVERIFY(it->iIndex <= rTable.rowCount());
+            QVERIFY(it->iIndex < it->rIndex || it->iIndex > it->rIndex + it->rCount);
+
+            const QVector<QVector<QVariant> >::iterator begin = rows.begin() + iCutoff - rOffset;
+            if (it->iIndex < it->rIndex) {
+                std::rotate(
+                        begin + it->iIndex,
+                        begin + it->rIndex,
+                        begin + it->rIndex + it->rCount);
+            } else {
+                std::rotate(
+                        begin + it->rIndex,
+                        begin + it->rIndex + it->rCount,
+                        begin + it->iIndex);
+            }
+            break;
+        }
+        case QGalleryTrackerRowDiff::Edit::Update:
+            QCOMPARE(it->iCount, it->rCount);
+            // Fall through.
+        case QGalleryTrackerRowDiff::Edit::Replace:
+        case QGalleryTrackerRowDiff::Edit::Finish: {
+            QCOMPARE(iCutoff + it->rIndex - rOffset, it->iIndex);
+            QVERIFY(it->iIndex + it->iCount <= iTable.rowCount());
+            QVERIFY(it->rIndex + it->rCount <= rTable.rowCount());
+
+            if (it->type == QGalleryTrackerRowDiff::Edit::Finish) {
+                QCOMPARE(it->rIndex + it->rCount, rTable.rowCount());
+                QCOMPARE(it->iIndex + it->iCount, iTable.rowCount());
+            }
+
+            rows.remove(it->iIndex, it->rCount);
+            for (int i = 0; i < it->iCount; ++i)
+                rows.insert(it->iIndex + i, row(iTable, it->iIndex + i));
+
+            rOffset = it->rIndex + it->rCount;
+            iCutoff = it->iIndex + it->iCount;
+            break;
+        }
+        default:
+            QFAIL("Unknown edit type");
+        }
+    }
+
+    QCOMPARE(rows.count(), iTable.rowCount());
+    for (int i = 0; i < rows.count(); ++i)
+        QCOMPARE(rows.at(i), row(iTable, i));
+
+    QCOMPARE(iCutoff, iTable.rowCount());
+    QCOMPARE(rOffset, rTable.rowCount());
+}
+
+void tst_QGalleryTrackerRowDiff::movedIndex_data()
+{
+    QTest::addColumn<int>("from");
+    QTest::addColumn<int>("to");
+    QTest::addColumn<int>("count");
+
+    QTest::newRow("one forward")
+            << 2 << 7 << 1;
+    QTest::newRow("one forward to end")
+            << 0 << 10 << 1;
+    QTest::newRow("one backward")
+            << 5 << 2 << 1;
+    QTest::newRow("one backward to start")
+            << 9 << 0 << 1;
+    QTest::newRow("run forward")
+            << 1 << 6 << 3;
+    QTest::newRow("run forward to end")
+            << 3 << 10 << 4;
+    QTest::newRow("run backward")
+            << 6 << 2 << 3;
+    QTest::newRow("run backward to start")
+            << 7 << 0 << 3;
+}
+
+/*
+    Moving rows follows the destination convention of QAbstractItemModel::beginMoveRows(), a
+    forward move's destination is the index before the moved rows are taken out.
+*/
+
+void tst_QGalleryTrackerRowDiff::movedIndex()
+{
+    QFETCH(int, from);
+    QFETCH(int, to);
+    QFETCH(int, count);
+
+    QVector<int> rows;
+    for (int i = 0; i < 10; ++i)
+        rows.append(i);
+
+    if (to < from)
+        std::rotate(rows.begin() + to, rows.begin() + from, rows.begin() + from + count);
+    else
+        std::rotate(rows.begin() + from, rows.begin() + from + count, rows.begin() + to);
+
+    for (int i = 0; i < rows.count(); ++i)
+        QCOMPARE(QGalleryTrackerRowDiff::movedIndex(i, from, to, count), rows.indexOf(i));
+
+    QCOMPARE(QGalleryTrackerRowDiff::movedIndex(-1, from, to, count), -1);
+}
+
+QTEST_MAIN(tst_QGalleryTrackerRowDiff)
+
+#include "tst_qgallerytrackerrowdiff.moc"
@@ -0,0 +1,5 @@
+include(../auto.pri)
+
+QT += docgallery docgallery-private
+
+SOURCES += tst_qgallerytrackerscheduler.cpp
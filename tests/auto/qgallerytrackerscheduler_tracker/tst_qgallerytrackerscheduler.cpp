@@ -0,0 +1,322 @@
+/****************************************************************************
+**
+** Copyright (C) 2012 Digia Plc and/or its subsidiary(-ies).
+** Contact: http://www.qt-project.org/legal
+**
+** This file is part of the Qt Mobility Components.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and Digia.  For licensing terms and
+** conditions see http://qt.digia.com/licensing.  For further information
+** use the contact form at http://qt.digia.com/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU Lesser General Public License version 2.1 requirements
+** will be met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** In addition, as a special exception, Digia gives you certain additional
+** rights.  These rights are described in the Digia Qt LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3.0 as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU General Public License version 3.0 requirements will be
+** met: http://www.gnu.org/copyleft/gpl.html.
+**
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+//TESTED_COMPONENT=src/gallery
+
+#include <private/qgallerytrackerscheduler_p.h>
+
+#include <QtTest/QtTest>
+
+QT_USE_DOCGALLERY_NAMESPACE
+
+class QtTestTask : public QGalleryTrackerTask
+{
+public:
+    QtTestTask(QSemaphore *gate = 0, QStringList *log = 0, const QString &name = QString())
+        : gate(gate), log(log), name(name), runCount(0), finishedCount(0), destroyed(0) {}
+    ~QtTestTask()
+    {
+        wait();
+
+        if (destroyed)
+            *destroyed = true;
+    }
+
+    QSemaphore *gate;
+    QStringList *log;
+    QString name;
+    QAtomicInt runCount;
+    QAtomicInt finishedCount;
+    bool *destroyed;
+
+protected:
+    void run()
+    {
+        if (gate)
+            gate->acquire();
+        if (log)
+            log->append(name);
+
+        runCount.ref();
+    }
+
+    void taskFinished()
+    {
+        finishedCount.ref();
+    }
+};
+
+class tst_QGalleryTrackerScheduler : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void instance();
+    void maxThreadCount();
+    void start();
+    void restart();
+    void waitTimeout();
+    void priority();
+    void statistics();
+    void orphanActive();
+    void orphanInactive();
+    void orphanQueued();
+};
+
+void tst_QGalleryTrackerScheduler::instance()
+{
+    QVERIFY(QGalleryTrackerScheduler::instance() != 0);
+    QCOMPARE(QGalleryTrackerScheduler::instance(), QGalleryTrackerScheduler::instance());
+    QVERIFY(QGalleryTrackerScheduler::instance()->maxThreadCount() >= 1);
+}
+
+void tst_QGalleryTrackerScheduler::maxThreadCount()
+{
+    QGalleryTrackerScheduler scheduler;
+
+    scheduler.setMaxThreadCount(3);
+    QCOMPARE(scheduler.maxThreadCount(), 3);
+
+    scheduler.setMaxThreadCount(0);
+    QCOMPARE(scheduler.maxThreadCount(), 1);
+}
+
+void tst_QGalleryTrackerScheduler::start()
+{
+    QGalleryTrackerScheduler scheduler;
+
+    QtTestTask task;
+    QCOMPARE(task.isActive(), false);
+
+    scheduler.start(&task);
+
+    QCOMPARE(task.wait(), true);
+    QCOMPARE(task.isActive(), false);
+    QCOMPARE(int(task.runCount), 1);
+    QCOMPARE(int(task.finishedCount), 1);
+}
+
+void tst_QGalleryTrackerScheduler::restart()
+{
+    QGalleryTrackerScheduler scheduler;
+
+    QtTestTask task;
+
+    for (int i = 0; i < 10; ++i) {
+        scheduler.start(&task);
+
+        QCOMPARE(task.wait(), true);
+    }
+
+    QCOMPARE(int(task.runCount), 10);
+    QCOMPARE(int(task.finishedCount), 10);
+}
+
+void tst_QGalleryTrackerScheduler::waitTimeout()
+{
+    QGalleryTrackerScheduler scheduler;
+
+    QSemaphore gate;
+    QtTestTask task(&gate);
+
+    scheduler.start(&task);
+
+    QCOMPARE(task.isActive(), true);
+    QCOMPARE(task.wait(50), false);
+    QCOMPARE(task.isActive(), true);
+
+    gate.release();
+
+    QCOMPARE(task.wait(), true);
+    QCOMPARE(int(task.runCount), 1);
+}
+
+void tst_QGalleryTrackerScheduler::priority()
+{
+    QGalleryTrackerScheduler scheduler;
+    scheduler.setMaxThreadCount(1);
+
+    QSemaphore gate;
+    QStringList log;
+
+    QtTestTask blocker(&gate);
+    QtTestTask low(0, &log, QLatin1String("low"));
+    QtTestTask normal(0, &log, QLatin1String("normal"));
+    QtTestTask high(0, &log, QLatin1String("high"));
+
+    scheduler.start(&blocker);
+    QTRY_COMPARE(scheduler.statistics().activeCount, 1);
+
+    scheduler.start(&low, QGalleryTrackerScheduler::LowPriority);
+    scheduler.start(&normal, QGalleryTrackerScheduler::NormalPriority);
+    scheduler.start(&high, QGalleryTrackerScheduler::HighPriority);
+
+    QCOMPARE(scheduler.queueDepth(), 3);
+
+    gate.release();
+
+    QCOMPARE(scheduler.waitForDone(), true);
+
+    QCOMPARE(log, QStringList()
+            << QLatin1String("high")
+            << QLatin1String("normal")
+            << QLatin1String("low"));
+}
+
+void tst_QGalleryTrackerScheduler::statistics()
+{
+    QGalleryTrackerScheduler scheduler;
+    scheduler.setMaxThreadCount(1);
+
+    QSemaphore gate;
+    QtTestTask blocker(&gate);
+    QtTestTask task;
+
+    scheduler.start(&blocker);
+    scheduler.start(&task);
+
+    QTRY_COMPARE(scheduler.statistics().activeCount, 1);
+    QTest::qWait(20);
+
+    QGalleryTrackerScheduler::Statistics statistics = scheduler.statistics();
+    QCOMPARE(statistics.queueDepth, 1);
+    QCOMPARE(statistics.maximumQueueDepth, 2);
+    QCOMPARE(statistics.activeCount, 1);
+    QCOMPARE(statistics.finishedCount, 0);
+
+    gate.release();
+
+    QCOMPARE(scheduler.waitForDone(), true);
+
+    statistics = scheduler.statistics();
+    QCOMPARE(statistics.queueDepth, 0);
+    QCOMPARE(statistics.maximumQueueDepth, 2);
+    QCOMPARE(statistics.activeCount, 0);
+    QCOMPARE(statistics.finishedCount, 2);
+    QVERIFY(statistics.maximumWaitTime >= 20);
+    QVERIFY(statistics.totalWaitTime >= statistics.maximumWaitTime);
+
+    scheduler.resetStatistics();
+
+    statistics = scheduler.statistics();
+    QCOMPARE(statistics.maximumQueueDepth, 0);
+    QCOMPARE(statistics.finishedCount, 0);
+    QCOMPARE(statistics.totalWaitTime, qint64(0));
+    QCOMPARE(statistics.maximumWaitTime, qint64(0));
+}
+
+void tst_QGalleryTrackerScheduler::orphanActive()
+{
+    QGalleryTrackerScheduler scheduler;
+
+    QSemaphore gate;
+    QStringList log;
+    bool destroyed = false;
+
+    QtTestTask *task = new QtTestTask(&gate, &log, QLatin1String("orphan"));
+    task->destroyed = &destroyed;
+
+    scheduler.start(task);
+
+    QCOMPARE(task->orphan(), true);
+
+    gate.release();
+
+    QCOMPARE(scheduler.waitForDone(), true);
+    QCOMPARE(destroyed, true);
+    QCOMPARE(log, QStringList() << QLatin1String("orphan"));
+}
+
+void tst_QGalleryTrackerScheduler::orphanInactive()
+{
+    QGalleryTrackerScheduler scheduler;
+
+    bool destroyed = false;
+
+    QtTestTask *task = new QtTestTask;
+    task->destroyed = &destroyed;
+
+    scheduler.start(task);
+
+    QCOMPARE(task->wait(), true);
+    QCOMPARE(task->orphan(), false);
+
+    QCOMPARE(scheduler.waitForDone(), true);
+    QCOMPARE(destroyed, false);
+    QCOMPARE(int(task->finishedCount), 1);
+
+    delete task;
+
+    QCOMPARE(destroyed, true);
+}
+
+void tst_QGalleryTrackerScheduler::orphanQueued()
+{
+    QGalleryTrackerScheduler scheduler;
+    scheduler.setMaxThreadCount(1);
+
+    QSemaphore gate;
+    QStringList log;
+    bool destroyed = false;
+
+    QtTestTask blocker(&gate, &log, QLatin1String("blocker"));
+    scheduler.start(&blocker);
+
+    // The task is still waiting in the queue behind the blocker when it's orphaned, it should
+    // still run before it's deleted.
+    QtTestTask *task = new QtTestTask(0, &log, QLatin1String("orphan"));
+    task->destroyed = &destroyed;
+
+    scheduler.start(task);
+
+    QCOMPARE(task->orphan(), true);
+    QCOMPARE(destroyed, false);
+
+    gate.release();
+
+    QCOMPARE(scheduler.waitForDone(), true);
+    QCOMPARE(destroyed, true);
+    QCOMPARE(log, QStringList() << QLatin1String("blocker") << QLatin1String("orphan"));
+    QCOMPARE(int(blocker.finishedCount), 1);
+}
+
+QTEST_MAIN(tst_QGalleryTrackerScheduler)
+
+#include "tst_qgallerytrackerscheduler.moc"
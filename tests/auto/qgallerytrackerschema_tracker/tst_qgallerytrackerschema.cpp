@@ -45,6 +45,7 @@
 
 #include <qdocumentgallery.h>
 #include <private/qgallerytrackerlistcolumn_p.h>
+#include <private/qgallerytrackerqueryplancache_p.h>
 #include <private/qgallerytrackerresultset_p.h>
 
 #include <QtTest/QtTest>
@@ -62,6 +63,14 @@ Q_DECLARE_METATYPE(QT_DOCGALLERY_PREPEND_NAMESPACE(QGalleryFilter))
 
 QT_USE_DOCGALLERY_NAMESPACE
 
+static QVector<QVariant::Type> qt_variantTypes(const QVector<QVariant> &row)
+{
+    QVector<QVariant::Type> types;
+    for (int i = 0; i < row.count(); ++i)
+        types.append(row.at(i).type());
+    return types;
+}
+
 #define QT_FILE_QUERY_ARGUMENTS_COUNT 9
 #define QT_FILE_QUERY_SERVICE_POSITION 1
 #define QT_FILE_QUERY_STRING_POSITION 5
@@ -82,6 +91,8 @@ private Q_SLOTS:
     void fromItemId();
     void serviceUpdateId_data();
     void serviceUpdateId();
+    void rdfTypeUpdateIds_data();
+    void rdfTypeUpdateIds();
     void supportedPropertyNames_data();
     void supportedPropertyNames();
     void propertyAttributes_data();
@@ -110,6 +121,9 @@ private Q_SLOTS:
     void queryResponseValueColumnToString();
     void queryResponseCompositeColumn_data();
     void queryResponseCompositeColumn();
+    void queryResponseResourceRefresh_data();
+    void queryResponseResourceRefresh();
+    void queryResponsePlanCache();
     void prepareInvalidQueryResponse_data();
     void prepareInvalidQueryResponse();
     void serviceForType_data();
@@ -247,6 +261,43 @@ void tst_QGalleryTrackerSchema::serviceUpdateId()
     QCOMPARE(QGalleryTrackerSchema::serviceUpdateId(service), updateId);
 }
 
+void tst_QGalleryTrackerSchema::rdfTypeUpdateIds_data()
+{
+    QTest::addColumn<QStringList>("rdfTypes");
+    QTest::addColumn<QList<int> >("updateIds");
+
+    QTest::newRow("Audio")
+            << (QStringList()
+                    << QLatin1String("http://tracker.api.gnome.org/ontology/v3/nie#InformationElement")
+                    << QLatin1String("http://tracker.api.gnome.org/ontology/v3/nmm#MusicPiece"))
+            << (QList<int>() << 0x08 << 0x1000);
+    QTest::newRow("Playlist")
+            << (QStringList()
+                    << QLatin1String("http://tracker.api.gnome.org/ontology/v3/nmm#Playlist"))
+            << (QList<int>() << 0x40);
+    QTest::newRow("Artist")
+            << (QStringList()
+                    << QLatin1String("http://tracker.api.gnome.org/ontology/v3/nmm#Artist"))
+            << (QList<int>() << 0x100 << 0x800);
+    QTest::newRow("Image and file")
+            << (QStringList()
+                    << QLatin1String("http://tracker.api.gnome.org/ontology/v3/nfo#FileDataObject")
+                    << QLatin1String("http://tracker.api.gnome.org/ontology/v3/nmm#Photo"))
+            << (QList<int>() << 0x01 << 0x10);
+    QTest::newRow("Turtles")
+            << (QStringList()
+                    << QLatin1String("http://tracker.api.gnome.org/ontology/v3/nmm#Turtles"))
+            << QList<int>();
+}
+
+void tst_QGalleryTrackerSchema::rdfTypeUpdateIds()
+{
+    QFETCH(QStringList, rdfTypes);
+    QFETCH(QList<int>, updateIds);
+
+    QCOMPARE(QGalleryTrackerSchema::rdfTypeUpdateIds(rdfTypes), updateIds);
+}
+
 void tst_QGalleryTrackerSchema::supportedPropertyNames_data()
 {
     QTest::addColumn<QString>("itemType");
@@ -405,7 +456,7 @@ void tst_QGalleryTrackerSchema::prepareValidTypeResponse_data()
 
     QTest::newRow("Artist")
             << QString::fromLatin1("Artist")
-            << 0x0100
+            << 0x0108
             <<  "SELECT 'identity' COUNT(DISTINCT ?x) "
                 "WHERE {"
                     "?x a nmm:Artist . "
@@ -416,7 +467,7 @@ void tst_QGalleryTrackerSchema::prepareValidTypeResponse_data()
 
     QTest::newRow("Album")
             << QString::fromLatin1("Album")
-            << 0x0200
+            << 0x0208
             <<  "SELECT 'identity' COUNT(DISTINCT ?x) "
                 "WHERE {"
                     "?x a nmm:MusicAlbum . "
@@ -427,7 +478,7 @@ void tst_QGalleryTrackerSchema::prepareValidTypeResponse_data()
 
     QTest::newRow("AudioGenre")
             << "AudioGenre"
-            << 0x08
+            << 0x1008
             <<  "SELECT 'identity' COUNT(DISTINCT nfo:genre(?x)) "
                 "WHERE {"
                     "?x a nmm:MusicPiece . "
@@ -518,7 +569,7 @@ void tst_QGalleryTrackerSchema::prepareValidItemResponse_data()
                     << 10)
             << QVariant()
             << QVariant(QLatin1String("Album"))
-            << 0x0200
+            << 0x0208
             << 1
             << 1
             << 1
@@ -555,14 +606,17 @@ void tst_QGalleryTrackerSchema::prepareValidItemResponse()
             schema.prepareItemResponse(&arguments, itemId.toString(), propertyNames),
             QDocumentGallery::NoError);
 
+    QGalleryTrackerTable table(qt_variantTypes(row));
+    table.appendRow(row);
+
     QVERIFY(arguments.idColumn != 0);
-    QCOMPARE(arguments.idColumn->value(row.constBegin()), itemId);
+    QCOMPARE(arguments.idColumn->value(QGalleryTrackerRow(&table, 0)), itemId);
 
     QVERIFY(arguments.urlColumn != 0);
-    QCOMPARE(arguments.urlColumn->value(row.constBegin()), itemUrl);
+    QCOMPARE(arguments.urlColumn->value(QGalleryTrackerRow(&table, 0)), itemUrl);
 
     QVERIFY(arguments.typeColumn != 0);
-    QCOMPARE(arguments.typeColumn->value(row.constBegin()), itemType);
+    QCOMPARE(arguments.typeColumn->value(QGalleryTrackerRow(&table, 0)), itemType);
 
     QCOMPARE(arguments.updateMask, updateMask);
     QCOMPARE(arguments.identityWidth, identityWidth);
@@ -663,7 +717,7 @@ void tst_QGalleryTrackerSchema::queryResponseRootType_data()
                     "?track tracker:available true"
                 "} "
                 "GROUP BY ?x"
-            << 0x0100
+            << 0x0108
             << 1
             << (QVector<QVariant>()
                     << QLatin1String("artist:Self%20Titled")
@@ -685,7 +739,7 @@ void tst_QGalleryTrackerSchema::queryResponseRootType_data()
                     "?track tracker:available true"
                 "} "
                 "GROUP BY ?x"
-            << 0x0100
+            << 0x0B08
             << 1
             << (QVector<QVariant>()
                     << QLatin1String("artist:Self%20Titled")
@@ -705,7 +759,7 @@ void tst_QGalleryTrackerSchema::queryResponseRootType_data()
                     "?track tracker:available true"
                 "} "
                 "GROUP BY ?x"
-            << 0x0200
+            << 0x0208
             << 1
             << (QVector<QVariant>()
                     << QLatin1String("musicAlbum:Greatest%20Hits")
@@ -748,14 +802,17 @@ void tst_QGalleryTrackerSchema::queryResponseRootType()
     QCOMPARE(arguments.updateMask, updateMask);
     QCOMPARE(arguments.identityWidth, identityWidth);
 
+    QGalleryTrackerTable table(qt_variantTypes(rowData));
+    table.appendRow(rowData);
+
     QVERIFY(arguments.idColumn != 0);
-    QCOMPARE(arguments.idColumn->value(rowData.constBegin()), QVariant(itemId));
+    QCOMPARE(arguments.idColumn->value(QGalleryTrackerRow(&table, 0)), QVariant(itemId));
 
     QVERIFY(arguments.urlColumn != 0);
-    QCOMPARE(arguments.urlColumn->value(rowData.constBegin()), itemUrl);
+    QCOMPARE(arguments.urlColumn->value(QGalleryTrackerRow(&table, 0)), itemUrl);
 
     QVERIFY(arguments.typeColumn != 0);
-    QCOMPARE(arguments.typeColumn->value(rowData.constBegin()), QVariant(itemType));
+    QCOMPARE(arguments.typeColumn->value(QGalleryTrackerRow(&table, 0)), QVariant(itemType));
 }
 
 void tst_QGalleryTrackerSchema::queryResponseFilePropertyNames_data()
@@ -1770,6 +1827,7 @@ void tst_QGalleryTrackerSchema::queryResponseFilter_data()
     QTest::addColumn<QGalleryQueryRequest::Scope>("scope");
     QTest::addColumn<QGalleryFilter>("filter");
     QTest::addColumn<QString>("sparql");
+    QTest::addColumn<QStringList>("parameters");
 
     {
         QGalleryFilter filter
@@ -1784,9 +1842,10 @@ void tst_QGalleryTrackerSchema::queryResponseFilter_data()
                     "WHERE {"
                         "?x a nfo:FileDataObject . "
                         "?x tracker:available true "
-                        "FILTER((nie:url(?x)='file:///path/to/file.ext'))"
+                        "FILTER((nie:url(?x)=~p0))"
                     "} "
-                    "GROUP BY ?x";
+                    "GROUP BY ?x"
+                << (QStringList() << QStringLiteral("file:///path/to/file.ext"));
     } {
         QGalleryFilter filter
                 = QDocumentGallery::url == QUrl::fromLocalFile(QLatin1String("/"));
@@ -1800,9 +1859,10 @@ void tst_QGalleryTrackerSchema::queryResponseFilter_data()
                     "WHERE {"
                         "?x a nfo:FileDataObject . "
                         "?x tracker:available true "
-                        "FILTER((nie:url(?x)='file:///'))"
+                        "FILTER((nie:url(?x)=~p0))"
                     "} "
-                    "GROUP BY ?x";
+                    "GROUP BY ?x"
+                << (QStringList() << QStringLiteral("file:///"));
     } {
         QGalleryFilter filter
                 = QDocumentGallery::url == QUrl(QLatin1String("http://example.com"));
@@ -1816,9 +1876,10 @@ void tst_QGalleryTrackerSchema::queryResponseFilter_data()
                     "WHERE {"
                         "?x a nfo:FileDataObject . "
                         "?x tracker:available true "
-                        "FILTER((nie:url(?x)='http://example.com'))"
+                        "FILTER((nie:url(?x)=~p0))"
                     "} "
-                    "GROUP BY ?x";
+                    "GROUP BY ?x"
+                << (QStringList() << QStringLiteral("http://example.com"));
     } {
         QGalleryFilter filter
                 = QDocumentGallery::url == QUrl(QLatin1String("http://example.com/index.html"));
@@ -1832,9 +1893,10 @@ void tst_QGalleryTrackerSchema::queryResponseFilter_data()
                     "WHERE {"
                         "?x a nfo:FileDataObject . "
                         "?x tracker:available true "
-                        "FILTER((nie:url(?x)='http://example.com/index.html'))"
+                        "FILTER((nie:url(?x)=~p0))"
                     "} "
-                    "GROUP BY ?x";
+                    "GROUP BY ?x"
+                << (QStringList() << QStringLiteral("http://example.com/index.html"));
     } {
         QGalleryFilter filter
                 = QDocumentGallery::url == QUrl::fromLocalFile(QString::fromUtf8("/path/to/K\xc3\xa4rp\xc3\xa4ssieni.jpg"));
@@ -1848,9 +1910,10 @@ void tst_QGalleryTrackerSchema::queryResponseFilter_data()
                     "WHERE {"
                         "?x a nfo:FileDataObject . "
                         "?x tracker:available true "
-                        "FILTER((nie:url(?x)='file:///path/to/K%C3%A4rp%C3%A4ssieni.jpg'))"
+                        "FILTER((nie:url(?x)=~p0))"
                     "} "
-                    "GROUP BY ?x";
+                    "GROUP BY ?x"
+                << (QStringList() << QStringLiteral("file:///path/to/K%C3%A4rp%C3%A4ssieni.jpg"));
     } {
         QGalleryFilter filter = QDocumentGallery::filePath == QLatin1String("/path/to/file.ext");
 
@@ -1863,9 +1926,10 @@ void tst_QGalleryTrackerSchema::queryResponseFilter_data()
                     "WHERE {"
                         "?x a nfo:FileDataObject . "
                         "?x tracker:available true "
-                        "FILTER((nie:url(?x)='file:///path/to/file.ext'))"
+                        "FILTER((nie:url(?x)=~p0))"
                     "} "
-                    "GROUP BY ?x";
+                    "GROUP BY ?x"
+                << (QStringList() << QStringLiteral("file:///path/to/file.ext"));
     } {
         QGalleryFilter filter
                 = QDocumentGallery::filePath == QVariant(QString::fromUtf8("/path/to/K\xc3\xa4rp\xc3\xa4ssieni.jpg"));
@@ -1879,9 +1943,10 @@ void tst_QGalleryTrackerSchema::queryResponseFilter_data()
                     "WHERE {"
                         "?x a nfo:FileDataObject . "
                         "?x tracker:available true "
-                        "FILTER((nie:url(?x)='file:///path/to/K%C3%A4rp%C3%A4ssieni.jpg'))"
+                        "FILTER((nie:url(?x)=~p0))"
                     "} "
-                    "GROUP BY ?x";
+                    "GROUP BY ?x"
+                << (QStringList() << QStringLiteral("file:///path/to/K%C3%A4rp%C3%A4ssieni.jpg"));
     } {
         QGalleryFilter filter = QDocumentGallery::filePath > QLatin1String("/path/to/file.ext");
 
@@ -1894,9 +1959,10 @@ void tst_QGalleryTrackerSchema::queryResponseFilter_data()
                     "WHERE {"
                         "?x a nfo:FileDataObject . "
                         "?x tracker:available true "
-                        "FILTER((nie:url(?x)>'file:///path/to/file.ext'))"
+                        "FILTER((nie:url(?x)>~p0))"
                     "} "
-                    "GROUP BY ?x";
+                    "GROUP BY ?x"
+                << (QStringList() << QStringLiteral("file:///path/to/file.ext"));
     } {
         QGalleryFilter filter = QDocumentGallery::filePath >= QLatin1String("/path/to/file.ext");
 
@@ -1909,9 +1975,10 @@ void tst_QGalleryTrackerSchema::queryResponseFilter_data()
                     "WHERE {"
                         "?x a nfo:FileDataObject . "
                         "?x tracker:available true "
-                        "FILTER((nie:url(?x)>='file:///path/to/file.ext'))"
+                        "FILTER((nie:url(?x)>=~p0))"
                     "} "
-                    "GROUP BY ?x";
+                    "GROUP BY ?x"
+                << (QStringList() << QStringLiteral("file:///path/to/file.ext"));
     } {
         QGalleryFilter filter = QDocumentGallery::filePath < QLatin1String("/path/to/file.ext");
 
@@ -1924,9 +1991,10 @@ void tst_QGalleryTrackerSchema::queryResponseFilter_data()
                     "WHERE {"
                         "?x a nfo:FileDataObject . "
                         "?x tracker:available true "
-                        "FILTER((nie:url(?x)<'file:///path/to/file.ext'))"
+                        "FILTER((nie:url(?x)<~p0))"
                     "} "
-                    "GROUP BY ?x";
+                    "GROUP BY ?x"
+                << (QStringList() << QStringLiteral("file:///path/to/file.ext"));
     } {
         QGalleryFilter filter = QDocumentGallery::filePath <= QLatin1String("/path/to/file.ext");
 
@@ -1939,9 +2007,10 @@ void tst_QGalleryTrackerSchema::queryResponseFilter_data()
                     "WHERE {"
                         "?x a nfo:FileDataObject . "
                         "?x tracker:available true "
-                        "FILTER((nie:url(?x)<='file:///path/to/file.ext'))"
+                        "FILTER((nie:url(?x)<=~p0))"
                     "} "
-                    "GROUP BY ?x";
+                    "GROUP BY ?x"
+                << (QStringList() << QStringLiteral("file:///path/to/file.ext"));
     } {
         QGalleryFilter filter = QDocumentGallery::path.startsWith(QLatin1String("/path/"));
 
@@ -1954,9 +2023,10 @@ void tst_QGalleryTrackerSchema::queryResponseFilter_data()
                     "WHERE {"
                         "?x a nfo:FileDataObject . "
                         "?x tracker:available true "
-                        "FILTER(fn:starts-with(nie:url(nfo:belongsToContainer(?x)),'file:///path/'))"
+                        "FILTER(fn:starts-with(nie:url(nfo:belongsToContainer(?x)),~p0))"
                     "} "
-                    "GROUP BY ?x";
+                    "GROUP BY ?x"
+                << (QStringList() << QStringLiteral("file:///path/"));
     } {
         QGalleryFilter filter = QDocumentGallery::path.endsWith(QLatin1String("/to"));
 
@@ -1969,9 +2039,10 @@ void tst_QGalleryTrackerSchema::queryResponseFilter_data()
                     "WHERE {"
                         "?x a nfo:FileDataObject . "
                         "?x tracker:available true "
-                        "FILTER(fn:ends-with(nie:url(nfo:belongsToContainer(?x)),'/to'))"
+                        "FILTER(fn:ends-with(nie:url(nfo:belongsToContainer(?x)),~p0))"
                     "} "
-                    "GROUP BY ?x";
+                    "GROUP BY ?x"
+                << (QStringList() << QStringLiteral("/to"));
     } {
         QGalleryFilter filter = QDocumentGallery::path.contains(QLatin1String("path"));
 
@@ -1984,9 +2055,10 @@ void tst_QGalleryTrackerSchema::queryResponseFilter_data()
                     "WHERE {"
                         "?x a nfo:FileDataObject . "
                         "?x tracker:available true "
-                        "FILTER(fn:contains(nie:url(nfo:belongsToContainer(?x)),'path'))"
+                        "FILTER(fn:contains(nie:url(nfo:belongsToContainer(?x)),~p0))"
                     "} "
-                    "GROUP BY ?x";
+                    "GROUP BY ?x"
+                << (QStringList() << QStringLiteral("path"));
     } {
         QGalleryFilter filter = QDocumentGallery::path.wildcard(QLatin1String("/*/to"));
 
@@ -1999,9 +2071,10 @@ void tst_QGalleryTrackerSchema::queryResponseFilter_data()
                     "WHERE {"
                         "?x a nfo:FileDataObject . "
                         "?x tracker:available true "
-                        "FILTER(fn:contains(nie:url(nfo:belongsToContainer(?x)),'file:///*/to'))"
+                        "FILTER(fn:contains(nie:url(nfo:belongsToContainer(?x)),~p0))"
                     "} "
-                    "GROUP BY ?x";
+                    "GROUP BY ?x"
+                << (QStringList() << QStringLiteral("file:///*/to"));
     } {
         QGalleryFilter filter = QDocumentGallery::fileExtension == QLatin1String("ext");
 
@@ -2014,9 +2087,10 @@ void tst_QGalleryTrackerSchema::queryResponseFilter_data()
                     "WHERE {"
                         "?x a nfo:FileDataObject . "
                         "?x tracker:available true "
-                        "FILTER(fn:ends-with(nfo:fileName(?x),'.ext'))"
+                        "FILTER(fn:ends-with(nfo:fileName(?x),~p0))"
                     "} "
-                    "GROUP BY ?x";
+                    "GROUP BY ?x"
+                << (QStringList() << QStringLiteral(".ext"));
     } {
         QGalleryFilter filter = QDocumentGallery::fileName == QLatin1String("file.ext");
 
@@ -2029,9 +2103,10 @@ void tst_QGalleryTrackerSchema::queryResponseFilter_data()
                     "WHERE {"
                         "?x a nfo:FileDataObject . "
                         "?x tracker:available true "
-                        "FILTER((nfo:fileName(?x)='file.ext'))"
+                        "FILTER((nfo:fileName(?x)=~p0))"
                     "} "
-                    "GROUP BY ?x";
+                    "GROUP BY ?x"
+                << (QStringList() << QStringLiteral("file.ext"));
     } {
         QGalleryFilter filter = QDocumentGallery::fileName.startsWith(QLatin1String("file."));
 
@@ -2044,9 +2119,10 @@ void tst_QGalleryTrackerSchema::queryResponseFilter_data()
                     "WHERE {"
                         "?x a nfo:FileDataObject . "
                         "?x tracker:available true "
-                        "FILTER(fn:starts-with(nfo:fileName(?x),'file.'))"
+                        "FILTER(fn:starts-with(nfo:fileName(?x),~p0))"
                     "} "
-                    "GROUP BY ?x";
+                    "GROUP BY ?x"
+                << (QStringList() << QStringLiteral("file."));
     } {
         QGalleryFilter filter = QDocumentGallery::fileName.endsWith(QLatin1String(".ext"));
 
@@ -2059,9 +2135,10 @@ void tst_QGalleryTrackerSchema::queryResponseFilter_data()
                     "WHERE {"
                         "?x a nfo:FileDataObject . "
                         "?x tracker:available true "
-                        "FILTER(fn:ends-with(nfo:fileName(?x),'.ext'))"
+                        "FILTER(fn:ends-with(nfo:fileName(?x),~p0))"
                     "} "
-                    "GROUP BY ?x";
+                    "GROUP BY ?x"
+                << (QStringList() << QStringLiteral(".ext"));
     } {
         QGalleryFilter filter = QDocumentGallery::fileName.contains(QLatin1String("ext"));
 
@@ -2074,9 +2151,10 @@ void tst_QGalleryTrackerSchema::queryResponseFilter_data()
                     "WHERE {"
                         "?x a nfo:FileDataObject . "
                         "?x tracker:available true "
-                        "FILTER(fn:contains(nfo:fileName(?x),'ext'))"
+                        "FILTER(fn:contains(nfo:fileName(?x),~p0))"
                     "} "
-                    "GROUP BY ?x";
+                    "GROUP BY ?x"
+                << (QStringList() << QStringLiteral("ext"));
     } {
         QGalleryFilter filter = QDocumentGallery::fileName.wildcard(QLatin1String("file*ext"));
 
@@ -2089,9 +2167,10 @@ void tst_QGalleryTrackerSchema::queryResponseFilter_data()
                     "WHERE {"
                         "?x a nfo:FileDataObject . "
                         "?x tracker:available true "
-                        "FILTER(fn:contains(nfo:fileName(?x),'file*ext'))"
+                        "FILTER(fn:contains(nfo:fileName(?x),~p0))"
                     "} "
-                    "GROUP BY ?x";
+                    "GROUP BY ?x"
+                << (QStringList() << QStringLiteral("file*ext"));
     } {
         QGalleryFilter filter
                 = QDocumentGallery::fileName.regExp(QLatin1String("(file|document).ext"));
@@ -2105,9 +2184,10 @@ void tst_QGalleryTrackerSchema::queryResponseFilter_data()
                     "WHERE {"
                         "?x a nfo:FileDataObject . "
                         "?x tracker:available true "
-                        "FILTER(REGEX(nfo:fileName(?x),'(file|document).ext'))"
+                        "FILTER(REGEX(nfo:fileName(?x),~p0))"
                     "} "
-                    "GROUP BY ?x";
+                    "GROUP BY ?x"
+                << (QStringList() << QStringLiteral("(file|document).ext"));
     } {
         QGalleryFilter filter
                 = QDocumentGallery::fileName.regExp(QRegExp(QLatin1String("(file|document).ext")));
@@ -2121,9 +2201,10 @@ void tst_QGalleryTrackerSchema::queryResponseFilter_data()
                     "WHERE {"
                         "?x a nfo:FileDataObject . "
                         "?x tracker:available true "
-                        "FILTER(REGEX(nfo:fileName(?x),'(file|document).ext'))"
+                        "FILTER(REGEX(nfo:fileName(?x),~p0))"
                     "} "
-                    "GROUP BY ?x";
+                    "GROUP BY ?x"
+                << (QStringList() << QStringLiteral("(file|document).ext"));
     } {
         QGalleryFilter filter
                 = QDocumentGallery::description == QUrl(QLatin1String("http://example.com/index.html"));
@@ -2137,9 +2218,10 @@ void tst_QGalleryTrackerSchema::queryResponseFilter_data()
                     "WHERE {"
                         "?x a nfo:FileDataObject . "
                         "?x tracker:available true "
-                        "FILTER((nie:description(?x)='http://example.com/index.html'))"
+                        "FILTER((nie:description(?x)=~p0))"
                     "} "
-                    "GROUP BY ?x";
+                    "GROUP BY ?x"
+                << (QStringList() << QStringLiteral("http://example.com/index.html"));
     } {
         QGalleryFilter filter = QDocumentGallery::width > 1024;
 
@@ -2152,9 +2234,10 @@ void tst_QGalleryTrackerSchema::queryResponseFilter_data()
                     "WHERE {"
                         "?x a nmm:Photo . "
                         "?x tracker:available true "
-                        "FILTER((nfo:width(?x)>'1024'))"
+                        "FILTER((nfo:width(?x)>~p0))"
                     "} "
-                    "GROUP BY ?x";
+                    "GROUP BY ?x"
+                << (QStringList() << QStringLiteral("1024"));
     } {
         QGalleryFilter filter = QDocumentGallery::width >= 1024u;
 
@@ -2167,9 +2250,10 @@ void tst_QGalleryTrackerSchema::queryResponseFilter_data()
                     "WHERE {"
                         "?x a nmm:Video . "
                         "?x tracker:available true "
-                        "FILTER((nfo:width(?x)>='1024'))"
+                        "FILTER((nfo:width(?x)>=~p0))"
                     "} "
-                    "GROUP BY ?x";
+                    "GROUP BY ?x"
+                << (QStringList() << QStringLiteral("1024"));
     } {
         QGalleryFilter filter = QDocumentGallery::height < Q_INT64_C(1024);
 
@@ -2182,9 +2266,10 @@ void tst_QGalleryTrackerSchema::queryResponseFilter_data()
                     "WHERE {"
                         "?x a nmm:Photo . "
                         "?x tracker:available true "
-                        "FILTER((nfo:height(?x)<'1024'))"
+                        "FILTER((nfo:height(?x)<~p0))"
                     "} "
-                    "GROUP BY ?x";
+                    "GROUP BY ?x"
+                << (QStringList() << QStringLiteral("1024"));
     } {
         QGalleryFilter filter = QDocumentGallery::height <= Q_UINT64_C(1024);
 
@@ -2197,9 +2282,10 @@ void tst_QGalleryTrackerSchema::queryResponseFilter_data()
                     "WHERE {"
                         "?x a nmm:Video . "
                         "?x tracker:available true "
-                        "FILTER((nfo:height(?x)<='1024'))"
+                        "FILTER((nfo:height(?x)<=~p0))"
                     "} "
-                    "GROUP BY ?x";
+                    "GROUP BY ?x"
+                << (QStringList() << QStringLiteral("1024"));
     } {
         QGalleryFilter filter = QDocumentGallery::focalLength <= 1.9;
 
@@ -2212,9 +2298,10 @@ void tst_QGalleryTrackerSchema::queryResponseFilter_data()
                     "WHERE {"
                         "?x a nmm:Photo . "
                         "?x tracker:available true "
-                        "FILTER((nmm:focalLength(?x)<='1.9'))"
+                        "FILTER((nmm:focalLength(?x)<=~p0))"
                     "} "
-                    "GROUP BY ?x";
+                    "GROUP BY ?x"
+                << (QStringList() << QStringLiteral("1.9"));
     } {
         QGalleryFilter filter = QDocumentGallery::focalLength < 0.25f;
 
@@ -2227,9 +2314,10 @@ void tst_QGalleryTrackerSchema::queryResponseFilter_data()
                     "WHERE {"
                         "?x a nmm:Photo . "
                         "?x tracker:available true "
-                        "FILTER((nmm:focalLength(?x)<'0.25'))"
+                        "FILTER((nmm:focalLength(?x)<~p0))"
                     "} "
-                    "GROUP BY ?x";
+                    "GROUP BY ?x"
+                << (QStringList() << QStringLiteral("0.25"));
     } {
         QGalleryFilter filter
                 = QDocumentGallery::lastModified > QDateTime(QDate(2008, 06, 01), QTime(12, 5, 8));
@@ -2243,9 +2331,10 @@ void tst_QGalleryTrackerSchema::queryResponseFilter_data()
                     "WHERE {"
                         "?x a nmm:Photo . "
                         "?x tracker:available true "
-                        "FILTER((nfo:fileLastModified(?x)>'2008-06-01T12:05:08'))"
+                        "FILTER((nfo:fileLastModified(?x)>~p0))"
                     "} "
-                    "GROUP BY ?x";
+                    "GROUP BY ?x"
+                << (QStringList() << QStringLiteral("2008-06-01T12:05:08"));
     } {
         QGalleryFilter filter = !(
                 QDocumentGallery::lastModified > QDateTime(QDate(2008, 06, 01), QTime(12, 5, 8)));
@@ -2259,9 +2348,10 @@ void tst_QGalleryTrackerSchema::queryResponseFilter_data()
                     "WHERE {"
                         "?x a nmm:Photo . "
                         "?x tracker:available true "
-                        "FILTER(!(nfo:fileLastModified(?x)>'2008-06-01T12:05:08'))"
+                        "FILTER(!(nfo:fileLastModified(?x)>~p0))"
                     "} "
-                    "GROUP BY ?x";
+                    "GROUP BY ?x"
+                << (QStringList() << QStringLiteral("2008-06-01T12:05:08"));
 
     } {
         QGalleryIntersectionFilter filter;
@@ -2277,9 +2367,10 @@ void tst_QGalleryTrackerSchema::queryResponseFilter_data()
                     "WHERE {"
                         "?x a nmm:Photo . "
                         "?x tracker:available true "
-                        "FILTER(((nfo:width(?x)>'1024')&&(nfo:height(?x)>'768')))"
+                        "FILTER(((nfo:width(?x)>~p0)&&(nfo:height(?x)>~p1)))"
                     "} "
-                    "GROUP BY ?x";
+                    "GROUP BY ?x"
+                << (QStringList() << QStringLiteral("1024") << QStringLiteral("768"));
     } {
         QGalleryIntersectionFilter filter;
         filter.append(QDocumentGallery::width > 1024);
@@ -2293,9 +2384,10 @@ void tst_QGalleryTrackerSchema::queryResponseFilter_data()
                     "WHERE {"
                         "?x a nmm:Photo . "
                         "?x tracker:available true "
-                        "FILTER(((nfo:width(?x)>'1024')))"
+                        "FILTER(((nfo:width(?x)>~p0)))"
                     "} "
-                    "GROUP BY ?x";
+                    "GROUP BY ?x"
+                << (QStringList() << QStringLiteral("1024"));
     } {
         QGalleryUnionFilter filter;
         filter.append(QDocumentGallery::width < 1920);
@@ -2310,9 +2402,10 @@ void tst_QGalleryTrackerSchema::queryResponseFilter_data()
                     "WHERE {"
                         "?x a nmm:Photo . "
                         "?x tracker:available true "
-                        "FILTER(((nfo:width(?x)<'1920')||(nfo:height(?x)<'1024')))"
+                        "FILTER(((nfo:width(?x)<~p0)||(nfo:height(?x)<~p1)))"
                     "} "
-                    "GROUP BY ?x";
+                    "GROUP BY ?x"
+                << (QStringList() << QStringLiteral("1920") << QStringLiteral("1024"));
     } {
         QGalleryUnionFilter filter;
         filter.append(QDocumentGallery::width < 1920);
@@ -2326,9 +2419,10 @@ void tst_QGalleryTrackerSchema::queryResponseFilter_data()
                     "WHERE {"
                         "?x a nmm:Photo . "
                         "?x tracker:available true "
-                        "FILTER(((nfo:width(?x)<'1920')))"
+                        "FILTER(((nfo:width(?x)<~p0)))"
                     "} "
-                    "GROUP BY ?x";
+                    "GROUP BY ?x"
+                << (QStringList() << QStringLiteral("1920"));
     } {
         QGalleryUnionFilter filter;
 
@@ -2342,7 +2436,8 @@ void tst_QGalleryTrackerSchema::queryResponseFilter_data()
                         "?x a nmm:Photo . "
                         "?x tracker:available true"
                     "} "
-                    "GROUP BY ?x";
+                    "GROUP BY ?x"
+                << QStringList();
     } {
         QGalleryIntersectionFilter filter;
 
@@ -2356,7 +2451,8 @@ void tst_QGalleryTrackerSchema::queryResponseFilter_data()
                         "?x a nmm:Photo . "
                         "?x tracker:available true"
                     "} "
-                    "GROUP BY ?x";
+                    "GROUP BY ?x"
+                << QStringList();
     } {
         QGalleryFilter filter = QDocumentGallery::fileName == QLatin1String("file.ext");
 
@@ -2370,9 +2466,10 @@ void tst_QGalleryTrackerSchema::queryResponseFilter_data()
                         "?x a nfo:FileDataObject . "
                         "?x tracker:available true . "
                         "?x nfo:belongsToContainer <uuid:ff172362-d959-99e0-a792-0ddafdd2c559> "
-                        "FILTER((nfo:fileName(?x)='file.ext'))"
+                        "FILTER((nfo:fileName(?x)=~p0))"
                     "} "
-                    "GROUP BY ?x";
+                    "GROUP BY ?x"
+                << (QStringList() << QStringLiteral("file.ext"));
     } {
         QGalleryFilter filter = QDocumentGallery::title == QLatin1String("Greatest Hits");
 
@@ -2387,9 +2484,10 @@ void tst_QGalleryTrackerSchema::queryResponseFilter_data()
                         "?track a nmm:MusicPiece . "
                         "?track nmm:musicAlbum ?x . "
                         "?track tracker:available true "
-                        "FILTER((nie:title(?x)='Greatest Hits'))"
+                        "FILTER((nie:title(?x)=~p0))"
                     "} "
-                    "GROUP BY ?x";
+                    "GROUP BY ?x"
+                << (QStringList() << QStringLiteral("Greatest Hits"));
     } {
         QGalleryFilter filter = QDocumentGallery::title == QLatin1String("Greatest Hits");
 
@@ -2404,9 +2502,10 @@ void tst_QGalleryTrackerSchema::queryResponseFilter_data()
                         "?track a nmm:MusicPiece . "
                         "?track nmm:musicAlbum ?x . "
                         "?track tracker:available true "
-                        "FILTER((nie:title(?x)='Greatest Hits'))"
+                        "FILTER((nie:title(?x)=~p0))"
                     "} "
-                    "GROUP BY ?x";
+                    "GROUP BY ?x"
+                << (QStringList() << QStringLiteral("Greatest Hits"));
     } {
         QGalleryFilter filter = QDocumentGallery::title == QLatin1String("Greatest Hits");
 
@@ -2422,9 +2521,10 @@ void tst_QGalleryTrackerSchema::queryResponseFilter_data()
                         "?track nmm:musicAlbum ?x . "
                         "?track tracker:available true . "
                         "?x nmm:albumArtist <artist:Self%20Titled> "
-                        "FILTER((nie:title(?x)='Greatest Hits'))"
+                        "FILTER((nie:title(?x)=~p0))"
                     "} "
-                    "GROUP BY ?x";
+                    "GROUP BY ?x"
+                << (QStringList() << QStringLiteral("Greatest Hits"));
     } {
         QGalleryFilter filter = QDocumentGallery::title == QLatin1String("Greatest Hits");
 
@@ -2440,9 +2540,10 @@ void tst_QGalleryTrackerSchema::queryResponseFilter_data()
                         "?track nmm:musicAlbum ?x . "
                         "?track tracker:available true . "
                         "?x nmm:albumArtist <artist:Self%20Titled> "
-                        "FILTER((nie:title(?x)='Greatest Hits'))"
+                        "FILTER((nie:title(?x)=~p0))"
                     "} "
-                    "GROUP BY ?x";
+                    "GROUP BY ?x"
+                << (QStringList() << QStringLiteral("Greatest Hits"));
     } {
         QGalleryFilter filter = QDocumentGallery::albumTitle == QLatin1String("Greatest Hits");
 
@@ -2458,9 +2559,10 @@ void tst_QGalleryTrackerSchema::queryResponseFilter_data()
                         "?album a nmm:MusicAlbum . "
                         "?x nmm:musicAlbum ?album . "
                         "?album nmm:albumArtist <artist:Self%20Titled> "
-                        "FILTER((nie:title(?album)='Greatest Hits'))"
+                        "FILTER((nie:title(?album)=~p0))"
                     "} "
-                    "GROUP BY ?x";
+                    "GROUP BY ?x"
+                << (QStringList() << QStringLiteral("Greatest Hits"));
     } {
         QGalleryFilter filter = QDocumentGallery::albumArtist == QLatin1String("Self Titled");
 
@@ -2475,9 +2577,10 @@ void tst_QGalleryTrackerSchema::queryResponseFilter_data()
                         "?x tracker:available true "
                         "OPTIONAL {?x nmm:musicAlbum ?album} "
                         "OPTIONAL {?album nmm:albumArtist ?albumArtist} "
-                        "FILTER((nmm:artistName(?albumArtist)='Self Titled'))"
+                        "FILTER((nmm:artistName(?albumArtist)=~p0))"
                     "} "
-                    "GROUP BY ?x";
+                    "GROUP BY ?x"
+                << (QStringList() << QStringLiteral("Self Titled"));
     }
 }
 
@@ -2488,6 +2591,7 @@ void tst_QGalleryTrackerSchema::queryResponseFilter()
     QFETCH(QGalleryQueryRequest::Scope, scope);
     QFETCH(QGalleryFilter, filter);
     QFETCH(QString, sparql);
+    QFETCH(QStringList, parameters);
 
     QGalleryTrackerResultSetArguments arguments;
 
@@ -2506,6 +2610,7 @@ void tst_QGalleryTrackerSchema::queryResponseFilter()
             QDocumentGallery::NoError);
 
     QCOMPARE(arguments.sparql, sparql);
+    QCOMPARE(arguments.parameters, parameters);
 }
 
 
@@ -2891,8 +2996,183 @@ void tst_QGalleryTrackerSchema::queryResponseCompositeColumn()
                     0),
             QDocumentGallery::NoError);
 
+    QGalleryTrackerTable table(qt_variantTypes(rowData));
+    table.appendRow(rowData);
+
     QCOMPARE(arguments.compositeColumns.count(), 1);
-    QCOMPARE(arguments.compositeColumns.at(0)->value(rowData.constBegin()), value);
+    QCOMPARE(arguments.compositeColumns.at(0)->value(QGalleryTrackerRow(&table, 0)), value);
+}
+
+void tst_QGalleryTrackerSchema::queryResponseResourceRefresh_data()
+{
+    QTest::addColumn<QString>("rootType");
+    QTest::addColumn<QStringList>("sortPropertyNames");
+    QTest::addColumn<int>("limit");
+    QTest::addColumn<bool>("refreshResources");
+    QTest::addColumn<QVector<int> >("sortColumns");
+
+    QTest::newRow("Image: unsorted")
+            << "Image"
+            << QStringList()
+            << 0
+            << true
+            << QVector<int>();
+    QTest::newRow("Image: sorted by fetched property")
+            << "Image"
+            << (QStringList() << QLatin1String("-dateTaken"))
+            << 0
+            << true
+            << (QVector<int>() << 4);
+    QTest::newRow("Image: sorted by fetched properties")
+            << "Image"
+            << (QStringList() << QLatin1String("+dateTaken") << QLatin1String("exposureTime"))
+            << 0
+            << true
+            << (QVector<int>() << 4 << 3);
+    QTest::newRow("Image: sorted by unfetched property")
+            << "Image"
+            << (QStringList() << QLatin1String("fNumber"))
+            << 0
+            << false
+            << QVector<int>();
+    QTest::newRow("Image: limited")
+            << "Image"
+            << QStringList()
+            << 10
+            << false
+            << QVector<int>();
+    QTest::newRow("Artist")
+            << "Artist"
+            << QStringList()
+            << 0
+            << false
+            << QVector<int>();
+}
+
+void tst_QGalleryTrackerSchema::queryResponseResourceRefresh()
+{
+    QFETCH(QString, rootType);
+    QFETCH(QStringList, sortPropertyNames);
+    QFETCH(int, limit);
+    QFETCH(bool, refreshResources);
+    QFETCH(QVector<int>, sortColumns);
+
+    QGalleryTrackerResultSetArguments arguments;
+
+    QGalleryTrackerSchema schema(rootType);
+
+    QCOMPARE(
+            schema.prepareQueryResponse(
+                    &arguments,
+                    QGalleryQueryRequest::AllDescendants,
+                    QString(),
+                    QGalleryFilter(),
+                    QStringList() << QLatin1String("exposureTime") << QLatin1String("dateTaken"),
+                    sortPropertyNames,
+                    0,
+                    limit),
+            QDocumentGallery::NoError);
+
+    QCOMPARE(arguments.resourceValuesIndex >= 0, refreshResources);
+    QCOMPARE(arguments.sortColumns, sortColumns);
+
+    if (refreshResources) {
+        QCOMPARE(arguments.resourceSparql, arguments.pageSparql);
+        QVERIFY(arguments.resourceSparql.left(arguments.resourceValuesIndex).endsWith(
+                QLatin1String("WHERE {")));
+    }
+}
+
+void tst_QGalleryTrackerSchema::queryResponsePlanCache()
+{
+    const QStringList propertyNames = QStringList()
+            << QLatin1String("fileName") << QLatin1String("width");
+    const QStringList sortPropertyNames = QStringList() << QLatin1String("-width");
+
+    QGalleryTrackerQueryPlanCache planCache;
+    QGalleryTrackerSchema schema(QLatin1String("Image"));
+
+    QGalleryTrackerResultSetArguments arguments;
+    QCOMPARE(
+            schema.prepareQueryResponse(
+                    &arguments,
+                    QGalleryQueryRequest::AllDescendants,
+                    QString(),
+                    QDocumentGallery::fileName == QLatin1String("a.jpg"),
+                    propertyNames,
+                    sortPropertyNames,
+                    0,
+                    0,
+                    &planCache),
+            QDocumentGallery::NoError);
+    QCOMPARE(planCache.hits(), 0);
+    QCOMPARE(planCache.misses(), 1);
+    QCOMPARE(planCache.count(), 1);
+
+    // The same filter with a different value reuses the plan.
+    QGalleryTrackerResultSetArguments cachedArguments;
+    QCOMPARE(
+            schema.prepareQueryResponse(
+                    &cachedArguments,
+                    QGalleryQueryRequest::AllDescendants,
+                    QString(),
+                    QDocumentGallery::fileName == QLatin1String("b.jpg"),
+                    propertyNames,
+                    sortPropertyNames,
+                    0,
+                    0,
+                    &planCache),
+            QDocumentGallery::NoError);
+    QCOMPARE(planCache.hits(), 1);
+    QCOMPARE(planCache.misses(), 1);
+    QCOMPARE(planCache.count(), 1);
+
+    QCOMPARE(cachedArguments.sparql, arguments.sparql);
+    QCOMPARE(cachedArguments.countSparql, arguments.countSparql);
+    QCOMPARE(cachedArguments.propertyNames, arguments.propertyNames);
+    QCOMPARE(cachedArguments.propertyTypes, arguments.propertyTypes);
+    QCOMPARE(cachedArguments.sortColumns, arguments.sortColumns);
+    QCOMPARE(cachedArguments.parameters, QStringList() << QLatin1String("b.jpg"));
+    QCOMPARE(arguments.parameters, QStringList() << QLatin1String("a.jpg"));
+
+    // Each request owns its own columns.
+    QCOMPARE(cachedArguments.valueColumns.count(), arguments.valueColumns.count());
+    for (int i = 0; i < arguments.valueColumns.count(); ++i) {
+        QVERIFY(cachedArguments.valueColumns.at(i) != arguments.valueColumns.at(i));
+        QCOMPARE(cachedArguments.valueColumns.at(i)->type(), arguments.valueColumns.at(i)->type());
+    }
+    QVERIFY(cachedArguments.idColumn);
+    QVERIFY(cachedArguments.idColumn.data() != arguments.idColumn.data());
+
+    // A different filter shape or sort order is a new plan.
+    QGalleryTrackerResultSetArguments otherArguments;
+    QCOMPARE(
+            schema.prepareQueryResponse(
+                    &otherArguments,
+                    QGalleryQueryRequest::AllDescendants,
+                    QString(),
+                    QDocumentGallery::fileName.startsWith(QLatin1String("a")),
+                    propertyNames,
+                    sortPropertyNames,
+                    0,
+                    0,
+                    &planCache),
+            QDocumentGallery::NoError);
+    QCOMPARE(
+            schema.prepareQueryResponse(
+                    &otherArguments,
+                    QGalleryQueryRequest::AllDescendants,
+                    QString(),
+                    QDocumentGallery::fileName == QLatin1String("a.jpg"),
+                    propertyNames,
+                    QStringList() << QLatin1String("width"),
+                    0,
+                    0,
+                    &planCache),
+            QDocumentGallery::NoError);
+    QCOMPARE(planCache.hits(), 1);
+    QCOMPARE(planCache.misses(), 3);
+    QCOMPARE(planCache.count(), 3);
 }
 
 void tst_QGalleryTrackerSchema::prepareInvalidQueryResponse_data()
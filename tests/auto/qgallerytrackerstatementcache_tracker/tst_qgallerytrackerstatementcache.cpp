@@ -0,0 +1,241 @@
+/****************************************************************************
+**
+** Copyright (C) 2012 Digia Plc and/or its subsidiary(-ies).
+** Contact: http://www.qt-project.org/legal
+**
+** This file is part of the Qt Mobility Components.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and Digia.  For licensing terms and
+** conditions see http://qt.digia.com/licensing.  For further information
+** use the contact form at http://qt.digia.com/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU Lesser General Public License version 2.1 requirements
+** will be met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** In addition, as a special exception, Digia gives you certain additional
+** rights.  These rights are described in the Digia Qt LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3.0 as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU General Public License version 3.0 requirements will be
+** met: http://www.gnu.org/copyleft/gpl.html.
+**
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+//TESTED_COMPONENT=src/gallery
+
+#include <private/qgallerytrackerstatementcache_p.h>
+
+#include <QtTest/QtTest>
+
+#include <libtracker-sparql/tracker-sparql.h>
+
+QT_USE_DOCGALLERY_NAMESPACE
+
+class tst_QGalleryTrackerStatementCache : public QObject
+{
+    Q_OBJECT
+public:
+    tst_QGalleryTrackerStatementCache() : m_connection(0) {}
+
+public Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+
+private Q_SLOTS:
+    void query();
+    void queryOnce();
+    void queryError();
+    void evictLeastRecentlyUsed();
+
+private:
+    static QStringList titles(TrackerSparqlCursor *cursor);
+
+    TrackerSparqlConnection *m_connection;
+};
+
+static const char *qt_titleQuery =
+        "SELECT ?title "
+        "WHERE { ?x a nfo:PaginatedTextDocument ; nie:title ?title . FILTER(?title != ~p0) } "
+        "ORDER BY ?title";
+
+static QString qt_limitQuery(int limit)
+{
+    return QString(QLatin1String(
+            "SELECT ?title "
+            "WHERE { ?x a nfo:PaginatedTextDocument ; nie:title ?title } "
+            "ORDER BY ?title LIMIT %1")).arg(limit);
+}
+
+void tst_QGalleryTrackerStatementCache::initTestCase()
+{
+    GFile *ontology = tracker_sparql_get_ontology_nepomuk();
+
+    GError *error = 0;
+    m_connection = tracker_sparql_connection_new(
+            TRACKER_SPARQL_CONNECTION_FLAGS_NONE, 0, ontology, 0, &error);
+
+    g_object_unref(ontology);
+
+    if (!m_connection) {
+        const QByteArray message = error->message;
+        g_error_free(error);
+
+        QFAIL(message.constData());
+    }
+
+    tracker_sparql_connection_update(
+            m_connection,
+            "INSERT DATA {"
+            " <urn:test:a> a nfo:PaginatedTextDocument ; nie:title \"a\" ."
+            " <urn:test:b> a nfo:PaginatedTextDocument ; nie:title \"b\" ."
+            " <urn:test:c> a nfo:PaginatedTextDocument ; nie:title \"c\" "
+            "}",
+            0,
+            &error);
+
+    if (error) {
+        const QByteArray message = error->message;
+        g_error_free(error);
+
+        QFAIL(message.constData());
+    }
+}
+
+void tst_QGalleryTrackerStatementCache::cleanupTestCase()
+{
+    if (m_connection)
+        g_object_unref(m_connection);
+}
+
+/*
+    Returns the strings in the first column of \a cursor and releases it.
+*/
+
+QStringList tst_QGalleryTrackerStatementCache::titles(TrackerSparqlCursor *cursor)
+{
+    QStringList titles;
+
+    if (cursor) {
+        while (tracker_sparql_cursor_next(cursor, 0, 0))
+            titles.append(QString::fromUtf8(tracker_sparql_cursor_get_string(cursor, 0, 0)));
+
+        g_object_unref(cursor);
+    }
+    return titles;
+}
+
+void tst_QGalleryTrackerStatementCache::query()
+{
+    QGalleryTrackerStatementCache cache(m_connection);
+
+    QCOMPARE(cache.count(), 0);
+
+    GError *error = 0;
+    QCOMPARE(titles(cache.query(
+                    QLatin1String(qt_titleQuery), QStringList() << QLatin1String("b"), 0, &error)),
+             QStringList() << QLatin1String("a") << QLatin1String("c"));
+    QVERIFY(!error);
+    QCOMPARE(cache.count(), 1);
+    QCOMPARE(cache.contains(QLatin1String(qt_titleQuery)), true);
+
+    // The cached statement is rebound with the new parameters rather than prepared again.
+    QCOMPARE(titles(cache.query(
+                    QLatin1String(qt_titleQuery), QStringList() << QLatin1String("a"), 0, &error)),
+             QStringList() << QLatin1String("b") << QLatin1String("c"));
+    QVERIFY(!error);
+    QCOMPARE(cache.count(), 1);
+}
+
+void tst_QGalleryTrackerStatementCache::queryOnce()
+{
+    QGalleryTrackerStatementCache cache(m_connection);
+
+    GError *error = 0;
+    QCOMPARE(titles(cache.queryOnce(
+                    QLatin1String(qt_titleQuery), QStringList() << QLatin1String("c"), 0, &error)),
+             QStringList() << QLatin1String("a") << QLatin1String("b"));
+    QVERIFY(!error);
+
+    QCOMPARE(titles(cache.queryOnce(qt_limitQuery(1), QStringList(), 0, &error)),
+             QStringList() << QLatin1String("a"));
+    QVERIFY(!error);
+
+    QCOMPARE(cache.count(), 0);
+    QCOMPARE(cache.contains(QLatin1String(qt_titleQuery)), false);
+}
+
+void tst_QGalleryTrackerStatementCache::queryError()
+{
+    QGalleryTrackerStatementCache cache(m_connection);
+
+    GError *error = 0;
+    QVERIFY(!cache.query(QLatin1String("SELECT WHERE"), QStringList(), 0, &error));
+    QVERIFY(error);
+
+    g_error_free(error);
+    error = 0;
+
+    QVERIFY(!cache.queryOnce(QLatin1String("SELECT WHERE"), QStringList(), 0, &error));
+    QVERIFY(error);
+
+    g_error_free(error);
+}
+
+void tst_QGalleryTrackerStatementCache::evictLeastRecentlyUsed()
+{
+    QGalleryTrackerStatementCache cache(m_connection);
+
+    GError *error = 0;
+    for (int i = 0; i < QGalleryTrackerStatementCache::MaximumStatements; ++i) {
+        QCOMPARE(titles(cache.query(qt_limitQuery(i + 1), QStringList(), 0, &error)).count(),
+                 qMin(i + 1, 3));
+        QVERIFY(!error);
+    }
+    QCOMPARE(cache.count(), int(QGalleryTrackerStatementCache::MaximumStatements));
+
+    // Using the first statement again makes the second the least recently used.
+    QCOMPARE(titles(cache.query(qt_limitQuery(1), QStringList(), 0, &error)).count(), 1);
+    QVERIFY(!error);
+    QCOMPARE(cache.count(), int(QGalleryTrackerStatementCache::MaximumStatements));
+
+    QCOMPARE(titles(cache.query(
+                    qt_limitQuery(QGalleryTrackerStatementCache::MaximumStatements + 1),
+                    QStringList(),
+                    0,
+                    &error)).count(), 3);
+    QVERIFY(!error);
+    QCOMPARE(cache.count(), int(QGalleryTrackerStatementCache::MaximumStatements));
+    QCOMPARE(cache.contains(qt_limitQuery(1)), true);
+    QCOMPARE(cache.contains(qt_limitQuery(2)), false);
+    QCOMPARE(cache.contains(qt_limitQuery(3)), true);
+    QCOMPARE(cache.contains(qt_limitQuery(QGalleryTrackerStatementCache::MaximumStatements + 1)), true);
+
+    // An evicted statement is prepared again when it's next used, evicting the next oldest.
+    QCOMPARE(titles(cache.query(qt_limitQuery(2), QStringList(), 0, &error)).count(), 2);
+    QVERIFY(!error);
+    QCOMPARE(cache.count(), int(QGalleryTrackerStatementCache::MaximumStatements));
+    QCOMPARE(cache.contains(qt_limitQuery(2)), true);
+    QCOMPARE(cache.contains(qt_limitQuery(3)), false);
+}
+
+QTEST_MAIN(tst_QGalleryTrackerStatementCache)
+
+#include "tst_qgallerytrackerstatementcache.moc"
@@ -0,0 +1,577 @@
+/****************************************************************************
+**
+** Copyright (C) 2012 Digia Plc and/or its subsidiary(-ies).
+** Contact: http://www.qt-project.org/legal
+**
+** This file is part of the Qt Mobility Components.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and Digia.  For licensing terms and
+** conditions see http://qt.digia.com/licensing.  For further information
+** use the contact form at http://qt.digia.com/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU Lesser General Public License version 2.1 requirements
+** will be met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** In addition, as a special exception, Digia gives you certain additional
+** rights.  These rights are described in the Digia Qt LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3.0 as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU General Public License version 3.0 requirements will be
+** met: http://www.gnu.org/copyleft/gpl.html.
+**
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+//TESTED_COMPONENT=src/gallery
+
+#include <private/qgallerytrackertable_p.h>
+
+#include <qgalleryrowbuffer.h>
+
+#include <QtTest/QtTest>
+
+QT_USE_DOCGALLERY_NAMESPACE
+
+Q_DECLARE_METATYPE(QVariant::Type)
+
+class tst_QGalleryTrackerTable : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void columnTypes();
+    void append_data();
+    void append();
+    void appendTable_data();
+    void appendTable();
+    void moveRows_data();
+    void moveRows();
+    void isEqual_data();
+    void isEqual();
+    void key_data();
+    void key();
+    void setValue_data();
+    void setValue();
+    void setStringValueMemoryUsage();
+    void dateTimeSpec();
+    void identity();
+    void read();
+    void readMovedAndEdited();
+
+private:
+    static void addStoreData();
+    static QGalleryTrackerTable *createTable(QVariant::Type type, const QVariantList &values);
+};
+
+/*
+    Three distinct values for each kind of store, none of them null.
+*/
+
+void tst_QGalleryTrackerTable::addStoreData()
+{
+    QTest::addColumn<QVariant::Type>("type");
+    QTest::addColumn<QVariantList>("values");
+
+    QTest::newRow("int")
+            << QVariant::Int
+            << (QVariantList() << 1 << -65536 << 0);
+    QTest::newRow("long long")
+            << QVariant::LongLong
+            << (QVariantList() << Q_INT64_C(1) << Q_INT64_C(-8589934592) << Q_INT64_C(0));
+    QTest::newRow("double")
+            << QVariant::Double
+            << (QVariantList() << 1.5 << -0.25 << 0.0);
+    QTest::newRow("date time")
+            << QVariant::DateTime
+            << (QVariantList()
+                    << QDateTime(QDate(2012, 5, 1), QTime(12, 30), Qt::UTC)
+                    << QDateTime(QDate(1970, 1, 1), QTime(0, 0), Qt::UTC)
+                    << QDateTime(QDate(1999, 12, 31), QTime(23, 59, 59), Qt::UTC));
+    QTest::newRow("string")
+            << QVariant::String
+            << (QVariantList()
+                    << QString(QLatin1String("alpha"))
+                    << QString(QLatin1String(""))
+                    << QString::fromUtf8("\xc3\xa9t\xc3\xa9"));
+    QTest::newRow("url")
+            << QVariant::Url
+            << (QVariantList()
+                    << QUrl(QLatin1String("file:///a/b.txt"))
+                    << QUrl(QLatin1String("file:///a%20b/c.txt"))
+                    << QUrl(QLatin1String("http://example.com/")));
+    QTest::newRow("string list")
+            << QVariant::StringList
+            << (QVariantList()
+                    << (QStringList() << QLatin1String("a") << QLatin1String("b"))
+                    << (QStringList() << QLatin1String("c"))
+                    << (QStringList() << QLatin1String("d") << QLatin1String("e") << QLatin1String("f")));
+}
+
+QGalleryTrackerTable *tst_QGalleryTrackerTable::createTable(
+        QVariant::Type type, const QVariantList &values)
+{
+    QGalleryTrackerTable *table = new QGalleryTrackerTable(QVector<QVariant::Type>() << type);
+
+    foreach (const QVariant &value, values)
+        table->appendRow(QVector<QVariant>() << value);
+
+    return table;
+}
+
+void tst_QGalleryTrackerTable::columnTypes()
+{
+    QGalleryTrackerTable table;
+    QCOMPARE(table.columnCount(), 0);
+    QCOMPARE(table.rowCount(), 0);
+
+    table.setColumnTypes(QVector<QVariant::Type>()
+            << QVariant::String << QVariant::Int << QVariant::DateTime);
+    QCOMPARE(table.columnCount(), 3);
+    QCOMPARE(table.rowCount(), 0);
+
+    table.appendRow(QVector<QVariant>() << QLatin1String("a") << 1);
+    QCOMPARE(table.rowCount(), 1);
+    QCOMPARE(table.value(0, 0), QVariant(QLatin1String("a")));
+    QCOMPARE(table.value(0, 1), QVariant(1));
+    QCOMPARE(table.value(0, 2), QVariant());
+
+    table.clear();
+    QCOMPARE(table.columnCount(), 3);
+    QCOMPARE(table.rowCount(), 0);
+
+    QCOMPARE(QGalleryTrackerTable::bufferType(QVariant::Int), QGalleryRowBuffer::Integer);
+    QCOMPARE(QGalleryTrackerTable::bufferType(QVariant::LongLong), QGalleryRowBuffer::Integer);
+    QCOMPARE(QGalleryTrackerTable::bufferType(QVariant::Double), QGalleryRowBuffer::Real);
+    QCOMPARE(QGalleryTrackerTable::bufferType(QVariant::DateTime), QGalleryRowBuffer::DateTime);
+    QCOMPARE(QGalleryTrackerTable::bufferType(QVariant::String), QGalleryRowBuffer::Text);
+    QCOMPARE(QGalleryTrackerTable::bufferType(QVariant::Url), QGalleryRowBuffer::Text);
+    QCOMPARE(QGalleryTrackerTable::bufferType(QVariant::StringList), QGalleryRowBuffer::Text);
+}
+
+void tst_QGalleryTrackerTable::append_data()
+{
+    addStoreData();
+}
+
+void tst_QGalleryTrackerTable::append()
+{
+    QFETCH(QVariant::Type, type);
+    QFETCH(QVariantList, values);
+
+    QScopedPointer<QGalleryTrackerTable> table(createTable(type, values));
+
+    table->appendRow(QVector<QVariant>() << QVariant());
+    table->appendRow(QVector<QVariant>());
+
+    QCOMPARE(table->rowCount(), 5);
+    QCOMPARE(table->value(0, 0), values.at(0));
+    QCOMPARE(table->value(1, 0), values.at(1));
+    QCOMPARE(table->value(2, 0), values.at(2));
+    QCOMPARE(table->value(3, 0), QVariant());
+    QCOMPARE(table->value(4, 0), QVariant());
+
+    QCOMPARE(table->value(0, 0).type(), type);
+
+    QVERIFY(table->memoryUsage() > 0);
+}
+
+void tst_QGalleryTrackerTable::appendTable_data()
+{
+    addStoreData();
+}
+
+void tst_QGalleryTrackerTable::appendTable()
+{
+    QFETCH(QVariant::Type, type);
+    QFETCH(QVariantList, values);
+
+    QScopedPointer<QGalleryTrackerTable> source(createTable(type, values));
+    source->appendRow(QVector<QVariant>() << QVariant());
+
+    QGalleryTrackerTable table(QVector<QVariant::Type>() << type);
+    table.appendRow(QVector<QVariant>() << values.at(2));
+
+    table.append(*source, 1, 3);
+    QCOMPARE(table.rowCount(), 4);
+    QCOMPARE(table.value(0, 0), values.at(2));
+    QCOMPARE(table.value(1, 0), values.at(1));
+    QCOMPARE(table.value(2, 0), values.at(2));
+    QCOMPARE(table.value(3, 0), QVariant());
+
+    table.append(*source);
+    QCOMPARE(table.rowCount(), 8);
+    QCOMPARE(table.value(4, 0), values.at(0));
+    QCOMPARE(table.value(7, 0), QVariant());
+
+    // The copied values are independent of the table they were copied from.
+    source->clear();
+    QCOMPARE(source->rowCount(), 0);
+    QCOMPARE(table.value(1, 0), values.at(1));
+    QCOMPARE(table.value(4, 0), values.at(0));
+}
+
+void tst_QGalleryTrackerTable::moveRows_data()
+{
+    addStoreData();
+}
+
+void tst_QGalleryTrackerTable::moveRows()
+{
+    QFETCH(QVariant::Type, type);
+    QFETCH(QVariantList, values);
+
+    const QVariantList rows = QVariantList()
+            << values.at(0) << QVariant() << values.at(1) << values.at(2) << QVariant();
+
+    QScopedPointer<QGalleryTrackerTable> table(createTable(type, rows));
+
+    // Move the first two rows to the end, destinations are given as in beginMoveRows().
+    table->moveRows(0, 2, 5);
+    QCOMPARE(table->value(0, 0), rows.at(2));
+    QCOMPARE(table->value(1, 0), rows.at(3));
+    QCOMPARE(table->value(2, 0), rows.at(4));
+    QCOMPARE(table->value(3, 0), rows.at(0));
+    QCOMPARE(table->value(4, 0), rows.at(1));
+
+    // And back again.
+    table->moveRows(3, 2, 0);
+    for (int i = 0; i < rows.count(); ++i)
+        QCOMPARE(table->value(i, 0), rows.at(i));
+
+    table->moveRows(3, 1, 1);
+    QCOMPARE(table->value(0, 0), rows.at(0));
+    QCOMPARE(table->value(1, 0), rows.at(3));
+    QCOMPARE(table->value(2, 0), rows.at(1));
+    QCOMPARE(table->value(3, 0), rows.at(2));
+    QCOMPARE(table->value(4, 0), rows.at(4));
+}
+
+void tst_QGalleryTrackerTable::isEqual_data()
+{
+    addStoreData();
+}
+
+void tst_QGalleryTrackerTable::isEqual()
+{
+    QFETCH(QVariant::Type, type);
+    QFETCH(QVariantList, values);
+
+    QScopedPointer<QGalleryTrackerTable> table(createTable(type, QVariantList()
+            << values.at(0) << values.at(1) << QVariant()));
+    QScopedPointer<QGalleryTrackerTable> other(createTable(type, QVariantList()
+            << values.at(1) << values.at(2) << QVariant() << values.at(0)));
+
+    QCOMPARE(table->isEqual(0, *other, 3, 0, 1), true);
+    QCOMPARE(table->isEqual(1, *other, 0, 0, 1), true);
+    QCOMPARE(table->isEqual(2, *other, 2, 0, 1), true);
+    QCOMPARE(table->isEqual(0, *other, 0, 0, 1), false);
+    QCOMPARE(table->isEqual(1, *other, 1, 0, 1), false);
+    QCOMPARE(table->isEqual(0, *other, 2, 0, 1), false);
+    QCOMPARE(table->isEqual(2, *other, 3, 0, 1), false);
+
+    // An empty range of columns is always equal.
+    QCOMPARE(table->isEqual(0, *other, 0, 0, 0), true);
+}
+
+void tst_QGalleryTrackerTable::key_data()
+{
+    addStoreData();
+}
+
+void tst_QGalleryTrackerTable::key()
+{
+    QFETCH(QVariant::Type, type);
+    QFETCH(QVariantList, values);
+
+    QScopedPointer<QGalleryTrackerTable> table(createTable(type, QVariantList()
+            << values.at(0) << values.at(1) << values.at(2) << values.at(0) << QVariant()));
+
+    const QGalleryTrackerValueStore *store = table->column(0);
+
+    QCOMPARE(store->count(), 5);
+    QCOMPARE(store->key(0), store->key(3));
+    QVERIFY(store->key(0) != store->key(1));
+    QVERIFY(store->key(0) != store->key(2));
+    QVERIFY(store->key(1) != store->key(2));
+    QVERIFY(store->key(4).isNull());
+    QVERIFY(!store->key(0).isNull());
+}
+
+void tst_QGalleryTrackerTable::setValue_data()
+{
+    addStoreData();
+}
+
+void tst_QGalleryTrackerTable::setValue()
+{
+    QFETCH(QVariant::Type, type);
+    QFETCH(QVariantList, values);
+
+    QScopedPointer<QGalleryTrackerTable> table(createTable(type, QVariantList()
+            << values.at(0) << QVariant() << values.at(1)));
+
+    table->setValue(0, 0, values.at(2));
+    QCOMPARE(table->value(0, 0), values.at(2));
+    QCOMPARE(table->value(1, 0), QVariant());
+    QCOMPARE(table->value(2, 0), values.at(1));
+
+    table->setValue(1, 0, values.at(0));
+    QCOMPARE(table->value(0, 0), values.at(2));
+    QCOMPARE(table->value(1, 0), values.at(0));
+    QCOMPARE(table->value(2, 0), values.at(1));
+
+    table->setValue(2, 0, QVariant());
+    QCOMPARE(table->value(0, 0), values.at(2));
+    QCOMPARE(table->value(1, 0), values.at(0));
+    QCOMPARE(table->value(2, 0), QVariant());
+
+    table->setValue(0, 0, values.at(0));
+    QCOMPARE(table->value(0, 0), values.at(0));
+    QCOMPARE(table->value(1, 0), values.at(0));
+    QCOMPARE(table->isEqual(0, *table, 1, 0, 1), true);
+    QCOMPARE(table->column(0)->key(0), table->column(0)->key(1));
+}
+
+static QString longValue(int index, int generation)
+{
+    return QString(QLatin1String("a longer value %1 %2")).arg(index, 4).arg(generation, 4);
+}
+
+void tst_QGalleryTrackerTable::setStringValueMemoryUsage()
+{
+    QGalleryTrackerTable table(QVector<QVariant::Type>() << QVariant::String);
+
+    for (int i = 0; i < 64; ++i)
+        table.appendRow(QVector<QVariant>() << QString(QLatin1String("value %1")).arg(i, 4));
+
+    const int usage = table.memoryUsage();
+    const int valuesSize = 64 * longValue(0, 0).toUtf8().size();
+
+    // Values which don't fit in the space of the ones they replace mustn't accumulate.
+    for (int generation = 0; generation < 64; ++generation) {
+        for (int i = 0; i < 64; ++i)
+            table.setValue(i, 0, longValue(i, generation));
+    }
+    for (int i = 0; i < 64; ++i)
+        QCOMPARE(table.value(i, 0), QVariant(longValue(i, 63)));
+
+    QVERIFY(table.memoryUsage() < usage + 8 * valuesSize);
+
+    // Shorter values are written over the ones they replace.
+    for (int i = 0; i < 64; ++i)
+        table.setValue(i, 0, QString::number(i));
+    for (int i = 0; i < 64; ++i)
+        QCOMPARE(table.value(i, 0), QVariant(QString::number(i)));
+
+    QVERIFY(table.memoryUsage() < usage + 8 * valuesSize);
+
+    for (int i = 0; i < 64; i += 2)
+        table.setValue(i, 0, QVariant());
+    for (int i = 0; i < 64; ++i)
+        QCOMPARE(table.value(i, 0), i % 2 == 0 ? QVariant() : QVariant(QString::number(i)));
+}
+
+void tst_QGalleryTrackerTable::dateTimeSpec()
+{
+    const QDateTime utc(QDate(2012, 5, 1), QTime(12, 30), Qt::UTC);
+    const QDateTime offset(QDate(2012, 5, 1), QTime(14, 30), Qt::OffsetFromUTC, 7200);
+    const QDateTime local(QDate(2012, 5, 1), QTime(12, 30), Qt::LocalTime);
+
+    QScopedPointer<QGalleryTrackerTable> table(createTable(
+            QVariant::DateTime, QVariantList() << utc << offset << local << QVariant()));
+
+    QCOMPARE(table->value(0, 0).toDateTime(), utc);
+    QCOMPARE(table->value(0, 0).toDateTime().timeSpec(), Qt::UTC);
+    QCOMPARE(table->value(1, 0).toDateTime(), offset);
+    QCOMPARE(table->value(1, 0).toDateTime().timeSpec(), Qt::OffsetFromUTC);
+    QCOMPARE(table->value(1, 0).toDateTime().offsetFromUtc(), 7200);
+    QCOMPARE(table->value(2, 0).toDateTime(), local);
+    QCOMPARE(table->value(2, 0).toDateTime().timeSpec(), Qt::LocalTime);
+
+    // The same instant with a different offset is a different value.
+    QCOMPARE(table->isEqual(0, *table, 1, 0, 1), false);
+    QVERIFY(table->column(0)->key(0) != table->column(0)->key(1));
+
+    table->setValue(3, 0, offset);
+    QCOMPARE(table->isEqual(1, *table, 3, 0, 1), true);
+    QCOMPARE(table->column(0)->key(1), table->column(0)->key(3));
+
+    table->moveRows(2, 2, 0);
+    QCOMPARE(table->value(0, 0).toDateTime().timeSpec(), Qt::LocalTime);
+    QCOMPARE(table->value(1, 0).toDateTime().offsetFromUtc(), 7200);
+    QCOMPARE(table->value(2, 0).toDateTime().timeSpec(), Qt::UTC);
+    QCOMPARE(table->value(3, 0).toDateTime().offsetFromUtc(), 7200);
+
+    QGalleryTrackerTable copy(QVector<QVariant::Type>() << QVariant::DateTime);
+    copy.append(*table, 1, 2);
+    QCOMPARE(copy.value(0, 0).toDateTime().offsetFromUtc(), 7200);
+    QCOMPARE(copy.value(1, 0).toDateTime().timeSpec(), Qt::UTC);
+}
+
+void tst_QGalleryTrackerTable::identity()
+{
+    QGalleryTrackerTable table(QVector<QVariant::Type>() << QVariant::String << QVariant::Int);
+
+    table.appendRow(QVector<QVariant>() << QLatin1String("a") << 1);
+    table.appendRow(QVector<QVariant>() << QLatin1String("a") << 2);
+    table.appendRow(QVector<QVariant>() << QLatin1String("b") << 1);
+    table.appendRow(QVector<QVariant>() << QLatin1String("a") << 1);
+
+    QCOMPARE(table.identity(0, 1), QByteArray("a"));
+    QCOMPARE(table.identity(0, 1), table.identity(1, 1));
+    QVERIFY(table.identity(0, 1) != table.identity(2, 1));
+
+    QCOMPARE(table.identity(0, 2), table.identity(3, 2));
+    QVERIFY(table.identity(0, 2) != table.identity(1, 2));
+    QVERIFY(table.identity(0, 2) != table.identity(2, 2));
+}
+
+static QVector<QVariant::Type> readColumnTypes()
+{
+    return QVector<QVariant::Type>()
+            << QVariant::String
+            << QVariant::Int
+            << QVariant::LongLong
+            << QVariant::Double
+            << QVariant::DateTime
+            << QVariant::Url
+            << QVariant::StringList;
+}
+
+static QVector<QGalleryRowBuffer::ColumnType> bufferTypes(const QVector<QVariant::Type> &types)
+{
+    QVector<QGalleryRowBuffer::ColumnType> bufferTypes;
+    for (int i = 0; i < types.count(); ++i)
+        bufferTypes.append(QGalleryTrackerTable::bufferType(types.at(i)));
+    return bufferTypes;
+}
+
+void tst_QGalleryTrackerTable::read()
+{
+    const QDateTime dateTime(QDate(2012, 5, 1), QTime(14, 30), Qt::OffsetFromUTC, 7200);
+
+    QGalleryTrackerTable table(readColumnTypes());
+
+    table.appendRow(QVector<QVariant>()
+            << QLatin1String("first")
+            << 1
+            << Q_INT64_C(8589934592)
+            << 0.5
+            << dateTime
+            << QUrl(QLatin1String("file:///a%20b/c.txt"))
+            << (QStringList() << QLatin1String("a") << QLatin1String("b")));
+    table.appendRow(QVector<QVariant>());
+    table.appendRow(QVector<QVariant>()
+            << QLatin1String("third")
+            << -2
+            << Q_INT64_C(-3)
+            << -1.25
+            << dateTime.addSecs(60)
+            << QUrl(QLatin1String("http://example.com/"))
+            << (QStringList() << QLatin1String("c")));
+
+    QGalleryRowBuffer buffer;
+    buffer.reset(4, bufferTypes(readColumnTypes()));
+
+    // Read all the rows into the middle of the buffer and the first again at the start.
+    for (int column = 0; column < table.columnCount(); ++column) {
+        table.read(0, 3, column, &buffer, 1, column);
+        table.read(0, 1, column, &buffer, 0, column);
+    }
+
+    QCOMPARE(buffer.rowCount(), 4);
+    QCOMPARE(buffer.columnCount(), 7);
+    QCOMPARE(buffer.columnType(0), QGalleryRowBuffer::Text);
+    QCOMPARE(buffer.columnType(1), QGalleryRowBuffer::Integer);
+    QCOMPARE(buffer.columnType(2), QGalleryRowBuffer::Integer);
+    QCOMPARE(buffer.columnType(3), QGalleryRowBuffer::Real);
+    QCOMPARE(buffer.columnType(4), QGalleryRowBuffer::DateTime);
+    QCOMPARE(buffer.columnType(5), QGalleryRowBuffer::Text);
+    QCOMPARE(buffer.columnType(6), QGalleryRowBuffer::Text);
+
+    for (int row = 0; row < 2; ++row) {
+        QCOMPARE(buffer.string(row, 0), QString(QLatin1String("first")));
+        QCOMPARE(buffer.integer(row, 1), Q_INT64_C(1));
+        QCOMPARE(buffer.integer(row, 2), Q_INT64_C(8589934592));
+        QCOMPARE(buffer.real(row, 3), 0.5);
+        QCOMPARE(buffer.integer(row, 4), dateTime.toMSecsSinceEpoch());
+        QCOMPARE(buffer.value(row, 4).toDateTime(), dateTime);
+        QCOMPARE(buffer.text(row, 5), QByteArray("file:///a%20b/c.txt"));
+        QCOMPARE(buffer.text(row, 6), QByteArray("a|b"));
+
+        for (int column = 0; column < 7; ++column)
+            QCOMPARE(buffer.isNull(row, column), false);
+    }
+
+    for (int column = 0; column < 7; ++column) {
+        QCOMPARE(buffer.isNull(2, column), true);
+        QCOMPARE(buffer.value(2, column), QVariant());
+    }
+
+    QCOMPARE(buffer.string(3, 0), QString(QLatin1String("third")));
+    QCOMPARE(buffer.integer(3, 1), Q_INT64_C(-2));
+    QCOMPARE(buffer.integers(1)[3], Q_INT64_C(-2));
+    QCOMPARE(buffer.integer(3, 2), Q_INT64_C(-3));
+    QCOMPARE(buffer.real(3, 3), -1.25);
+    QCOMPARE(buffer.reals(3)[3], -1.25);
+    QCOMPARE(buffer.integer(3, 4), dateTime.addSecs(60).toMSecsSinceEpoch());
+    QCOMPARE(buffer.text(3, 5), QByteArray("http://example.com/"));
+    QCOMPARE(buffer.string(3, 6), QString(QLatin1String("c")));
+
+    // Reading nothing leaves the buffer as it was.
+    table.read(3, 0, 1, &buffer, 0, 1);
+    QCOMPARE(buffer.integer(0, 1), Q_INT64_C(1));
+}
+
+void tst_QGalleryTrackerTable::readMovedAndEdited()
+{
+    QGalleryTrackerTable table(QVector<QVariant::Type>() << QVariant::String << QVariant::Int);
+
+    for (int i = 0; i < 8; ++i)
+        table.appendRow(QVector<QVariant>() << QString::number(i) << i);
+
+    table.moveRows(6, 2, 0);
+    table.setValue(0, 0, QLatin1String("six, edited"));
+    table.setValue(1, 0, QLatin1String("7"));
+    table.setValue(1, 1, QVariant());
+    table.setValue(2, 0, QVariant());
+
+    QGalleryRowBuffer buffer;
+    buffer.reset(8, QVector<QGalleryRowBuffer::ColumnType>()
+            << QGalleryRowBuffer::Text << QGalleryRowBuffer::Integer);
+
+    table.read(0, 8, 0, &buffer, 0, 0);
+    table.read(0, 8, 1, &buffer, 0, 1);
+
+    QCOMPARE(buffer.string(0, 0), QString(QLatin1String("six, edited")));
+    QCOMPARE(buffer.integer(0, 1), Q_INT64_C(6));
+    QCOMPARE(buffer.string(1, 0), QString(QLatin1String("7")));
+    QCOMPARE(buffer.isNull(1, 1), true);
+    QCOMPARE(buffer.isNull(2, 0), true);
+    QCOMPARE(buffer.integer(2, 1), Q_INT64_C(0));
+
+    for (int row = 3; row < 8; ++row) {
+        QCOMPARE(buffer.string(row, 0), QString::number(row - 2));
+        QCOMPARE(buffer.integer(row, 1), qint64(row - 2));
+    }
+}
+
+QTEST_MAIN(tst_QGalleryTrackerTable)
+
+#include "tst_qgallerytrackertable.moc"
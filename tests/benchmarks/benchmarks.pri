@@ -0,0 +1,7 @@
+TEMPLATE = app
+CONFIG += console benchmark
+
+QT = \
+    core \
+    testlib \
+    docgallery
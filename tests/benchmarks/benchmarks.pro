@@ -0,0 +1,10 @@
+TEMPLATE = subdirs
+SUBDIRS += \
+    qgalleryquerymodel
+
+linux-*:qtHaveModule(dbus):contains(tracker_enabled, yes) {
+    SUBDIRS += \
+            qgallerytrackerrowdiff_tracker \
+            qgallerytrackerschema_tracker \
+            qgallerytrackersynceventqueue_tracker
+}
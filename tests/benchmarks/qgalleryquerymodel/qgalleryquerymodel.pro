@@ -0,0 +1,3 @@
+include(../benchmarks.pri)
+
+SOURCES += tst_bench_qgalleryquerymodel.cpp
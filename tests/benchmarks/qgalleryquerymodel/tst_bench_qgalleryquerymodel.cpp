@@ -0,0 +1,256 @@
+/****************************************************************************
+**
+** Copyright (C) 2012 Digia Plc and/or its subsidiary(-ies).
+** Contact: http://www.qt-project.org/legal
+**
+** This file is part of the Qt Mobility Components.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and Digia.  For licensing terms and
+** conditions see http://qt.digia.com/licensing.  For further information
+** use the contact form at http://qt.digia.com/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU Lesser General Public License version 2.1 requirements
+** will be met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** In addition, as a special exception, Digia gives you certain additional
+** rights.  These rights are described in the Digia Qt LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3.0 as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU General Public License version 3.0 requirements will be
+** met: http://www.gnu.org/copyleft/gpl.html.
+**
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+//TESTED_COMPONENT=src/gallery
+
+#include <qabstractgallery.h>
+#include <qgalleryquerymodel.h>
+#include <qgalleryqueryrequest.h>
+#include <qgalleryresultset.h>
+
+#include <QtTest/QtTest>
+
+QT_USE_DOCGALLERY_NAMESPACE
+
+class QtBenchResultSet : public QGalleryResultSet
+{
+    Q_OBJECT
+public:
+    QtBenchResultSet(const QStringList &propertyNames, int rowCount)
+        : m_propertyNames(propertyNames)
+        , m_rowCount(rowCount)
+        , m_currentIndex(-1)
+    {
+        finish();
+    }
+
+    int propertyKey(const QString &propertyName) const {
+        return m_propertyNames.indexOf(propertyName); }
+    QGalleryProperty::Attributes propertyAttributes(int) const {
+        return QGalleryProperty::CanRead; }
+    QVariant::Type propertyType(int) const { return QVariant::Int; }
+
+    int itemCount() const { return m_rowCount; }
+
+    int currentIndex() const { return m_currentIndex; }
+    bool fetch(int index)
+    {
+        m_currentIndex = index;
+
+        Q_EMIT currentIndexChanged(index);
+        Q_EMIT currentItemChanged();
+
+        return isValid();
+    }
+
+    QVariant itemId() const { return m_currentIndex; }
+    QUrl itemUrl() const { return QUrl(); }
+    QString itemType() const { return QString(); }
+
+    QVariant metaData(int key) const { return m_currentIndex * m_propertyNames.count() + key; }
+    bool setMetaData(int, const QVariant &) { return false; }
+
+private:
+    const QStringList m_propertyNames;
+    const int m_rowCount;
+    int m_currentIndex;
+};
+
+class QtBenchGallery : public QAbstractGallery
+{
+public:
+    QtBenchGallery(const QStringList &propertyNames, int rowCount)
+        : m_propertyNames(propertyNames)
+        , m_rowCount(rowCount)
+        , m_resultSet(0)
+    {
+    }
+
+    bool isRequestSupported(QGalleryAbstractRequest::RequestType) const { return true; }
+
+    QtBenchResultSet *resultSet() const { return m_resultSet; }
+
+protected:
+    QGalleryAbstractResponse *createResponse(QGalleryAbstractRequest *)
+    {
+        return m_resultSet = new QtBenchResultSet(m_propertyNames, m_rowCount);
+    }
+
+private:
+    const QStringList m_propertyNames;
+    const int m_rowCount;
+    QtBenchResultSet *m_resultSet;
+};
+
+class tst_QGalleryQueryModel : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void data_data();
+    void data();
+    void metaDataChanged_data();
+    void metaDataChanged();
+
+private:
+    static QStringList propertyNames(int columnCount, int rolesPerColumn);
+    static void addColumns(QGalleryQueryModel *model, int columnCount, int rolesPerColumn);
+};
+
+QStringList tst_QGalleryQueryModel::propertyNames(int columnCount, int rolesPerColumn)
+{
+    QStringList names;
+
+    for (int i = 0; i < columnCount * rolesPerColumn; ++i)
+        names.append(QString(QLatin1String("property%1")).arg(i));
+
+    return names;
+}
+
+void tst_QGalleryQueryModel::addColumns(
+        QGalleryQueryModel *model, int columnCount, int rolesPerColumn)
+{
+    for (int column = 0; column < columnCount; ++column) {
+        QHash<int, QString> properties;
+
+        properties.insert(
+                Qt::DisplayRole, QString(QLatin1String("property%1")).arg(column * rolesPerColumn));
+
+        for (int role = 1; role < rolesPerColumn; ++role) {
+            properties.insert(
+                    Qt::UserRole + role,
+                    QString(QLatin1String("property%1")).arg(column * rolesPerColumn + role));
+        }
+
+        model->addColumn(properties);
+    }
+}
+
+void tst_QGalleryQueryModel::data_data()
+{
+    QTest::addColumn<int>("columnCount");
+    QTest::addColumn<int>("rolesPerColumn");
+
+    QTest::newRow("20 columns, 1 role") << 20 << 1;
+    QTest::newRow("20 columns, 4 roles") << 20 << 4;
+    QTest::newRow("20 columns, 8 roles") << 20 << 8;
+}
+
+void tst_QGalleryQueryModel::data()
+{
+    QFETCH(int, columnCount);
+    QFETCH(int, rolesPerColumn);
+
+    const int rowCount = 1000;
+
+    QtBenchGallery gallery(propertyNames(columnCount, rolesPerColumn), rowCount);
+
+    QGalleryQueryModel model(&gallery);
+    addColumns(&model, columnCount, rolesPerColumn);
+    model.execute();
+
+    QCOMPARE(model.rowCount(), rowCount);
+    QCOMPARE(model.columnCount(), columnCount);
+
+    // Read the display role and the last mapped role of every cell, as a table view does when
+    // painting its delegates.
+    const int lastRole = rolesPerColumn > 1 ? Qt::UserRole + rolesPerColumn - 1 : Qt::DisplayRole;
+
+    int sum = 0;
+
+    QBENCHMARK {
+        for (int row = 0; row < rowCount; ++row) {
+            for (int column = 0; column < columnCount; ++column) {
+                const QModelIndex index = model.index(row, column);
+
+                sum += model.data(index, Qt::DisplayRole).toInt();
+                sum += model.data(index, lastRole).toInt();
+            }
+        }
+    }
+
+    QVERIFY(sum != 0);
+}
+
+void tst_QGalleryQueryModel::metaDataChanged_data()
+{
+    QTest::addColumn<int>("columnCount");
+    QTest::addColumn<int>("rolesPerColumn");
+    QTest::addColumn<int>("changedKeys");
+
+    QTest::newRow("20 columns, 4 roles, 1 key") << 20 << 4 << 1;
+    QTest::newRow("20 columns, 4 roles, 20 keys") << 20 << 4 << 20;
+    QTest::newRow("20 columns, 4 roles, all keys") << 20 << 4 << 80;
+}
+
+void tst_QGalleryQueryModel::metaDataChanged()
+{
+    QFETCH(int, columnCount);
+    QFETCH(int, rolesPerColumn);
+    QFETCH(int, changedKeys);
+
+    QtBenchGallery gallery(propertyNames(columnCount, rolesPerColumn), 1000);
+
+    QGalleryQueryModel model(&gallery);
+    addColumns(&model, columnCount, rolesPerColumn);
+    model.execute();
+
+    QtBenchResultSet *resultSet = gallery.resultSet();
+    QVERIFY(resultSet != 0);
+
+    // Spread the changed keys across the columns.
+    QList<int> keys;
+    for (int i = 0; i < changedKeys; ++i)
+        keys.append((i * rolesPerColumn + i / columnCount) % (columnCount * rolesPerColumn));
+
+    int changes = 0;
+    connect(&model, &QAbstractItemModel::dataChanged, [&changes]() { ++changes; });
+
+    QBENCHMARK {
+        for (int row = 0; row < 1000; ++row)
+            Q_EMIT resultSet->metaDataChanged(row, 1, keys);
+    }
+
+    QVERIFY(changes > 0);
+}
+
+QTEST_MAIN(tst_QGalleryQueryModel)
+
+#include "tst_bench_qgalleryquerymodel.moc"
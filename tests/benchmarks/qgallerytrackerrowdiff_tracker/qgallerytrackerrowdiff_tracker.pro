@@ -0,0 +1,5 @@
+include(../benchmarks.pri)
+
+QT += docgallery-private
+
+SOURCES += tst_bench_qgallerytrackerrowdiff.cpp
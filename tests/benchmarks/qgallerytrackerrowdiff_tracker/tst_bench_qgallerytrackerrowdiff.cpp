@@ -0,0 +1,183 @@
+/****************************************************************************
+**
+** Copyright (C) 2012 Digia Plc and/or its subsidiary(-ies).
+** Contact: http://www.qt-project.org/legal
+**
+** This file is part of the QtDocGallery module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and Digia.  For licensing terms and
+** conditions see http://qt.digia.com/licensing.  For further information
+** use the contact form at http://qt.digia.com/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU Lesser General Public License version 2.1 requirements
+** will be met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** In addition, as a special exception, Digia gives you certain additional
+** rights.  These rights are described in the Digia Qt LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3.0 as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU General Public License version 3.0 requirements will be
+** met: http://www.gnu.org/copyleft/gpl.html.
+**
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+//TESTED_COMPONENT=src/gallery
+
+#include <private/qgallerytrackerrowdiff_p.h>
+#include <private/qgallerytrackertable_p.h>
+
+#include <QtTest/QtTest>
+
+QT_USE_DOCGALLERY_NAMESPACE
+
+class tst_QGalleryTrackerRowDiff : public QObject
+{
+    Q_OBJECT
+public:
+    enum Churn
+    {
+        Unchanged,
+        Append,
+        DeleteBlock,
+        Retag,
+        Reorder
+    };
+
+private Q_SLOTS:
+    void diff_data();
+    void diff();
+
+private:
+    static QVector<QVariant> createRows(int count);
+    static QVector<QVariant> applyChurn(const QVector<QVariant> &rows, Churn churn);
+    static void populateTable(QGalleryTrackerTable *table, const QVector<QVariant> &rows);
+
+    static const int tableWidth = 6;
+};
+
+Q_DECLARE_METATYPE(tst_QGalleryTrackerRowDiff::Churn)
+
+QVector<QVariant> tst_QGalleryTrackerRowDiff::createRows(int count)
+{
+    QVector<QVariant> rows;
+    rows.reserve(count * tableWidth);
+
+    for (int i = 0; i < count; ++i) {
+        rows.append(QString(QLatin1String("urn:uuid:%1")).arg(i));
+        rows.append(QUrl(QString(QLatin1String("file:///home/user/Pictures/image%1.jpg")).arg(i)));
+        rows.append(QString(QLatin1String("Image %1")).arg(i));
+        rows.append(i % 5);
+        rows.append(qint64(i) * 1024);
+        rows.append(QDateTime::fromMSecsSinceEpoch(qint64(i) * 60000));
+    }
+    return rows;
+}
+
+QVector<QVariant> tst_QGalleryTrackerRowDiff::applyChurn(const QVector<QVariant> &rows, Churn churn)
+{
+    QVector<QVariant> changed = rows;
+
+    const int count = rows.count() / tableWidth;
+
+    switch (churn) {
+    case Append:
+        changed += createRows(count + count / 100).mid(count * tableWidth);
+        break;
+    case DeleteBlock:
+        changed.remove((count / 2) * tableWidth, (count / 10) * tableWidth);
+        break;
+    case Retag:
+        for (int i = 0; i < count; i += 10)
+            changed[i * tableWidth + 3] = 5;
+        break;
+    case Reorder:
+        for (int i = 0; i < count; i += count / 16) {
+            const int to = count - i - 1;
+            for (int column = 0; column < tableWidth; ++column)
+                qSwap(changed[i * tableWidth + column], changed[to * tableWidth + column]);
+        }
+        break;
+    default:
+        break;
+    }
+    return changed;
+}
+
+void tst_QGalleryTrackerRowDiff::populateTable(
+        QGalleryTrackerTable *table, const QVector<QVariant> &rows)
+{
+    table->setColumnTypes(QVector<QVariant::Type>()
+            << QVariant::String
+            << QVariant::Url
+            << QVariant::String
+            << QVariant::Int
+            << QVariant::LongLong
+            << QVariant::DateTime);
+
+    for (int i = 0; i < rows.count(); i += tableWidth)
+        table->appendRow(rows.mid(i, tableWidth));
+}
+
+void tst_QGalleryTrackerRowDiff::diff_data()
+{
+    QTest::addColumn<int>("rowCount");
+    QTest::addColumn<Churn>("churn");
+
+    QTest::newRow("10k unchanged") << 10000 << Unchanged;
+    QTest::newRow("10k append") << 10000 << Append;
+    QTest::newRow("10k delete block") << 10000 << DeleteBlock;
+    QTest::newRow("10k retag") << 10000 << Retag;
+    QTest::newRow("10k reorder") << 10000 << Reorder;
+    QTest::newRow("100k unchanged") << 100000 << Unchanged;
+    QTest::newRow("100k append") << 100000 << Append;
+    QTest::newRow("100k delete block") << 100000 << DeleteBlock;
+    QTest::newRow("100k retag") << 100000 << Retag;
+    QTest::newRow("100k reorder") << 100000 << Reorder;
+}
+
+void tst_QGalleryTrackerRowDiff::diff()
+{
+    QFETCH(int, rowCount);
+    QFETCH(Churn, churn);
+
+    const QVector<QVariant> rows = createRows(rowCount);
+
+    QGalleryTrackerTable rTable;
+    populateTable(&rTable, rows);
+
+    QGalleryTrackerTable iTable;
+    populateTable(&iTable, applyChurn(rows, churn));
+
+    const QGalleryTrackerRowDiff rowDiff(1, tableWidth);
+
+    QVector<QGalleryTrackerRowDiff::Edit> edits;
+
+    QBENCHMARK {
+        edits = rowDiff.diff(rTable, iTable);
+    }
+
+    QVERIFY(!edits.isEmpty());
+    QCOMPARE(edits.last().type, QGalleryTrackerRowDiff::Edit::Finish);
+}
+
+QTEST_MAIN(tst_QGalleryTrackerRowDiff)
+
+#include "tst_bench_qgallerytrackerrowdiff.moc"
@@ -0,0 +1,192 @@
+/****************************************************************************
+**
+** Copyright (C) 2012 Digia Plc and/or its subsidiary(-ies).
+** Contact: http://www.qt-project.org/legal
+**
+** This file is part of the QtDocGallery module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and Digia.  For licensing terms and
+** conditions see http://qt.digia.com/licensing.  For further information
+** use the contact form at http://qt.digia.com/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU Lesser General Public License version 2.1 requirements
+** will be met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** In addition, as a special exception, Digia gives you certain additional
+** rights.  These rights are described in the Digia Qt LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3.0 as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU General Public License version 3.0 requirements will be
+** met: http://www.gnu.org/copyleft/gpl.html.
+**
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+//TESTED_COMPONENT=src/gallery
+
+#include <private/qgallerytrackerqueryplancache_p.h>
+#include <private/qgallerytrackerresultset_p.h>
+#include <private/qgallerytrackerschema_p.h>
+
+#include <qdocumentgallery.h>
+
+#include <QtTest/QtTest>
+
+Q_DECLARE_METATYPE(QT_DOCGALLERY_PREPEND_NAMESPACE(QGalleryFilter))
+
+QT_USE_DOCGALLERY_NAMESPACE
+
+class tst_QGalleryTrackerSchema : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void prepareQueryResponse_data();
+    void prepareQueryResponse();
+    void propertyAttributes_data();
+    void propertyAttributes();
+    void fromItemId();
+};
+
+void tst_QGalleryTrackerSchema::prepareQueryResponse_data()
+{
+    QTest::addColumn<QString>("rootType");
+    QTest::addColumn<QStringList>("propertyNames");
+    QTest::addColumn<QStringList>("sortPropertyNames");
+    QTest::addColumn<QGalleryFilter>("filter");
+    QTest::addColumn<bool>("cached");
+
+    const QStringList imageProperties = QStringList()
+            << QLatin1String("url")
+            << QLatin1String("fileName")
+            << QLatin1String("filePath")
+            << QLatin1String("mimeType")
+            << QLatin1String("title")
+            << QLatin1String("width")
+            << QLatin1String("height")
+            << QLatin1String("dateTaken")
+            << QLatin1String("orientation")
+            << QLatin1String("lastModified");
+    const QStringList audioProperties = QStringList()
+            << QLatin1String("url")
+            << QLatin1String("title")
+            << QLatin1String("artist")
+            << QLatin1String("albumTitle")
+            << QLatin1String("trackNumber")
+            << QLatin1String("duration");
+
+    const QGalleryFilter imageFilter = QGalleryIntersectionFilter(
+            QDocumentGallery::fileName.startsWith(QLatin1String("IMG")))
+            && QDocumentGallery::width > 1024;
+    const QGalleryFilter audioFilter = QDocumentGallery::title.contains(QLatin1String("love"));
+
+    for (int cached = 0; cached < 2; ++cached) {
+        const char *suffix = cached ? " cached" : "";
+
+        QTest::newRow(QByteArray(QByteArray("Image") + suffix).constData())
+                << QString::fromLatin1("Image")
+                << imageProperties
+                << (QStringList() << QLatin1String("-dateTaken"))
+                << QGalleryFilter()
+                << bool(cached);
+        QTest::newRow(QByteArray(QByteArray("Image filtered") + suffix).constData())
+                << QString::fromLatin1("Image")
+                << imageProperties
+                << (QStringList() << QLatin1String("-dateTaken") << QLatin1String("fileName"))
+                << imageFilter
+                << bool(cached);
+        QTest::newRow(QByteArray(QByteArray("Audio filtered") + suffix).constData())
+                << QString::fromLatin1("Audio")
+                << audioProperties
+                << (QStringList() << QLatin1String("artist") << QLatin1String("trackNumber"))
+                << audioFilter
+                << bool(cached);
+    }
+}
+
+void tst_QGalleryTrackerSchema::prepareQueryResponse()
+{
+    QFETCH(QString, rootType);
+    QFETCH(QStringList, propertyNames);
+    QFETCH(QStringList, sortPropertyNames);
+    QFETCH(QGalleryFilter, filter);
+    QFETCH(bool, cached);
+
+    QGalleryTrackerQueryPlanCache planCache;
+
+    QBENCHMARK {
+        // The schema is constructed per request by the gallery, so include it in the cost.
+        QGalleryTrackerSchema schema(rootType);
+        QGalleryTrackerResultSetArguments arguments;
+
+        schema.prepareQueryResponse(
+                &arguments,
+                QGalleryQueryRequest::AllDescendants,
+                QString(),
+                filter,
+                propertyNames,
+                sortPropertyNames,
+                0,
+                0,
+                cached ? &planCache : 0);
+    }
+}
+
+void tst_QGalleryTrackerSchema::propertyAttributes_data()
+{
+    QTest::addColumn<QString>("rootType");
+
+    QTest::newRow("File") << QString::fromLatin1("File");
+    QTest::newRow("Image") << QString::fromLatin1("Image");
+    QTest::newRow("Audio") << QString::fromLatin1("Audio");
+    QTest::newRow("Video") << QString::fromLatin1("Video");
+}
+
+void tst_QGalleryTrackerSchema::propertyAttributes()
+{
+    QFETCH(QString, rootType);
+
+    const QGalleryTrackerSchema schema(rootType);
+    const QStringList propertyNames = schema.supportedPropertyNames();
+
+    QVERIFY(!propertyNames.isEmpty());
+
+    QBENCHMARK {
+        for (int i = 0; i < propertyNames.count(); ++i)
+            schema.propertyAttributes(propertyNames.at(i));
+    }
+}
+
+void tst_QGalleryTrackerSchema::fromItemId()
+{
+    const QStringList itemIds = QStringList()
+            << QLatin1String("file::urn:uuid:0001")
+            << QLatin1String("image::urn:uuid:0002")
+            << QLatin1String("audioGenre::Jazz")
+            << QLatin1String("photoAlbum::urn:uuid:0003");
+
+    QBENCHMARK {
+        for (int i = 0; i < itemIds.count(); ++i)
+            QGalleryTrackerSchema::fromItemId(itemIds.at(i));
+    }
+}
+
+QTEST_MAIN(tst_QGalleryTrackerSchema)
+
+#include "tst_bench_qgallerytrackerschema.moc"
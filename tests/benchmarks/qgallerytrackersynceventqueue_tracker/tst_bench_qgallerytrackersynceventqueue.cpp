@@ -0,0 +1,171 @@
+/****************************************************************************
+**
+** Copyright (C) 2012 Digia Plc and/or its subsidiary(-ies).
+** Contact: http://www.qt-project.org/legal
+**
+** This file is part of the QtDocGallery module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and Digia.  For licensing terms and
+** conditions see http://qt.digia.com/licensing.  For further information
+** use the contact form at http://qt.digia.com/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU Lesser General Public License version 2.1 requirements
+** will be met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** In addition, as a special exception, Digia gives you certain additional
+** rights.  These rights are described in the Digia Qt LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3.0 as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU General Public License version 3.0 requirements will be
+** met: http://www.gnu.org/copyleft/gpl.html.
+**
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+//TESTED_COMPONENT=src/gallery
+
+#include <private/qgallerytrackersynceventqueue_p.h>
+
+#include <QtCore/qthread.h>
+#include <QtTest/QtTest>
+
+QT_USE_DOCGALLERY_NAMESPACE
+
+static QGalleryTrackerSyncEvent qt_createSyncEvent(int index, bool adjacent)
+{
+    // Adjacent updates are merged as they're dequeued, moves never are.
+    return adjacent
+            ? QGalleryTrackerSyncEvent::updateEvent(index, index, 1)
+            : QGalleryTrackerSyncEvent::moveEvent(index, 1, index + 2);
+}
+
+class tst_QGalleryTrackerSyncEventQueue : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void sameThread_data();
+    void sameThread();
+    void crossThread_data();
+    void crossThread();
+};
+
+class QtTestSyncEventProducer : public QThread
+{
+public:
+    QtTestSyncEventProducer(QGalleryTrackerSyncEventQueue *queue, int count, bool adjacent)
+        : m_queue(queue), m_count(count), m_adjacent(adjacent) {}
+
+protected:
+    void run()
+    {
+        for (int i = 0; i < m_count; ++i)
+            m_queue->enqueue(qt_createSyncEvent(i, m_adjacent));
+        m_queue->enqueue(QGalleryTrackerSyncEvent::finishEvent(m_count, m_count));
+    }
+
+private:
+    QGalleryTrackerSyncEventQueue *m_queue;
+    const int m_count;
+    const bool m_adjacent;
+};
+
+void tst_QGalleryTrackerSyncEventQueue::sameThread_data()
+{
+    QTest::addColumn<int>("count");
+    QTest::addColumn<bool>("adjacent");
+
+    QTest::newRow("64 moves") << 64 << false;
+    QTest::newRow("64 updates") << 64 << true;
+    QTest::newRow("4k moves") << 4096 << false;
+    QTest::newRow("4k updates") << 4096 << true;
+}
+
+void tst_QGalleryTrackerSyncEventQueue::sameThread()
+{
+    QFETCH(int, count);
+    QFETCH(bool, adjacent);
+
+    QGalleryTrackerSyncEventQueue queue;
+    QGalleryTrackerSyncEvent event;
+
+    int dequeued = 0;
+
+    // Batches larger than the ring's capacity exercise the overflow queue.
+    QBENCHMARK {
+        for (int i = 0; i < count; ++i)
+            queue.enqueue(qt_createSyncEvent(i, adjacent));
+
+        dequeued = 0;
+        while (queue.dequeue(&event))
+            ++dequeued;
+    }
+
+    QVERIFY(queue.isEmpty());
+    if (adjacent)
+        QVERIFY(dequeued < count);
+    else
+        QCOMPARE(dequeued, count);
+}
+
+void tst_QGalleryTrackerSyncEventQueue::crossThread_data()
+{
+    QTest::addColumn<int>("count");
+    QTest::addColumn<bool>("adjacent");
+
+    QTest::newRow("100k moves") << 100000 << false;
+    QTest::newRow("100k updates") << 100000 << true;
+}
+
+void tst_QGalleryTrackerSyncEventQueue::crossThread()
+{
+    QFETCH(int, count);
+    QFETCH(bool, adjacent);
+
+    QBENCHMARK {
+        QGalleryTrackerSyncEventQueue queue;
+        QtTestSyncEventProducer producer(&queue, count, adjacent);
+
+        producer.start();
+
+        QGalleryTrackerSyncEvent event;
+        int rowCount = 0;
+
+        for (bool finished = false; !finished; ) {
+            while (queue.dequeue(&event)) {
+                if (event.type == QGalleryTrackerSyncEvent::Finish) {
+                    finished = true;
+                    break;
+                }
+                rowCount += event.rCount;
+            }
+
+            if (!finished)
+                queue.waitForEvent(1000);
+        }
+
+        producer.wait();
+
+        QCOMPARE(rowCount, count);
+    }
+}
+
+QTEST_MAIN(tst_QGalleryTrackerSyncEventQueue)
+
+#include "tst_bench_qgallerytrackersynceventqueue.moc"